@@ -0,0 +1,55 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/AtomicWait.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace Common
+{
+#ifdef __linux__
+
+static_assert(sizeof(std::atomic<s32>) == sizeof(s32), "futexes operate on plain 32-bit words");
+
+void AtomicWait(const std::atomic<s32>& value, s32 old)
+{
+  syscall(SYS_futex, reinterpret_cast<const s32*>(&value), FUTEX_WAIT_PRIVATE, old, nullptr,
+          nullptr, 0);
+}
+
+void AtomicNotifyAll(std::atomic<s32>& value)
+{
+  syscall(SYS_futex, reinterpret_cast<s32*>(&value), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr,
+          nullptr, 0);
+}
+
+#else
+
+static std::mutex s_wait_mutex;
+static std::condition_variable s_wait_condvar;
+
+void AtomicWait(const std::atomic<s32>& value, s32 old)
+{
+  // The notifier takes the mutex after changing the value, so either we see the new value here
+  // or we are already waiting when the notification arrives.
+  std::unique_lock<std::mutex> lk(s_wait_mutex);
+  if (value.load() == old)
+    s_wait_condvar.wait(lk);
+}
+
+void AtomicNotifyAll(std::atomic<s32>& value)
+{
+  std::lock_guard<std::mutex> lk(s_wait_mutex);
+  s_wait_condvar.notify_all();
+}
+
+#endif
+}  // namespace Common
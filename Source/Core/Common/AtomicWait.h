@@ -0,0 +1,23 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Wait/notify on an atomic integer, similar to C++20's std::atomic<T>::wait/notify_all.
+// * AtomicWait(value, old): blocks while value == old. May return spuriously.
+// * AtomicNotifyAll(value): wakes all threads blocked on value.
+//
+// On Linux (and Android) this maps directly onto futexes, so a notify costs a single syscall and
+// nothing at all has to be locked. Other platforms share one condition variable between all
+// waiters.
+
+#pragma once
+
+#include <atomic>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+void AtomicWait(const std::atomic<s32>& value, s32 old);
+void AtomicNotifyAll(std::atomic<s32>& value);
+}  // namespace Common
@@ -10,9 +10,11 @@
 #include "Common/CPUDetect.h"
 #include "Common/CommonFuncs.h"
 #include "Common/Intrinsics.h"
+#include "Common/Swap.h"
 
 #ifdef _M_ARM_64
 #include <arm_acle.h>
+#include <arm_neon.h>
 #endif
 
 namespace Common
@@ -501,14 +503,387 @@ static u64 GetMurmurHash3(const u8* src, u32 len, u32 samples)
 }
 #endif
 
+// XXH3, the 64-bit variant with the default secret and a seed of 0. The long input loop is the
+// part which matters for textures, so it comes in SSE2, AVX2 and NEON flavors. All of them produce
+// the same hashes as the reference implementation.
+
+constexpr u32 XXH_PRIME32_1 = 0x9E3779B1U;
+constexpr u32 XXH_PRIME32_2 = 0x85EBCA77U;
+constexpr u32 XXH_PRIME32_3 = 0xC2B2AE3DU;
+constexpr u64 XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+constexpr u64 XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr u64 XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+constexpr u64 XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+constexpr u64 XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+constexpr u64 XXH_PRIME_MX1 = 0x165667919E3779F9ULL;
+constexpr u64 XXH_PRIME_MX2 = 0x9FB21C651E98DF25ULL;
+
+constexpr size_t XXH3_STRIPE_LEN = 64;
+constexpr size_t XXH3_SECRET_CONSUME_RATE = 8;
+constexpr size_t XXH3_SECRET_SIZE = 192;
+constexpr size_t XXH3_STRIPES_PER_BLOCK =
+    (XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / XXH3_SECRET_CONSUME_RATE;
+constexpr size_t XXH3_BLOCK_LEN = XXH3_STRIPE_LEN * XXH3_STRIPES_PER_BLOCK;
+
+alignas(64) static const u8 s_xxh3_secret[XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+static u32 XXH3Read32(const u8* p)
+{
+  u32 value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+static u64 XXH3Read64(const u8* p)
+{
+  u64 value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Returns the low and high halves of the 128-bit product xor'd together.
+static u64 XXH3Mul128Fold64(u64 a, u64 b)
+{
+#if defined(__SIZEOF_INT128__)
+  const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+  return static_cast<u64>(product) ^ static_cast<u64>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X86_64)
+  u64 high;
+  const u64 low = _umul128(a, b, &high);
+  return low ^ high;
+#else
+  const u64 lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  const u64 hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+  const u64 lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+  const u64 hi_hi = (a >> 32) * (b >> 32);
+  const u64 cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+  const u64 high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+  const u64 low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+  return low ^ high;
+#endif
+}
+
+static u64 XXH64Avalanche(u64 h)
+{
+  h ^= h >> 33;
+  h *= XXH_PRIME64_2;
+  h ^= h >> 29;
+  h *= XXH_PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+static u64 XXH3Avalanche(u64 h)
+{
+  h ^= h >> 37;
+  h *= XXH_PRIME_MX1;
+  h ^= h >> 32;
+  return h;
+}
+
+static u64 XXH3RRMXMX(u64 h, u64 len)
+{
+  h ^= Common::RotateLeft(h, 49) ^ Common::RotateLeft(h, 24);
+  h *= XXH_PRIME_MX2;
+  h ^= (h >> 35) + len;
+  h *= XXH_PRIME_MX2;
+  return h ^ (h >> 28);
+}
+
+static u64 XXH3Mix16B(const u8* input, const u8* secret)
+{
+  return XXH3Mul128Fold64(XXH3Read64(input) ^ XXH3Read64(secret),
+                          XXH3Read64(input + 8) ^ XXH3Read64(secret + 8));
+}
+
+static u64 XXH3HashShort(const u8* input, size_t len)
+{
+  const u8* secret = s_xxh3_secret;
+  if (len > 8)
+  {
+    const u64 input_lo = XXH3Read64(input) ^ (XXH3Read64(secret + 24) ^ XXH3Read64(secret + 32));
+    const u64 input_hi =
+        XXH3Read64(input + len - 8) ^ (XXH3Read64(secret + 40) ^ XXH3Read64(secret + 48));
+    const u64 acc =
+        len + Common::swap64(input_lo) + input_hi + XXH3Mul128Fold64(input_lo, input_hi);
+    return XXH3Avalanche(acc);
+  }
+  if (len >= 4)
+  {
+    const u64 input64 = XXH3Read32(input + len - 4) + (u64{XXH3Read32(input)} << 32);
+    return XXH3RRMXMX(input64 ^ (XXH3Read64(secret + 8) ^ XXH3Read64(secret + 16)), len);
+  }
+  if (len > 0)
+  {
+    const u32 combined = (u32{input[0]} << 16) | (u32{input[len >> 1]} << 24) |
+                         u32{input[len - 1]} | (static_cast<u32>(len) << 8);
+    return XXH64Avalanche(combined ^ (XXH3Read32(secret) ^ XXH3Read32(secret + 4)));
+  }
+  return XXH64Avalanche(XXH3Read64(secret + 56) ^ XXH3Read64(secret + 64));
+}
+
+static u64 XXH3HashMedium(const u8* input, size_t len)
+{
+  const u8* secret = s_xxh3_secret;
+  u64 acc = len * XXH_PRIME64_1;
+  if (len <= 128)
+  {
+    if (len > 32)
+    {
+      if (len > 64)
+      {
+        if (len > 96)
+        {
+          acc += XXH3Mix16B(input + 48, secret + 96);
+          acc += XXH3Mix16B(input + len - 64, secret + 112);
+        }
+        acc += XXH3Mix16B(input + 32, secret + 64);
+        acc += XXH3Mix16B(input + len - 48, secret + 80);
+      }
+      acc += XXH3Mix16B(input + 16, secret + 32);
+      acc += XXH3Mix16B(input + len - 32, secret + 48);
+    }
+    acc += XXH3Mix16B(input, secret);
+    acc += XXH3Mix16B(input + len - 16, secret + 16);
+    return XXH3Avalanche(acc);
+  }
+
+  // 129 to 240 bytes
+  const size_t rounds = len / 16;
+  for (size_t i = 0; i < 8; i++)
+    acc += XXH3Mix16B(input + 16 * i, secret + 16 * i);
+  acc = XXH3Avalanche(acc);
+  for (size_t i = 8; i < rounds; i++)
+    acc += XXH3Mix16B(input + 16 * i, secret + 16 * (i - 8) + 3);
+  acc += XXH3Mix16B(input + len - 16, secret + 136 - 17);
+  return XXH3Avalanche(acc);
+}
+
+#if defined(_M_X86_64)
+
+static void XXH3AccumulateSSE2(u64* acc, const u8* input, const u8* secret, size_t num_stripes)
+{
+  __m128i* acc_vec = reinterpret_cast<__m128i*>(acc);
+  for (size_t stripe = 0; stripe < num_stripes; stripe++)
+  {
+    const u8* stripe_input = input + stripe * XXH3_STRIPE_LEN;
+    const u8* stripe_secret = secret + stripe * XXH3_SECRET_CONSUME_RATE;
+    for (size_t i = 0; i < 4; i++)
+    {
+      const __m128i data =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe_input + 16 * i));
+      const __m128i key = _mm_xor_si128(
+          data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(stripe_secret + 16 * i)));
+      const __m128i product =
+          _mm_mul_epu32(key, _mm_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+      const __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+      acc_vec[i] = _mm_add_epi64(acc_vec[i], _mm_add_epi64(product, swapped));
+    }
+  }
+}
+
+static void XXH3ScrambleSSE2(u64* acc, const u8* secret)
+{
+  __m128i* acc_vec = reinterpret_cast<__m128i*>(acc);
+  const __m128i prime = _mm_set1_epi32(XXH_PRIME32_1);
+  for (size_t i = 0; i < 4; i++)
+  {
+    __m128i value = _mm_xor_si128(acc_vec[i], _mm_srli_epi64(acc_vec[i], 47));
+    value = _mm_xor_si128(value,
+                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret + 16 * i)));
+    const __m128i product_low = _mm_mul_epu32(value, prime);
+    const __m128i product_high =
+        _mm_mul_epu32(_mm_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+    acc_vec[i] = _mm_add_epi64(product_low, _mm_slli_epi64(product_high, 32));
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void XXH3AccumulateAVX2(u64* acc, const u8* input, const u8* secret, size_t num_stripes)
+{
+  __m256i acc_vec[2] = {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc)),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + 4))};
+  for (size_t stripe = 0; stripe < num_stripes; stripe++)
+  {
+    const u8* stripe_input = input + stripe * XXH3_STRIPE_LEN;
+    const u8* stripe_secret = secret + stripe * XXH3_SECRET_CONSUME_RATE;
+    for (size_t i = 0; i < 2; i++)
+    {
+      const __m256i data =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stripe_input + 32 * i));
+      const __m256i key = _mm256_xor_si256(
+          data, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(stripe_secret + 32 * i)));
+      const __m256i product =
+          _mm256_mul_epu32(key, _mm256_shuffle_epi32(key, _MM_SHUFFLE(0, 3, 0, 1)));
+      const __m256i swapped = _mm256_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+      acc_vec[i] = _mm256_add_epi64(acc_vec[i], _mm256_add_epi64(product, swapped));
+    }
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc), acc_vec[0]);
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + 4), acc_vec[1]);
+}
+
+FUNCTION_TARGET_AVX2
+static void XXH3ScrambleAVX2(u64* acc, const u8* secret)
+{
+  const __m256i prime = _mm256_set1_epi32(XXH_PRIME32_1);
+  for (size_t i = 0; i < 2; i++)
+  {
+    __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + 4 * i));
+    value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+    value = _mm256_xor_si256(
+        value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret + 32 * i)));
+    const __m256i product_low = _mm256_mul_epu32(value, prime);
+    const __m256i product_high =
+        _mm256_mul_epu32(_mm256_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + 4 * i),
+                        _mm256_add_epi64(product_low, _mm256_slli_epi64(product_high, 32)));
+  }
+}
+
+#elif defined(_M_ARM_64)
+
+static void XXH3AccumulateNEON(u64* acc, const u8* input, const u8* secret, size_t num_stripes)
+{
+  uint64x2_t acc_vec[4] = {vld1q_u64(acc), vld1q_u64(acc + 2), vld1q_u64(acc + 4),
+                           vld1q_u64(acc + 6)};
+  for (size_t stripe = 0; stripe < num_stripes; stripe++)
+  {
+    const u8* stripe_input = input + stripe * XXH3_STRIPE_LEN;
+    const u8* stripe_secret = secret + stripe * XXH3_SECRET_CONSUME_RATE;
+    for (size_t i = 0; i < 4; i++)
+    {
+      const uint64x2_t data = vreinterpretq_u64_u8(vld1q_u8(stripe_input + 16 * i));
+      const uint64x2_t key =
+          veorq_u64(data, vreinterpretq_u64_u8(vld1q_u8(stripe_secret + 16 * i)));
+      const uint64x2_t swapped = vextq_u64(data, data, 1);
+      acc_vec[i] = vaddq_u64(acc_vec[i], swapped);
+      acc_vec[i] = vmlal_u32(acc_vec[i], vmovn_u64(key), vshrn_n_u64(key, 32));
+    }
+  }
+  for (size_t i = 0; i < 4; i++)
+    vst1q_u64(acc + 2 * i, acc_vec[i]);
+}
+
+static void XXH3ScrambleNEON(u64* acc, const u8* secret)
+{
+  const uint32x2_t prime = vdup_n_u32(XXH_PRIME32_1);
+  for (size_t i = 0; i < 4; i++)
+  {
+    uint64x2_t value = vld1q_u64(acc + 2 * i);
+    value = veorq_u64(value, vshrq_n_u64(value, 47));
+    value = veorq_u64(value, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+    const uint64x2_t product_high = vshlq_n_u64(vmull_u32(vshrn_n_u64(value, 32), prime), 32);
+    vst1q_u64(acc + 2 * i, vmlal_u32(product_high, vmovn_u64(value), prime));
+  }
+}
+
+#else
+
+// Accumulates num_stripes 64 byte stripes, advancing through the secret by 8 bytes per stripe.
+static void XXH3AccumulateScalar(u64* acc, const u8* input, const u8* secret, size_t num_stripes)
+{
+  for (size_t stripe = 0; stripe < num_stripes; stripe++)
+  {
+    const u8* stripe_input = input + stripe * XXH3_STRIPE_LEN;
+    const u8* stripe_secret = secret + stripe * XXH3_SECRET_CONSUME_RATE;
+    for (size_t i = 0; i < 8; i++)
+    {
+      const u64 data = XXH3Read64(stripe_input + 8 * i);
+      const u64 key = data ^ XXH3Read64(stripe_secret + 8 * i);
+      acc[i ^ 1] += data;
+      acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+    }
+  }
+}
+
+static void XXH3ScrambleScalar(u64* acc, const u8* secret)
+{
+  for (size_t i = 0; i < 8; i++)
+  {
+    u64 value = acc[i];
+    value ^= value >> 47;
+    value ^= XXH3Read64(secret + 8 * i);
+    acc[i] = value * XXH_PRIME32_1;
+  }
+}
+
+#endif
+
+template <void (*Accumulate)(u64*, const u8*, const u8*, size_t),
+          void (*Scramble)(u64*, const u8*)>
+static u64 XXH3HashLong(const u8* input, size_t len)
+{
+  alignas(32) u64 acc[8] = {XXH_PRIME32_3, XXH_PRIME64_1, XXH_PRIME64_2, XXH_PRIME64_3,
+                            XXH_PRIME64_4, XXH_PRIME32_2, XXH_PRIME64_5, XXH_PRIME32_1};
+
+  const size_t num_blocks = (len - 1) / XXH3_BLOCK_LEN;
+  for (size_t block = 0; block < num_blocks; block++)
+  {
+    Accumulate(acc, input + block * XXH3_BLOCK_LEN, s_xxh3_secret, XXH3_STRIPES_PER_BLOCK);
+    Scramble(acc, s_xxh3_secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+  }
+
+  const size_t num_stripes = ((len - 1) - num_blocks * XXH3_BLOCK_LEN) / XXH3_STRIPE_LEN;
+  Accumulate(acc, input + num_blocks * XXH3_BLOCK_LEN, s_xxh3_secret, num_stripes);
+  Accumulate(acc, input + len - XXH3_STRIPE_LEN,
+             s_xxh3_secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - 7, 1);
+
+  u64 result = len * XXH_PRIME64_1;
+  for (size_t i = 0; i < 4; i++)
+    result += XXH3Mul128Fold64(acc[2 * i] ^ XXH3Read64(s_xxh3_secret + 11 + 16 * i),
+                               acc[2 * i + 1] ^ XXH3Read64(s_xxh3_secret + 11 + 16 * i + 8));
+  return XXH3Avalanche(result);
+}
+
+template <void (*Accumulate)(u64*, const u8*, const u8*, size_t),
+          void (*Scramble)(u64*, const u8*)>
+static u64 GetXXH3Hash(const u8* src, u32 len, u32 samples)
+{
+  // Hashing everything is fast enough that the sample count is ignored.
+  if (len <= 16)
+    return XXH3HashShort(src, len);
+  if (len <= 240)
+    return XXH3HashMedium(src, len);
+  return XXH3HashLong<Accumulate, Scramble>(src, len);
+}
+
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
   return ptrHashFunction(src, len, samples);
 }
 
 // sets the hash function used for the texture cache
-void SetHash64Function()
+void SetHash64Function(Hash64Function function)
 {
+  if (function == Hash64Function::XXH3)
+  {
+#if defined(_M_X86_64)
+    if (cpu_info.bAVX2)
+      ptrHashFunction = &GetXXH3Hash<XXH3AccumulateAVX2, XXH3ScrambleAVX2>;
+    else
+      ptrHashFunction = &GetXXH3Hash<XXH3AccumulateSSE2, XXH3ScrambleSSE2>;
+#elif defined(_M_ARM_64)
+    ptrHashFunction = &GetXXH3Hash<XXH3AccumulateNEON, XXH3ScrambleNEON>;
+#else
+    ptrHashFunction = &GetXXH3Hash<XXH3AccumulateScalar, XXH3ScrambleScalar>;
+#endif
+    return;
+  }
+
 #if defined(_M_X86_64) || defined(_M_X86)
   if (cpu_info.bSSE4_2)  // sse crc32 version
   {
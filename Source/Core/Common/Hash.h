@@ -13,6 +13,16 @@ namespace Common
 u32 HashFletcher(const u8* data_u8, size_t length);  // FAST. Length & 1 == 0.
 u32 HashAdler32(const u8* data, size_t len);         // Fairly accurate, slightly slower
 u32 HashEctor(const u8* ptr, int length);            // JUNK. DO NOT USE FOR NEW THINGS
+
+enum class Hash64Function
+{
+  // CRC32 where the host has instructions for it, MurmurHash3 otherwise. Only hashes the given
+  // number of samples, or everything if that is 0.
+  Sampled,
+  // XXH3. Always hashes everything.
+  XXH3,
+};
+
 u64 GetHash64(const u8* src, u32 len, u32 samples);
-void SetHash64Function();
+void SetHash64Function(Hash64Function function = Hash64Function::Sampled);
 }  // namespace Common
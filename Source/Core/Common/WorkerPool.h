@@ -0,0 +1,157 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Thread.h"
+
+// A fixed set of threads that cooperatively run a batch of independent jobs.
+//
+// ParallelFor() hands out job indices to the workers and the calling thread alike and
+// returns once every job has completed, so callers can treat it like a plain loop.
+// Only one thread may submit work to a pool at a time.
+
+namespace Common
+{
+class WorkerPool
+{
+public:
+  WorkerPool() = default;
+  WorkerPool(u32 num_threads, std::string name) { Reset(num_threads, std::move(name)); }
+  ~WorkerPool() { Shutdown(); }
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  void Reset(u32 num_threads, std::string name)
+  {
+    Shutdown();
+    m_name = std::move(name);
+    m_exit = false;
+    for (u32 i = 0; i < num_threads; i++)
+      m_threads.emplace_back([this] { ThreadLoop(); });
+  }
+
+  void Shutdown()
+  {
+    if (m_threads.empty())
+      return;
+
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_exit = true;
+    }
+    m_wakeup.notify_all();
+    for (std::thread& thread : m_threads)
+      thread.join();
+    m_threads.clear();
+  }
+
+  u32 GetThreadCount() const { return static_cast<u32>(m_threads.size()); }
+
+  // The automatic number of workers for a pool fed by the GPU thread. That thread runs jobs
+  // itself and the CPU thread needs a core too, so we use clamp(cpus - 2, 0, 3).
+  static u32 GetDefaultThreadCount()
+  {
+    return static_cast<u32>(std::min(std::max(cpu_info.num_cores - 2, 0), 3));
+  }
+
+  // Calls function(i) for every i in [0, num_jobs). Job order is unspecified.
+  void ParallelFor(u32 num_jobs, const std::function<void(u32)>& function)
+  {
+    if (m_threads.empty() || num_jobs <= 1)
+    {
+      for (u32 i = 0; i < num_jobs; i++)
+        function(i);
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(m_lock);
+      m_function = &function;
+      m_num_jobs = num_jobs;
+      m_next_job.store(0);
+      m_pending_jobs.store(num_jobs);
+      m_generation++;
+    }
+    m_wakeup.notify_all();
+
+    RunJobs(function, num_jobs);
+
+    std::unique_lock<std::mutex> lk(m_lock);
+    m_done.wait(lk, [this] { return m_pending_jobs.load() == 0 && m_active_workers == 0; });
+    m_function = nullptr;
+  }
+
+private:
+  void RunJobs(const std::function<void(u32)>& function, u32 num_jobs)
+  {
+    for (u32 job = m_next_job.fetch_add(1); job < num_jobs; job = m_next_job.fetch_add(1))
+    {
+      function(job);
+      if (m_pending_jobs.fetch_sub(1) == 1)
+      {
+        std::lock_guard<std::mutex> lk(m_lock);
+        m_done.notify_all();
+      }
+    }
+  }
+
+  void ThreadLoop()
+  {
+    Common::SetCurrentThreadName(m_name.c_str());
+
+    u64 seen_generation = 0;
+    std::unique_lock<std::mutex> lk(m_lock);
+    while (true)
+    {
+      m_wakeup.wait(lk, [&] { return m_exit || seen_generation != m_generation; });
+      if (m_exit)
+        return;
+
+      // Workers that wake up after the batch has finished just skip it.
+      seen_generation = m_generation;
+      if (!m_function)
+        continue;
+
+      const std::function<void(u32)>& function = *m_function;
+      const u32 num_jobs = m_num_jobs;
+      m_active_workers++;
+      lk.unlock();
+
+      RunJobs(function, num_jobs);
+
+      lk.lock();
+      if (--m_active_workers == 0)
+        m_done.notify_all();
+    }
+  }
+
+  std::string m_name;
+  std::vector<std::thread> m_threads;
+
+  std::mutex m_lock;
+  std::condition_variable m_wakeup;
+  std::condition_variable m_done;
+  bool m_exit = false;
+  u64 m_generation = 0;
+  u32 m_active_workers = 0;
+
+  const std::function<void(u32)>* m_function = nullptr;
+  u32 m_num_jobs = 0;
+  std::atomic<u32> m_next_job{0};
+  std::atomic<u32> m_pending_jobs{0};
+};
+
+}  // namespace Common
@@ -39,6 +39,7 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_ASPECT_RATIO.location,
       Config::GFX_CROP.location,
       Config::GFX_SAFE_TEXTURE_CACHE_COLOR_SAMPLES.location,
+      Config::GFX_FULL_TEXTURE_HASH.location,
       Config::GFX_SHOW_FPS.location,
       Config::GFX_SHOW_NETPLAY_PING.location,
       Config::GFX_SHOW_NETPLAY_MESSAGES.location,
@@ -48,6 +49,10 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_DUMP_TEXTURES.location,
       Config::GFX_HIRES_TEXTURES.location,
       Config::GFX_CACHE_HIRES_TEXTURES.location,
+      Config::GFX_STREAM_HIRES_TEXTURES.location,
+      Config::GFX_HIRES_TEXTURE_CACHE_SIZE.location,
+      Config::GFX_CACHE_DECODED_TEXTURES.location,
+      Config::GFX_DECODED_TEXTURE_CACHE_SIZE.location,
       Config::GFX_DUMP_EFB_TARGET.location,
       Config::GFX_DUMP_FRAMES_AS_IMAGES.location,
       Config::GFX_FREE_LOOK.location,
@@ -77,6 +82,8 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_SHADER_COMPILATION_MODE.location,
       Config::GFX_SHADER_COMPILER_THREADS.location,
       Config::GFX_SHADER_PRECOMPILER_THREADS.location,
+      Config::GFX_VERTEX_LOADER_THREADS.location,
+      Config::GFX_TEXTURE_DECODER_THREADS.location,
 
       Config::GFX_SW_ZCOMPLOC.location,
       Config::GFX_SW_ZFREEZE.location,
@@ -85,6 +92,7 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       Config::GFX_SW_DUMP_TEV_TEX_FETCHES.location,
       Config::GFX_SW_DRAW_START.location,
       Config::GFX_SW_DRAW_END.location,
+      Config::GFX_SW_RASTERIZER_THREADS.location,
 
       // Graphics.Enhancements
 
@@ -108,10 +116,13 @@ bool IsSettingSaveable(const Config::ConfigLocation& config_location)
       // Graphics.Hacks
 
       Config::GFX_HACK_EFB_ACCESS_ENABLE.location,
+      Config::GFX_HACK_EFB_ACCESS_PREFETCH.location,
       Config::GFX_HACK_BBOX_ENABLE.location,
       Config::GFX_HACK_BBOX_PREFER_STENCIL_IMPLEMENTATION.location,
       Config::GFX_HACK_FORCE_PROGRESSIVE.location,
       Config::GFX_HACK_SKIP_EFB_COPY_TO_RAM.location,
+      Config::GFX_HACK_DEFER_EFB_COPIES.location,
+      Config::GFX_HACK_TRACK_TEXTURE_WRITES.location,
       Config::GFX_HACK_SKIP_XFB_COPY_TO_RAM.location,
       Config::GFX_HACK_DISABLE_COPY_TO_VRAM.location,
       Config::GFX_HACK_IMMEDIATE_XFB.location,
@@ -87,6 +87,7 @@ public:
     IsPlayingBackFifologWithBrokenEFBCopies = m_parent->m_File->HasBrokenEFBCopies();
 
     m_parent->m_CurrentFrame = m_parent->m_FrameRangeStart;
+    m_parent->m_LoopsPlayed = 0;
     m_parent->LoadMemory();
   }
 
@@ -134,7 +135,8 @@ CPU::State FifoPlayer::AdvanceFrame()
 {
   if (m_CurrentFrame >= m_FrameRangeEnd)
   {
-    if (!m_Loop)
+    ++m_LoopsPlayed;
+    if (m_LoopCount ? m_LoopsPlayed >= m_LoopCount : !m_Loop)
       return CPU::State::PowerDown;
     // If there are zero frames in the range then sleep instead of busy spinning
     if (m_FrameRangeStart >= m_FrameRangeEnd)
@@ -92,6 +92,9 @@ public:
   // If enabled then all memory updates happen at once before the first frame
   // Default is disabled
   void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
+  // If non-zero, the frame range is played this many times and then emulation stops, regardless
+  // of the loop setting. Default is zero
+  void SetLoopCount(u32 count) { m_LoopCount = count; }
   // Callbacks
   void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
   void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
@@ -139,6 +142,8 @@ private:
   static bool IsHighWatermarkSet();
 
   bool m_Loop;
+  u32 m_LoopCount = 0;
+  u32 m_LoopsPlayed = 0;
 
   u32 m_CurrentFrame = 0;
   u32 m_FrameRangeStart = 0;
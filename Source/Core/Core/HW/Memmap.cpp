@@ -10,13 +10,19 @@
 #include "Core/HW/Memmap.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <memory>
+#include <vector>
 
 #include "Common/ChunkFile.h"
+#include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/Swap.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/AudioInterface.h"
@@ -164,6 +170,188 @@ static PhysicalMemoryRegion physical_regions[] = {
 
 static std::vector<LogicalMemoryView> logical_mapped_entries;
 
+// Write tracking covers RAM followed by EXRAM, in pages of at least 4 KiB (or the host page size,
+// if that is larger). Each page has a word whose lowest bit is set while the page is write
+// protected, and whose other bits count how often a write lifted the protection. Pages can also
+// be protected from access, which takes precedence over write protection.
+constexpr u32 MIN_TRACKED_PAGE_SHIFT = 12;
+constexpr u32 MAX_TRACKED_PAGES = (RAM_SIZE + EXRAM_SIZE) >> MIN_TRACKED_PAGE_SHIFT;
+constexpr u32 TRACKED_BLOCKS = (RAM_SIZE + EXRAM_SIZE) / PowerPC::BAT_PAGE_SIZE;
+constexpr u32 NO_TRACKED_BLOCK = UINT32_MAX;
+constexpr u32 PAGE_PROTECTED = 1;
+constexpr u32 PAGE_WRITE_INCREMENT = 2;
+
+static std::atomic<bool> s_write_tracking_enabled{false};
+// Guards the page protection and the logical aliases. The fault handler takes it too, so it has
+// to be a spin lock, and nothing may touch guest memory while holding it.
+static std::atomic_flag s_write_tracking_lock = ATOMIC_FLAG_INIT;
+static u32 s_tracked_page_shift = MIN_TRACKED_PAGE_SHIFT;
+static u32 s_num_tracked_pages = 0;
+static std::array<std::atomic<u32>, MAX_TRACKED_PAGES> s_tracked_pages;
+// How often each page was protected from access and not unprotected yet
+static std::array<u16, MAX_TRACKED_PAGES> s_access_protection_counts;
+static std::atomic<AccessHandler> s_access_handler{nullptr};
+// Views of RAM and EXRAM which are never protected
+static u8* s_unprotected_ram = nullptr;
+static u8* s_unprotected_exram = nullptr;
+// The logical mappings of each BAT sized block of tracked memory, and the reverse.
+static std::array<std::vector<u8*>, TRACKED_BLOCKS> s_logical_aliases;
+static std::array<u32, 1 << (32 - PowerPC::BAT_INDEX_SHIFT)> s_logical_block_to_tracked_block;
+
+namespace
+{
+class WriteTrackingLock
+{
+public:
+  WriteTrackingLock()
+  {
+    while (s_write_tracking_lock.test_and_set(std::memory_order_acquire))
+    {
+    }
+  }
+  ~WriteTrackingLock() { s_write_tracking_lock.clear(std::memory_order_release); }
+  WriteTrackingLock(const WriteTrackingLock&) = delete;
+  WriteTrackingLock& operator=(const WriteTrackingLock&) = delete;
+};
+}  // namespace
+
+// Converts a physical range to an offset into tracked memory. Fails if the range isn't entirely
+// inside RAM or EXRAM.
+static bool GetTrackedOffset(u32 address, u32 size, u32* offset)
+{
+  address &= 0x3FFFFFFF;
+  if (size == 0)
+    return false;
+
+  if (address < RAM_SIZE && size <= RAM_SIZE - address)
+  {
+    *offset = address;
+    return true;
+  }
+
+  const u32 exram_address = address & 0x0FFFFFFF;
+  if (m_pEXRAM && (address >> 28) == 0x1 && exram_address < EXRAM_SIZE &&
+      size <= EXRAM_SIZE - exram_address)
+  {
+    *offset = RAM_SIZE + exram_address;
+    return true;
+  }
+
+  return false;
+}
+
+static u32 TrackedOffsetToPhysical(u32 offset)
+{
+  return offset < RAM_SIZE ? offset : 0x10000000 + (offset - RAM_SIZE);
+}
+
+// Needs the write tracking lock, because it looks at the logical aliases.
+static bool HostAddressToTrackedOffset(uintptr_t host_address, u32* offset)
+{
+  const uintptr_t physical = reinterpret_cast<uintptr_t>(physical_base);
+  if (physical_base && host_address >= physical && host_address - physical < 0x100000000)
+    return GetTrackedOffset(static_cast<u32>(host_address - physical), 1, offset);
+
+  const uintptr_t logical = reinterpret_cast<uintptr_t>(logical_base);
+  if (logical_base && host_address >= logical && host_address - logical < 0x100000000)
+  {
+    const u32 logical_address = static_cast<u32>(host_address - logical);
+    const u32 block = s_logical_block_to_tracked_block[logical_address >> PowerPC::BAT_INDEX_SHIFT];
+    if (block == NO_TRACKED_BLOCK)
+      return false;
+    *offset = block * PowerPC::BAT_PAGE_SIZE + (logical_address & (PowerPC::BAT_PAGE_SIZE - 1));
+    return true;
+  }
+
+  return false;
+}
+
+enum class PageAccess
+{
+  ReadWrite,
+  ReadOnly,
+  NoAccess,
+};
+
+// The protection a page needs in its current state. Needs the write tracking lock.
+static PageAccess GetPageAccess(u32 page)
+{
+  if (s_access_protection_counts[page] != 0)
+    return PageAccess::NoAccess;
+  if (s_tracked_pages[page].load(std::memory_order_relaxed) & PAGE_PROTECTED)
+    return PageAccess::ReadOnly;
+  return PageAccess::ReadWrite;
+}
+
+// Counts a write to a page and clears its write protection flag.
+static void MarkPageWritten(u32 page)
+{
+  const u32 state = s_tracked_pages[page].load(std::memory_order_relaxed);
+  s_tracked_pages[page].store((state & ~PAGE_PROTECTED) + PAGE_WRITE_INCREMENT,
+                              std::memory_order_release);
+}
+
+// Changes the protection of a run of tracked pages in all mappings. Needs the write tracking lock.
+static void SetPageProtection(u32 first_page, u32 num_pages, PageAccess access)
+{
+  u32 offset = first_page << s_tracked_page_shift;
+  const u32 end = (first_page + num_pages) << s_tracked_page_shift;
+  while (offset < end)
+  {
+    const u32 block = offset / PowerPC::BAT_PAGE_SIZE;
+    const u32 chunk_end = std::min(end, (block + 1) * PowerPC::BAT_PAGE_SIZE);
+    const size_t size = chunk_end - offset;
+
+    const auto protect = [&](u8* pointer) {
+      if (access == PageAccess::NoAccess)
+        Common::ReadProtectMemory(pointer, size);
+      else if (access == PageAccess::ReadOnly)
+        Common::WriteProtectMemory(pointer, size);
+      else
+        Common::UnWriteProtectMemory(pointer, size);
+    };
+    protect(physical_base + TrackedOffsetToPhysical(offset));
+    for (u8* alias : s_logical_aliases[block])
+      protect(alias + offset % PowerPC::BAT_PAGE_SIZE);
+
+    offset = chunk_end;
+  }
+}
+
+// Calls f(first_page, num_pages, access) for every run of pages in [first_page, end_page) which
+// need the same protection. f may change the state of the pages it is called for.
+template <typename F>
+static void ForEachPageRun(u32 first_page, u32 end_page, F f)
+{
+  u32 run_start = first_page;
+  for (u32 page = first_page + 1; page <= end_page; page++)
+  {
+    const PageAccess access = GetPageAccess(run_start);
+    if (page == end_page || GetPageAccess(page) != access)
+    {
+      f(run_start, page - run_start, access);
+      run_start = page;
+    }
+  }
+}
+
+// Lifts all protection, counting it as a write to every protected page. Needs the write tracking
+// lock.
+static void UnprotectAllPages()
+{
+  ForEachPageRun(0, s_num_tracked_pages, [](u32 first_page, u32 num_pages, PageAccess access) {
+    if (access == PageAccess::ReadWrite)
+      return;
+
+    for (u32 page = first_page; page < first_page + num_pages; page++)
+    {
+      MarkPageWritten(page);
+      s_access_protection_counts[page] = 0;
+    }
+    SetPageProtection(first_page, num_pages, PageAccess::ReadWrite);
+  });
+}
+
 void Init()
 {
   bool wii = SConfig::GetInstance().bWii;
@@ -205,12 +393,26 @@ void Init()
       PanicAlert("MemoryMap_Setup: Failed finding a memory base.");
       exit(0);
     }
+
+    if (region.out_pointer == &m_pRAM)
+      s_unprotected_ram = static_cast<u8*>(g_arena.CreateView(region.shm_position, region.size));
+    else if (region.out_pointer == &m_pEXRAM)
+      s_unprotected_exram = static_cast<u8*>(g_arena.CreateView(region.shm_position, region.size));
   }
 
 #ifndef _ARCH_32
   logical_base = physical_base + 0x200000000;
 #endif
 
+  s_tracked_page_shift = std::min<u32>(
+      std::max<u32>(IntLog2(Common::MemPageSize()), MIN_TRACKED_PAGE_SHIFT),
+      PowerPC::BAT_INDEX_SHIFT);
+  s_num_tracked_pages = (RAM_SIZE + (m_pEXRAM ? EXRAM_SIZE : 0)) >> s_tracked_page_shift;
+  for (std::atomic<u32>& page : s_tracked_pages)
+    page.store(0, std::memory_order_relaxed);
+  s_access_protection_counts.fill(0);
+  s_logical_block_to_tracked_block.fill(NO_TRACKED_BLOCK);
+
   if (wii)
     mmio_mapping = InitMMIOWii();
   else
@@ -224,11 +426,17 @@ void Init()
 
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 {
+  WriteTrackingLock lock;
+
   for (auto& entry : logical_mapped_entries)
   {
     g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
   }
   logical_mapped_entries.clear();
+  for (std::vector<u8*>& aliases : s_logical_aliases)
+    aliases.clear();
+  s_logical_block_to_tracked_block.fill(NO_TRACKED_BLOCK);
+
   for (u32 i = 0; i < dbat_table.size(); ++i)
   {
     if (dbat_table[i] & PowerPC::BAT_PHYSICAL_BIT)
@@ -257,15 +465,37 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
             exit(0);
           }
           logical_mapped_entries.push_back({mapped_pointer, mapped_size});
+
+          u32 tracked_offset;
+          if (GetTrackedOffset(intersection_start, mapped_size, &tracked_offset))
+          {
+            const u32 block = tracked_offset / PowerPC::BAT_PAGE_SIZE;
+            s_logical_aliases[block].push_back(static_cast<u8*>(mapped_pointer));
+            s_logical_block_to_tracked_block[i] = block;
+          }
         }
       }
     }
   }
+
+  // The new mappings start out writable.
+  if (s_write_tracking_enabled.load(std::memory_order_relaxed))
+  {
+    ForEachPageRun(0, s_num_tracked_pages, [](u32 first_page, u32 num_pages, PageAccess access) {
+      if (access != PageAccess::ReadWrite)
+        SetPageProtection(first_page, num_pages, access);
+    });
+  }
 }
 
 void DoState(PointerWrap& p)
 {
   bool wii = SConfig::GetInstance().bWii;
+  if (p.GetMode() == PointerWrap::MODE_READ && s_write_tracking_enabled.load())
+  {
+    WriteTrackingLock lock;
+    UnprotectAllPages();
+  }
   p.DoArray(m_pRAM, RAM_SIZE);
   p.DoArray(m_pL1Cache, L1_CACHE_SIZE);
   p.DoMarker("Memory RAM");
@@ -279,6 +509,7 @@ void DoState(PointerWrap& p)
 
 void Shutdown()
 {
+  DisableWriteTracking();
   m_IsInitialized = false;
   u32 flags = 0;
   if (SConfig::GetInstance().bWii)
@@ -297,6 +528,14 @@ void Shutdown()
     g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
   }
   logical_mapped_entries.clear();
+  for (std::vector<u8*>& aliases : s_logical_aliases)
+    aliases.clear();
+  if (s_unprotected_ram)
+    g_arena.ReleaseView(s_unprotected_ram, RAM_SIZE);
+  if (s_unprotected_exram)
+    g_arena.ReleaseView(s_unprotected_exram, EXRAM_SIZE);
+  s_unprotected_ram = nullptr;
+  s_unprotected_exram = nullptr;
   g_arena.ReleaseSHMSegment();
   physical_base = nullptr;
   logical_base = nullptr;
@@ -461,4 +700,262 @@ void Write_U64_Swap(u64 value, u32 address)
   std::memcpy(GetPointer(address), &value, sizeof(u64));
 }
 
+void EnableWriteTracking()
+{
+  // The tracking relies on fastmem's memory layout.
+  if (!physical_base || !logical_base)
+    return;
+
+  s_write_tracking_enabled.store(true);
+}
+
+void DisableWriteTracking()
+{
+  WriteTrackingLock lock;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed))
+    return;
+
+  UnprotectAllPages();
+  s_write_tracking_enabled.store(false);
+}
+
+u64 TrackWrites(u32 address, u32 size)
+{
+  u32 offset;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed) ||
+      !GetTrackedOffset(address, size, &offset))
+  {
+    return WRITE_TOKEN_INVALID;
+  }
+
+  const u32 first_page = offset >> s_tracked_page_shift;
+  const u32 end_page = ((offset + size - 1) >> s_tracked_page_shift) + 1;
+
+  WriteTrackingLock lock;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed))
+    return WRITE_TOKEN_INVALID;
+
+  // Pages which are protected from access stay that way; the flag is still set, so that writes
+  // are detected once they become accessible again.
+  ForEachPageRun(first_page, end_page, [](u32 first, u32 num_pages, PageAccess access) {
+    if (access == PageAccess::ReadWrite)
+      SetPageProtection(first, num_pages, PageAccess::ReadOnly);
+  });
+  for (u32 page = first_page; page < end_page; page++)
+    s_tracked_pages[page].fetch_or(PAGE_PROTECTED, std::memory_order_release);
+
+  // Write counters only ever grow, so their sum changes whenever any page of the range is written.
+  u64 token = WRITE_TOKEN_INVALID + 1;
+  for (u32 page = first_page; page < end_page; page++)
+    token += s_tracked_pages[page].load(std::memory_order_relaxed) / PAGE_WRITE_INCREMENT;
+  return token;
+}
+
+bool IsUnchangedSince(u32 address, u32 size, u64 token)
+{
+  u32 offset;
+  if (token == WRITE_TOKEN_INVALID || !GetTrackedOffset(address, size, &offset))
+    return false;
+
+  const u32 first_page = offset >> s_tracked_page_shift;
+  const u32 end_page = ((offset + size - 1) >> s_tracked_page_shift) + 1;
+  u64 current = WRITE_TOKEN_INVALID + 1;
+  for (u32 page = first_page; page < end_page; page++)
+  {
+    const u32 state = s_tracked_pages[page].load(std::memory_order_acquire);
+    if (!(state & PAGE_PROTECTED))
+      return false;
+    current += state / PAGE_WRITE_INCREMENT;
+  }
+  return current == token;
+}
+
+// Lets the access handler fill in a page which is protected from access. Has to be called without
+// the lock, since the handler unprotects the page. Returns false if the handler didn't do that.
+static bool CallAccessHandler(u32 page)
+{
+  const u32 address = TrackedOffsetToPhysical(page << s_tracked_page_shift);
+  const AccessHandler handler = s_access_handler.load();
+  if (handler)
+    handler(address, GetTrackedPageSize());
+
+  WriteTrackingLock lock;
+  return s_access_protection_counts[page] == 0;
+}
+
+// Fills in the pages of a range which are protected from access, like accesses to them would.
+static void ResolveAccessProtection(u32 address, u32 size)
+{
+  u32 offset;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed) ||
+      !GetTrackedOffset(address, size, &offset))
+  {
+    return;
+  }
+
+  const u32 first_page = offset >> s_tracked_page_shift;
+  const u32 end_page = ((offset + size - 1) >> s_tracked_page_shift) + 1;
+  for (u32 page = first_page; page < end_page; page++)
+  {
+    bool is_protected;
+    {
+      WriteTrackingLock lock;
+      is_protected = s_access_protection_counts[page] != 0;
+    }
+    // The returned pointers bypass the protection, so this would go unnoticed otherwise.
+    if (is_protected && !CallAccessHandler(page))
+      Crash();
+  }
+}
+
+bool HandleAccessFault(uintptr_t host_address)
+{
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed))
+    return false;
+
+  u32 page;
+  {
+    WriteTrackingLock lock;
+    u32 offset;
+    if (!HostAddressToTrackedOffset(host_address, &offset))
+      return false;
+
+    // If the page isn't protected anymore, another thread got here first; just retry the access.
+    page = offset >> s_tracked_page_shift;
+    if (s_access_protection_counts[page] == 0)
+    {
+      if (s_tracked_pages[page].load(std::memory_order_relaxed) & PAGE_PROTECTED)
+      {
+        MarkPageWritten(page);
+        SetPageProtection(page, 1, PageAccess::ReadWrite);
+      }
+      return true;
+    }
+  }
+
+  // An access which the handler can't serve mustn't see stale data, so leave it to crash.
+  return CallAccessHandler(page);
+}
+
+void SetAccessHandler(AccessHandler handler)
+{
+  s_access_handler.store(handler);
+}
+
+bool ProtectFromAccess(u32 address, u32 size)
+{
+  u32 offset;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed) ||
+      !GetTrackedOffset(address, size, &offset))
+  {
+    return false;
+  }
+
+  const u32 first_page = offset >> s_tracked_page_shift;
+  const u32 end_page = ((offset + size - 1) >> s_tracked_page_shift) + 1;
+
+  WriteTrackingLock lock;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed))
+    return false;
+
+  for (u32 page = first_page; page < end_page; page++)
+  {
+    if (s_access_protection_counts[page] == UINT16_MAX)
+      return false;
+  }
+
+  ForEachPageRun(first_page, end_page, [](u32 first, u32 num_pages, PageAccess access) {
+    if (access != PageAccess::NoAccess)
+      SetPageProtection(first, num_pages, PageAccess::NoAccess);
+  });
+  for (u32 page = first_page; page < end_page; page++)
+  {
+    MarkPageWritten(page);
+    s_access_protection_counts[page]++;
+  }
+  return true;
+}
+
+void UnprotectFromAccess(u32 address, u32 size)
+{
+  u32 offset;
+  if (!GetTrackedOffset(address, size, &offset))
+    return;
+
+  const u32 first_page = offset >> s_tracked_page_shift;
+  const u32 end_page = ((offset + size - 1) >> s_tracked_page_shift) + 1;
+
+  // The counts may already be zero, if all protection was lifted in the meantime.
+  WriteTrackingLock lock;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed))
+    return;
+
+  // Whoever filled in the range wrote to it, even if the protection was lifted in the meantime.
+  for (u32 page = first_page; page < end_page; page++)
+  {
+    if (s_access_protection_counts[page] != 0)
+      s_access_protection_counts[page]--;
+    MarkPageWritten(page);
+  }
+  ForEachPageRun(first_page, end_page, [](u32 first, u32 num_pages, PageAccess access) {
+    if (access == PageAccess::ReadWrite)
+      SetPageProtection(first, num_pages, PageAccess::ReadWrite);
+  });
+}
+
+u8* GetUnprotectedPointer(u32 address, u32 size)
+{
+  u32 offset;
+  if (!GetTrackedOffset(address, size, &offset))
+    return nullptr;
+
+  if (offset < RAM_SIZE)
+    return s_unprotected_ram ? s_unprotected_ram + offset : nullptr;
+  return s_unprotected_exram ? s_unprotected_exram + (offset - RAM_SIZE) : nullptr;
+}
+
+u32 GetTrackedPageSize()
+{
+  return 1u << s_tracked_page_shift;
+}
+
+HostPointer::HostPointer(u32 address, u32 size, HostAccess access)
+    : m_address(address), m_size(size), m_access(access)
+{
+  // Writes need this too, otherwise filling in the range later would overwrite what the host
+  // writes.
+  ResolveAccessProtection(address, size);
+  m_pointer = GetUnprotectedPointer(address, size);
+  if (!m_pointer)
+    m_pointer = GetPointer(address);
+}
+
+HostPointer::~HostPointer()
+{
+  if (m_access == HostAccess::Read)
+    return;
+
+  // Counting the write only now catches ranges which were tracked again while it happened.
+  u32 offset;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed) ||
+      !GetTrackedOffset(m_address, m_size, &offset))
+  {
+    return;
+  }
+
+  const u32 first_page = offset >> s_tracked_page_shift;
+  const u32 end_page = ((offset + m_size - 1) >> s_tracked_page_shift) + 1;
+
+  WriteTrackingLock lock;
+  if (!s_write_tracking_enabled.load(std::memory_order_relaxed))
+    return;
+
+  for (u32 page = first_page; page < end_page; page++)
+    MarkPageWritten(page);
+  ForEachPageRun(first_page, end_page, [](u32 first, u32 num_pages, PageAccess access) {
+    if (access == PageAccess::ReadWrite)
+      SetPageProtection(first, num_pages, PageAccess::ReadWrite);
+  });
+}
+
 }  // namespace
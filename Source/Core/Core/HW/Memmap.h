@@ -86,6 +86,71 @@ void Write_U64(u64 var, u32 address);
 void Write_U32_Swap(u32 var, u32 address);
 void Write_U64_Swap(u64 var, u32 address);
 
+// Write tracking for RAM and EXRAM, used to avoid rehashing memory which can't have changed.
+//
+// TrackWrites() write protects the pages of a physical address range, in every mapping of them.
+// The first write to such a page, from any thread, faults into HandleAccessFault(), which bumps
+// the page's write counter and lifts the protection again. This needs the fault handler to be
+// installed, so tracking is only enabled when fastmem is.
+constexpr u64 WRITE_TOKEN_INVALID = 0;
+
+void EnableWriteTracking();
+void DisableWriteTracking();
+// Returns a token describing the current state of the range, or WRITE_TOKEN_INVALID if it
+// can't be tracked.
+u64 TrackWrites(u32 address, u32 size);
+// True if nothing in the range was written since TrackWrites() returned token for it.
+bool IsUnchangedSince(u32 address, u32 size, u64 token);
+// Called from the fault handlers. Returns true if the fault was caused by write tracking or
+// access protection and the access should be retried.
+bool HandleAccessFault(uintptr_t host_address);
+
+// Access protection for RAM and EXRAM, used to fill in memory lazily, e.g. with the results of
+// EFB copies which are still on the GPU. It needs the same fault handler as write tracking.
+//
+// ProtectFromAccess() makes the pages of a range inaccessible until UnprotectFromAccess() was
+// called for the range as often. Protecting and unprotecting a range count as writes to it. Any
+// access to a protected page, from any thread, calls the access handler on the faulting thread
+// with the physical range of the page. The handler has to fill in the page through
+// GetUnprotectedPointer() and unprotect it before it returns, otherwise the access crashes.
+using AccessHandler = void (*)(u32 address, u32 size);
+void SetAccessHandler(AccessHandler handler);
+// Returns false if the range can't be protected, in which case it mustn't be unprotected either.
+bool ProtectFromAccess(u32 address, u32 size);
+void UnprotectFromAccess(u32 address, u32 size);
+// Returns a pointer to the range which bypasses all protection, or null if the range isn't
+// entirely inside RAM or EXRAM.
+u8* GetUnprotectedPointer(u32 address, u32 size);
+// The granularity of write tracking and access protection, in bytes
+u32 GetTrackedPageSize();
+
+// Host system calls fail on protected pages instead of faulting, so every pointer to emulated
+// memory which is passed to one has to come from a HostPointer rather than GetPointer(). It fills
+// in the pages which are protected from access first, and bypasses the protection. A range the
+// host writes counts as written once the object is destroyed, i.e. after the call wrote to it.
+enum class HostAccess
+{
+  Read,
+  Write,
+};
+
+class HostPointer final
+{
+public:
+  HostPointer(u32 address, u32 size, HostAccess access);
+  ~HostPointer();
+  HostPointer(const HostPointer&) = delete;
+  HostPointer& operator=(const HostPointer&) = delete;
+
+  u8* Get() const { return m_pointer; }
+
+private:
+  u32 m_address;
+  u32 m_size;
+  HostAccess m_access;
+  u8* m_pointer;
+};
+
 // Templated functions for byteswapped copies.
 template <typename T>
 void CopyFromEmuSwapped(T* data, u32 address, size_t size)
@@ -229,8 +229,9 @@ IPCCommandResult FS::Read(const ReadWriteRequest& request)
   // Simulate the FS read logic to estimate ticks. Note: this must be done before reading.
   const u64 ticks = EstimateTicksForReadWrite(handle, request);
 
-  const Result<u32> result = m_ios.GetFS()->ReadBytesFromFile(
-      handle.fs_fd, Memory::GetPointer(request.buffer), request.size);
+  Memory::HostPointer buffer(request.buffer, request.size, Memory::HostAccess::Write);
+  const Result<u32> result =
+      m_ios.GetFS()->ReadBytesFromFile(handle.fs_fd, buffer.Get(), request.size);
   LogResult(
       StringFromFormat("Read(%s, 0x%08x, %u)", handle.name.data(), request.buffer, request.size),
       result);
@@ -249,8 +250,9 @@ IPCCommandResult FS::Write(const ReadWriteRequest& request)
   // Simulate the FS write logic to estimate ticks. Must be done before writing.
   const u64 ticks = EstimateTicksForReadWrite(handle, request);
 
-  const Result<u32> result = m_ios.GetFS()->WriteBytesToFile(
-      handle.fs_fd, Memory::GetPointer(request.buffer), request.size);
+  Memory::HostPointer buffer(request.buffer, request.size, Memory::HostAccess::Read);
+  const Result<u32> result =
+      m_ios.GetFS()->WriteBytesToFile(handle.fs_fd, buffer.Get(), request.size);
   LogResult(
       StringFromFormat("Write(%s, 0x%08x, %u)", handle.name.data(), request.buffer, request.size),
       result);
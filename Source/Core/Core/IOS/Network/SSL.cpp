@@ -301,7 +301,8 @@ IPCCommandResult NetSSL::IOCtlV(const IOCtlVRequest& request)
       if (SConfig::GetInstance().m_SSLDumpRootCA)
       {
         std::string filename = File::GetUserPath(D_DUMPSSL_IDX) + ssl->hostname + "_rootca.der";
-        File::IOFile(filename, "wb").WriteBytes(Memory::GetPointer(BufferOut2), BufferOutSize2);
+        Memory::HostPointer buffer(BufferOut2, BufferOutSize2, Memory::HostAccess::Read);
+        File::IOFile(filename, "wb").WriteBytes(buffer.Get(), BufferOutSize2);
       }
 
       if (ret)
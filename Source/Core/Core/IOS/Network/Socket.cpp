@@ -19,6 +19,7 @@
 #include "Common/FileUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/IOS/Device.h"
 #include "Core/IOS/IOS.h"
 
@@ -408,7 +409,8 @@ void WiiSocket::Update(bool read, bool write, bool except)
             {
               std::string filename = File::GetUserPath(D_DUMPSSL_IDX) +
                                      SConfig::GetInstance().GetGameID() + "_write.bin";
-              File::IOFile(filename, "ab").WriteBytes(Memory::GetPointer(BufferOut2), ret);
+              Memory::HostPointer buffer(BufferOut2, ret, Memory::HostAccess::Read);
+              File::IOFile(filename, "ab").WriteBytes(buffer.Get(), ret);
             }
 
             if (ret >= 0)
@@ -446,7 +448,8 @@ void WiiSocket::Update(bool read, bool write, bool except)
             {
               std::string filename = File::GetUserPath(D_DUMPSSL_IDX) +
                                      SConfig::GetInstance().GetGameID() + "_read.bin";
-              File::IOFile(filename, "ab").WriteBytes(Memory::GetPointer(BufferIn2), ret);
+              Memory::HostPointer buffer(BufferIn2, ret, Memory::HostAccess::Read);
+              File::IOFile(filename, "ab").WriteBytes(buffer.Get(), ret);
             }
 
             if (ret >= 0)
@@ -494,7 +497,8 @@ void WiiSocket::Update(bool read, bool write, bool except)
           u32 has_destaddr = Memory::Read_U32(BufferIn2 + 0x08);
 
           // Not a string, Windows requires a const char* for sendto
-          const char* data = (const char*)Memory::GetPointer(BufferIn);
+          Memory::HostPointer buffer(BufferIn, BufferInSize, Memory::HostAccess::Read);
+          const char* data = (const char*)buffer.Get();
 
           // Act as non blocking when SO_MSG_NONBLOCK is specified
           forceNonBlock = ((flags & SO_MSG_NONBLOCK) == SO_MSG_NONBLOCK);
@@ -525,8 +529,9 @@ void WiiSocket::Update(bool read, bool write, bool except)
         case IOCTLV_SO_RECVFROM:
         {
           u32 flags = Memory::Read_U32(BufferIn + 0x04);
+          Memory::HostPointer buffer(BufferOut, BufferOutSize, Memory::HostAccess::Write);
           // Not a string, Windows requires a char* for recvfrom
-          char* data = (char*)Memory::GetPointer(BufferOut);
+          char* data = (char*)buffer.Get();
           int data_len = BufferOutSize;
 
           sockaddr_in local_name;
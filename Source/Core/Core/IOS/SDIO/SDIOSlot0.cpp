@@ -251,7 +251,8 @@ s32 SDIOSlot0::ExecuteCommand(const Request& request, u32 _BufferIn, u32 _Buffer
       if (!m_card.Seek(address, SEEK_SET))
         ERROR_LOG(IOS_SD, "Seek failed WTF");
 
-      if (m_card.ReadBytes(Memory::GetPointer(req.addr), size))
+      Memory::HostPointer buffer(req.addr, size, Memory::HostAccess::Write);
+      if (m_card.ReadBytes(buffer.Get(), size))
       {
         DEBUG_LOG(IOS_SD, "Outbuffer size %i got %i", _rwBufferSize, size);
       }
@@ -281,7 +282,8 @@ s32 SDIOSlot0::ExecuteCommand(const Request& request, u32 _BufferIn, u32 _Buffer
       if (!m_card.Seek(address, SEEK_SET))
         ERROR_LOG(IOS_SD, "fseeko failed WTF");
 
-      if (!m_card.WriteBytes(Memory::GetPointer(req.addr), size))
+      Memory::HostPointer buffer(req.addr, size, Memory::HostAccess::Read);
+      if (!m_card.WriteBytes(buffer.Get(), size))
       {
         ERROR_LOG(IOS_SD, "Write Failed - error: %i, eof: %i", ferror(m_card.GetHandle()),
                   feof(m_card.GetHandle()));
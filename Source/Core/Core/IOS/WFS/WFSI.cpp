@@ -467,7 +467,8 @@ IPCCommandResult WFSI::IOCtl(const IOCtlRequest& request)
     }
     else
     {
-      fp.ReadBytes(Memory::GetPointer(dol_addr), max_dol_size);
+      Memory::HostPointer buffer(dol_addr, max_dol_size, Memory::HostAccess::Write);
+      fp.ReadBytes(buffer.Get(), max_dol_size);
     }
     Memory::Write_U32(real_dol_size, request.buffer_out);
     break;
@@ -515,7 +516,8 @@ u32 WFSI::GetTmd(u16 group_id, u32 title_id, u64 subtitle_id, u32 address, u32*
   }
   if (address)
   {
-    fp.ReadBytes(Memory::GetPointer(address), fp.GetSize());
+    Memory::HostPointer buffer(address, static_cast<u32>(fp.GetSize()), Memory::HostAccess::Write);
+    fp.ReadBytes(buffer.Get(), fp.GetSize());
   }
   *size = fp.GetSize();
   return IPC_SUCCESS;
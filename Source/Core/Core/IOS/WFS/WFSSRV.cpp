@@ -296,7 +296,8 @@ IPCCommandResult WFSSRV::IOCtl(const IOCtlRequest& request)
       fd_obj->file.Seek(position, SEEK_SET);
     }
     size_t read_bytes;
-    fd_obj->file.ReadArray(Memory::GetPointer(addr), size, &read_bytes);
+    Memory::HostPointer buffer(addr, size, Memory::HostAccess::Write);
+    fd_obj->file.ReadArray(buffer.Get(), size, &read_bytes);
     // TODO(wfs): Handle read errors.
     if (absolute)
     {
@@ -336,7 +337,8 @@ IPCCommandResult WFSSRV::IOCtl(const IOCtlRequest& request)
     {
       fd_obj->file.Seek(position, SEEK_SET);
     }
-    fd_obj->file.WriteArray(Memory::GetPointer(addr), size);
+    Memory::HostPointer buffer(addr, size, Memory::HostAccess::Read);
+    fd_obj->file.WriteArray(buffer.Get(), size);
     // TODO(wfs): Handle write errors.
     if (absolute)
     {
@@ -14,6 +14,7 @@
 #include "Common/MsgHandler.h"
 #include "Common/Thread.h"
 
+#include "Core/HW/Memmap.h"
 #include "Core/MachineContext.h"
 #include "Core/PowerPC/JitInterface.h"
 
@@ -44,7 +45,7 @@ static LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
     uintptr_t badAddress = (uintptr_t)pPtrs->ExceptionRecord->ExceptionInformation[1];
     CONTEXT* ctx = pPtrs->ContextRecord;
 
-    if (JitInterface::HandleFault(badAddress, ctx))
+    if (Memory::HandleAccessFault(badAddress) || JitInterface::HandleFault(badAddress, ctx))
     {
       return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
     }
@@ -98,6 +99,11 @@ void UninstallExceptionHandler()
 {
 }
 
+bool IsExceptionHandlerProcessWide()
+{
+  return true;
+}
+
 #elif defined(__APPLE__) && !defined(USE_SIGACTION_ON_APPLE)
 
 static void CheckKR(const char* name, kern_return_t kr)
@@ -230,6 +236,12 @@ void UninstallExceptionHandler()
 {
 }
 
+// Exceptions are only redirected for the thread which installed the handler.
+bool IsExceptionHandlerProcessWide()
+{
+  return false;
+}
+
 #elif defined(_POSIX_VERSION) && !defined(_M_GENERIC)
 
 static struct sigaction old_sa_segv;
@@ -257,6 +269,9 @@ static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
 #else
   mcontext_t* ctx = &context->uc_mcontext;
 #endif
+  if (Memory::HandleAccessFault(bad_address))
+    return;
+
   // assume it's not a write
   if (!JitInterface::HandleFault(bad_address,
 #ifdef __APPLE__
@@ -338,6 +353,11 @@ void UninstallExceptionHandler()
   sigaction(SIGBUS, &old_sa_bus, nullptr);
 #endif
 }
+
+bool IsExceptionHandlerProcessWide()
+{
+  return true;
+}
 #else  // _M_GENERIC or unsupported platform
 
 void InstallExceptionHandler()
@@ -346,6 +366,10 @@ void InstallExceptionHandler()
 void UninstallExceptionHandler()
 {
 }
+bool IsExceptionHandlerProcessWide()
+{
+  return false;
+}
 
 #endif
 
@@ -8,4 +8,6 @@ namespace EMM
 {
 void InstallExceptionHandler();
 void UninstallExceptionHandler();
+// Whether faults on threads other than the one which installed the handler are caught as well.
+bool IsExceptionHandlerProcessWide();
 }
@@ -10,9 +10,11 @@
 #include <string>
 #include <thread>
 #include <unistd.h>
+#include <variant>
 
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileUtil.h"
 #include "Common/Flag.h"
 #include "Common/Logging/LogManager.h"
 #include "Common/MsgHandler.h"
@@ -22,6 +24,7 @@
 #include "Core/BootManager.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/Host.h"
 #include "Core/IOS/IOS.h"
 #include "Core/IOS/STM/STM.h"
@@ -33,7 +36,9 @@
 #endif
 #include "UICommon/UICommon.h"
 
+#include "VideoCommon/BenchmarkRecorder.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/VideoBackendBase.h"
 
 static bool rendererHasFocus = true;
@@ -374,6 +379,28 @@ static Platform* GetPlatform()
 int main(int argc, char* argv[])
 {
   auto parser = CommandLineParse::CreateParser(CommandLineParse::ParserOptions::OmitGUIOptions);
+  parser->add_option("--benchmark")
+      .action("store")
+      .metavar("<loops>")
+      .type("int")
+      .help("Play a FIFO log the given number of times without a speed limit, and print the "
+            "frame times and throughput as JSON");
+  parser->add_option("--benchmark_output")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Write the benchmark results to a file instead of the standard output");
+  parser->add_option("--stage_times_output")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Write the time spent in each stage of the video thread for the last frames to a "
+            "CSV file");
+  parser->add_option("--trace_output")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Write a trace of the stages of the video thread in the Chrome trace event format");
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
@@ -405,6 +432,16 @@ int main(int argc, char* argv[])
     return 0;
   }
 
+  const int benchmark_loops =
+      options.is_set("benchmark") ? static_cast<int>(options.get("benchmark")) : 0;
+  if (options.is_set("benchmark") &&
+      (benchmark_loops <= 0 || !boot ||
+       !std::holds_alternative<BootParameters::DFF>(boot->parameters)))
+  {
+    fprintf(stderr, "Benchmarks need a FIFO log and a positive number of loops\n");
+    return 1;
+  }
+
   std::string user_directory;
   if (options.is_set("user"))
   {
@@ -437,6 +474,21 @@ int main(int argc, char* argv[])
 
   DolphinAnalytics::Instance()->ReportDolphinStart("nogui");
 
+  // The speed limit is only lifted for this run, it isn't saved to the settings.
+  const float emulation_speed = SConfig::GetInstance().m_EmulationSpeed;
+  std::string benchmark_file;
+  if (benchmark_loops > 0)
+  {
+    benchmark_file = std::get<BootParameters::DFF>(boot->parameters).dff_path;
+    FifoPlayer::GetInstance().SetLoopCount(benchmark_loops);
+    SConfig::GetInstance().m_EmulationSpeed = 0.0f;
+    BenchmarkRecorder::Start();
+  }
+  if (options.is_set("stage_times_output"))
+    StageTimings::SetBenchmarking(true);
+  if (options.is_set("trace_output"))
+    StageTimings::StartTrace();
+
   if (!BootManager::BootCore(std::move(boot)))
   {
     fprintf(stderr, "Could not boot the specified file\n");
@@ -459,6 +511,41 @@ int main(int argc, char* argv[])
 
   Core::Shutdown();
   platform->Shutdown();
+
+  if (benchmark_loops > 0)
+  {
+    SConfig::GetInstance().m_EmulationSpeed = emulation_speed;
+
+    const BenchmarkRecorder::Summary summary =
+        BenchmarkRecorder::Summarize(BenchmarkRecorder::Stop());
+    const std::string json = BenchmarkRecorder::SummaryToJSON(
+        summary, {{"file", benchmark_file}, {"video_backend", g_video_backend->GetName()}});
+    if (options.is_set("benchmark_output"))
+    {
+      const std::string output = static_cast<const char*>(options.get("benchmark_output"));
+      if (!File::WriteStringToFile(json, output))
+        fprintf(stderr, "Could not write the benchmark results to %s\n", output.c_str());
+    }
+    else
+    {
+      printf("%s\n", json.c_str());
+    }
+  }
+
+  if (options.is_set("stage_times_output"))
+  {
+    StageTimings::SetBenchmarking(false);
+    const std::string output = static_cast<const char*>(options.get("stage_times_output"));
+    if (!File::WriteStringToFile(StageTimings::FramesToCSV(StageTimings::GetFrames()), output))
+      fprintf(stderr, "Could not write the stage times to %s\n", output.c_str());
+  }
+  if (options.is_set("trace_output"))
+  {
+    const std::string output = static_cast<const char*>(options.get("trace_output"));
+    if (!File::WriteStringToFile(StageTimings::StopTrace(), output))
+      fprintf(stderr, "Could not write the trace to %s\n", output.c_str());
+  }
+
   UICommon::Shutdown();
 
   delete platform;
@@ -66,6 +66,8 @@ void AdvancedWidget::CreateWidgets()
   m_load_custom_textures = new GraphicsBool(tr("Load Custom Textures"), Config::GFX_HIRES_TEXTURES);
   m_prefetch_custom_textures =
       new GraphicsBool(tr("Prefetch Custom Textures"), Config::GFX_CACHE_HIRES_TEXTURES);
+  m_stream_custom_textures =
+      new GraphicsBool(tr("Stream Custom Textures"), Config::GFX_STREAM_HIRES_TEXTURES);
   m_use_fullres_framedumps = new GraphicsBool(tr("Internal Resolution Frame Dumps"),
                                               Config::GFX_INTERNAL_RESOLUTION_FRAME_DUMPS);
   m_dump_efb_target = new GraphicsBool(tr("Dump EFB Target"), Config::GFX_DUMP_EFB_TARGET);
@@ -73,6 +75,8 @@ void AdvancedWidget::CreateWidgets()
       new GraphicsBool(tr("Disable EFB VRAM Copies"), Config::GFX_HACK_DISABLE_COPY_TO_VRAM);
   m_enable_freelook = new GraphicsBool(tr("Free Look"), Config::GFX_FREE_LOOK);
   m_dump_use_ffv1 = new GraphicsBool(tr("Frame Dumps Use FFV1"), Config::GFX_USE_FFV1);
+  m_cache_decoded_textures =
+      new GraphicsBool(tr("Cache Decoded Textures on Disk"), Config::GFX_CACHE_DECODED_TEXTURES);
 
   utility_layout->addWidget(m_dump_textures, 0, 0);
   utility_layout->addWidget(m_load_custom_textures, 0, 1);
@@ -84,6 +88,8 @@ void AdvancedWidget::CreateWidgets()
 #if defined(HAVE_FFMPEG)
   utility_layout->addWidget(m_dump_use_ffv1, 3, 1);
 #endif
+  utility_layout->addWidget(m_cache_decoded_textures, 4, 0);
+  utility_layout->addWidget(m_stream_custom_textures, 4, 1);
 
   // Misc.
   auto* misc_box = new QGroupBox(tr("Misc"));
@@ -120,6 +126,7 @@ void AdvancedWidget::ConnectWidgets()
 void AdvancedWidget::LoadSettings()
 {
   m_prefetch_custom_textures->setEnabled(Config::Get(Config::GFX_HIRES_TEXTURES));
+  m_stream_custom_textures->setEnabled(Config::Get(Config::GFX_HIRES_TEXTURES));
   m_enable_prog_scan->setChecked(Config::Get(Config::SYSCONF_PROGRESSIVE_SCAN));
 }
 
@@ -127,6 +134,7 @@ void AdvancedWidget::SaveSettings()
 {
   const auto hires_enabled = Config::Get(Config::GFX_HIRES_TEXTURES);
   m_prefetch_custom_textures->setEnabled(hires_enabled);
+  m_stream_custom_textures->setEnabled(hires_enabled);
 
   Config::SetBase(Config::SYSCONF_PROGRESSIVE_SCAN, m_enable_prog_scan->isChecked());
 }
@@ -161,6 +169,15 @@ void AdvancedWidget::AddDescriptions()
   static const char TR_CACHE_CUSTOM_TEXTURE_DESCRIPTION[] =
       QT_TR_NOOP("Cache custom textures to system RAM on startup.\nThis can require exponentially "
                  "more RAM but fixes possible stuttering.\n\nIf unsure, leave this unchecked.");
+  static const char TR_STREAM_CUSTOM_TEXTURE_DESCRIPTION[] =
+      QT_TR_NOOP("Load custom textures in the background, and show the original texture until "
+                 "the custom one is ready. Avoids stuttering when a custom texture is used for the "
+                 "first time.\n\nIf unsure, leave this checked.");
+  static const char TR_CACHE_DECODED_TEXTURES_DESCRIPTION[] =
+      QT_TR_NOOP("Keep decoded textures in User/Cache/DecodedTextures/ so that they don't have to "
+                 "be decoded again in later sessions. Only fully hashed textures are cached, and "
+                 "the cache is limited to 1 GiB per game by default.\n\nIf unsure, leave this "
+                 "unchecked.");
   static const char TR_DUMP_EFB_DESCRIPTION[] =
       QT_TR_NOOP("Dump the contents of EFB copies to User/Dump/Textures/.\n\nIf unsure, leave this "
                  "unchecked.");
@@ -208,6 +225,8 @@ void AdvancedWidget::AddDescriptions()
   AddDescription(m_dump_textures, TR_DUMP_TEXTURE_DESCRIPTION);
   AddDescription(m_load_custom_textures, TR_LOAD_CUSTOM_TEXTURE_DESCRIPTION);
   AddDescription(m_prefetch_custom_textures, TR_CACHE_CUSTOM_TEXTURE_DESCRIPTION);
+  AddDescription(m_stream_custom_textures, TR_STREAM_CUSTOM_TEXTURE_DESCRIPTION);
+  AddDescription(m_cache_decoded_textures, TR_CACHE_DECODED_TEXTURES_DESCRIPTION);
   AddDescription(m_dump_efb_target, TR_DUMP_EFB_DESCRIPTION);
   AddDescription(m_disable_vram_copies, TR_DISABLE_VRAM_COPIES_DESCRIPTION);
   AddDescription(m_use_fullres_framedumps, TR_INTERNAL_RESOLUTION_FRAME_DUMPING_DESCRIPTION);
@@ -34,6 +34,8 @@ private:
   // Utility
   QCheckBox* m_dump_textures;
   QCheckBox* m_prefetch_custom_textures;
+  QCheckBox* m_stream_custom_textures;
+  QCheckBox* m_cache_decoded_textures;
   QCheckBox* m_dump_efb_target;
   QCheckBox* m_disable_vram_copies;
   QCheckBox* m_dump_use_ffv1;
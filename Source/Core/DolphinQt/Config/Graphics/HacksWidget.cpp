@@ -45,10 +45,16 @@ void HacksWidget::CreateWidgets()
                                              Config::GFX_HACK_EFB_EMULATE_FORMAT_CHANGES, true);
   m_store_efb_copies = new GraphicsBool(tr("Store EFB Copies to Texture Only"),
                                         Config::GFX_HACK_SKIP_EFB_COPY_TO_RAM);
+  m_prefetch_efb_peeks =
+      new GraphicsBool(tr("Prefetch EFB Peeks"), Config::GFX_HACK_EFB_ACCESS_PREFETCH);
+  m_defer_efb_copies =
+      new GraphicsBool(tr("Defer EFB Copies to RAM"), Config::GFX_HACK_DEFER_EFB_COPIES);
 
   efb_layout->addWidget(m_skip_efb_cpu, 0, 0);
   efb_layout->addWidget(m_ignore_format_changes, 0, 1);
   efb_layout->addWidget(m_store_efb_copies, 1, 0);
+  efb_layout->addWidget(m_prefetch_efb_peeks, 1, 1);
+  efb_layout->addWidget(m_defer_efb_copies, 2, 0);
 
   // Texture Cache
   auto* texture_cache_box = new QGroupBox(tr("Texture Cache"));
@@ -62,6 +68,10 @@ void HacksWidget::CreateWidgets()
   m_accuracy->setTickPosition(QSlider::TicksBelow);
   m_gpu_texture_decoding =
       new GraphicsBool(tr("GPU Texture Decoding"), Config::GFX_ENABLE_GPU_TEXTURE_DECODING);
+  m_full_texture_hash =
+      new GraphicsBool(tr("Hash Entire Textures"), Config::GFX_FULL_TEXTURE_HASH);
+  m_track_texture_writes =
+      new GraphicsBool(tr("Track Texture Writes"), Config::GFX_HACK_TRACK_TEXTURE_WRITES);
 
   auto* safe_label = new QLabel(tr("Safe"));
   safe_label->setAlignment(Qt::AlignRight);
@@ -73,6 +83,8 @@ void HacksWidget::CreateWidgets()
   texture_cache_layout->addWidget(m_accuracy, 0, 2);
   texture_cache_layout->addWidget(new QLabel(tr("Fast")), 0, 3);
   texture_cache_layout->addWidget(m_gpu_texture_decoding, 1, 0);
+  texture_cache_layout->addWidget(m_full_texture_hash, 1, 2);
+  texture_cache_layout->addWidget(m_track_texture_writes, 2, 0);
 
   // XFB
   auto* xfb_box = new QGroupBox(tr("External Frame Buffer (XFB)"));
@@ -114,15 +126,25 @@ void HacksWidget::OnBackendChanged(const QString& backend_name)
 {
   const bool bbox = g_Config.backend_info.bSupportsBBox;
   const bool gpu_texture_decoding = g_Config.backend_info.bSupportsGPUTextureDecoding;
+  const bool efb_peek_cache = g_Config.backend_info.bSupportsEFBPeekCache;
+  const bool deferred_efb_copies = g_Config.backend_info.bSupportsDeferredEFBCopies;
 
   m_gpu_texture_decoding->setEnabled(gpu_texture_decoding);
   m_disable_bounding_box->setEnabled(bbox);
+  m_prefetch_efb_peeks->setEnabled(efb_peek_cache);
+  m_defer_efb_copies->setEnabled(deferred_efb_copies);
 
   if (!gpu_texture_decoding)
     m_gpu_texture_decoding->setToolTip(tr("%1 doesn't support this feature.").arg(backend_name));
 
   if (!bbox)
     m_disable_bounding_box->setToolTip(tr("%1 doesn't support this feature.").arg(backend_name));
+
+  if (!efb_peek_cache)
+    m_prefetch_efb_peeks->setToolTip(tr("%1 doesn't support this feature.").arg(backend_name));
+
+  if (!deferred_efb_copies)
+    m_defer_efb_copies->setToolTip(tr("%1 doesn't support this feature.").arg(backend_name));
 }
 
 void HacksWidget::ConnectWidgets()
@@ -203,6 +225,16 @@ void HacksWidget::AddDescriptions()
       "in a small number of games.\n\nEnabled = EFB Copies to Texture\nDisabled = EFB Copies to "
       "RAM "
       "(and Texture)\n\nIf unsure, leave this checked.");
+  static const char TR_PREFETCH_EFB_PEEKS_DESCRIPTION[] = QT_TR_NOOP(
+      "When the CPU reads from the EFB after it changed, also reads back the parts of the EFB "
+      "which were read before the change. Improves performance in games which read from many "
+      "parts of the EFB in every frame, but reads back more than needed in others.\n\nIf "
+      "unsure, leave this unchecked.");
+  static const char TR_DEFER_EFB_COPIES_DESCRIPTION[] = QT_TR_NOOP(
+      "Leaves EFB copies to RAM on the GPU until the emulated CPU or a texture reads them. "
+      "Improves performance in games which make EFB copies they don't read back, if EFB copies "
+      "are stored to RAM. Only has an effect with dual core and fastmem enabled.\n\nIf unsure, "
+      "leave this unchecked.");
   static const char TR_ACCUARCY_DESCRIPTION[] = QT_TR_NOOP(
       "The \"Safe\" setting eliminates the likelihood of the GPU missing texture updates "
       "from RAM.\nLower accuracies cause in-game text to appear garbled in certain "
@@ -226,6 +258,16 @@ void HacksWidget::AddDescriptions()
                  "performance gains in some scenarios, or on systems where the CPU is the "
                  "bottleneck.\n\nIf unsure, leave this unchecked.");
 
+  static const char TR_FULL_TEXTURE_HASH_DESCRIPTION[] =
+      QT_TR_NOOP("Hashes all of a texture's data with a vectorized hash instead of sampling it. "
+                 "This never misses texture updates, and on CPUs with AVX2 or NEON is about as "
+                 "fast as sampling. Overrides the accuracy setting.\n\nIf unsure, leave this "
+                 "unchecked.");
+  static const char TR_TRACK_TEXTURE_WRITES_DESCRIPTION[] = QT_TR_NOOP(
+      "Write protects the memory of textures, so that they are only hashed again after they were "
+      "written to. Improves performance in games with many large textures. Only has an effect "
+      "with fastmem enabled.\n\nIf unsure, leave this unchecked.");
+
   static const char TR_FAST_DEPTH_CALC_DESCRIPTION[] = QT_TR_NOOP(
       "Use a less accurate algorithm to calculate depth values.\nCauses issues in a few "
       "games, but can give a decent speedup depending on the game and/or your GPU.\n\nIf "
@@ -241,10 +283,14 @@ void HacksWidget::AddDescriptions()
   AddDescription(m_skip_efb_cpu, TR_SKIP_EFB_CPU_ACCESS_DESCRIPTION);
   AddDescription(m_ignore_format_changes, TR_IGNORE_FORMAT_CHANGE_DESCRIPTION);
   AddDescription(m_store_efb_copies, TR_STORE_EFB_TO_TEXTURE_DESCRIPTION);
+  AddDescription(m_prefetch_efb_peeks, TR_PREFETCH_EFB_PEEKS_DESCRIPTION);
+  AddDescription(m_defer_efb_copies, TR_DEFER_EFB_COPIES_DESCRIPTION);
   AddDescription(m_accuracy, TR_ACCUARCY_DESCRIPTION);
   AddDescription(m_store_xfb_copies, TR_STORE_XFB_TO_TEXTURE_DESCRIPTION);
   AddDescription(m_immediate_xfb, TR_IMMEDIATE_XFB_DESCRIPTION);
   AddDescription(m_gpu_texture_decoding, TR_GPU_DECODING_DESCRIPTION);
+  AddDescription(m_full_texture_hash, TR_FULL_TEXTURE_HASH_DESCRIPTION);
+  AddDescription(m_track_texture_writes, TR_TRACK_TEXTURE_WRITES_DESCRIPTION);
   AddDescription(m_fast_depth_calculation, TR_FAST_DEPTH_CALC_DESCRIPTION);
   AddDescription(m_disable_bounding_box, TR_DISABLE_BOUNDINGBOX_DESCRIPTION);
   AddDescription(m_vertex_rounding, TR_VERTEX_ROUNDING_DESCRIPTION);
@@ -28,11 +28,15 @@ private:
   QCheckBox* m_skip_efb_cpu;
   QCheckBox* m_ignore_format_changes;
   QCheckBox* m_store_efb_copies;
+  QCheckBox* m_prefetch_efb_peeks;
+  QCheckBox* m_defer_efb_copies;
 
   // Texture Cache
   QLabel* m_accuracy_label;
   QSlider* m_accuracy;
   QCheckBox* m_gpu_texture_decoding;
+  QCheckBox* m_full_texture_hash;
+  QCheckBox* m_track_texture_writes;
 
   // External Framebuffer
   QCheckBox* m_store_xfb_copies;
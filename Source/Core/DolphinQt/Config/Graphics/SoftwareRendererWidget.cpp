@@ -46,6 +46,13 @@ void SoftwareRendererWidget::CreateWidgets()
   rendering_layout->addWidget(new QLabel(tr("Backend:")), 1, 1);
   rendering_layout->addWidget(m_backend_combo, 1, 2);
 
+  m_rasterizer_threads = new QSpinBox();
+  m_rasterizer_threads->setMinimum(-1);
+  m_rasterizer_threads->setMaximum(64);
+  m_rasterizer_threads->setSpecialValueText(tr("Automatic"));
+  rendering_layout->addWidget(new QLabel(tr("Rasterizer Threads:")), 2, 1);
+  rendering_layout->addWidget(m_rasterizer_threads, 2, 2);
+
   for (const auto& backend : g_available_video_backends)
     m_backend_combo->addItem(tr(backend->GetDisplayName().c_str()));
 
@@ -109,6 +116,8 @@ void SoftwareRendererWidget::ConnectWidgets()
 {
   connect(m_backend_combo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged),
           [this](int) { SaveSettings(); });
+  connect(m_rasterizer_threads, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+          [this](int) { SaveSettings(); });
   connect(m_object_range_min, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
           [this](int) { SaveSettings(); });
   connect(m_object_range_max, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
@@ -124,6 +133,7 @@ void SoftwareRendererWidget::LoadSettings()
           m_backend_combo->findText(tr(backend->GetDisplayName().c_str())));
   }
 
+  m_rasterizer_threads->setValue(Config::Get(Config::GFX_SW_RASTERIZER_THREADS));
   m_object_range_min->setValue(Config::Get(Config::GFX_SW_DRAW_START));
   m_object_range_max->setValue(Config::Get(Config::GFX_SW_DRAW_END));
 }
@@ -141,6 +151,7 @@ void SoftwareRendererWidget::SaveSettings()
     }
   }
 
+  Config::SetBaseOrCurrent(Config::GFX_SW_RASTERIZER_THREADS, m_rasterizer_threads->value());
   Config::SetBaseOrCurrent(Config::GFX_SW_DRAW_START, m_object_range_min->value());
   Config::SetBaseOrCurrent(Config::GFX_SW_DRAW_END, m_object_range_max->value());
 }
@@ -154,6 +165,11 @@ void SoftwareRendererWidget::AddDescriptions()
                  "backend, so for the best emulation experience it's recommended to try both and "
                  "choose the one that's less problematic.\n\nIf unsure, select OpenGL.");
 
+  static const char TR_RASTERIZER_THREADS_DESCRIPTION[] =
+      QT_TR_NOOP("Number of additional threads used to draw the screen. The screen is split into "
+                 "tiles which are drawn in parallel, with the same result as on a single thread."
+                 "\n\nIf unsure, select Automatic.");
+
   static const char TR_SHOW_STATISTICS_DESCRIPTION[] =
       QT_TR_NOOP("Show various rendering statistics.\n\nIf unsure, leave this unchecked.");
 
@@ -174,6 +190,7 @@ void SoftwareRendererWidget::AddDescriptions()
                  "this unchecked.");
 
   AddDescription(m_backend_combo, TR_BACKEND_DESCRIPTION);
+  AddDescription(m_rasterizer_threads, TR_RASTERIZER_THREADS_DESCRIPTION);
   AddDescription(m_show_statistics, TR_SHOW_STATISTICS_DESCRIPTION);
   AddDescription(m_dump_textures, TR_DUMP_TEXTURES_DESCRIPTION);
   AddDescription(m_dump_objects, TR_DUMP_OBJECTS_DESCRIPTION);
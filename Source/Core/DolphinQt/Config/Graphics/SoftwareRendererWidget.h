@@ -29,6 +29,7 @@ private:
   void AddDescriptions();
 
   QComboBox* m_backend_combo;
+  QSpinBox* m_rasterizer_threads;
   QCheckBox* m_show_statistics;
   QCheckBox* m_dump_textures;
   QCheckBox* m_dump_objects;
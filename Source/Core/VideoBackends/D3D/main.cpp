@@ -73,6 +73,9 @@ void VideoBackend::InitBackendInfo()
   g_Config.backend_info.bSupportsBPTCTextures = false;
   g_Config.backend_info.bSupportsFramebufferFetch = false;
   g_Config.backend_info.bSupportsBackgroundCompiling = true;
+  // Peeks read back single pixels, so reading whole tiles would be much slower.
+  g_Config.backend_info.bSupportsEFBPeekCache = false;
+  g_Config.backend_info.bSupportsDeferredEFBCopies = false;
 
   IDXGIFactory2* factory;
   IDXGIAdapter* ad;
@@ -82,6 +82,23 @@ void TextureCache::CopyEFB(u8* dst, const EFBCopyParams& params, u32 native_widt
                                            clamp_top_val, clamp_bottom_val, filter_coefficients);
 }
 
+void TextureCache::CopyEFBToStagingTexture(AbstractStagingTexture* dst,
+                                           const EFBCopyParams& params, u32 native_width,
+                                           u32 bytes_per_row, u32 num_blocks_y,
+                                           const EFBRectangle& src_rect, bool scale_by_half,
+                                           float y_scale, float gamma, bool clamp_top,
+                                           bool clamp_bottom,
+                                           const CopyFilterCoefficientArray& filter_coefficients)
+{
+  float clamp_top_val =
+      clamp_bottom ? (1.0f - src_rect.bottom / static_cast<float>(EFB_HEIGHT)) : 0.0f;
+  float clamp_bottom_val =
+      clamp_top ? (1.0f - src_rect.top / static_cast<float>(EFB_HEIGHT)) : 1.0f;
+  TextureConverter::EncodeToStagingTexture(dst, params, native_width, bytes_per_row, num_blocks_y,
+                                           src_rect, scale_by_half, y_scale, gamma, clamp_top_val,
+                                           clamp_bottom_val, filter_coefficients);
+}
+
 TextureCache::TextureCache()
 {
   CompileShaders();
@@ -68,6 +68,12 @@ private:
                bool scale_by_half, float y_scale, float gamma, bool clamp_top, bool clamp_bottom,
                const CopyFilterCoefficientArray& filter_coefficients) override;
 
+  void CopyEFBToStagingTexture(AbstractStagingTexture* dst, const EFBCopyParams& params,
+                               u32 native_width, u32 bytes_per_row, u32 num_blocks_y,
+                               const EFBRectangle& src_rect, bool scale_by_half, float y_scale,
+                               float gamma, bool clamp_top, bool clamp_bottom,
+                               const CopyFilterCoefficientArray& filter_coefficients) override;
+
   void CopyEFBToCacheEntry(TCacheEntry* entry, bool is_depth_copy, const EFBRectangle& src_rect,
                            bool scale_by_half, EFBCopyFormat dst_format, bool is_intensity,
                            float gamma, bool clamp_top, bool clamp_bottom,
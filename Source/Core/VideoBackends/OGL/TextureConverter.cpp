@@ -110,10 +110,11 @@ void Shutdown()
   s_encoding_programs.clear();
 }
 
-// dst_line_size, writeStride in bytes
+// dst_line_size in bytes
 
-static void EncodeToRamUsingShader(GLuint srcTexture, u8* destAddr, u32 dst_line_size,
-                                   u32 dstHeight, u32 writeStride, bool linearFilter, float y_scale)
+static void EncodeToRamUsingShader(GLuint srcTexture, AbstractStagingTexture* dst,
+                                   u32 dst_line_size, u32 dstHeight, bool linearFilter,
+                                   float y_scale)
 {
   FramebufferManager::SetFramebuffer(
       static_cast<OGLTexture*>(s_encoding_render_texture.get())->GetFramebuffer());
@@ -137,13 +138,11 @@ static void EncodeToRamUsingShader(GLuint srcTexture, u8* destAddr, u32 dst_line
   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
   MathUtil::Rectangle<int> copy_rect(0, 0, dst_line_size / 4, dstHeight);
-  s_encoding_readback_texture->CopyFromTexture(s_encoding_render_texture.get(), copy_rect, 0, 0,
-                                               copy_rect);
-  s_encoding_readback_texture->ReadTexels(copy_rect, destAddr, writeStride);
+  dst->CopyFromTexture(s_encoding_render_texture.get(), copy_rect, 0, 0, copy_rect);
 }
 
-void EncodeToRamFromTexture(u8* dest_ptr, const EFBCopyParams& params, u32 native_width,
-                            u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride,
+void EncodeToStagingTexture(AbstractStagingTexture* dst, const EFBCopyParams& params,
+                            u32 native_width, u32 bytes_per_row, u32 num_blocks_y,
                             const EFBRectangle& src_rect, bool scale_by_half, float y_scale,
                             float gamma, float clamp_top, float clamp_bottom,
                             const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients)
@@ -165,12 +164,26 @@ void EncodeToRamFromTexture(u8* dest_ptr, const EFBCopyParams& params, u32 nativ
                                   FramebufferManager::ResolveAndGetDepthTarget(src_rect) :
                                   FramebufferManager::ResolveAndGetRenderTarget(src_rect);
 
-  EncodeToRamUsingShader(read_texture, dest_ptr, bytes_per_row, num_blocks_y, memory_stride,
+  EncodeToRamUsingShader(read_texture, dst, bytes_per_row, num_blocks_y,
                          scale_by_half && !params.depth, y_scale);
 
   g_renderer->RestoreAPIState();
 }
 
+void EncodeToRamFromTexture(u8* dest_ptr, const EFBCopyParams& params, u32 native_width,
+                            u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride,
+                            const EFBRectangle& src_rect, bool scale_by_half, float y_scale,
+                            float gamma, float clamp_top, float clamp_bottom,
+                            const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients)
+{
+  EncodeToStagingTexture(s_encoding_readback_texture.get(), params, native_width, bytes_per_row,
+                         num_blocks_y, src_rect, scale_by_half, y_scale, gamma, clamp_top,
+                         clamp_bottom, filter_coefficients);
+
+  MathUtil::Rectangle<int> copy_rect(0, 0, bytes_per_row / 4, num_blocks_y);
+  s_encoding_readback_texture->ReadTexels(copy_rect, dest_ptr, memory_stride);
+}
+
 }  // namespace TextureConverter
 
 }  // namespace OGL
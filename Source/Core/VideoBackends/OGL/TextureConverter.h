@@ -10,6 +10,8 @@
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VideoCommon.h"
 
+class AbstractStagingTexture;
+
 namespace OGL
 {
 // Converts textures between formats using shaders
@@ -25,6 +27,14 @@ void EncodeToRamFromTexture(
     u32 num_blocks_y, u32 memory_stride, const EFBRectangle& src_rect, bool scale_by_half,
     float y_scale, float gamma, float clamp_top, float clamp_bottom,
     const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients);
+
+// Like EncodeToRamFromTexture, but leaves the encoded rows in dst, which has to be at least
+// bytes_per_row / 4 by num_blocks_y texels.
+void EncodeToStagingTexture(
+    AbstractStagingTexture* dst, const EFBCopyParams& params, u32 native_width, u32 bytes_per_row,
+    u32 num_blocks_y, const EFBRectangle& src_rect, bool scale_by_half, float y_scale, float gamma,
+    float clamp_top, float clamp_bottom,
+    const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients);
 }
 
 }  // namespace OGL
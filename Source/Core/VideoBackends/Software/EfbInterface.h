@@ -59,5 +59,6 @@ void EncodeXFB(u8* xfb_in_ram, u32 memory_stride, const EFBRectangle& source_rec
 
 u32 GetPerfQueryResult(PerfQueryType type);
 void ResetPerfQuery();
-void IncPerfCounterQuadCount(PerfQueryType type);
+// Adds pixels which passed the given stage.
+void IncPerfCounterQuadCount(PerfQueryType type, u32 num_pixels);
 }  // namespace EfbInterface
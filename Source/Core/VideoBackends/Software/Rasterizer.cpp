@@ -3,13 +3,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
+#include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/WorkerPool.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/NativeVertexFormat.h"
 #include "VideoBackends/Software/Rasterizer.h"
 #include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoConfig.h"
@@ -19,23 +25,57 @@ namespace Rasterizer
 {
 static constexpr int BLOCK_SIZE = 2;
 
+// The EFB is split into tiles, which are drawn in parallel. Tiles are made of whole blocks, so the
+// LOD of a block doesn't depend on the tile it is drawn in.
+static constexpr int TILE_SIZE = 32;
+static constexpr int NUM_TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static constexpr int NUM_TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+static_assert(TILE_SIZE % BLOCK_SIZE == 0, "Tiles must be made of whole blocks");
+
+// Everything needed to draw the pixels of a triangle
+struct Triangle
+{
+  Slope ZSlope;
+  Slope WSlope;
+  Slope ColorSlopes[2][4];
+  Slope TexSlopes[8][3];
+
+  s32 vertex0X;
+  s32 vertex0Y;
+  float vertexOffsetX;
+  float vertexOffsetY;
+
+  // Half-edge constants and deltas
+  s32 C1, C2, C3;
+  s32 DX12, DX23, DX31;
+  s32 DY12, DY23, DY31;
+
+  // Scissored bounding rectangle, starting at a block corner
+  s32 minx, maxx, miny, maxy;
+};
+
+// Everything a thread needs to draw tiles
+struct DrawState
+{
+  Tev tev;
+  RasterBlock rasterBlock;
+  u32 rasterizedPixels;
+};
+
+// Kept between triangles for zfreeze.
 static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
 
-static s32 vertex0X;
-static s32 vertex0Y;
-static float vertexOffsetX;
-static float vertexOffsetY;
+static std::vector<Triangle> triangles;
+// The triangles covering each tile, in the order they were queued.
+static std::array<std::vector<u32>, NUM_TILES_X * NUM_TILES_Y> tileTriangles;
+static std::vector<u32> usedTiles;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+static s16 konstColors[4][4];
+static std::vector<std::unique_ptr<DrawState>> drawStates;
+static Common::WorkerPool workerPool;
 
 void Init()
 {
-  tev.Init();
-
   // Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the
   // first primitive.
   // TODO: This is just a guess!
@@ -43,6 +83,17 @@ void Init()
   ZSlope.f0 = 1.f;
 }
 
+void Shutdown()
+{
+  workerPool.Shutdown();
+  drawStates.clear();
+  Tev::ClearPrograms();
+  triangles.clear();
+  for (u32 tile : usedTiles)
+    tileTriangles[tile].clear();
+  usedTiles.clear();
+}
+
 // Returns approximation of log2(f) in s28.4
 // results are close enough to use for LOD
 static s32 FixedLog2(float f)
@@ -67,59 +118,80 @@ static inline int iround(float x)
 
 void SetTevReg(int reg, int comp, s16 color)
 {
-  tev.SetRegColor(reg, comp, color);
+  konstColors[reg][comp] = color;
 }
 
-static void Draw(s32 x, s32 y, s32 xi, s32 yi)
+// Draws the pixels of the block which are set in lane_mask, lane i being pixel (i & 1, i >> 1)
+static void DrawBlock(const Triangle& tri, DrawState& state, s32 blockX, s32 blockY,
+                      u32 lane_mask)
 {
-  INCSTAT(stats.thisFrame.rasterizedPixels);
+  Tev& tev = state.tev;
+  const RasterBlock& rasterBlock = state.rasterBlock;
+
+  for (int lane = 0; lane < Tev::NUM_LANES; lane++)
+  {
+    if (!(lane_mask & (1 << lane)))
+      continue;
 
-  float dx = vertexOffsetX + (float)(x - vertex0X);
-  float dy = vertexOffsetY + (float)(y - vertex0Y);
+    const s32 xi = lane & 1;
+    const s32 yi = lane >> 1;
+    const s32 x = blockX + xi;
+    const s32 y = blockY + yi;
+    state.rasterizedPixels++;
 
-  s32 z = (s32)MathUtil::Clamp<float>(ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
+    float dx = tri.vertexOffsetX + (float)(x - tri.vertex0X);
+    float dy = tri.vertexOffsetY + (float)(y - tri.vertex0Y);
 
-  if (bpmem.UseEarlyDepthTest() && g_ActiveConfig.bZComploc)
-  {
-    // TODO: Test if perf regs are incremented even if test is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
-    if (bpmem.zmode.testenable)
+    s32 z = (s32)MathUtil::Clamp<float>(tri.ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
+
+    if (bpmem.UseEarlyDepthTest() && g_ActiveConfig.bZComploc)
     {
-      // early z
-      if (!EfbInterface::ZCompare(x, y, z))
-        return;
+      // TODO: Test if perf regs are incremented even if test is disabled
+      tev.PerfCounters[PQ_ZCOMP_INPUT_ZCOMPLOC]++;
+      if (bpmem.zmode.testenable)
+      {
+        // early z
+        if (!EfbInterface::ZCompare(x, y, z))
+        {
+          lane_mask &= ~(1 << lane);
+          continue;
+        }
+      }
+      tev.PerfCounters[PQ_ZCOMP_OUTPUT_ZCOMPLOC]++;
     }
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
-  }
 
-  RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+    const RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-  tev.Position[0] = x;
-  tev.Position[1] = y;
-  tev.Position[2] = z;
+    tev.Position[lane][0] = x;
+    tev.Position[lane][1] = y;
+    tev.Position[lane][2] = z;
 
-  //  colors
-  for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
-  {
-    for (int comp = 0; comp < 4; comp++)
+    //  colors
+    for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
     {
-      u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+      for (int comp = 0; comp < 4; comp++)
+      {
+        u16 color = (u16)tri.ColorSlopes[i][comp].GetValue(dx, dy);
 
-      // clamp color value to 0
-      u16 mask = ~(color >> 8);
+        // clamp color value to 0
+        u16 mask = ~(color >> 8);
 
-      tev.Color[i][comp] = color & mask;
+        tev.Color[lane][i][comp] = color & mask;
+      }
     }
-  }
 
-  // tex coords
-  for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
-  {
-    // multiply by 128 because TEV stores UVs as s17.7
-    tev.Uv[i].s = (s32)(pixel.Uv[i][0] * 128);
-    tev.Uv[i].t = (s32)(pixel.Uv[i][1] * 128);
+    // tex coords
+    for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
+    {
+      // multiply by 128 because TEV stores UVs as s17.7
+      tev.Uv[lane][i].s = (s32)(pixel.Uv[i][0] * 128);
+      tev.Uv[lane][i].t = (s32)(pixel.Uv[i][1] * 128);
+    }
   }
 
+  if (!lane_mask)
+    return;
+
   for (unsigned int i = 0; i < bpmem.genMode.numindstages; i++)
   {
     tev.IndirectLod[i] = rasterBlock.IndirectLod[i];
@@ -132,19 +204,19 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
     tev.TextureLinear[i] = rasterBlock.TextureLinear[i];
   }
 
-  tev.Draw();
+  tev.Draw(lane_mask);
 }
 
-static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
+static void InitTriangle(Triangle* tri, float X1, float Y1, s32 xi, s32 yi)
 {
-  vertex0X = xi;
-  vertex0Y = yi;
+  tri->vertex0X = xi;
+  tri->vertex0Y = yi;
 
   // adjust a little less than 0.5
   const float adjust = 0.495f;
 
-  vertexOffsetX = ((float)xi - X1) + adjust;
-  vertexOffsetY = ((float)yi - Y1) + adjust;
+  tri->vertexOffsetX = ((float)xi - X1) + adjust;
+  tri->vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 static void InitSlope(Slope* slope, float f1, float f2, float f3, float DX31, float DX12,
@@ -160,7 +232,17 @@ static void InitSlope(Slope* slope, float f1, float f2, float f3, float DX31, fl
   slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+// FixedLog2 of the largest difference of each texture coordinate between the pixels of a block,
+// with and without diagonal LOD. Only computed for the coordinates which are sampled, once for all
+// texmaps which use them.
+struct BlockDerivatives
+{
+  s32 log2[8][2];
+  u32 known = 0;
+};
+
+static inline void CalculateLOD(const RasterBlock& rasterBlock, BlockDerivatives* derivatives,
+                                s32* lodp, bool* linear, u32 texmap, u32 texcoord)
 {
   const FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
   const u8 subTexmap = texmap & 3;
@@ -170,27 +252,35 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
   const TexMode0& tm0 = texUnit.texMode0[subTexmap];
   const TexMode1& tm1 = texUnit.texMode1[subTexmap];
 
-  float sDelta, tDelta;
-  if (tm0.diag_lod)
+  const u32 diag = tm0.diag_lod;
+  const u32 known_bit = 1 << (texcoord * 2 + diag);
+  if (!(derivatives->known & known_bit))
   {
-    float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-    float* uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+    float sDelta, tDelta;
+    if (diag)
+    {
+      const float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+      const float* uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
-    sDelta = fabsf(uv0[0] - uv1[0]);
-    tDelta = fabsf(uv0[1] - uv1[1]);
-  }
-  else
-  {
-    float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-    float* uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-    float* uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+      sDelta = fabsf(uv0[0] - uv1[0]);
+      tDelta = fabsf(uv0[1] - uv1[1]);
+    }
+    else
+    {
+      const float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+      const float* uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+      const float* uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+
+      sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
+      tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
+    }
 
-    sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
-    tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
+    derivatives->log2[texcoord][diag] = FixedLog2(std::max(sDelta, tDelta));
+    derivatives->known |= known_bit;
   }
 
   // get LOD in s28.4
-  s32 lod = FixedLog2(std::max(sDelta, tDelta));
+  s32 lod = derivatives->log2[texcoord][diag];
 
   // bias is s2.5
   int bias = tm0.lod_bias;
@@ -208,7 +298,7 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
   *lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(const Triangle& tri, RasterBlock& rasterBlock, s32 blockX, s32 blockY)
 {
   for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
   {
@@ -216,10 +306,10 @@ static void BuildBlock(s32 blockX, s32 blockY)
     {
       RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-      float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-      float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+      float dx = tri.vertexOffsetX + (float)(xi + blockX - tri.vertex0X);
+      float dy = tri.vertexOffsetY + (float)(yi + blockY - tri.vertex0Y);
 
-      float invW = 1.0f / WSlope.GetValue(dx, dy);
+      float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
       pixel.InvW = invW;
 
       // tex coords
@@ -228,17 +318,19 @@ static void BuildBlock(s32 blockX, s32 blockY)
         float projection = invW;
         if (xfmem.texMtxInfo[i].projection)
         {
-          float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
+          float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
           if (q != 0.0f)
             projection = invW / q;
         }
 
-        pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-        pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+        pixel.Uv[i][0] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+        pixel.Uv[i][1] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
       }
     }
   }
 
+  BlockDerivatives derivatives;
+
   u32 indref = bpmem.tevindref.hex;
   for (unsigned int i = 0; i < bpmem.genMode.numindstages; i++)
   {
@@ -247,7 +339,8 @@ static void BuildBlock(s32 blockX, s32 blockY)
     u32 texcoord = indref & 3;
     indref >>= 3;
 
-    CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+    CalculateLOD(rasterBlock, &derivatives, &rasterBlock.IndirectLod[i],
+                 &rasterBlock.IndirectLinear[i], texmap, texcoord);
   }
 
   for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -259,7 +352,114 @@ static void BuildBlock(s32 blockX, s32 blockY)
       u32 texmap = order.getTexMap(stageOdd);
       u32 texcoord = order.getTexCoord(stageOdd);
 
-      CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+      CalculateLOD(rasterBlock, &derivatives, &rasterBlock.TextureLod[i],
+                   &rasterBlock.TextureLinear[i], texmap, texcoord);
+    }
+  }
+}
+
+// Draws the blocks of the triangle which are inside the tile
+static void DrawTriangleInTile(const Triangle& tri, DrawState& state, s32 tileX, s32 tileY)
+{
+  const s32 minx = std::max(tri.minx, tileX);
+  const s32 maxx = std::min(tri.maxx, tileX + TILE_SIZE);
+  const s32 miny = std::max(tri.miny, tileY);
+  const s32 maxy = std::min(tri.maxy, tileY + TILE_SIZE);
+
+  const s32 C1 = tri.C1;
+  const s32 C2 = tri.C2;
+  const s32 C3 = tri.C3;
+
+  const s32 DX12 = tri.DX12;
+  const s32 DX23 = tri.DX23;
+  const s32 DX31 = tri.DX31;
+
+  const s32 DY12 = tri.DY12;
+  const s32 DY23 = tri.DY23;
+  const s32 DY31 = tri.DY31;
+
+  // Fixed-pos32 deltas
+  const s32 FDX12 = DX12 * 16;
+  const s32 FDX23 = DX23 * 16;
+  const s32 FDX31 = DX31 * 16;
+
+  const s32 FDY12 = DY12 * 16;
+  const s32 FDY23 = DY23 * 16;
+  const s32 FDY31 = DY31 * 16;
+
+  // Loop through blocks
+  for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+  {
+    for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+    {
+      // Corners of block
+      s32 x0 = x << 4;
+      s32 x1 = (x + BLOCK_SIZE - 1) << 4;
+      s32 y0 = y << 4;
+      s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+
+      // Evaluate half-space functions
+      bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
+      bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
+      bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
+      bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
+      int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+      bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
+      bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
+      bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
+      bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
+      int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+      bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
+      bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
+      bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
+      bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
+      int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+
+      // Skip block when outside an edge
+      if (a == 0x0 || b == 0x0 || c == 0x0)
+        continue;
+
+      BuildBlock(tri, state.rasterBlock, x, y);
+
+      // Accept whole block when totally covered
+      if (a == 0xF && b == 0xF && c == 0xF)
+      {
+        DrawBlock(tri, state, x, y, 0xF);
+      }
+      else  // Partially covered block
+      {
+        s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
+        s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
+        s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+
+        u32 lane_mask = 0;
+        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+        {
+          s32 CX1 = CY1;
+          s32 CX2 = CY2;
+          s32 CX3 = CY3;
+
+          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+          {
+            if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+            {
+              lane_mask |= 1 << (iy * BLOCK_SIZE + ix);
+            }
+
+            CX1 -= FDY12;
+            CX2 -= FDY23;
+            CX3 -= FDY31;
+          }
+
+          CY1 += FDX12;
+          CY2 += FDX23;
+          CY3 += FDX31;
+        }
+
+        DrawBlock(tri, state, x, y, lane_mask);
+      }
     }
   }
 }
@@ -290,15 +490,6 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   const s32 DY23 = Y2 - Y3;
   const s32 DY31 = Y3 - Y1;
 
-  // Fixed-pos32 deltas
-  const s32 FDX12 = DX12 * 16;
-  const s32 FDX23 = DX23 * 16;
-  const s32 FDX31 = DX31 * 16;
-
-  const s32 FDY12 = DY12 * 16;
-  const s32 FDY23 = DY23 * 16;
-  const s32 FDY31 = DY31 * 16;
-
   // Bounding rectangle
   s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
   s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
@@ -333,6 +524,9 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (minx >= maxx || miny >= maxy)
     return;
 
+  triangles.emplace_back();
+  Triangle& tri = triangles.back();
+
   // Setup slopes
   float fltx1 = v0->screenPosition.x;
   float flty1 = v0->screenPosition.y;
@@ -341,11 +535,11 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   float fltdy12 = flty1 - v1->screenPosition.y;
   float fltdy31 = v2->screenPosition.y - flty1;
 
-  InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
+  InitTriangle(&tri, fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
 
   float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w,
                 1.0f / v2->projectedPosition.w};
-  InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+  InitSlope(&tri.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 
   // TODO: The zfreeze emulation is not quite correct, yet!
   // Many things might prevent us from reaching this line (culling, clipping, scissoring).
@@ -356,19 +550,21 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (!bpmem.genMode.zfreeze || !g_ActiveConfig.bZFreeze)
     InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31,
               fltdx12, fltdy12, fltdy31);
+  tri.ZSlope = ZSlope;
 
   for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
   {
     for (int comp = 0; comp < 4; comp++)
-      InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp],
-                fltdx31, fltdx12, fltdy12, fltdy31);
+      InitSlope(&tri.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp],
+                v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
   }
 
   for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
   {
     for (int comp = 0; comp < 3; comp++)
-      InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1],
-                v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+      InitSlope(&tri.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0],
+                v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12,
+                fltdy12, fltdy31);
   }
 
   // Half-edge constants
@@ -384,87 +580,122 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (DY31 < 0 || (DY31 == 0 && DX31 > 0))
     C3++;
 
-  // Start in corner of 8x8 block
-  minx &= ~(BLOCK_SIZE - 1);
-  miny &= ~(BLOCK_SIZE - 1);
+  tri.C1 = C1;
+  tri.C2 = C2;
+  tri.C3 = C3;
+  tri.DX12 = DX12;
+  tri.DX23 = DX23;
+  tri.DX31 = DX31;
+  tri.DY12 = DY12;
+  tri.DY23 = DY23;
+  tri.DY31 = DY31;
 
-  // Loop through blocks
-  for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+  // Start in corner of 8x8 block
+  tri.minx = minx & ~(BLOCK_SIZE - 1);
+  tri.maxx = maxx;
+  tri.miny = miny & ~(BLOCK_SIZE - 1);
+  tri.maxy = maxy;
+
+  // Sort the triangle into the tiles its bounding rectangle touches
+  const u32 index = static_cast<u32>(triangles.size() - 1);
+  for (s32 tileY = tri.miny / TILE_SIZE; tileY <= (maxy - 1) / TILE_SIZE; tileY++)
   {
-    for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+    for (s32 tileX = tri.minx / TILE_SIZE; tileX <= (maxx - 1) / TILE_SIZE; tileX++)
     {
-      // Corners of block
-      s32 x0 = x << 4;
-      s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-      s32 y0 = y << 4;
-      s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+      const u32 tile = tileY * NUM_TILES_X + tileX;
+      if (tileTriangles[tile].empty())
+        usedTiles.push_back(tile);
+      tileTriangles[tile].push_back(index);
+    }
+  }
+}
 
-      // Evaluate half-space functions
-      bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-      bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-      bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-      bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-      int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+static void UpdateDrawStates()
+{
+  u32 num_threads = g_ActiveConfig.GetSWRasterizerThreads();
 
-      bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-      bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-      bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-      bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-      int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+  // The TEV stage dumps go through shared buffers, so only one tile can be drawn at a time.
+  if (g_ActiveConfig.bDumpTevStages || g_ActiveConfig.bDumpTevTextureFetches)
+    num_threads = 0;
 
-      bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-      bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-      bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-      bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-      int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+  if (workerPool.GetThreadCount() != num_threads)
+    workerPool.Reset(num_threads, "Rasterizer");
 
-      // Skip block when outside an edge
-      if (a == 0x0 || b == 0x0 || c == 0x0)
-        continue;
+  // The GPU thread draws tiles too.
+  while (drawStates.size() < num_threads + 1)
+  {
+    drawStates.push_back(std::make_unique<DrawState>());
+    drawStates.back()->tev.Init();
+    drawStates.back()->rasterizedPixels = 0;
+  }
+}
 
-      BuildBlock(x, y);
+void Flush()
+{
+  if (triangles.empty())
+    return;
 
-      // Accept whole block when totally covered
-      if (a == 0xF && b == 0xF && c == 0xF)
-      {
-        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-        {
-          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-          {
-            Draw(x + ix, y + iy, ix, iy);
-          }
-        }
-      }
-      else  // Partially covered block
-      {
-        s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-        s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-        s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+  UpdateDrawStates();
+  const u32 num_jobs =
+      std::min(workerPool.GetThreadCount() + 1, static_cast<u32>(usedTiles.size()));
+  for (u32 job = 0; job < num_jobs; job++)
+  {
+    for (int reg = 0; reg < 4; reg++)
+    {
+      for (int comp = 0; comp < 4; comp++)
+        drawStates[job]->tev.SetRegColor(reg, comp, konstColors[reg][comp]);
+    }
+    drawStates[job]->tev.PrepareDraw();
+  }
 
-        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-        {
-          s32 CX1 = CY1;
-          s32 CX2 = CY2;
-          s32 CX3 = CY3;
+  // Every job draws whole tiles until all of them are done.
+  std::atomic<u32> next_tile{0};
+  workerPool.ParallelFor(num_jobs, [&](u32 job) {
+    DrawState& state = *drawStates[job];
+    for (u32 i = next_tile++; i < usedTiles.size(); i = next_tile++)
+    {
+      const u32 tile = usedTiles[i];
+      const s32 tileX = static_cast<s32>(tile % NUM_TILES_X) * TILE_SIZE;
+      const s32 tileY = static_cast<s32>(tile / NUM_TILES_X) * TILE_SIZE;
+      for (u32 index : tileTriangles[tile])
+        DrawTriangleInTile(triangles[index], state, tileX, tileY);
+    }
+  });
 
-          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-          {
-            if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-            {
-              Draw(x + ix, y + iy, ix, iy);
-            }
+  for (u32 job = 0; job < num_jobs; job++)
+  {
+    DrawState& state = *drawStates[job];
+    Tev& tev = state.tev;
 
-            CX1 -= FDY12;
-            CX2 -= FDY23;
-            CX3 -= FDY31;
-          }
+    ADDSTAT(stats.thisFrame.rasterizedPixels, state.rasterizedPixels);
+    ADDSTAT(stats.thisFrame.tevPixelsIn, tev.PixelsIn);
+    ADDSTAT(stats.thisFrame.tevPixelsOut, tev.PixelsOut);
 
-          CY1 += FDX12;
-          CY2 += FDX23;
-          CY3 += FDX31;
-        }
-      }
+    for (int type = 0; type < PQ_NUM_MEMBERS; type++)
+    {
+      if (tev.PerfCounters[type])
+        EfbInterface::IncPerfCounterQuadCount(static_cast<PerfQueryType>(type),
+                                              tev.PerfCounters[type]);
+    }
+
+    if (tev.PixelsOut)
+    {
+      u16* coords = BoundingBox::coords;
+      coords[BoundingBox::LEFT] = std::min(tev.BBox[BoundingBox::LEFT], coords[BoundingBox::LEFT]);
+      coords[BoundingBox::RIGHT] =
+          std::max(tev.BBox[BoundingBox::RIGHT], coords[BoundingBox::RIGHT]);
+      coords[BoundingBox::TOP] = std::min(tev.BBox[BoundingBox::TOP], coords[BoundingBox::TOP]);
+      coords[BoundingBox::BOTTOM] =
+          std::max(tev.BBox[BoundingBox::BOTTOM], coords[BoundingBox::BOTTOM]);
     }
+
+    state.rasterizedPixels = 0;
+    tev.ResetCounters();
   }
+
+  for (u32 tile : usedTiles)
+    tileTriangles[tile].clear();
+  usedTiles.clear();
+  triangles.clear();
 }
 }
@@ -11,9 +11,15 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 void Init();
+void Shutdown();
 
+// Sets up the triangle and sorts it into the tiles it covers. It is drawn by the next Flush().
 void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
                            const OutputVertexData* v2);
+// Draws the triangles queued since the last call. The tiles are drawn in parallel, but every tile
+// draws its triangles in the order they were queued, so each pixel is written in the same order
+// as when drawing the triangles one after another.
+void Flush();
 
 void SetTevReg(int reg, int comp, s16 color);
 
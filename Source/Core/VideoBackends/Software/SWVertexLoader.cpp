@@ -4,6 +4,7 @@
 
 #include "VideoBackends/Software/SWVertexLoader.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 
@@ -87,29 +88,38 @@ void SWVertexLoader::vFlush()
     Rasterizer::SetTevReg(i, Tev::ALP_C, PixelShaderManager::constants.kcolors[i][3]);
   }
 
-  for (u32 i = 0; i < IndexGenerator::GetIndexLen(); i++)
-  {
-    const u16 index = m_local_index_buffer[i];
-    memset(&m_vertex, 0, sizeof(m_vertex));
+  // Each vertex is parsed and transformed once, however many primitives use it.
+  const u32 num_indices = IndexGenerator::GetIndexLen();
+  u32 num_vertices = 0;
+  for (u32 i = 0; i < num_indices; i++)
+    num_vertices = std::max<u32>(num_vertices, m_local_index_buffer[i] + 1);
 
-    // Super Mario Sunshine requires those to be zero for those debug boxes.
-    m_vertex.color = {};
+  memset(&m_vertex, 0, sizeof(m_vertex));
 
-    // parse the videocommon format to our own struct format (m_vertex)
-    SetFormat(g_main_cp_state.last_id, primitiveType);
-    ParseVertex(VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration(), index);
+  // Super Mario Sunshine requires those to be zero for those debug boxes.
+  m_vertex.color = {};
 
-    // transform this vertex so that it can be used for rasterization (outVertex)
-    OutputVertexData* outVertex = m_setup_unit.GetVertex();
-    TransformUnit::TransformPosition(&m_vertex, outVertex);
-    outVertex->normal = {};
-    if (VertexLoaderManager::g_current_components & VB_HAS_NRM0)
-    {
-      TransformUnit::TransformNormal(
-          &m_vertex, (VertexLoaderManager::g_current_components & VB_HAS_NRM2) != 0, outVertex);
-    }
-    TransformUnit::TransformColor(&m_vertex, outVertex);
-    TransformUnit::TransformTexCoord(&m_vertex, outVertex, m_tex_gen_special_case);
+  // parse the videocommon format to our own struct format (m_vertices)
+  SetFormat(g_main_cp_state.last_id, primitiveType);
+  const PortableVertexDeclaration& vdec =
+      VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration();
+  m_vertices.resize(num_vertices);
+  for (u32 i = 0; i < num_vertices; i++)
+  {
+    m_vertices[i] = m_vertex;
+    ParseVertex(vdec, i, &m_vertices[i]);
+  }
+
+  // transform the vertices so that they can be used for rasterization (m_transformed_vertices)
+  m_transformed_vertices.resize(num_vertices);
+  TransformUnit::TransformVertices(m_vertices.data(), m_transformed_vertices.data(), num_vertices,
+                                   (VertexLoaderManager::g_current_components & VB_HAS_NRM0) != 0,
+                                   (VertexLoaderManager::g_current_components & VB_HAS_NRM2) != 0,
+                                   m_tex_gen_special_case);
+
+  for (u32 i = 0; i < num_indices; i++)
+  {
+    *m_setup_unit.GetVertex() = m_transformed_vertices[m_local_index_buffer[i]];
 
     // assemble and rasterize the primitive
     m_setup_unit.SetupVertex();
@@ -117,6 +127,8 @@ void SWVertexLoader::vFlush()
     INCSTAT(stats.thisFrame.numVerticesLoaded)
   }
 
+  Rasterizer::Flush();
+
   DebugUtil::OnObjectEnd();
 }
 
@@ -207,34 +219,35 @@ static void ReadVertexAttribute(T* dst, DataReader src, const AttributeFormat& f
   }
 }
 
-void SWVertexLoader::ParseVertex(const PortableVertexDeclaration& vdec, int index)
+void SWVertexLoader::ParseVertex(const PortableVertexDeclaration& vdec, int index,
+                                 InputVertexData* vertex)
 {
   DataReader src(m_local_vertex_buffer.data(),
                  m_local_vertex_buffer.data() + m_local_vertex_buffer.size());
   src.Skip(index * vdec.stride);
 
-  ReadVertexAttribute<float>(&m_vertex.position[0], src, vdec.position, 0, 3, false);
+  ReadVertexAttribute<float>(&vertex->position[0], src, vdec.position, 0, 3, false);
 
-  for (std::size_t i = 0; i < m_vertex.normal.size(); i++)
+  for (std::size_t i = 0; i < vertex->normal.size(); i++)
   {
-    ReadVertexAttribute<float>(&m_vertex.normal[i][0], src, vdec.normals[i], 0, 3, false);
+    ReadVertexAttribute<float>(&vertex->normal[i][0], src, vdec.normals[i], 0, 3, false);
   }
 
-  for (std::size_t i = 0; i < m_vertex.color.size(); i++)
+  for (std::size_t i = 0; i < vertex->color.size(); i++)
   {
-    ReadVertexAttribute<u8>(m_vertex.color[i].data(), src, vdec.colors[i], 0, 4, true);
+    ReadVertexAttribute<u8>(vertex->color[i].data(), src, vdec.colors[i], 0, 4, true);
   }
 
-  for (std::size_t i = 0; i < m_vertex.texCoords.size(); i++)
+  for (std::size_t i = 0; i < vertex->texCoords.size(); i++)
   {
-    ReadVertexAttribute<float>(m_vertex.texCoords[i].data(), src, vdec.texcoords[i], 0, 2, false);
+    ReadVertexAttribute<float>(vertex->texCoords[i].data(), src, vdec.texcoords[i], 0, 2, false);
 
     // the texmtr is stored as third component of the texCoord
     if (vdec.texcoords[i].components >= 3)
     {
-      ReadVertexAttribute<u8>(&m_vertex.texMtx[i], src, vdec.texcoords[i], 2, 1, false);
+      ReadVertexAttribute<u8>(&vertex->texMtx[i], src, vdec.texcoords[i], 2, 1, false);
     }
   }
 
-  ReadVertexAttribute<u8>(&m_vertex.posMtx, src, vdec.posmtx, 0, 1, false);
+  ReadVertexAttribute<u8>(&vertex->posMtx, src, vdec.posmtx, 0, 1, false);
 }
@@ -28,12 +28,15 @@ private:
   void vFlush() override;
 
   void SetFormat(u8 attributeIndex, u8 primitiveType);
-  void ParseVertex(const PortableVertexDeclaration& vdec, int index);
+  void ParseVertex(const PortableVertexDeclaration& vdec, int index, InputVertexData* vertex);
 
   std::vector<u8> m_local_vertex_buffer;
   std::vector<u16> m_local_index_buffer;
 
   InputVertexData m_vertex;
+  // The vertices of the buffer, which are transformed before the primitives are assembled
+  std::vector<InputVertexData> m_vertices;
+  std::vector<OutputVertexData> m_transformed_vertices;
   SetupUnit m_setup_unit;
 
   bool m_tex_gen_special_case;
@@ -72,6 +72,8 @@ void VideoSoftware::InitBackendInfo()
   g_Config.backend_info.bSupportsCopyToVram = false;
   g_Config.backend_info.bSupportsFramebufferFetch = false;
   g_Config.backend_info.bSupportsBackgroundCompiling = false;
+  g_Config.backend_info.bSupportsEFBPeekCache = true;
+  g_Config.backend_info.bSupportsDeferredEFBCopies = false;
   g_Config.backend_info.bSupportsLogicOp = true;
 
   // aamodes
@@ -108,6 +110,7 @@ void VideoSoftware::Shutdown()
   if (g_renderer)
     g_renderer->Shutdown();
 
+  Rasterizer::Shutdown();
   DebugUtil::Shutdown();
   SWOGLWindow::Shutdown();
   g_framebuffer_manager.reset();
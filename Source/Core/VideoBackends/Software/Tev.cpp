@@ -2,19 +2,28 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/Tev.h"
 #include "VideoBackends/Software/TextureSampler.h"
 
+#ifdef _M_X86_64
+#include "VideoBackends/Software/TevX64.h"
+#endif
+
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/PixelShaderManager.h"
-#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"
 
@@ -24,80 +33,35 @@
 #define ALLOW_TEV_DUMPS 0
 #endif
 
-void Tev::Init()
+#ifdef _M_X86_64
+// The compiled combiners are shared by the Tevs of all threads.
+static std::mutex s_programs_lock;
+static std::map<TevX64::Key, std::unique_ptr<TevX64>> s_programs;
+
+static Tev::CombinerProgram GetProgram()
+{
+  const TevX64::Key key = TevX64::GetCurrentKey();
+
+  std::lock_guard<std::mutex> lk(s_programs_lock);
+  std::unique_ptr<TevX64>& program = s_programs[key];
+  if (!program)
+    program = std::make_unique<TevX64>(key);
+  return program->GetProgram();
+}
+#endif
+
+void Tev::Init(bool vectorized, bool jit)
 {
-  FixedConstants[0] = 0;
-  FixedConstants[1] = 32;
-  FixedConstants[2] = 64;
-  FixedConstants[3] = 96;
-  FixedConstants[4] = 128;
-  FixedConstants[5] = 159;
-  FixedConstants[6] = 191;
-  FixedConstants[7] = 223;
-  FixedConstants[8] = 255;
-
-  for (s16& comp : Zero16)
-  {
-    comp = 0;
-  }
-
-  m_ColorInputLUT[0][RED_INP] = &Reg[0][RED_C];
-  m_ColorInputLUT[0][GRN_INP] = &Reg[0][GRN_C];
-  m_ColorInputLUT[0][BLU_INP] = &Reg[0][BLU_C];  // prev.rgb
-  m_ColorInputLUT[1][RED_INP] = &Reg[0][ALP_C];
-  m_ColorInputLUT[1][GRN_INP] = &Reg[0][ALP_C];
-  m_ColorInputLUT[1][BLU_INP] = &Reg[0][ALP_C];  // prev.aaa
-  m_ColorInputLUT[2][RED_INP] = &Reg[1][RED_C];
-  m_ColorInputLUT[2][GRN_INP] = &Reg[1][GRN_C];
-  m_ColorInputLUT[2][BLU_INP] = &Reg[1][BLU_C];  // c0.rgb
-  m_ColorInputLUT[3][RED_INP] = &Reg[1][ALP_C];
-  m_ColorInputLUT[3][GRN_INP] = &Reg[1][ALP_C];
-  m_ColorInputLUT[3][BLU_INP] = &Reg[1][ALP_C];  // c0.aaa
-  m_ColorInputLUT[4][RED_INP] = &Reg[2][RED_C];
-  m_ColorInputLUT[4][GRN_INP] = &Reg[2][GRN_C];
-  m_ColorInputLUT[4][BLU_INP] = &Reg[2][BLU_C];  // c1.rgb
-  m_ColorInputLUT[5][RED_INP] = &Reg[2][ALP_C];
-  m_ColorInputLUT[5][GRN_INP] = &Reg[2][ALP_C];
-  m_ColorInputLUT[5][BLU_INP] = &Reg[2][ALP_C];  // c1.aaa
-  m_ColorInputLUT[6][RED_INP] = &Reg[3][RED_C];
-  m_ColorInputLUT[6][GRN_INP] = &Reg[3][GRN_C];
-  m_ColorInputLUT[6][BLU_INP] = &Reg[3][BLU_C];  // c2.rgb
-  m_ColorInputLUT[7][RED_INP] = &Reg[3][ALP_C];
-  m_ColorInputLUT[7][GRN_INP] = &Reg[3][ALP_C];
-  m_ColorInputLUT[7][BLU_INP] = &Reg[3][ALP_C];  // c2.aaa
-  m_ColorInputLUT[8][RED_INP] = &TexColor[RED_C];
-  m_ColorInputLUT[8][GRN_INP] = &TexColor[GRN_C];
-  m_ColorInputLUT[8][BLU_INP] = &TexColor[BLU_C];  // tex.rgb
-  m_ColorInputLUT[9][RED_INP] = &TexColor[ALP_C];
-  m_ColorInputLUT[9][GRN_INP] = &TexColor[ALP_C];
-  m_ColorInputLUT[9][BLU_INP] = &TexColor[ALP_C];  // tex.aaa
-  m_ColorInputLUT[10][RED_INP] = &RasColor[RED_C];
-  m_ColorInputLUT[10][GRN_INP] = &RasColor[GRN_C];
-  m_ColorInputLUT[10][BLU_INP] = &RasColor[BLU_C];  // ras.rgb
-  m_ColorInputLUT[11][RED_INP] = &RasColor[ALP_C];
-  m_ColorInputLUT[11][GRN_INP] = &RasColor[ALP_C];
-  m_ColorInputLUT[11][BLU_INP] = &RasColor[ALP_C];  // ras.rgb
-  m_ColorInputLUT[12][RED_INP] = &FixedConstants[8];
-  m_ColorInputLUT[12][GRN_INP] = &FixedConstants[8];
-  m_ColorInputLUT[12][BLU_INP] = &FixedConstants[8];  // one
-  m_ColorInputLUT[13][RED_INP] = &FixedConstants[4];
-  m_ColorInputLUT[13][GRN_INP] = &FixedConstants[4];
-  m_ColorInputLUT[13][BLU_INP] = &FixedConstants[4];  // half
-  m_ColorInputLUT[14][RED_INP] = &StageKonst[RED_C];
-  m_ColorInputLUT[14][GRN_INP] = &StageKonst[GRN_C];
-  m_ColorInputLUT[14][BLU_INP] = &StageKonst[BLU_C];  // konst
-  m_ColorInputLUT[15][RED_INP] = &FixedConstants[0];
-  m_ColorInputLUT[15][GRN_INP] = &FixedConstants[0];
-  m_ColorInputLUT[15][BLU_INP] = &FixedConstants[0];  // zero
-
-  m_AlphaInputLUT[0] = &Reg[0][ALP_C];      // prev
-  m_AlphaInputLUT[1] = &Reg[1][ALP_C];      // c0
-  m_AlphaInputLUT[2] = &Reg[2][ALP_C];      // c1
-  m_AlphaInputLUT[3] = &Reg[3][ALP_C];      // c2
-  m_AlphaInputLUT[4] = &TexColor[ALP_C];    // tex
-  m_AlphaInputLUT[5] = &RasColor[ALP_C];    // ras
-  m_AlphaInputLUT[6] = &StageKonst[ALP_C];  // konst
-  m_AlphaInputLUT[7] = &Zero16[ALP_C];      // zero
+  m_vectorized = vectorized;
+  m_jit = jit;
+  m_program = nullptr;
+
+  static const s16 fixed_constants[9] = {0, 32, 64, 96, 128, 159, 191, 223, 255};
+  std::copy(std::begin(fixed_constants), std::end(fixed_constants), FixedConstants);
+
+  std::fill(std::begin(m_state.One), std::end(m_state.One), FixedConstants[8]);
+  std::fill(std::begin(m_state.Half), std::end(m_state.Half), FixedConstants[4]);
+  std::fill(std::begin(m_state.Zero), std::end(m_state.Zero), FixedConstants[0]);
 
   for (int comp = 0; comp < 4; comp++)
   {
@@ -157,6 +121,107 @@ void Tev::Init()
   m_ScaleRShiftLUT[1] = 0;
   m_ScaleRShiftLUT[2] = 0;
   m_ScaleRShiftLUT[3] = 1;
+
+  ResetCounters();
+}
+
+void Tev::ClearPrograms()
+{
+#ifdef _M_X86_64
+  std::lock_guard<std::mutex> lk(s_programs_lock);
+  s_programs.clear();
+#endif
+}
+
+const s16* Tev::GetColorInput(const CombinerState& state, int stage, u32 sel, int comp)
+{
+  switch (sel)
+  {
+  case TEVCOLORARG_CPREV:
+  case TEVCOLORARG_C0:
+  case TEVCOLORARG_C1:
+  case TEVCOLORARG_C2:
+    return state.Reg[sel >> 1][comp];
+  case TEVCOLORARG_APREV:
+  case TEVCOLORARG_A0:
+  case TEVCOLORARG_A1:
+  case TEVCOLORARG_A2:
+    return state.Reg[sel >> 1][ALP_C];
+  case TEVCOLORARG_TEXC:
+    return state.TexColor[stage][comp];
+  case TEVCOLORARG_TEXA:
+    return state.TexColor[stage][ALP_C];
+  case TEVCOLORARG_RASC:
+    return state.RasColor[stage][comp];
+  case TEVCOLORARG_RASA:
+    return state.RasColor[stage][ALP_C];
+  case TEVCOLORARG_ONE:
+    return state.One;
+  case TEVCOLORARG_HALF:
+    return state.Half;
+  case TEVCOLORARG_KONST:
+    return state.Konst[stage][comp];
+  default:  // TEVCOLORARG_ZERO
+    return state.Zero;
+  }
+}
+
+const s16* Tev::GetAlphaInput(const CombinerState& state, int stage, u32 sel)
+{
+  switch (sel)
+  {
+  case TEVALPHAARG_APREV:
+  case TEVALPHAARG_A0:
+  case TEVALPHAARG_A1:
+  case TEVALPHAARG_A2:
+    return state.Reg[sel][ALP_C];
+  case TEVALPHAARG_TEXA:
+    return state.TexColor[stage][ALP_C];
+  case TEVALPHAARG_RASA:
+    return state.RasColor[stage][ALP_C];
+  case TEVALPHAARG_KONST:
+    return state.Konst[stage][ALP_C];
+  default:  // TEVALPHAARG_ZERO
+    return state.Zero;
+  }
+}
+
+void Tev::PrepareDraw()
+{
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+  {
+    const TevKSel& kSel = bpmem.tevksel[stageNum >> 1];
+    const int kc = kSel.getKC(stageNum & 1);
+    const int ka = kSel.getKA(stageNum & 1);
+    s16(&konst)[4][NUM_LANES] = m_state.Konst[stageNum];
+    std::fill(std::begin(konst[RED_C]), std::end(konst[RED_C]), *m_KonstLUT[kc][RED_C]);
+    std::fill(std::begin(konst[GRN_C]), std::end(konst[GRN_C]), *m_KonstLUT[kc][GRN_C]);
+    std::fill(std::begin(konst[BLU_C]), std::end(konst[BLU_C]), *m_KonstLUT[kc][BLU_C]);
+    std::fill(std::begin(konst[ALP_C]), std::end(konst[ALP_C]), *m_KonstLUT[ka][ALP_C]);
+
+    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+    const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+    for (int i = BLU_C; i <= RED_C; i++)
+    {
+      m_StageInputs[stageNum][i][0] = GetColorInput(m_state, stageNum, cc.a, i);
+      m_StageInputs[stageNum][i][1] = GetColorInput(m_state, stageNum, cc.b, i);
+      m_StageInputs[stageNum][i][2] = GetColorInput(m_state, stageNum, cc.c, i);
+      m_StageInputs[stageNum][i][3] = GetColorInput(m_state, stageNum, cc.d, i);
+    }
+    m_StageInputs[stageNum][ALP_C][0] = GetAlphaInput(m_state, stageNum, ac.a);
+    m_StageInputs[stageNum][ALP_C][1] = GetAlphaInput(m_state, stageNum, ac.b);
+    m_StageInputs[stageNum][ALP_C][2] = GetAlphaInput(m_state, stageNum, ac.c);
+    m_StageInputs[stageNum][ALP_C][3] = GetAlphaInput(m_state, stageNum, ac.d);
+  }
+
+  m_texels.Reset();
+
+  m_program = nullptr;
+#ifdef _M_X86_64
+  // The stages aren't dumped by the compiled combiners.
+  if (m_jit && !(ALLOW_TEV_DUMPS && g_ActiveConfig.bDumpTevStages))
+    m_program = GetProgram();
+#endif
 }
 
 static inline s16 Clamp255(s16 in)
@@ -169,52 +234,130 @@ static inline s16 Clamp1024(s16 in)
   return in > 1023 ? 1023 : (in < -1024 ? -1024 : in);
 }
 
-void Tev::SetRasColor(int colorChan, int swaptable)
+#ifdef _M_X86_64
+static inline __m128i Load4(const s16* lanes)
+{
+  return _mm_loadl_epi64(reinterpret_cast<const __m128i*>(lanes));
+}
+
+static inline void Store4(s16* lanes, __m128i values)
+{
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(lanes), values);
+}
+
+// Sign extends the lanes to 32 bits
+static inline __m128i Load4Wide(const s16* lanes)
 {
+  const __m128i values = Load4(lanes);
+  return _mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16);
+}
+
+// The results of the combiners always fit in 16 bits, so saturating them is the same as
+// truncating them.
+static inline void Store4Wide(s16* lanes, __m128i values)
+{
+  Store4(lanes, _mm_packs_epi32(values, values));
+}
+
+// a * (256 - c) + b * c, with c scaled from 0-255 to 0-256
+static inline __m128i Lerp4(const s16* a, const s16* b, const s16* c)
+{
+  const __m128i c8 = Load4(c);
+  const __m128i c9 = _mm_add_epi16(c8, _mm_srli_epi16(c8, 7));
+  const __m128i weights = _mm_unpacklo_epi16(_mm_sub_epi16(_mm_set1_epi16(256), c9), c9);
+  return _mm_madd_epi16(_mm_unpacklo_epi16(Load4(a), Load4(b)), weights);
+}
+
+// Lanes of a 24 bit value made of 8 bit components, from low to high
+static inline __m128i Combine4(const s16* low, const s16* mid, const s16* high)
+{
+  const __m128i zero = _mm_setzero_si128();
+  __m128i values = _mm_unpacklo_epi16(Load4(low), zero);
+  if (mid)
+    values = _mm_or_si128(values, _mm_slli_epi32(_mm_unpacklo_epi16(Load4(mid), zero), 8));
+  if (high)
+    values = _mm_or_si128(values, _mm_slli_epi32(_mm_unpacklo_epi16(Load4(high), zero), 16));
+  return values;
+}
+
+// Returns all ones in the lanes where a > b (or a == b), as 16 bit lanes
+static inline __m128i Compare4(__m128i a, __m128i b, bool equal)
+{
+  const __m128i result = equal ? _mm_cmpeq_epi32(a, b) : _mm_cmpgt_epi32(a, b);
+  return _mm_packs_epi32(result, result);
+}
+#endif
+
+static inline void ClampLanes(s16* lanes, bool clamp255, bool vectorized)
+{
+#ifdef _M_X86_64
+  if (vectorized)
+  {
+    const __m128i low = _mm_set1_epi16(clamp255 ? 0 : -1024);
+    const __m128i high = _mm_set1_epi16(clamp255 ? 255 : 1023);
+    Store4(lanes, _mm_max_epi16(_mm_min_epi16(Load4(lanes), high), low));
+    return;
+  }
+#endif
+
+  for (int lane = 0; lane < Tev::NUM_LANES; lane++)
+    lanes[lane] = clamp255 ? Clamp255(lanes[lane]) : Clamp1024(lanes[lane]);
+}
+
+// The d input of the combiners is 11 bits
+static inline s16 SignExtend11(s16 value)
+{
+  return static_cast<s16>(static_cast<u16>(value) << 5) >> 5;
+}
+
+void Tev::SetRasColor(int lane, int stageNum, int colorChan, int swaptable)
+{
+  s16(&RasColor)[4][NUM_LANES] = m_state.RasColor[stageNum];
+
   switch (colorChan)
   {
   case 0:  // Color0
   {
-    const u8* color = Color[0];
-    RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-    RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
+    const u8* color = Color[lane][0];
+    RasColor[RED_C][lane] = color[bpmem.tevksel[swaptable].swap1];
+    RasColor[GRN_C][lane] = color[bpmem.tevksel[swaptable].swap2];
     swaptable++;
-    RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-    RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
+    RasColor[BLU_C][lane] = color[bpmem.tevksel[swaptable].swap1];
+    RasColor[ALP_C][lane] = color[bpmem.tevksel[swaptable].swap2];
   }
   break;
   case 1:  // Color1
   {
-    const u8* color = Color[1];
-    RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-    RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
+    const u8* color = Color[lane][1];
+    RasColor[RED_C][lane] = color[bpmem.tevksel[swaptable].swap1];
+    RasColor[GRN_C][lane] = color[bpmem.tevksel[swaptable].swap2];
     swaptable++;
-    RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-    RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
+    RasColor[BLU_C][lane] = color[bpmem.tevksel[swaptable].swap1];
+    RasColor[ALP_C][lane] = color[bpmem.tevksel[swaptable].swap2];
   }
   break;
   case 5:  // alpha bump
   {
-    for (s16& comp : RasColor)
+    for (auto& comp : RasColor)
     {
-      comp = AlphaBump;
+      comp[lane] = AlphaBump[lane];
     }
   }
   break;
   case 6:  // alpha bump normalized
   {
-    const u8 normalized = AlphaBump | AlphaBump >> 5;
-    for (s16& comp : RasColor)
+    const u8 normalized = AlphaBump[lane] | AlphaBump[lane] >> 5;
+    for (auto& comp : RasColor)
     {
-      comp = normalized;
+      comp[lane] = normalized;
     }
   }
   break;
   default:  // zero
   {
-    for (s16& comp : RasColor)
+    for (auto& comp : RasColor)
     {
-      comp = 0;
+      comp[lane] = 0;
     }
   }
   break;
@@ -223,78 +366,142 @@ void Tev::SetRasColor(int colorChan, int swaptable)
 
 void Tev::DrawColorRegular(const TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4])
 {
+#ifdef _M_X86_64
+  if (m_vectorized)
+  {
+    const __m128i lshift = _mm_cvtsi32_si128(m_ScaleLShiftLUT[cc.shift]);
+    const __m128i rshift = _mm_cvtsi32_si128(m_ScaleRShiftLUT[cc.shift]);
+    const __m128i round = _mm_set1_epi32((cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128);
+    const __m128i bias = _mm_set1_epi32(m_BiasLUT[cc.bias]);
+
+    for (int i = BLU_C; i <= RED_C; i++)
+    {
+      const InputRegType& InputReg = inputs[i];
+
+      __m128i temp = Lerp4(InputReg.a, InputReg.b, InputReg.c);
+      temp = _mm_sll_epi32(temp, lshift);
+      temp = _mm_srai_epi32(_mm_add_epi32(temp, round), 8);
+      if (cc.op)
+        temp = _mm_sub_epi32(_mm_setzero_si128(), temp);
+
+      __m128i result = _mm_sll_epi32(_mm_add_epi32(Load4Wide(InputReg.d), bias), lshift);
+      result = _mm_sra_epi32(_mm_add_epi32(result, temp), rshift);
+
+      Store4Wide(m_state.Reg[cc.dest][i], result);
+    }
+    return;
+  }
+#endif
+
   for (int i = 0; i < 3; i++)
   {
     const InputRegType& InputReg = inputs[BLU_C + i];
 
-    const u16 c = InputReg.c + (InputReg.c >> 7);
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      const u16 c = InputReg.c[lane] + (InputReg.c[lane] >> 7);
 
-    s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
-    temp <<= m_ScaleLShiftLUT[cc.shift];
-    temp += (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
-    temp >>= 8;
-    temp = cc.op ? -temp : temp;
+      s32 temp = InputReg.a[lane] * (256 - c) + (InputReg.b[lane] * c);
+      temp <<= m_ScaleLShiftLUT[cc.shift];
+      temp += (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+      temp >>= 8;
+      temp = cc.op ? -temp : temp;
 
-    s32 result = ((InputReg.d + m_BiasLUT[cc.bias]) << m_ScaleLShiftLUT[cc.shift]) + temp;
-    result = result >> m_ScaleRShiftLUT[cc.shift];
+      s32 result = ((InputReg.d[lane] + m_BiasLUT[cc.bias]) << m_ScaleLShiftLUT[cc.shift]) + temp;
+      result = result >> m_ScaleRShiftLUT[cc.shift];
 
-    Reg[cc.dest][BLU_C + i] = result;
+      m_state.Reg[cc.dest][BLU_C + i][lane] = result;
+    }
   }
 }
 
 void Tev::DrawColorCompare(const TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4])
 {
-  for (int i = BLU_C; i <= RED_C; i++)
+  const u32 mode = (cc.shift << 1) | cc.op | 8;  // encoded compare mode
+
+#ifdef _M_X86_64
+  if (m_vectorized)
   {
-    switch ((cc.shift << 1) | cc.op | 8)  // encoded compare mode
+    const bool equal = (mode & 1) != 0;
+    __m128i mask;
+    switch (mode & ~1)
     {
     case TEVCMP_R8_GT:
-      Reg[cc.dest][i] = inputs[i].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[i].c : 0);
+      mask = Compare4(Combine4(inputs[RED_C].a, nullptr, nullptr),
+                      Combine4(inputs[RED_C].b, nullptr, nullptr), equal);
       break;
-
-    case TEVCMP_R8_EQ:
-      Reg[cc.dest][i] = inputs[i].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[i].c : 0);
-      break;
-
     case TEVCMP_GR16_GT:
-    {
-      const u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-      const u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-      Reg[cc.dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
-    }
-    break;
-
-    case TEVCMP_GR16_EQ:
-    {
-      const u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-      const u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-      Reg[cc.dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
-    }
-    break;
-
+      mask = Compare4(Combine4(inputs[RED_C].a, inputs[GRN_C].a, nullptr),
+                      Combine4(inputs[RED_C].b, inputs[GRN_C].b, nullptr), equal);
+      break;
     case TEVCMP_BGR24_GT:
-    {
-      const u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-      const u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-      Reg[cc.dest][i] = inputs[i].d + ((a > b) ? inputs[i].c : 0);
+      mask = Compare4(Combine4(inputs[RED_C].a, inputs[GRN_C].a, inputs[BLU_C].a),
+                      Combine4(inputs[RED_C].b, inputs[GRN_C].b, inputs[BLU_C].b), equal);
+      break;
+    default:  // TEVCMP_RGB8_GT, compared separately for each component
+      mask = _mm_setzero_si128();
+      break;
     }
-    break;
 
-    case TEVCMP_BGR24_EQ:
+    for (int i = BLU_C; i <= RED_C; i++)
     {
-      const u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-      const u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-      Reg[cc.dest][i] = inputs[i].d + ((a == b) ? inputs[i].c : 0);
+      if (mode >= TEVCMP_RGB8_GT)
+      {
+        mask = Compare4(Combine4(inputs[i].a, nullptr, nullptr),
+                        Combine4(inputs[i].b, nullptr, nullptr), equal);
+      }
+      Store4(m_state.Reg[cc.dest][i],
+             _mm_add_epi16(Load4(inputs[i].d), _mm_and_si128(mask, Load4(inputs[i].c))));
     }
-    break;
+    return;
+  }
+#endif
 
-    case TEVCMP_RGB8_GT:
-      Reg[cc.dest][i] = inputs[i].d + ((inputs[i].a > inputs[i].b) ? inputs[i].c : 0);
+  for (int i = BLU_C; i <= RED_C; i++)
+  {
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      bool result = false;
+      switch (mode)
+      {
+      case TEVCMP_R8_GT:
+        result = inputs[RED_C].a[lane] > inputs[RED_C].b[lane];
+        break;
+
+      case TEVCMP_R8_EQ:
+        result = inputs[RED_C].a[lane] == inputs[RED_C].b[lane];
+        break;
+
+      case TEVCMP_GR16_GT:
+      case TEVCMP_GR16_EQ:
+      {
+        const u32 a = (inputs[GRN_C].a[lane] << 8) | inputs[RED_C].a[lane];
+        const u32 b = (inputs[GRN_C].b[lane] << 8) | inputs[RED_C].b[lane];
+        result = mode == TEVCMP_GR16_GT ? a > b : a == b;
+      }
       break;
 
-    case TEVCMP_RGB8_EQ:
-      Reg[cc.dest][i] = inputs[i].d + ((inputs[i].a == inputs[i].b) ? inputs[i].c : 0);
+      case TEVCMP_BGR24_GT:
+      case TEVCMP_BGR24_EQ:
+      {
+        const u32 a = (inputs[BLU_C].a[lane] << 16) | (inputs[GRN_C].a[lane] << 8) |
+                      inputs[RED_C].a[lane];
+        const u32 b = (inputs[BLU_C].b[lane] << 16) | (inputs[GRN_C].b[lane] << 8) |
+                      inputs[RED_C].b[lane];
+        result = mode == TEVCMP_BGR24_GT ? a > b : a == b;
+      }
       break;
+
+      case TEVCMP_RGB8_GT:
+        result = inputs[i].a[lane] > inputs[i].b[lane];
+        break;
+
+      case TEVCMP_RGB8_EQ:
+        result = inputs[i].a[lane] == inputs[i].b[lane];
+        break;
+      }
+
+      m_state.Reg[cc.dest][i][lane] = inputs[i].d[lane] + (result ? inputs[i].c[lane] : 0);
     }
   }
 }
@@ -303,74 +510,123 @@ void Tev::DrawAlphaRegular(const TevStageCombiner::AlphaCombiner& ac, const Inpu
 {
   const InputRegType& InputReg = inputs[ALP_C];
 
-  const u16 c = InputReg.c + (InputReg.c >> 7);
+#ifdef _M_X86_64
+  if (m_vectorized)
+  {
+    const __m128i lshift = _mm_cvtsi32_si128(m_ScaleLShiftLUT[ac.shift]);
+    const __m128i rshift = _mm_cvtsi32_si128(m_ScaleRShiftLUT[ac.shift]);
 
-  s32 temp = InputReg.a * (256 - c) + (InputReg.b * c);
-  temp <<= m_ScaleLShiftLUT[ac.shift];
-  temp += (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
-  temp = ac.op ? (-temp >> 8) : (temp >> 8);
+    __m128i temp = Lerp4(InputReg.a, InputReg.b, InputReg.c);
+    temp = _mm_sll_epi32(temp, lshift);
+    temp = _mm_add_epi32(temp, _mm_set1_epi32((ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128));
+    if (ac.op)
+      temp = _mm_sub_epi32(_mm_setzero_si128(), temp);
+    temp = _mm_srai_epi32(temp, 8);
 
-  s32 result = ((InputReg.d + m_BiasLUT[ac.bias]) << m_ScaleLShiftLUT[ac.shift]) + temp;
-  result = result >> m_ScaleRShiftLUT[ac.shift];
+    __m128i result = _mm_add_epi32(Load4Wide(InputReg.d), _mm_set1_epi32(m_BiasLUT[ac.bias]));
+    result = _mm_sra_epi32(_mm_add_epi32(_mm_sll_epi32(result, lshift), temp), rshift);
 
-  Reg[ac.dest][ALP_C] = result;
-}
+    Store4Wide(m_state.Reg[ac.dest][ALP_C], result);
+    return;
+  }
+#endif
 
-void Tev::DrawAlphaCompare(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
-{
-  switch ((ac.shift << 1) | ac.op | 8)  // encoded compare mode
+  for (int lane = 0; lane < NUM_LANES; lane++)
   {
-  case TEVCMP_R8_GT:
-    Reg[ac.dest][ALP_C] =
-        inputs[ALP_C].d + ((inputs[RED_C].a > inputs[RED_C].b) ? inputs[ALP_C].c : 0);
-    break;
+    const u16 c = InputReg.c[lane] + (InputReg.c[lane] >> 7);
 
-  case TEVCMP_R8_EQ:
-    Reg[ac.dest][ALP_C] =
-        inputs[ALP_C].d + ((inputs[RED_C].a == inputs[RED_C].b) ? inputs[ALP_C].c : 0);
-    break;
+    s32 temp = InputReg.a[lane] * (256 - c) + (InputReg.b[lane] * c);
+    temp <<= m_ScaleLShiftLUT[ac.shift];
+    temp += (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
+    temp = ac.op ? (-temp >> 8) : (temp >> 8);
 
-  case TEVCMP_GR16_GT:
-  {
-    const u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-    const u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-    Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
-  }
-  break;
+    s32 result = ((InputReg.d[lane] + m_BiasLUT[ac.bias]) << m_ScaleLShiftLUT[ac.shift]) + temp;
+    result = result >> m_ScaleRShiftLUT[ac.shift];
 
-  case TEVCMP_GR16_EQ:
-  {
-    const u32 a = (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-    const u32 b = (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-    Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
+    m_state.Reg[ac.dest][ALP_C][lane] = result;
   }
-  break;
+}
 
-  case TEVCMP_BGR24_GT:
+void Tev::DrawAlphaCompare(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4])
+{
+  const u32 mode = (ac.shift << 1) | ac.op | 8;  // encoded compare mode
+
+#ifdef _M_X86_64
+  if (m_vectorized)
   {
-    const u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-    const u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-    Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a > b) ? inputs[ALP_C].c : 0);
+    const bool equal = (mode & 1) != 0;
+    __m128i a, b;
+    switch (mode & ~1)
+    {
+    case TEVCMP_R8_GT:
+      a = Combine4(inputs[RED_C].a, nullptr, nullptr);
+      b = Combine4(inputs[RED_C].b, nullptr, nullptr);
+      break;
+    case TEVCMP_GR16_GT:
+      a = Combine4(inputs[RED_C].a, inputs[GRN_C].a, nullptr);
+      b = Combine4(inputs[RED_C].b, inputs[GRN_C].b, nullptr);
+      break;
+    case TEVCMP_BGR24_GT:
+      a = Combine4(inputs[RED_C].a, inputs[GRN_C].a, inputs[BLU_C].a);
+      b = Combine4(inputs[RED_C].b, inputs[GRN_C].b, inputs[BLU_C].b);
+      break;
+    default:  // TEVCMP_A8_GT
+      a = Combine4(inputs[ALP_C].a, nullptr, nullptr);
+      b = Combine4(inputs[ALP_C].b, nullptr, nullptr);
+      break;
+    }
+
+    const __m128i mask = Compare4(a, b, equal);
+    Store4(m_state.Reg[ac.dest][ALP_C],
+           _mm_add_epi16(Load4(inputs[ALP_C].d), _mm_and_si128(mask, Load4(inputs[ALP_C].c))));
+    return;
   }
-  break;
+#endif
 
-  case TEVCMP_BGR24_EQ:
+  for (int lane = 0; lane < NUM_LANES; lane++)
   {
-    const u32 a = (inputs[BLU_C].a << 16) | (inputs[GRN_C].a << 8) | inputs[RED_C].a;
-    const u32 b = (inputs[BLU_C].b << 16) | (inputs[GRN_C].b << 8) | inputs[RED_C].b;
-    Reg[ac.dest][ALP_C] = inputs[ALP_C].d + ((a == b) ? inputs[ALP_C].c : 0);
-  }
-  break;
+    bool result = false;
+    switch (mode)
+    {
+    case TEVCMP_R8_GT:
+      result = inputs[RED_C].a[lane] > inputs[RED_C].b[lane];
+      break;
 
-  case TEVCMP_A8_GT:
-    Reg[ac.dest][ALP_C] =
-        inputs[ALP_C].d + ((inputs[ALP_C].a > inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
+    case TEVCMP_R8_EQ:
+      result = inputs[RED_C].a[lane] == inputs[RED_C].b[lane];
+      break;
+
+    case TEVCMP_GR16_GT:
+    case TEVCMP_GR16_EQ:
+    {
+      const u32 a = (inputs[GRN_C].a[lane] << 8) | inputs[RED_C].a[lane];
+      const u32 b = (inputs[GRN_C].b[lane] << 8) | inputs[RED_C].b[lane];
+      result = mode == TEVCMP_GR16_GT ? a > b : a == b;
+    }
     break;
 
-  case TEVCMP_A8_EQ:
-    Reg[ac.dest][ALP_C] =
-        inputs[ALP_C].d + ((inputs[ALP_C].a == inputs[ALP_C].b) ? inputs[ALP_C].c : 0);
+    case TEVCMP_BGR24_GT:
+    case TEVCMP_BGR24_EQ:
+    {
+      const u32 a = (inputs[BLU_C].a[lane] << 16) | (inputs[GRN_C].a[lane] << 8) |
+                    inputs[RED_C].a[lane];
+      const u32 b = (inputs[BLU_C].b[lane] << 16) | (inputs[GRN_C].b[lane] << 8) |
+                    inputs[RED_C].b[lane];
+      result = mode == TEVCMP_BGR24_GT ? a > b : a == b;
+    }
     break;
+
+    case TEVCMP_A8_GT:
+      result = inputs[ALP_C].a[lane] > inputs[ALP_C].b[lane];
+      break;
+
+    case TEVCMP_A8_EQ:
+      result = inputs[ALP_C].a[lane] == inputs[ALP_C].b[lane];
+      break;
+    }
+
+    m_state.Reg[ac.dest][ALP_C][lane] =
+        inputs[ALP_C].d[lane] + (result ? inputs[ALP_C].c[lane] : 0);
   }
 }
 
@@ -442,10 +698,10 @@ static inline s32 WrapIndirectCoord(s32 coord, int wrapMode)
   }
 }
 
-void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
+void Tev::Indirect(int lane, unsigned int stageNum, s32 s, s32 t)
 {
   const TevStageIndirect& indirect = bpmem.tevind[stageNum];
-  const u8* indmap = IndirectTex[indirect.bt];
+  const u8* indmap = IndirectTex[lane][indirect.bt];
 
   s32 indcoord[3];
 
@@ -453,16 +709,16 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
   switch (indirect.bs)
   {
   case ITBA_OFF:
-    AlphaBump = 0;
+    AlphaBump[lane] = 0;
     break;
   case ITBA_S:
-    AlphaBump = indmap[TextureSampler::ALP_SMP];
+    AlphaBump[lane] = indmap[TextureSampler::ALP_SMP];
     break;
   case ITBA_T:
-    AlphaBump = indmap[TextureSampler::BLU_SMP];
+    AlphaBump[lane] = indmap[TextureSampler::BLU_SMP];
     break;
   case ITBA_U:
-    AlphaBump = indmap[TextureSampler::GRN_SMP];
+    AlphaBump[lane] = indmap[TextureSampler::GRN_SMP];
     break;
   }
 
@@ -480,25 +736,25 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
     indcoord[0] = indmap[TextureSampler::ALP_SMP] + bias[0];
     indcoord[1] = indmap[TextureSampler::BLU_SMP] + bias[1];
     indcoord[2] = indmap[TextureSampler::GRN_SMP] + bias[2];
-    AlphaBump = AlphaBump & 0xf8;
+    AlphaBump[lane] = AlphaBump[lane] & 0xf8;
     break;
   case ITF_5:
     indcoord[0] = (indmap[TextureSampler::ALP_SMP] & 0x1f) + bias[0];
     indcoord[1] = (indmap[TextureSampler::BLU_SMP] & 0x1f) + bias[1];
     indcoord[2] = (indmap[TextureSampler::GRN_SMP] & 0x1f) + bias[2];
-    AlphaBump = AlphaBump & 0xe0;
+    AlphaBump[lane] = AlphaBump[lane] & 0xe0;
     break;
   case ITF_4:
     indcoord[0] = (indmap[TextureSampler::ALP_SMP] & 0x0f) + bias[0];
     indcoord[1] = (indmap[TextureSampler::BLU_SMP] & 0x0f) + bias[1];
     indcoord[2] = (indmap[TextureSampler::GRN_SMP] & 0x0f) + bias[2];
-    AlphaBump = AlphaBump & 0xf0;
+    AlphaBump[lane] = AlphaBump[lane] & 0xf0;
     break;
   case ITF_3:
     indcoord[0] = (indmap[TextureSampler::ALP_SMP] & 0x07) + bias[0];
     indcoord[1] = (indmap[TextureSampler::BLU_SMP] & 0x07) + bias[1];
     indcoord[2] = (indmap[TextureSampler::GRN_SMP] & 0x07) + bias[2];
-    AlphaBump = AlphaBump & 0xf8;
+    AlphaBump[lane] = AlphaBump[lane] & 0xf8;
     break;
   default:
     PanicAlert("Tev::Indirect");
@@ -552,30 +808,54 @@ void Tev::Indirect(unsigned int stageNum, s32 s, s32 t)
 
   if (indirect.fb_addprev)
   {
-    TexCoord.s += (int)(WrapIndirectCoord(s, indirect.sw) + indtevtrans[0]);
-    TexCoord.t += (int)(WrapIndirectCoord(t, indirect.tw) + indtevtrans[1]);
+    TexCoord[lane].s += (int)(WrapIndirectCoord(s, indirect.sw) + indtevtrans[0]);
+    TexCoord[lane].t += (int)(WrapIndirectCoord(t, indirect.tw) + indtevtrans[1]);
   }
   else
   {
-    TexCoord.s = (int)(WrapIndirectCoord(s, indirect.sw) + indtevtrans[0]);
-    TexCoord.t = (int)(WrapIndirectCoord(t, indirect.tw) + indtevtrans[1]);
+    TexCoord[lane].s = (int)(WrapIndirectCoord(s, indirect.sw) + indtevtrans[0]);
+    TexCoord[lane].t = (int)(WrapIndirectCoord(t, indirect.tw) + indtevtrans[1]);
   }
 }
 
-void Tev::Draw()
+void Tev::Draw(u32 lane_mask)
 {
-  ASSERT(Position[0] >= 0 && Position[0] < EFB_WIDTH);
-  ASSERT(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
+#if ALLOW_TEV_DUMPS
+  // The dumps are collected in a buffer which only holds a single pixel.
+  if ((g_ActiveConfig.bDumpTevStages || g_ActiveConfig.bDumpTevTextureFetches) &&
+      (lane_mask & (lane_mask - 1)) != 0)
+  {
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      if (lane_mask & (1 << lane))
+        Draw(1 << lane);
+    }
+    return;
+  }
+#endif
+
+  for (int lane = 0; lane < NUM_LANES; lane++)
+  {
+    if (!(lane_mask & (1 << lane)))
+      continue;
 
-  INCSTAT(stats.thisFrame.tevPixelsIn);
+    ASSERT(Position[lane][0] >= 0 && Position[lane][0] < EFB_WIDTH);
+    ASSERT(Position[lane][1] >= 0 && Position[lane][1] < EFB_HEIGHT);
+
+    PixelsIn++;
+  }
 
   // initial color values
   for (int i = 0; i < 4; i++)
   {
-    Reg[i][RED_C] = PixelShaderManager::constants.colors[i][0];
-    Reg[i][GRN_C] = PixelShaderManager::constants.colors[i][1];
-    Reg[i][BLU_C] = PixelShaderManager::constants.colors[i][2];
-    Reg[i][ALP_C] = PixelShaderManager::constants.colors[i][3];
+    std::fill(std::begin(m_state.Reg[i][RED_C]), std::end(m_state.Reg[i][RED_C]),
+              PixelShaderManager::constants.colors[i][0]);
+    std::fill(std::begin(m_state.Reg[i][GRN_C]), std::end(m_state.Reg[i][GRN_C]),
+              PixelShaderManager::constants.colors[i][1]);
+    std::fill(std::begin(m_state.Reg[i][BLU_C]), std::end(m_state.Reg[i][BLU_C]),
+              PixelShaderManager::constants.colors[i][2]);
+    std::fill(std::begin(m_state.Reg[i][ALP_C]), std::end(m_state.Reg[i][ALP_C]),
+              PixelShaderManager::constants.colors[i][3]);
   }
 
   for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
@@ -590,19 +870,35 @@ void Tev::Draw()
     const s32 scaleS = stageOdd ? texscale.ss1 : texscale.ss0;
     const s32 scaleT = stageOdd ? texscale.ts1 : texscale.ts0;
 
-    TextureSampler::Sample(Uv[texcoordSel].s >> scaleS, Uv[texcoordSel].t >> scaleT,
-                           IndirectLod[stageNum], IndirectLinear[stageNum], texmap,
-                           IndirectTex[stageNum]);
-
-#if ALLOW_TEV_DUMPS
-    if (g_ActiveConfig.bDumpTevStages)
+    s32 s[NUM_LANES];
+    s32 t[NUM_LANES];
+    for (int lane = 0; lane < NUM_LANES; lane++)
     {
-      u8 stage[4] = {IndirectTex[stageNum][TextureSampler::ALP_SMP],
-                     IndirectTex[stageNum][TextureSampler::BLU_SMP],
-                     IndirectTex[stageNum][TextureSampler::GRN_SMP], 255};
-      DebugUtil::DrawTempBuffer(stage, INDIRECT + stageNum);
+      s[lane] = Uv[lane][texcoordSel].s >> scaleS;
+      t[lane] = Uv[lane][texcoordSel].t >> scaleT;
     }
+
+    u8 samples[NUM_LANES][4];
+    m_texels.Sample(s, t, IndirectLod[stageNum], IndirectLinear[stageNum], texmap, lane_mask,
+                    samples);
+
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      if (!(lane_mask & (1 << lane)))
+        continue;
+
+      std::copy(std::begin(samples[lane]), std::end(samples[lane]), IndirectTex[lane][stageNum]);
+
+#if ALLOW_TEV_DUMPS
+      if (g_ActiveConfig.bDumpTevStages)
+      {
+        u8 stage[4] = {IndirectTex[lane][stageNum][TextureSampler::ALP_SMP],
+                       IndirectTex[lane][stageNum][TextureSampler::BLU_SMP],
+                       IndirectTex[lane][stageNum][TextureSampler::GRN_SMP], 255};
+        DebugUtil::DrawTempBuffer(stage, INDIRECT + stageNum);
+      }
 #endif
+    }
   }
 
   for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
@@ -610,112 +906,156 @@ void Tev::Draw()
     const int stageNum2 = stageNum >> 1;
     const int stageOdd = stageNum & 1;
     const TwoTevStageOrders& order = bpmem.tevorders[stageNum2];
-    const TevKSel& kSel = bpmem.tevksel[stageNum2];
-
-    // stage combiners
-    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
     const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
 
     const int texcoordSel = order.getTexCoord(stageOdd);
     const int texmap = order.getTexMap(stageOdd);
 
-    Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      if (lane_mask & (1 << lane))
+        Indirect(lane, stageNum, Uv[lane][texcoordSel].s, Uv[lane][texcoordSel].t);
+    }
 
     // sample texture
     if (order.getEnable(stageOdd))
     {
+      s32 s[NUM_LANES];
+      s32 t[NUM_LANES];
+      for (int lane = 0; lane < NUM_LANES; lane++)
+      {
+        s[lane] = TexCoord[lane].s;
+        t[lane] = TexCoord[lane].t;
+      }
+
       // RGBA
-      u8 texel[4];
+      u8 texels[NUM_LANES][4];
+      m_texels.Sample(s, t, TextureLod[stageNum], TextureLinear[stageNum], texmap, lane_mask,
+                      texels);
 
-      TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum],
-                             texmap, texel);
+      for (int lane = 0; lane < NUM_LANES; lane++)
+      {
+        if (!(lane_mask & (1 << lane)))
+          continue;
+
+        const u8* texel = texels[lane];
 
 #if ALLOW_TEV_DUMPS
-      if (g_ActiveConfig.bDumpTevTextureFetches)
-        DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
+        if (g_ActiveConfig.bDumpTevTextureFetches)
+          DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
 #endif
 
-      int swaptable = ac.tswap * 2;
+        int swaptable = ac.tswap * 2;
 
-      TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-      TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-      swaptable++;
-      TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-      TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+        TexColor[RED_C][lane] = texel[bpmem.tevksel[swaptable].swap1];
+        TexColor[GRN_C][lane] = texel[bpmem.tevksel[swaptable].swap2];
+        swaptable++;
+        TexColor[BLU_C][lane] = texel[bpmem.tevksel[swaptable].swap1];
+        TexColor[ALP_C][lane] = texel[bpmem.tevksel[swaptable].swap2];
+      }
     }
 
-    // set konst for this stage
-    const int kc = kSel.getKC(stageOdd);
-    const int ka = kSel.getKA(stageOdd);
-    StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-    StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-    StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-    StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      if (!(lane_mask & (1 << lane)))
+        continue;
+
+      // the texture color stays the same for stages without a texture
+      for (int i = 0; i < 4; i++)
+        m_state.TexColor[stageNum][i][lane] = TexColor[i][lane];
+
+      // set color
+      SetRasColor(lane, stageNum, order.getColorChan(stageOdd), ac.rswap * 2);
+    }
+  }
+
+  lane_mask &= m_program ? m_program(&m_state) : DrawCombiners(lane_mask);
 
-    // set color
-    SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+  for (int lane = 0; lane < NUM_LANES; lane++)
+  {
+    if (lane_mask & (1 << lane))
+      DrawPixel(lane);
+  }
+}
+
+// Returns the mask of the lanes which pass the alpha test
+u32 Tev::DrawCombiners(u32 lane_mask)
+{
+  for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+  {
+    // stage combiners
+    const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+    const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
 
     // combine inputs
     InputRegType inputs[4];
-    for (int i = 0; i < 3; i++)
+    for (int i = 0; i < 4; i++)
     {
-      inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-      inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-      inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-      inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+      const s16* const* input = m_StageInputs[stageNum][i];
+      for (int lane = 0; lane < NUM_LANES; lane++)
+      {
+        inputs[i].a[lane] = input[0][lane] & 0xff;
+        inputs[i].b[lane] = input[1][lane] & 0xff;
+        inputs[i].c[lane] = input[2][lane] & 0xff;
+        inputs[i].d[lane] = SignExtend11(input[3][lane]);
+      }
     }
-    inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-    inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-    inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-    inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
 
     if (cc.bias != 3)
       DrawColorRegular(cc, inputs);
     else
       DrawColorCompare(cc, inputs);
 
-    if (cc.clamp)
-    {
-      Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
-    }
-    else
-    {
-      Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
-    }
+    ClampLanes(m_state.Reg[cc.dest][RED_C], cc.clamp, m_vectorized);
+    ClampLanes(m_state.Reg[cc.dest][GRN_C], cc.clamp, m_vectorized);
+    ClampLanes(m_state.Reg[cc.dest][BLU_C], cc.clamp, m_vectorized);
 
     if (ac.bias != 3)
       DrawAlphaRegular(ac, inputs);
     else
       DrawAlphaCompare(ac, inputs);
 
-    if (ac.clamp)
-      Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-    else
-      Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+    ClampLanes(m_state.Reg[ac.dest][ALP_C], ac.clamp, m_vectorized);
 
 #if ALLOW_TEV_DUMPS
     if (g_ActiveConfig.bDumpTevStages)
     {
-      u8 stage[4] = {(u8)Reg[0][RED_C], (u8)Reg[0][GRN_C], (u8)Reg[0][BLU_C], (u8)Reg[0][ALP_C]};
-      DebugUtil::DrawTempBuffer(stage, DIRECT + stageNum);
+      for (int lane = 0; lane < NUM_LANES; lane++)
+      {
+        if (!(lane_mask & (1 << lane)))
+          continue;
+
+        u8 stage[4] = {(u8)m_state.Reg[0][RED_C][lane], (u8)m_state.Reg[0][GRN_C][lane],
+                       (u8)m_state.Reg[0][BLU_C][lane], (u8)m_state.Reg[0][ALP_C][lane]};
+        DebugUtil::DrawTempBuffer(stage, DIRECT + stageNum);
+      }
     }
 #endif
   }
 
+  // the results of the last tev stage are put onto the screen,
+  // regardless of the used destination register - TODO: Verify!
+  const u32 alpha_index = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
+  u32 alpha_mask = 0;
+  for (int lane = 0; lane < NUM_LANES; lane++)
+  {
+    if (TevAlphaTest((u8)m_state.Reg[alpha_index][ALP_C][lane]))
+      alpha_mask |= 1 << lane;
+  }
+  return alpha_mask;
+}
+
+void Tev::DrawPixel(int lane)
+{
   // convert to 8 bits per component
   // the results of the last tev stage are put onto the screen,
   // regardless of the used destination register - TODO: Verify!
   const u32 color_index = bpmem.combiners[bpmem.genMode.numtevstages].colorC.dest;
   const u32 alpha_index = bpmem.combiners[bpmem.genMode.numtevstages].alphaC.dest;
-  u8 output[4] = {(u8)Reg[alpha_index][ALP_C], (u8)Reg[color_index][BLU_C],
-                  (u8)Reg[color_index][GRN_C], (u8)Reg[color_index][RED_C]};
-
-  if (!TevAlphaTest(output[ALP_C]))
-    return;
+  u8 output[4] = {(u8)m_state.Reg[alpha_index][ALP_C][lane],
+                  (u8)m_state.Reg[color_index][BLU_C][lane],
+                  (u8)m_state.Reg[color_index][GRN_C][lane],
+                  (u8)m_state.Reg[color_index][RED_C][lane]};
 
   // z texture
   if (bpmem.ztex2.op)
@@ -724,20 +1064,20 @@ void Tev::Draw()
     switch (bpmem.ztex2.type)
     {
     case 0:  // 8 bit
-      ztex += TexColor[ALP_C];
+      ztex += TexColor[ALP_C][lane];
       break;
     case 1:  // 16 bit
-      ztex += TexColor[ALP_C] << 8 | TexColor[RED_C];
+      ztex += TexColor[ALP_C][lane] << 8 | TexColor[RED_C][lane];
       break;
     case 2:  // 24 bit
-      ztex += TexColor[RED_C] << 16 | TexColor[GRN_C] << 8 | TexColor[BLU_C];
+      ztex += TexColor[RED_C][lane] << 16 | TexColor[GRN_C][lane] << 8 | TexColor[BLU_C][lane];
       break;
     }
 
     if (bpmem.ztex2.op == ZTEXTURE_ADD)
-      ztex += Position[2];
+      ztex += Position[lane][2];
 
-    Position[2] = ztex & 0x00ffffff;
+    Position[lane][2] = ztex & 0x00ffffff;
   }
 
   // fog
@@ -749,7 +1089,7 @@ void Tev::Draw()
     {
       // perspective
       // ze = A/(B - (Zs >> B_SHF))
-      const s32 denom = bpmem.fog.b_magnitude - (Position[2] >> bpmem.fog.b_shift);
+      const s32 denom = bpmem.fog.b_magnitude - (Position[lane][2] >> bpmem.fog.b_shift);
       // in addition downscale magnitude and zs to 0.24 bits
       ze = (bpmem.fog.GetA() * 16777215.0f) / static_cast<float>(denom);
     }
@@ -758,7 +1098,7 @@ void Tev::Draw()
       // orthographic
       // ze = a*Zs
       // in addition downscale zs to 0.24 bits
-      ze = bpmem.fog.GetA() * (static_cast<float>(Position[2]) / 16777215.0f);
+      ze = bpmem.fog.GetA() * (static_cast<float>(Position[lane][2]) / 16777215.0f);
     }
 
     if (bpmem.fogRange.Base.Enabled)
@@ -770,7 +1110,7 @@ void Tev::Draw()
 
       // First, calculate the offset from the viewport center (normalized to 0..1)
       const float offset =
-          (Position[0] - (static_cast<s32>(bpmem.fogRange.Base.Center.Value()) - 342)) /
+          (Position[lane][0] - (static_cast<s32>(bpmem.fogRange.Base.Center.Value()) - 342)) /
           static_cast<float>(xfmem.viewport.wd);
 
       // Based on that, choose the index such that points which are far away from the z-axis use the
@@ -832,31 +1172,27 @@ void Tev::Draw()
   if (late_ztest && bpmem.zmode.testenable)
   {
     // TODO: Check against hw if these values get incremented even if depth testing is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+    PerfCounters[PQ_ZCOMP_INPUT]++;
 
-    if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
+    if (!EfbInterface::ZCompare(Position[lane][0], Position[lane][1], Position[lane][2]))
       return;
 
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+    PerfCounters[PQ_ZCOMP_OUTPUT]++;
   }
 
   // branchless bounding box update
-  BoundingBox::coords[BoundingBox::LEFT] =
-      std::min((u16)Position[0], BoundingBox::coords[BoundingBox::LEFT]);
-  BoundingBox::coords[BoundingBox::RIGHT] =
-      std::max((u16)Position[0], BoundingBox::coords[BoundingBox::RIGHT]);
-  BoundingBox::coords[BoundingBox::TOP] =
-      std::min((u16)Position[1], BoundingBox::coords[BoundingBox::TOP]);
-  BoundingBox::coords[BoundingBox::BOTTOM] =
-      std::max((u16)Position[1], BoundingBox::coords[BoundingBox::BOTTOM]);
+  BBox[BoundingBox::LEFT] = std::min((u16)Position[lane][0], BBox[BoundingBox::LEFT]);
+  BBox[BoundingBox::RIGHT] = std::max((u16)Position[lane][0], BBox[BoundingBox::RIGHT]);
+  BBox[BoundingBox::TOP] = std::min((u16)Position[lane][1], BBox[BoundingBox::TOP]);
+  BBox[BoundingBox::BOTTOM] = std::max((u16)Position[lane][1], BBox[BoundingBox::BOTTOM]);
 
 #if ALLOW_TEV_DUMPS
   if (g_ActiveConfig.bDumpTevStages)
   {
     for (u32 i = 0; i < bpmem.genMode.numindstages; ++i)
-      DebugUtil::CopyTempBuffer(Position[0], Position[1], INDIRECT, i, "Indirect");
+      DebugUtil::CopyTempBuffer(Position[lane][0], Position[lane][1], INDIRECT, i, "Indirect");
     for (u32 i = 0; i <= bpmem.genMode.numtevstages; ++i)
-      DebugUtil::CopyTempBuffer(Position[0], Position[1], DIRECT, i, "Stage");
+      DebugUtil::CopyTempBuffer(Position[lane][0], Position[lane][1], DIRECT, i, "Stage");
   }
 
   if (g_ActiveConfig.bDumpTevTextureFetches)
@@ -865,15 +1201,24 @@ void Tev::Draw()
     {
       TwoTevStageOrders& order = bpmem.tevorders[i >> 1];
       if (order.getEnable(i & 1))
-        DebugUtil::CopyTempBuffer(Position[0], Position[1], DIRECT_TFETCH, i, "TFetch");
+        DebugUtil::CopyTempBuffer(Position[lane][0], Position[lane][1], DIRECT_TFETCH, i, "TFetch");
     }
   }
 #endif
 
-  INCSTAT(stats.thisFrame.tevPixelsOut);
-  EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+  PixelsOut++;
+  PerfCounters[PQ_BLEND_INPUT]++;
 
-  EfbInterface::BlendTev(Position[0], Position[1], output);
+  EfbInterface::BlendTev(Position[lane][0], Position[lane][1], output);
+}
+
+void Tev::ResetCounters()
+{
+  PixelsIn = 0;
+  PixelsOut = 0;
+  std::fill(std::begin(PerfCounters), std::end(PerfCounters), 0);
+  BBox[BoundingBox::LEFT] = BBox[BoundingBox::TOP] = 0xffff;
+  BBox[BoundingBox::RIGHT] = BBox[BoundingBox::BOTTOM] = 0;
 }
 
 void Tev::SetRegColor(int reg, int comp, s16 color)
@@ -4,16 +4,51 @@
 
 #pragma once
 
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/TextureSampler.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class Tev
 {
+public:
+  // The pixels of a 2x2 block are drawn at once, and the stage combiners are evaluated for all of
+  // them together. Lane i is pixel (i & 1, i >> 1) of the block.
+  static constexpr int NUM_LANES = 4;
+  static constexpr int NUM_STAGES = 16;
+
+  // Everything the stage combiners read and write, for all lanes
+  struct CombinerState
+  {
+    // color order: ABGR, the values of the lanes next to each other
+    s16 Reg[4][4][NUM_LANES];
+    s16 TexColor[NUM_STAGES][4][NUM_LANES];
+    s16 RasColor[NUM_STAGES][4][NUM_LANES];
+    s16 Konst[NUM_STAGES][4][NUM_LANES];
+    s16 One[NUM_LANES];
+    s16 Half[NUM_LANES];
+    s16 Zero[NUM_LANES];
+  };
+
+  // Combiners compiled for a TEV configuration. Returns the mask of the lanes which pass the alpha
+  // test.
+  using CombinerProgram = u32 (*)(CombinerState* state);
+
+  // The lanes of the input of a stage
+  static const s16* GetColorInput(const CombinerState& state, int stage, u32 sel, int comp);
+  static const s16* GetAlphaInput(const CombinerState& state, int stage, u32 sel);
+
+  // Frees the compiled combiners of all Tevs
+  static void ClearPrograms();
+
+private:
+  // The inputs of a combiner for all lanes, a/b/c masked to 8 bits and d sign extended from 11 bits
   struct InputRegType
   {
-    unsigned a : 8;
-    unsigned b : 8;
-    unsigned c : 8;
-    signed d : 11;
+    s16 a[NUM_LANES];
+    s16 b[NUM_LANES];
+    s16 c[NUM_LANES];
+    s16 d[NUM_LANES];
   };
 
   struct TextureCoordinateType
@@ -22,33 +57,28 @@ class Tev
     signed t : 24;
   };
 
-  // color order: ABGR
-  s16 Reg[4][4];
+  CombinerState m_state;
   s16 KonstantColors[4][4];
-  s16 TexColor[4];
-  s16 RasColor[4];
-  s16 StageKonst[4];
-  s16 Zero16[4];
+  s16 TexColor[4][NUM_LANES];
 
   s16 FixedConstants[9];
-  u8 AlphaBump;
-  u8 IndirectTex[4][4];
-  TextureCoordinateType TexCoord;
+  u8 AlphaBump[NUM_LANES];
+  u8 IndirectTex[NUM_LANES][4][4];
+  TextureCoordinateType TexCoord[NUM_LANES];
 
-  s16* m_ColorInputLUT[16][3];
-  s16* m_AlphaInputLUT[8];  // values must point to ABGR color
-  s16* m_KonstLUT[32][4];
+  const s16* m_KonstLUT[32][4];
   s16 m_BiasLUT[4];
   u8 m_ScaleLShiftLUT[4];
   u8 m_ScaleRShiftLUT[4];
 
-  // enumeration for color input LUT
-  enum
-  {
-    BLU_INP,
-    GRN_INP,
-    RED_INP
-  };
+  // The inputs of the components of each stage, set up by PrepareDraw()
+  const s16* m_StageInputs[NUM_STAGES][4][4];
+
+  TextureSampler::TexelCache m_texels;
+
+  bool m_vectorized;
+  bool m_jit;
+  CombinerProgram m_program;
 
   enum BufferBase
   {
@@ -57,24 +87,33 @@ class Tev
     INDIRECT = 32
   };
 
-  void SetRasColor(int colorChan, int swaptable);
+  void SetRasColor(int lane, int stageNum, int colorChan, int swaptable);
 
   void DrawColorRegular(const TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
   void DrawColorCompare(const TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
   void DrawAlphaRegular(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
   void DrawAlphaCompare(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
 
-  void Indirect(unsigned int stageNum, s32 s, s32 t);
+  void Indirect(int lane, unsigned int stageNum, s32 s, s32 t);
+  u32 DrawCombiners(u32 lane_mask);
+  void DrawPixel(int lane);
 
 public:
-  s32 Position[3];
-  u8 Color[2][4];  // must be RGBA for correct swap table ordering
-  TextureCoordinateType Uv[8];
+  s32 Position[NUM_LANES][3];
+  u8 Color[NUM_LANES][2][4];  // must be RGBA for correct swap table ordering
+  TextureCoordinateType Uv[NUM_LANES][8];
   s32 IndirectLod[4];
   bool IndirectLinear[4];
   s32 TextureLod[16];
   bool TextureLinear[16];
 
+  // Several threads may draw with their own Tev at once, so the statistics, perf query counters
+  // and bounding box are collected here, and added to the global ones by the rasterizer.
+  u32 PixelsIn;
+  u32 PixelsOut;
+  u32 PerfCounters[PQ_NUM_MEMBERS];
+  u16 BBox[4];
+
   enum
   {
     ALP_C,
@@ -83,9 +122,16 @@ public:
     RED_C
   };
 
-  void Init();
+  // On x86-64, the combiners are compiled for each TEV configuration unless jit is false, and
+  // otherwise use SSE2 unless vectorized is false.
+  void Init(bool vectorized = true, bool jit = true);
 
-  void Draw();
+  // Picks up the TEV configuration, the konst colors and the textures. Has to be called before
+  // drawing whenever they changed.
+  void PrepareDraw();
+  // Draws the lanes which are set in lane_mask.
+  void Draw(u32 lane_mask);
+  void ResetCounters();
 
   void SetRegColor(int reg, int comp, s16 color);
 };
@@ -0,0 +1,379 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Software/TevX64.h"
+
+#include "Common/CommonTypes.h"
+#include "Common/JitRegister.h"
+#include "Common/x64ABI.h"
+#include "Common/x64Emitter.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+
+using namespace Gen;
+
+// Points to the Tev::CombinerState. The program only uses caller-saved registers, XMM0-XMM5
+// included, so it doesn't need to save anything.
+static const X64Reg state_reg = ABI_PARAM1;
+static const X64Reg scratch = RAX;
+
+// The rswap and tswap fields of the alpha combiner only select the inputs.
+static constexpr u32 ALPHA_COMBINER_MASK = ~0xFu;
+
+TevX64::TevX64(const Key& key)
+{
+  const u32 num_stages = key[0] + 1;
+
+  AllocCodeSpace(2048 * (num_stages + 1));
+  ClearCodeSpace();
+
+  const u8* start = GetCodePtr();
+  m_program = reinterpret_cast<Tev::CombinerProgram>(const_cast<u8*>(start));
+
+  for (u32 stage = 0; stage < num_stages; stage++)
+  {
+    TevStageCombiner::ColorCombiner cc;
+    TevStageCombiner::AlphaCombiner ac;
+    cc.hex = key[2 + 2 * stage];
+    ac.hex = key[3 + 2 * stage];
+    EmitStage(stage, cc, ac);
+  }
+
+  // The alpha of the last stage is tested.
+  TevStageCombiner::AlphaCombiner last_ac;
+  last_ac.hex = key[1 + 2 * num_stages];
+  AlphaTest alpha_test;
+  alpha_test.hex = key[1];
+  EmitAlphaTest(last_ac.dest, alpha_test);
+
+  WriteProtect();
+
+  JitRegister::Register(start, GetCodePtr(), "TevX64_%u_stages", num_stages);
+}
+
+TevX64::Key TevX64::GetCurrentKey()
+{
+  Key key{};
+  key[0] = bpmem.genMode.numtevstages;
+  key[1] = bpmem.alpha_test.hex;
+  for (u32 stage = 0; stage <= bpmem.genMode.numtevstages; stage++)
+  {
+    key[2 + 2 * stage] = bpmem.combiners[stage].colorC.hex;
+    key[3 + 2 * stage] = bpmem.combiners[stage].alphaC.hex & ALPHA_COMBINER_MASK;
+  }
+  return key;
+}
+
+OpArg TevX64::Lanes(const s16* lanes) const
+{
+  return MDisp(state_reg, static_cast<int>(PtrOffset(lanes, &m_layout)));
+}
+
+void TevX64::LoadConstant16(X64Reg reg, s16 value)
+{
+  MOV(32, R(scratch), Imm32(static_cast<u16>(value) * 0x10001u));
+  MOVD_xmm(reg, R(scratch));
+  PSHUFD(reg, R(reg), 0);
+}
+
+void TevX64::LoadConstant32(X64Reg reg, s32 value)
+{
+  MOV(32, R(scratch), Imm32(static_cast<u32>(value)));
+  MOVD_xmm(reg, R(scratch));
+  PSHUFD(reg, R(reg), 0);
+}
+
+// Loads the lanes of an input, with a/b/c masked to 8 bits and d sign extended from 11 bits
+void TevX64::LoadInput(X64Reg reg, const s16* lanes, bool sign_extend)
+{
+  MOVQ_xmm(reg, Lanes(lanes));
+
+  // Everything but the registers and the konst colors is 8 bits already.
+  const s16* reg_start = &m_layout.Reg[0][0][0];
+  const s16* reg_end = reg_start + sizeof(m_layout.Reg) / sizeof(s16);
+  const s16* konst_start = &m_layout.Konst[0][0][0];
+  const s16* konst_end = konst_start + sizeof(m_layout.Konst) / sizeof(s16);
+  if ((lanes < reg_start || lanes >= reg_end) && (lanes < konst_start || lanes >= konst_end))
+    return;
+
+  if (sign_extend)
+  {
+    PSLLW(reg, 5);
+    PSRAW(reg, 5);
+  }
+  else
+  {
+    PSLLW(reg, 8);
+    PSRLW(reg, 8);
+  }
+}
+
+// Loads the lanes of a value made of up to three 8 bit components, from low to high, as 32 bits.
+// XMM3 has to be zero.
+void TevX64::LoadCompareInput(X64Reg reg, const s16* const components[3], int count)
+{
+  LoadInput(reg, components[0], false);
+  PUNPCKLWD(reg, R(XMM3));
+  for (int i = 1; i < count; i++)
+  {
+    LoadInput(XMM2, components[i], false);
+    PUNPCKLWD(XMM2, R(XMM3));
+    PSLLD(XMM2, 8 * i);
+    POR(reg, R(XMM2));
+  }
+}
+
+void TevX64::Not(X64Reg reg)
+{
+  PCMPEQW(XMM3, R(XMM3));
+  PXOR(reg, R(XMM3));
+}
+
+void TevX64::Clamp(X64Reg reg, bool clamp255)
+{
+  LoadConstant16(XMM1, clamp255 ? 255 : 1023);
+  PMINSW(reg, R(XMM1));
+  LoadConstant16(XMM1, clamp255 ? 0 : -1024);
+  PMAXSW(reg, R(XMM1));
+}
+
+// Leaves all ones in the 16 bit lanes of XMM0 where a > b (or a == b), comparing the red, green
+// and blue components as selected by the compare mode
+void TevX64::CompareMask(u32 mode, const s16* const a[3], const s16* const b[3])
+{
+  const bool equal = (mode & 1) != 0;
+  const int count = (mode & ~1u) == TEVCMP_BGR24_GT ? 3 : (mode & ~1u) == TEVCMP_GR16_GT ? 2 : 1;
+  if (count == 1)
+  {
+    // 8 bit values can be compared as 16 bits.
+    LoadInput(XMM0, a[0], false);
+    LoadInput(XMM1, b[0], false);
+    if (equal)
+      PCMPEQW(XMM0, R(XMM1));
+    else
+      PCMPGTW(XMM0, R(XMM1));
+    return;
+  }
+
+  PXOR(XMM3, R(XMM3));
+  LoadCompareInput(XMM0, a, count);
+  LoadCompareInput(XMM1, b, count);
+  if (equal)
+    PCMPEQD(XMM0, R(XMM1));
+  else
+    PCMPGTD(XMM0, R(XMM1));
+  PACKSSDW(XMM0, R(XMM0));
+}
+
+// Leaves the result of a regular combiner in XMM0
+void TevX64::CombineRegular(const s16* a, const s16* b, const s16* c, const s16* d, u32 bias,
+                            u32 op, u32 shift, bool alpha)
+{
+  static const s32 bias_lut[4] = {0, 128, -128, 0};
+  const int lshift = shift == 3 ? 0 : shift;
+  const int rshift = shift == 3 ? 1 : 0;
+
+  // a * (256 - c) + b * c, with c scaled from 0-255 to 0-256
+  LoadInput(XMM0, c, false);
+  MOVDQA(XMM1, R(XMM0));
+  PSRLW(XMM1, 7);
+  PADDW(XMM0, R(XMM1));
+  LoadConstant16(XMM1, 256);
+  PSUBW(XMM1, R(XMM0));
+  PUNPCKLWD(XMM1, R(XMM0));
+  LoadInput(XMM0, a, false);
+  LoadInput(XMM2, b, false);
+  PUNPCKLWD(XMM0, R(XMM2));
+  PMADDWD(XMM0, R(XMM1));
+  if (lshift)
+    PSLLD(XMM0, lshift);
+
+  // The color and alpha combiners round differently.
+  const bool round = alpha ? shift == 3 : shift != 3;
+  if (round)
+  {
+    LoadConstant32(XMM1, op == 1 ? 127 : 128);
+    PADDD(XMM0, R(XMM1));
+  }
+  if (!alpha)
+    PSRAD(XMM0, 8);
+  if (op)
+  {
+    PXOR(XMM1, R(XMM1));
+    PSUBD(XMM1, R(XMM0));
+    MOVDQA(XMM0, R(XMM1));
+  }
+  if (alpha)
+    PSRAD(XMM0, 8);
+
+  LoadInput(XMM1, d, true);
+  PUNPCKLWD(XMM1, R(XMM1));
+  PSRAD(XMM1, 16);
+  if (bias_lut[bias])
+  {
+    LoadConstant32(XMM2, bias_lut[bias]);
+    PADDD(XMM1, R(XMM2));
+  }
+  if (lshift)
+    PSLLD(XMM1, lshift);
+  PADDD(XMM0, R(XMM1));
+  if (rshift)
+    PSRAD(XMM0, rshift);
+
+  // The results always fit in 16 bits, so saturating them is the same as truncating them.
+  PACKSSDW(XMM0, R(XMM0));
+}
+
+// Leaves d + (c masked by XMM0) in XMM0
+void TevX64::CombineCompare(const s16* c, const s16* d)
+{
+  LoadInput(XMM1, c, false);
+  PAND(XMM0, R(XMM1));
+  LoadInput(XMM1, d, true);
+  PADDW(XMM0, R(XMM1));
+}
+
+void TevX64::EmitStage(int stage, TevStageCombiner::ColorCombiner cc,
+                       TevStageCombiner::AlphaCombiner ac)
+{
+  // Inputs of the red, green and blue components
+  const s16* a[3];
+  const s16* b[3];
+  const s16* c[3];
+  const s16* d[3];
+  for (int i = 0; i < 3; i++)
+  {
+    const int comp = Tev::RED_C - i;
+    a[i] = Tev::GetColorInput(m_layout, stage, cc.a, comp);
+    b[i] = Tev::GetColorInput(m_layout, stage, cc.b, comp);
+    c[i] = Tev::GetColorInput(m_layout, stage, cc.c, comp);
+    d[i] = Tev::GetColorInput(m_layout, stage, cc.d, comp);
+  }
+
+  // All inputs are read before any results are stored, so the color results are kept in XMM4
+  // (blue and green) and XMM5 (red).
+  const u32 color_mode = (cc.shift << 1) | cc.op | 8;
+  if (cc.bias == 3 && color_mode < TEVCMP_RGB8_GT)
+  {
+    CompareMask(color_mode, a, b);
+    MOVDQA(XMM5, R(XMM0));
+  }
+  for (int i = 2; i >= 0; i--)
+  {
+    if (cc.bias != 3)
+    {
+      CombineRegular(a[i], b[i], c[i], d[i], cc.bias, cc.op, cc.shift, false);
+    }
+    else
+    {
+      if (color_mode >= TEVCMP_RGB8_GT)
+        CompareMask(color_mode, &a[i], &b[i]);
+      else
+        MOVDQA(XMM0, R(XMM5));
+      CombineCompare(c[i], d[i]);
+    }
+
+    if (i == 2)
+      MOVDQA(XMM4, R(XMM0));
+    else if (i == 1)
+      PUNPCKLQDQ(XMM4, R(XMM0));
+    else
+      MOVDQA(XMM5, R(XMM0));
+  }
+  Clamp(XMM4, cc.clamp);
+  Clamp(XMM5, cc.clamp);
+
+  const s16* alpha_a = Tev::GetAlphaInput(m_layout, stage, ac.a);
+  const s16* alpha_b = Tev::GetAlphaInput(m_layout, stage, ac.b);
+  const s16* alpha_c = Tev::GetAlphaInput(m_layout, stage, ac.c);
+  const s16* alpha_d = Tev::GetAlphaInput(m_layout, stage, ac.d);
+  if (ac.bias != 3)
+  {
+    CombineRegular(alpha_a, alpha_b, alpha_c, alpha_d, ac.bias, ac.op, ac.shift, true);
+  }
+  else
+  {
+    const u32 alpha_mode = (ac.shift << 1) | ac.op | 8;
+    if (alpha_mode >= TEVCMP_A8_GT)
+      CompareMask(alpha_mode, &alpha_a, &alpha_b);
+    else
+      CompareMask(alpha_mode, a, b);
+    CombineCompare(alpha_c, alpha_d);
+  }
+  Clamp(XMM0, ac.clamp);
+
+  MOVQ_xmm(Lanes(m_layout.Reg[cc.dest][Tev::BLU_C]), XMM4);
+  PSHUFD(XMM4, R(XMM4), 0xEE);
+  MOVQ_xmm(Lanes(m_layout.Reg[cc.dest][Tev::GRN_C]), XMM4);
+  MOVQ_xmm(Lanes(m_layout.Reg[cc.dest][Tev::RED_C]), XMM5);
+  MOVQ_xmm(Lanes(m_layout.Reg[ac.dest][Tev::ALP_C]), XMM0);
+}
+
+// Leaves all ones in the 16 bit lanes of result where the alpha in XMM0 passes the comparison
+void TevX64::EmitAlphaCompare(X64Reg result, u32 ref, u32 comp)
+{
+  switch (comp)
+  {
+  case AlphaTest::NEVER:
+    PXOR(result, R(result));
+    break;
+  case AlphaTest::LESS:
+  case AlphaTest::GEQUAL:
+    LoadConstant16(result, ref);
+    PCMPGTW(result, R(XMM0));
+    if (comp == AlphaTest::GEQUAL)
+      Not(result);
+    break;
+  case AlphaTest::EQUAL:
+  case AlphaTest::NEQUAL:
+    LoadConstant16(result, ref);
+    PCMPEQW(result, R(XMM0));
+    if (comp == AlphaTest::NEQUAL)
+      Not(result);
+    break;
+  case AlphaTest::GREATER:
+  case AlphaTest::LEQUAL:
+    LoadConstant16(XMM3, ref);
+    MOVDQA(result, R(XMM0));
+    PCMPGTW(result, R(XMM3));
+    if (comp == AlphaTest::LEQUAL)
+      Not(result);
+    break;
+  default:  // ALWAYS
+    PCMPEQW(result, R(result));
+    break;
+  }
+}
+
+void TevX64::EmitAlphaTest(u32 alpha_dest, AlphaTest alpha_test)
+{
+  // The output alpha is the 8 bits of the alpha of the last stage.
+  MOVQ_xmm(XMM0, Lanes(m_layout.Reg[alpha_dest][Tev::ALP_C]));
+  PSLLW(XMM0, 8);
+  PSRLW(XMM0, 8);
+
+  EmitAlphaCompare(XMM1, alpha_test.ref0, alpha_test.comp0);
+  EmitAlphaCompare(XMM2, alpha_test.ref1, alpha_test.comp1);
+  switch (alpha_test.logic)
+  {
+  case AlphaTest::AND:
+    PAND(XMM1, R(XMM2));
+    break;
+  case AlphaTest::OR:
+    POR(XMM1, R(XMM2));
+    break;
+  case AlphaTest::XOR:
+    PXOR(XMM1, R(XMM2));
+    break;
+  case AlphaTest::XNOR:
+    PXOR(XMM1, R(XMM2));
+    Not(XMM1);
+    break;
+  }
+
+  PACKSSWB(XMM1, R(XMM1));
+  PMOVMSKB(ABI_RETURN, R(XMM1));
+  AND(32, R(ABI_RETURN), Imm32((1 << Tev::NUM_LANES) - 1));
+  RET();
+}
@@ -0,0 +1,47 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+
+#include "Common/CommonTypes.h"
+#include "Common/x64Emitter.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+
+// The stage combiners and the alpha test of a TEV configuration, compiled to run on all lanes of a
+// block at once
+class TevX64 : public Gen::X64CodeBlock
+{
+public:
+  // The registers the compiled code depends on
+  using Key = std::array<u32, 2 + 2 * Tev::NUM_STAGES>;
+  explicit TevX64(const Key& key);
+
+  static Key GetCurrentKey();
+  Tev::CombinerProgram GetProgram() const { return m_program; }
+
+private:
+  Gen::OpArg Lanes(const s16* lanes) const;
+  void LoadConstant16(Gen::X64Reg reg, s16 value);
+  void LoadConstant32(Gen::X64Reg reg, s32 value);
+  void LoadInput(Gen::X64Reg reg, const s16* lanes, bool sign_extend);
+  void LoadCompareInput(Gen::X64Reg reg, const s16* const components[3], int count);
+  void Not(Gen::X64Reg reg);
+  void Clamp(Gen::X64Reg reg, bool clamp255);
+
+  void CompareMask(u32 mode, const s16* const a[3], const s16* const b[3]);
+  void CombineRegular(const s16* a, const s16* b, const s16* c, const s16* d, u32 bias, u32 op,
+                      u32 shift, bool alpha);
+  void CombineCompare(const s16* c, const s16* d);
+  void EmitStage(int stage, TevStageCombiner::ColorCombiner cc,
+                 TevStageCombiner::AlphaCombiner ac);
+  void EmitAlphaCompare(Gen::X64Reg result, u32 ref, u32 comp);
+  void EmitAlphaTest(u32 alpha_dest, AlphaTest alpha_test);
+
+  // Only used to find the offsets of the inputs
+  Tev::CombinerState m_layout;
+  Tev::CombinerProgram m_program;
+};
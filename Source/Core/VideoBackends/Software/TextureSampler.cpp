@@ -6,8 +6,10 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Core/HW/Memmap.h"
 
 #include "VideoCommon/BPMemory.h"
@@ -59,10 +61,11 @@ static inline void AddTexel(const u8* inTexel, u32* outTexel, u32 fract)
   outTexel[3] += inTexel[3] * fract;
 }
 
-void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8* sample)
+// Returns the fraction to blend the mip level after the base one with, or 0 if only the base
+// one is sampled
+static s32 SelectMip(s32 lod, u8 texmap, int* baseMip)
 {
-  int baseMip = 0;
-  bool mipLinear = false;
+  *baseMip = 0;
 
 #if (ALLOW_MIPMAP)
   const FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
@@ -73,14 +76,26 @@ void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8* sample)
   if (lod > 0 && SamplerCommon::AreBpTexMode0MipmapsEnabled(tm0))
   {
     // use mipmap
-    baseMip = lod >> 4;
-    mipLinear = (lodFract && tm0.min_filter & TexMode0::TEXF_LINEAR);
+    *baseMip = lod >> 4;
+    const bool mipLinear = (lodFract && tm0.min_filter & TexMode0::TEXF_LINEAR);
 
     // if using nearest mip filter and lodFract >= 0.5 round up to next mip
-    baseMip += (lodFract >> 3) & (tm0.min_filter & TexMode0::TEXF_POINT);
+    *baseMip += (lodFract >> 3) & (tm0.min_filter & TexMode0::TEXF_POINT);
+
+    if (mipLinear)
+      return lodFract;
   }
+#endif
+
+  return 0;
+}
+
+void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8* sample)
+{
+  int baseMip;
+  const s32 lodFract = SelectMip(lod, texmap, &baseMip);
 
-  if (mipLinear)
+  if (lodFract)
   {
     u8 sampledTex[4];
     u32 texel[4];
@@ -97,22 +112,19 @@ void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8* sample)
     sample[3] = (u8)(texel[3] >> 4);
   }
   else
-#endif
   {
     SampleMip(s, t, baseMip, linear, texmap, sample);
   }
 }
 
-void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
+void GetMipLevel(u8 texmap, s32 mip, MipLevel* level)
 {
   const FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
   const u8 subTexmap = texmap & 3;
 
-  const TexMode0& tm0 = texUnit.texMode0[subTexmap];
   const TexImage0& ti0 = texUnit.texImage0[subTexmap];
   const TexTLUT& texTlut = texUnit.texTlut[subTexmap];
   const TextureFormat texfmt = static_cast<TextureFormat>(ti0.format);
-  const TLUTFormat tlutfmt = static_cast<TLUTFormat>(texTlut.tlut_format);
 
   const u8* imageSrc;
   const u8* imageSrcOdd = nullptr;
@@ -131,10 +143,7 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
   int imageWidth = ti0.width;
   int imageHeight = ti0.height;
 
-  const int tlutAddress = texTlut.tmem_offset << 9;
-  const u8* tlut = &texMem[tlutAddress];
-
-  // reduce sample location and texture size to mip level
+  // reduce texture size to mip level
   // move texture pointer to mip location
   if (mip)
   {
@@ -147,8 +156,6 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
 
     imageWidth >>= mip;
     imageHeight >>= mip;
-    s >>= mip;
-    t >>= mip;
 
     while (mip)
     {
@@ -163,6 +170,41 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
     }
   }
 
+  level->src = imageSrc;
+  level->srcOdd = imageSrcOdd;
+  level->width = imageWidth;
+  level->height = imageHeight;
+  level->format = texfmt;
+  level->tlut = &texMem[texTlut.tmem_offset << 9];
+  level->tlutFormat = static_cast<TLUTFormat>(texTlut.tlut_format);
+}
+
+static inline void DecodeTexel(const MipLevel& level, int s, int t, u8* texel)
+{
+  if (!level.srcOdd)
+  {
+    TexDecoder_DecodeTexel(texel, level.src, s, t, level.width, level.format, level.tlut,
+                           level.tlutFormat);
+  }
+  else
+  {
+    TexDecoder_DecodeTexelRGBA8FromTmem(texel, level.src, level.srcOdd, s, t, level.width);
+  }
+}
+
+void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
+{
+  const TexMode0& tm0 = bpmem.tex[(texmap >> 2) & 1].texMode0[texmap & 3];
+
+  MipLevel level;
+  GetMipLevel(texmap, mip, &level);
+  const int imageWidth = level.width;
+  const int imageHeight = level.height;
+
+  // reduce sample location to mip level
+  s >>= mip;
+  t >>= mip;
+
   if (linear)
   {
     // offset linear sampling
@@ -188,42 +230,17 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
     WrapCoord(&imageSPlus1, tm0.wrap_s, imageWidth);
     WrapCoord(&imageTPlus1, tm0.wrap_t, imageHeight);
 
-    if (!(texfmt == TextureFormat::RGBA8 && texUnit.texImage1[subTexmap].image_type))
-    {
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageT, imageWidth, texfmt, tlut,
-                             tlutfmt);
-      SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
+    DecodeTexel(level, imageS, imageT, sampledTex);
+    SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
 
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageT, imageWidth, texfmt, tlut,
-                             tlutfmt);
-      AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
+    DecodeTexel(level, imageSPlus1, imageT, sampledTex);
+    AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
 
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageS, imageTPlus1, imageWidth, texfmt, tlut,
-                             tlutfmt);
-      AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
+    DecodeTexel(level, imageS, imageTPlus1, sampledTex);
+    AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
 
-      TexDecoder_DecodeTexel(sampledTex, imageSrc, imageSPlus1, imageTPlus1, imageWidth, texfmt,
-                             tlut, tlutfmt);
-      AddTexel(sampledTex, texel, (fractS) * (fractT));
-    }
-    else
-    {
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageT,
-                                          imageWidth);
-      SetTexel(sampledTex, texel, (128 - fractS) * (128 - fractT));
-
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1, imageT,
-                                          imageWidth);
-      AddTexel(sampledTex, texel, (fractS) * (128 - fractT));
-
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageS, imageTPlus1,
-                                          imageWidth);
-      AddTexel(sampledTex, texel, (128 - fractS) * (fractT));
-
-      TexDecoder_DecodeTexelRGBA8FromTmem(sampledTex, imageSrc, imageSrcOdd, imageSPlus1,
-                                          imageTPlus1, imageWidth);
-      AddTexel(sampledTex, texel, (fractS) * (fractT));
-    }
+    DecodeTexel(level, imageSPlus1, imageTPlus1, sampledTex);
+    AddTexel(sampledTex, texel, (fractS) * (fractT));
 
     sample[0] = (u8)(texel[0] >> 14);
     sample[1] = (u8)(texel[1] >> 14);
@@ -240,11 +257,237 @@ void SampleMip(s32 s, s32 t, s32 mip, bool linear, u8 texmap, u8* sample)
     WrapCoord(&imageS, tm0.wrap_s, imageWidth);
     WrapCoord(&imageT, tm0.wrap_t, imageHeight);
 
-    if (!(texfmt == TextureFormat::RGBA8 && texUnit.texImage1[subTexmap].image_type))
-      TexDecoder_DecodeTexel(sample, imageSrc, imageS, imageT, imageWidth, texfmt, tlut, tlutfmt);
-    else
-      TexDecoder_DecodeTexelRGBA8FromTmem(sample, imageSrc, imageSrcOdd, imageS, imageT,
-                                          imageWidth);
+    DecodeTexel(level, imageS, imageT, sample);
+  }
+}
+
+void TexelCache::Reset()
+{
+  // After wrapping around, tiles decoded long ago would look current.
+  if (++m_generation == 0)
+  {
+    for (auto& levels : m_levels)
+    {
+      for (Level& level : levels)
+      {
+        level.generation = 0;
+        std::fill(level.tileGenerations.begin(), level.tileGenerations.end(), 0);
+      }
+    }
+    m_generation = 1;
+  }
+}
+
+TexelCache::Level& TexelCache::GetLevel(u8 texmap, s32 mip)
+{
+  Level& level = m_levels[texmap][mip];
+  if (level.generation == m_generation)
+    return level;
+
+  const TexMode0& tm0 = bpmem.tex[(texmap >> 2) & 1].texMode0[texmap & 3];
+  GetMipLevel(texmap, mip, &level.info);
+  level.wrapS = tm0.wrap_s;
+  level.wrapT = tm0.wrap_t;
+  level.tilesX = (level.info.width + TILE_SIZE) >> TILE_SHIFT;
+
+  // The tiles of earlier generations are decoded again when they are used, so the buffers only
+  // need to grow.
+  const size_t numTiles = level.tilesX * ((level.info.height + TILE_SIZE) >> TILE_SHIFT);
+  if (level.tileGenerations.size() < numTiles)
+  {
+    level.tileGenerations.resize(numTiles, 0);
+    level.texels.resize(numTiles * TILE_SIZE * TILE_SIZE);
+  }
+
+  level.generation = m_generation;
+  return level;
+}
+
+u32 TexelCache::GetTexel(Level& level, int s, int t)
+{
+  u32 texel;
+
+  // Invalid wrap modes leave the coordinates outside of the texture.
+  if (s < 0 || s > level.info.width || t < 0 || t > level.info.height)
+  {
+    DecodeTexel(level.info, s, t, reinterpret_cast<u8*>(&texel));
+    return texel;
+  }
+
+  const int tile = (t >> TILE_SHIFT) * level.tilesX + (s >> TILE_SHIFT);
+  u32* tileTexels = &level.texels[tile * TILE_SIZE * TILE_SIZE];
+  if (level.tileGenerations[tile] != m_generation)
+  {
+    const int tileS = s & ~(TILE_SIZE - 1);
+    const int tileT = t & ~(TILE_SIZE - 1);
+    const int tileWidth = std::min(TILE_SIZE, level.info.width + 1 - tileS);
+    const int tileHeight = std::min(TILE_SIZE, level.info.height + 1 - tileT);
+    for (int y = 0; y < tileHeight; y++)
+    {
+      for (int x = 0; x < tileWidth; x++)
+      {
+        DecodeTexel(level.info, tileS + x, tileT + y,
+                    reinterpret_cast<u8*>(&tileTexels[y * TILE_SIZE + x]));
+      }
+    }
+    level.tileGenerations[tile] = m_generation;
+  }
+
+  return tileTexels[(t & (TILE_SIZE - 1)) * TILE_SIZE + (s & (TILE_SIZE - 1))];
+}
+
+// Blends the four texels around the sample location of each lane like SampleMip does, but as a
+// horizontal and then a vertical blend, which gives the same results.
+static void Filter(const u32 texels[4][TexelCache::NUM_LANES],
+                   const s16 fractS[TexelCache::NUM_LANES], const s16 fractT[TexelCache::NUM_LANES],
+                   u8 samples[TexelCache::NUM_LANES][4])
+{
+#ifdef _M_X86_64
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i full = _mm_set1_epi16(128);
+
+  // Two lanes at a time, with 16 bits per component
+  __m128i results[2];
+  for (int half = 0; half < 2; half++)
+  {
+    __m128i corners[4];
+    for (int i = 0; i < 4; i++)
+    {
+      const __m128i corner = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels[i]));
+      corners[i] = half ? _mm_unpackhi_epi8(corner, zero) : _mm_unpacklo_epi8(corner, zero);
+    }
+
+    const s16 s0 = fractS[half * 2];
+    const s16 s1 = fractS[half * 2 + 1];
+    const s16 t0 = fractT[half * 2];
+    const s16 t1 = fractT[half * 2 + 1];
+    const __m128i weightS = _mm_setr_epi16(s0, s0, s0, s0, s1, s1, s1, s1);
+    const __m128i weightT = _mm_setr_epi16(t0, t0, t0, t0, t1, t1, t1, t1);
+    const __m128i invWeightS = _mm_sub_epi16(full, weightS);
+    const __m128i invWeightT = _mm_sub_epi16(full, weightT);
+
+    // At most 255 * 128, which still fits in 16 bits
+    const __m128i top = _mm_add_epi16(_mm_mullo_epi16(corners[0], invWeightS),
+                                      _mm_mullo_epi16(corners[1], weightS));
+    const __m128i bottom = _mm_add_epi16(_mm_mullo_epi16(corners[2], invWeightS),
+                                         _mm_mullo_epi16(corners[3], weightS));
+
+    const __m128i low = _mm_madd_epi16(_mm_unpacklo_epi16(top, bottom),
+                                       _mm_unpacklo_epi16(invWeightT, weightT));
+    const __m128i high = _mm_madd_epi16(_mm_unpackhi_epi16(top, bottom),
+                                        _mm_unpackhi_epi16(invWeightT, weightT));
+    results[half] = _mm_packs_epi32(_mm_srli_epi32(low, 14), _mm_srli_epi32(high, 14));
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(samples), _mm_packus_epi16(results[0], results[1]));
+#else
+  for (int lane = 0; lane < TexelCache::NUM_LANES; lane++)
+  {
+    u32 texel[4];
+    SetTexel(reinterpret_cast<const u8*>(&texels[0][lane]), texel,
+             (128 - fractS[lane]) * (128 - fractT[lane]));
+    AddTexel(reinterpret_cast<const u8*>(&texels[1][lane]), texel,
+             (fractS[lane]) * (128 - fractT[lane]));
+    AddTexel(reinterpret_cast<const u8*>(&texels[2][lane]), texel,
+             (128 - fractS[lane]) * (fractT[lane]));
+    AddTexel(reinterpret_cast<const u8*>(&texels[3][lane]), texel, (fractS[lane]) * (fractT[lane]));
+
+    for (int i = 0; i < 4; i++)
+      samples[lane][i] = (u8)(texel[i] >> 14);
+  }
+#endif
+}
+
+void TexelCache::SampleMip(const s32 s[NUM_LANES], const s32 t[NUM_LANES], s32 mip, bool linear,
+                           u8 texmap, u32 lane_mask, u8 samples[NUM_LANES][4])
+{
+  // No texture has that many levels, so there is nothing worth caching.
+  if (mip >= MAX_LEVELS)
+  {
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      if (lane_mask & (1 << lane))
+        TextureSampler::SampleMip(s[lane], t[lane], mip, linear, texmap, samples[lane]);
+    }
+    return;
+  }
+
+  Level& level = GetLevel(texmap, mip);
+
+  if (!linear)
+  {
+    for (int lane = 0; lane < NUM_LANES; lane++)
+    {
+      if (!(lane_mask & (1 << lane)))
+        continue;
+
+      int imageS = (s[lane] >> mip) >> 7;
+      int imageT = (t[lane] >> mip) >> 7;
+      WrapCoord(&imageS, level.wrapS, level.info.width);
+      WrapCoord(&imageT, level.wrapT, level.info.height);
+
+      const u32 texel = GetTexel(level, imageS, imageT);
+      std::memcpy(samples[lane], &texel, sizeof(texel));
+    }
+    return;
+  }
+
+  // The texels around the sample locations, starting at the top left one
+  u32 texels[4][NUM_LANES] = {};
+  s16 fractS[NUM_LANES] = {};
+  s16 fractT[NUM_LANES] = {};
+  for (int lane = 0; lane < NUM_LANES; lane++)
+  {
+    if (!(lane_mask & (1 << lane)))
+      continue;
+
+    // offset linear sampling
+    const s32 laneS = (s[lane] >> mip) - 64;
+    const s32 laneT = (t[lane] >> mip) - 64;
+
+    int imageS = laneS >> 7;
+    int imageT = laneT >> 7;
+    int imageSPlus1 = imageS + 1;
+    int imageTPlus1 = imageT + 1;
+    fractS[lane] = laneS & 0x7f;
+    fractT[lane] = laneT & 0x7f;
+
+    WrapCoord(&imageS, level.wrapS, level.info.width);
+    WrapCoord(&imageT, level.wrapT, level.info.height);
+    WrapCoord(&imageSPlus1, level.wrapS, level.info.width);
+    WrapCoord(&imageTPlus1, level.wrapT, level.info.height);
+
+    texels[0][lane] = GetTexel(level, imageS, imageT);
+    texels[1][lane] = GetTexel(level, imageSPlus1, imageT);
+    texels[2][lane] = GetTexel(level, imageS, imageTPlus1);
+    texels[3][lane] = GetTexel(level, imageSPlus1, imageTPlus1);
+  }
+
+  Filter(texels, fractS, fractT, samples);
+}
+
+void TexelCache::Sample(const s32 s[NUM_LANES], const s32 t[NUM_LANES], s32 lod, bool linear,
+                        u8 texmap, u32 lane_mask, u8 samples[NUM_LANES][4])
+{
+  int baseMip;
+  const s32 lodFract = SelectMip(lod, texmap, &baseMip);
+
+  SampleMip(s, t, baseMip, linear, texmap, lane_mask, samples);
+  if (!lodFract)
+    return;
+
+  u8 nextSamples[NUM_LANES][4];
+  SampleMip(s, t, baseMip + 1, linear, texmap, lane_mask, nextSamples);
+  for (int lane = 0; lane < NUM_LANES; lane++)
+  {
+    if (!(lane_mask & (1 << lane)))
+      continue;
+
+    for (int i = 0; i < 4; i++)
+    {
+      samples[lane][i] =
+          (u8)((samples[lane][i] * (16 - lodFract) + nextSamples[lane][i] * lodFract) >> 4);
+    }
   }
 }
 }
@@ -4,8 +4,13 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Common/CommonTypes.h"
 
+enum class TextureFormat;
+enum class TLUTFormat;
+
 namespace TextureSampler
 {
 void Sample(s32 s, s32 t, s32 lod, bool linear, u8 texmap, u8* sample);
@@ -19,4 +24,62 @@ enum
   BLU_SMP,
   ALP_SMP
 };
+
+// Where and how a mip level of a texmap is stored
+struct MipLevel
+{
+  const u8* src;
+  // The odd cache lines of RGBA8 textures in TMEM, or null
+  const u8* srcOdd;
+  // The size minus one, like in the texture registers
+  int width;
+  int height;
+  TextureFormat format;
+  const u8* tlut;
+  TLUTFormat tlutFormat;
+};
+
+void GetMipLevel(u8 texmap, s32 mip, MipLevel* level);
+
+// Samples the textures of a draw for the pixels of a 2x2 block at once. The texels are decoded in
+// tiles of 8x8 texels when they are first used, and kept until Reset() is called.
+class TexelCache
+{
+public:
+  static constexpr int NUM_LANES = 4;
+
+  // Has to be called whenever the textures or the texture registers may have changed
+  void Reset();
+
+  // Samples the texture for the lanes set in lane_mask. The results are RGBA, and undefined for
+  // the other lanes.
+  void Sample(const s32 s[NUM_LANES], const s32 t[NUM_LANES], s32 lod, bool linear, u8 texmap,
+              u32 lane_mask, u8 samples[NUM_LANES][4]);
+
+private:
+  static constexpr int TILE_SHIFT = 3;
+  static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+  // Enough for 1024x1024 textures, the largest ones
+  static constexpr int MAX_LEVELS = 11;
+
+  struct Level
+  {
+    MipLevel info;
+    int wrapS;
+    int wrapT;
+    int tilesX;
+    u32 generation = 0;
+    // The texels, tile after tile, and the generation in which each tile was decoded
+    std::vector<u32> texels;
+    std::vector<u32> tileGenerations;
+  };
+
+  Level& GetLevel(u8 texmap, s32 mip);
+  u32 GetTexel(Level& level, int s, int t);
+  void SampleMip(const s32 s[NUM_LANES], const s32 t[NUM_LANES], s32 mip, bool linear, u8 texmap,
+                 u32 lane_mask, u8 samples[NUM_LANES][4]);
+
+  Level m_levels[8][MAX_LEVELS];
+  u32 m_generation = 1;
+};
 }
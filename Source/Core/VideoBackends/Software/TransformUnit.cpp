@@ -11,6 +11,7 @@
 
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
@@ -319,38 +320,84 @@ static void LightAlpha(const Vec3& pos, const Vec3& normal, u8 lightNum, const L
   }
 }
 
+static Vec3 GetAmbientColor(const InputVertexData* src, u32 chan)
+{
+  if (xfmem.color[chan].ambsource)
+  {
+    // vertex
+    return Vec3(src->color[chan][1], src->color[chan][2], src->color[chan][3]);
+  }
+
+  const u8* ambColor = reinterpret_cast<u8*>(&xfmem.ambColor[chan]);
+  return Vec3(ambColor[1], ambColor[2], ambColor[3]);
+}
+
+static float GetAmbientAlpha(const InputVertexData* src, u32 chan)
+{
+  if (xfmem.alpha[chan].ambsource)
+    return src->color[chan][0];  // vertex
+
+  return static_cast<float>(xfmem.ambColor[chan] & 0xff);
+}
+
+static u8 ScaleColor(u8 matcolor, float lightCol)
+{
+  const int light = MathUtil::Clamp(static_cast<int>(lightCol), 0, 255);
+  return static_cast<u8>((matcolor * (light + (light >> 7))) >> 8);
+}
+
+// Combines the material color of a channel with the light color, if lighting is enabled
+static void CombineColor(const InputVertexData* src, u32 chan, const Vec3& lightCol,
+                         float lightAlpha, OutputVertexData* dst)
+{
+  // abgr
+  std::array<u8, 4> matcolor;
+  std::array<u8, 4> chancolor;
+
+  // color
+  const LitChannel& colorchan = xfmem.color[chan];
+  if (colorchan.matsource)
+    matcolor = src->color[chan];  // vertex
+  else
+    std::memcpy(matcolor.data(), &xfmem.matColor[chan], sizeof(u32));
+
+  if (colorchan.enablelighting)
+  {
+    chancolor[1] = ScaleColor(matcolor[1], lightCol.x);
+    chancolor[2] = ScaleColor(matcolor[2], lightCol.y);
+    chancolor[3] = ScaleColor(matcolor[3], lightCol.z);
+  }
+  else
+  {
+    chancolor = matcolor;
+  }
+
+  // alpha
+  const LitChannel& alphachan = xfmem.alpha[chan];
+  if (alphachan.matsource)
+    matcolor[0] = src->color[chan][0];  // vertex
+  else
+    matcolor[0] = xfmem.matColor[chan] & 0xff;
+
+  if (alphachan.enablelighting)
+    chancolor[0] = ScaleColor(matcolor[0], lightAlpha);
+  else
+    chancolor[0] = matcolor[0];
+
+  // abgr -> rgba
+  const u32 rgba_color = Common::swap32(chancolor.data());
+  std::memcpy(dst->color[chan].data(), &rgba_color, sizeof(u32));
+}
+
 void TransformColor(const InputVertexData* src, OutputVertexData* dst)
 {
   for (u32 chan = 0; chan < NUM_XF_COLOR_CHANNELS; chan++)
   {
-    // abgr
-    std::array<u8, 4> matcolor;
-    std::array<u8, 4> chancolor;
-
-    // color
+    Vec3 lightCol(0.0f);
     const LitChannel& colorchan = xfmem.color[chan];
-    if (colorchan.matsource)
-      matcolor = src->color[chan];  // vertex
-    else
-      std::memcpy(matcolor.data(), &xfmem.matColor[chan], sizeof(u32));
-
     if (colorchan.enablelighting)
     {
-      Vec3 lightCol;
-      if (colorchan.ambsource)
-      {
-        // vertex
-        lightCol.x = src->color[chan][1];
-        lightCol.y = src->color[chan][2];
-        lightCol.z = src->color[chan][3];
-      }
-      else
-      {
-        const u8* ambColor = reinterpret_cast<u8*>(&xfmem.ambColor[chan]);
-        lightCol.x = ambColor[1];
-        lightCol.y = ambColor[2];
-        lightCol.z = ambColor[3];
-      }
+      lightCol = GetAmbientColor(src, chan);
 
       u8 mask = colorchan.GetFullLightMask();
       for (int i = 0; i < 8; ++i)
@@ -358,102 +405,601 @@ void TransformColor(const InputVertexData* src, OutputVertexData* dst)
         if (mask & (1 << i))
           LightColor(dst->mvPosition, dst->normal[0], i, colorchan, lightCol);
       }
-
-      int light_x = MathUtil::Clamp(static_cast<int>(lightCol.x), 0, 255);
-      int light_y = MathUtil::Clamp(static_cast<int>(lightCol.y), 0, 255);
-      int light_z = MathUtil::Clamp(static_cast<int>(lightCol.z), 0, 255);
-      chancolor[1] = (matcolor[1] * (light_x + (light_x >> 7))) >> 8;
-      chancolor[2] = (matcolor[2] * (light_y + (light_y >> 7))) >> 8;
-      chancolor[3] = (matcolor[3] * (light_z + (light_z >> 7))) >> 8;
-    }
-    else
-    {
-      chancolor = matcolor;
     }
 
-    // alpha
+    float lightAlpha = 0.0f;
     const LitChannel& alphachan = xfmem.alpha[chan];
-    if (alphachan.matsource)
-      matcolor[0] = src->color[chan][0];  // vertex
-    else
-      matcolor[0] = xfmem.matColor[chan] & 0xff;
-
-    if (xfmem.alpha[chan].enablelighting)
+    if (alphachan.enablelighting)
     {
-      float lightCol;
-      if (alphachan.ambsource)
-        lightCol = src->color[chan][0];  // vertex
-      else
-        lightCol = static_cast<float>(xfmem.ambColor[chan] & 0xff);
+      lightAlpha = GetAmbientAlpha(src, chan);
 
       u8 mask = alphachan.GetFullLightMask();
       for (int i = 0; i < 8; ++i)
       {
         if (mask & (1 << i))
-          LightAlpha(dst->mvPosition, dst->normal[0], i, alphachan, lightCol);
+          LightAlpha(dst->mvPosition, dst->normal[0], i, alphachan, lightAlpha);
       }
-
-      int light_a = MathUtil::Clamp(static_cast<int>(lightCol), 0, 255);
-      chancolor[0] = (matcolor[0] * (light_a + (light_a >> 7))) >> 8;
-    }
-    else
-    {
-      chancolor[0] = matcolor[0];
     }
 
-    // abgr -> rgba
-    const u32 rgba_color = Common::swap32(chancolor.data());
-    std::memcpy(dst->color[chan].data(), &rgba_color, sizeof(u32));
+    CombineColor(src, chan, lightCol, lightAlpha, dst);
+  }
+}
+
+static void TransformTexGen(const TexMtxInfo& texinfo, u32 coordNum, bool specialCase,
+                            const InputVertexData* src, OutputVertexData* dst)
+{
+  switch (texinfo.texgentype)
+  {
+  case XF_TEXGEN_REGULAR:
+    TransformTexCoordRegular(texinfo, coordNum, specialCase, src, dst);
+    break;
+  case XF_TEXGEN_EMBOSS_MAP:
+  {
+    const LightPointer* light = (const LightPointer*)&xfmem.lights[texinfo.embosslightshift];
+
+    Vec3 ldir = (light->pos - dst->mvPosition).Normalized();
+    float d1 = ldir * dst->normal[1];
+    float d2 = ldir * dst->normal[2];
+
+    dst->texCoords[coordNum].x = dst->texCoords[texinfo.embosssourceshift].x + d1;
+    dst->texCoords[coordNum].y = dst->texCoords[texinfo.embosssourceshift].y + d2;
+    dst->texCoords[coordNum].z = dst->texCoords[texinfo.embosssourceshift].z;
+  }
+  break;
+  case XF_TEXGEN_COLOR_STRGBC0:
+    ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
+    ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
+    dst->texCoords[coordNum].x = (float)dst->color[0][0] / 255.0f;
+    dst->texCoords[coordNum].y = (float)dst->color[0][1] / 255.0f;
+    dst->texCoords[coordNum].z = 1.0f;
+    break;
+  case XF_TEXGEN_COLOR_STRGBC1:
+    ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
+    ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
+    dst->texCoords[coordNum].x = (float)dst->color[1][0] / 255.0f;
+    dst->texCoords[coordNum].y = (float)dst->color[1][1] / 255.0f;
+    dst->texCoords[coordNum].z = 1.0f;
+    break;
+  default:
+    ERROR_LOG(VIDEO, "Bad tex gen type %i", texinfo.texgentype.Value());
+  }
+}
+
+static void ScaleTexCoords(OutputVertexData* dst)
+{
+  for (u32 coordNum = 0; coordNum < xfmem.numTexGen.numTexGens; coordNum++)
+  {
+    dst->texCoords[coordNum][0] *= (bpmem.texcoords[coordNum].s.scale_minus_1 + 1);
+    dst->texCoords[coordNum][1] *= (bpmem.texcoords[coordNum].t.scale_minus_1 + 1);
   }
 }
 
 void TransformTexCoord(const InputVertexData* src, OutputVertexData* dst, bool specialCase)
 {
   for (u32 coordNum = 0; coordNum < xfmem.numTexGen.numTexGens; coordNum++)
+    TransformTexGen(xfmem.texMtxInfo[coordNum], coordNum, specialCase, src, dst);
+
+  ScaleTexCoords(dst);
+}
+
+static void TransformVertex(const InputVertexData* src, OutputVertexData* dst, bool normals,
+                            bool nbt, bool specialCase)
+{
+  TransformPosition(src, dst);
+  dst->normal.fill(Vec3(0.0f));
+  if (normals)
+    TransformNormal(src, nbt, dst);
+  TransformColor(src, dst);
+  TransformTexCoord(src, dst, specialCase);
+}
+
+#ifdef _M_X86_64
+// The SSE versions of the functions above transform the vertices of a batch together. They do the
+// same operations in the same order, so the results are exactly the same.
+constexpr u32 BATCH_SIZE = 4;
+
+// A vector of each vertex of a batch
+struct Vec3x4
+{
+  __m128 x;
+  __m128 y;
+  __m128 z;
+};
+
+template <typename Get>
+static Vec3x4 Load(Get get)
+{
+  alignas(16) float x[BATCH_SIZE];
+  alignas(16) float y[BATCH_SIZE];
+  alignas(16) float z[BATCH_SIZE];
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
   {
-    const TexMtxInfo& texinfo = xfmem.texMtxInfo[coordNum];
+    const Vec3& vec = get(lane);
+    x[lane] = vec.x;
+    y[lane] = vec.y;
+    z[lane] = vec.z;
+  }
+  return {_mm_load_ps(x), _mm_load_ps(y), _mm_load_ps(z)};
+}
 
-    switch (texinfo.texgentype)
-    {
-    case XF_TEXGEN_REGULAR:
-      TransformTexCoordRegular(texinfo, coordNum, specialCase, src, dst);
-      break;
-    case XF_TEXGEN_EMBOSS_MAP:
+template <typename Get>
+static void Store(const Vec3x4& vec, Get get)
+{
+  alignas(16) float x[BATCH_SIZE];
+  alignas(16) float y[BATCH_SIZE];
+  alignas(16) float z[BATCH_SIZE];
+  _mm_store_ps(x, vec.x);
+  _mm_store_ps(y, vec.y);
+  _mm_store_ps(z, vec.z);
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+    get(lane) = Vec3(x[lane], y[lane], z[lane]);
+}
+
+static Vec3x4 Splat(const Vec3& vec)
+{
+  return {_mm_set1_ps(vec.x), _mm_set1_ps(vec.y), _mm_set1_ps(vec.z)};
+}
+
+// Loads the first count elements of the matrices of the vertices, one element per register
+static void LoadMatrices(const float* const mats[BATCH_SIZE], int count, __m128* mat)
+{
+  // The vertices of a draw mostly use the same matrix.
+  if (mats[0] == mats[1] && mats[0] == mats[2] && mats[0] == mats[3])
+  {
+    for (int i = 0; i < count; i++)
+      mat[i] = _mm_set1_ps(mats[0][i]);
+    return;
+  }
+
+  for (int i = 0; i < count; i++)
+    mat[i] = _mm_setr_ps(mats[0][i], mats[1][i], mats[2][i], mats[3][i]);
+}
+
+static __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static Vec3x4 Select(__m128 mask, const Vec3x4& a, const Vec3x4& b)
+{
+  return {Select(mask, a.x, b.x), Select(mask, a.y, b.y), Select(mask, a.z, b.z)};
+}
+
+static Vec3x4 Subtract(const Vec3x4& a, const Vec3x4& b)
+{
+  return {_mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z)};
+}
+
+static Vec3x4 Scale(const Vec3x4& vec, __m128 f)
+{
+  return {_mm_mul_ps(vec.x, f), _mm_mul_ps(vec.y, f), _mm_mul_ps(vec.z, f)};
+}
+
+static __m128 Dot(const Vec3x4& a, const Vec3x4& b)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)),
+                    _mm_mul_ps(a.z, b.z));
+}
+
+static Vec3x4 Normalized(const Vec3x4& vec)
+{
+  return Scale(vec, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(Dot(vec, vec))));
+}
+
+// std::max(0.0f, value), which is 0 for NaN
+static __m128 MaxZero(__m128 value)
+{
+  return _mm_max_ps(value, _mm_setzero_ps());
+}
+
+// MathUtil::Clamp(value, -1.0f, 1.0f), which is 1 for NaN
+static __m128 ClampOne(__m128 value)
+{
+  return _mm_max_ps(_mm_min_ps(value, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+}
+
+static __m128 MultiplyVec2Row(const Vec3x4& vec, const __m128* row)
+{
+  return _mm_add_ps(
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(row[0], vec.x), _mm_mul_ps(row[1], vec.y)), row[2]),
+      row[3]);
+}
+
+static __m128 MultiplyVec3Row(const Vec3x4& vec, const __m128* row)
+{
+  return _mm_add_ps(_mm_add_ps(_mm_mul_ps(row[0], vec.x), _mm_mul_ps(row[1], vec.y)),
+                    _mm_mul_ps(row[2], vec.z));
+}
+
+static __m128 MultiplyVec3AffineRow(const Vec3x4& vec, const __m128* row)
+{
+  return _mm_add_ps(
+      _mm_add_ps(_mm_add_ps(_mm_mul_ps(row[0], vec.x), _mm_mul_ps(row[1], vec.y)),
+                 _mm_mul_ps(row[2], vec.z)),
+      row[3]);
+}
+
+static Vec3x4 MultiplyVec2Mat24(const Vec3x4& vec, const __m128* mat)
+{
+  return {MultiplyVec2Row(vec, mat), MultiplyVec2Row(vec, mat + 4), _mm_set1_ps(1.0f)};
+}
+
+static Vec3x4 MultiplyVec2Mat34(const Vec3x4& vec, const __m128* mat)
+{
+  return {MultiplyVec2Row(vec, mat), MultiplyVec2Row(vec, mat + 4), MultiplyVec2Row(vec, mat + 8)};
+}
+
+static Vec3x4 MultiplyVec3Mat33(const Vec3x4& vec, const __m128* mat)
+{
+  return {MultiplyVec3Row(vec, mat), MultiplyVec3Row(vec, mat + 3), MultiplyVec3Row(vec, mat + 6)};
+}
+
+static Vec3x4 MultiplyVec3Mat24(const Vec3x4& vec, const __m128* mat)
+{
+  return {MultiplyVec3AffineRow(vec, mat), MultiplyVec3AffineRow(vec, mat + 4),
+          _mm_set1_ps(1.0f)};
+}
+
+static Vec3x4 MultiplyVec3Mat34(const Vec3x4& vec, const __m128* mat)
+{
+  return {MultiplyVec3AffineRow(vec, mat), MultiplyVec3AffineRow(vec, mat + 4),
+          MultiplyVec3AffineRow(vec, mat + 8)};
+}
+
+static void TransformPositions(const InputVertexData* src, OutputVertexData* dst,
+                               Vec3x4* mvPosition)
+{
+  const float* mats[BATCH_SIZE];
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+    mats[lane] = &xfmem.posMatrices[src[lane].posMtx * 4];
+
+  __m128 mat[12];
+  LoadMatrices(mats, 12, mat);
+  const Vec3x4 vec = MultiplyVec3Mat34(Load([&](u32 lane) { return src[lane].position; }), mat);
+  Store(vec, [&](u32 lane) -> Vec3& { return dst[lane].mvPosition; });
+  *mvPosition = vec;
+
+  const float* proj = xfmem.projection.rawProjection;
+  __m128 projected[4];
+  if (xfmem.projection.type == GX_PERSPECTIVE)
+  {
+    projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), vec.x),
+                              _mm_mul_ps(_mm_set1_ps(proj[1]), vec.z));
+    projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), vec.y),
+                              _mm_mul_ps(_mm_set1_ps(proj[3]), vec.z));
+    projected[2] =
+        _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), vec.z), _mm_set1_ps(proj[5])),
+                   _mm_set1_ps(1.0f - (float)1e-7));
+    projected[3] = _mm_xor_ps(vec.z, _mm_set1_ps(-0.0f));
+  }
+  else
+  {
+    projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), vec.x), _mm_set1_ps(proj[1]));
+    projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), vec.y), _mm_set1_ps(proj[3]));
+    projected[2] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), vec.z), _mm_set1_ps(proj[5]));
+    projected[3] = _mm_set1_ps(1.0f);
+  }
+
+  _MM_TRANSPOSE4_PS(projected[0], projected[1], projected[2], projected[3]);
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+    _mm_storeu_ps(&dst[lane].projectedPosition.x, projected[lane]);
+}
+
+static void TransformNormals(const InputVertexData* src, bool nbt, OutputVertexData* dst,
+                             Vec3x4* normal)
+{
+  const float* mats[BATCH_SIZE];
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+    mats[lane] = &xfmem.normalMatrices[(src[lane].posMtx & 31) * 3];
+
+  __m128 mat[9];
+  LoadMatrices(mats, 9, mat);
+
+  if (nbt)
+  {
+    for (int i = 1; i < 3; i++)
     {
-      const LightPointer* light = (const LightPointer*)&xfmem.lights[texinfo.embosslightshift];
+      const Vec3x4 vec = Load([&](u32 lane) { return src[lane].normal[i]; });
+      Store(MultiplyVec3Mat33(vec, mat), [&](u32 lane) -> Vec3& { return dst[lane].normal[i]; });
+    }
+  }
+
+  const Vec3x4 vec = Load([&](u32 lane) { return src[lane].normal[0]; });
+  *normal = Normalized(MultiplyVec3Mat33(vec, mat));
+  Store(*normal, [&](u32 lane) -> Vec3& { return dst[lane].normal[0]; });
+}
+
+static void TransformTexCoordsRegular(const TexMtxInfo& texinfo, u32 coordNum, bool specialCase,
+                                      const InputVertexData* srcVertices,
+                                      OutputVertexData* dstVertices)
+{
+  Vec3x4 src;
+  switch (texinfo.sourcerow)
+  {
+  case XF_SRCGEOM_INROW:
+    src = Load([&](u32 lane) { return srcVertices[lane].position; });
+    break;
+  case XF_SRCNORMAL_INROW:
+    src = Load([&](u32 lane) { return srcVertices[lane].normal[0]; });
+    break;
+  case XF_SRCBINORMAL_T_INROW:
+    src = Load([&](u32 lane) { return srcVertices[lane].normal[1]; });
+    break;
+  case XF_SRCBINORMAL_B_INROW:
+    src = Load([&](u32 lane) { return srcVertices[lane].normal[2]; });
+    break;
+  default:
+  {
+    ASSERT(texinfo.sourcerow >= XF_SRCTEX0_INROW && texinfo.sourcerow <= XF_SRCTEX7_INROW);
+    const u32 row = texinfo.sourcerow - XF_SRCTEX0_INROW;
+    src = Load([&](u32 lane) {
+      return Vec3(srcVertices[lane].texCoords[row][0], srcVertices[lane].texCoords[row][1], 1.0f);
+    });
+    break;
+  }
+  }
+
+  const float* mats[BATCH_SIZE];
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+    mats[lane] = &xfmem.posMatrices[srcVertices[lane].texMtx[coordNum] * 4];
+
+  __m128 mat[12];
+  Vec3x4 dst;
+  if (texinfo.projection == XF_TEXPROJ_ST)
+  {
+    LoadMatrices(mats, 8, mat);
+    if (texinfo.inputform == XF_TEXINPUT_AB11 || specialCase)
+      dst = MultiplyVec2Mat24(src, mat);
+    else
+      dst = MultiplyVec3Mat24(src, mat);
+  }
+  else  // texinfo.projection == XF_TEXPROJ_STQ
+  {
+    ASSERT(!specialCase);
+
+    LoadMatrices(mats, 12, mat);
+    if (texinfo.inputform == XF_TEXINPUT_AB11)
+      dst = MultiplyVec2Mat34(src, mat);
+    else
+      dst = MultiplyVec3Mat34(src, mat);
+  }
 
-      Vec3 ldir = (light->pos - dst->mvPosition).Normalized();
-      float d1 = ldir * dst->normal[1];
-      float d2 = ldir * dst->normal[2];
+  if (xfmem.dualTexTrans.enabled)
+  {
+    const PostMtxInfo& postInfo = xfmem.postMtxInfo[coordNum];
+    const float* postMats[BATCH_SIZE];
+    for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+      postMats[lane] = &xfmem.postMatrices[postInfo.index * 4];
 
-      dst->texCoords[coordNum].x = dst->texCoords[texinfo.embosssourceshift].x + d1;
-      dst->texCoords[coordNum].y = dst->texCoords[texinfo.embosssourceshift].y + d2;
-      dst->texCoords[coordNum].z = dst->texCoords[texinfo.embosssourceshift].z;
+    __m128 postMat[12];
+    if (specialCase)
+    {
+      LoadMatrices(postMats, 8, postMat);
+      dst = MultiplyVec2Mat24(dst, postMat);
     }
+    else
+    {
+      LoadMatrices(postMats, 12, postMat);
+      dst = MultiplyVec3Mat34(postInfo.normalize ? Normalized(dst) : dst, postMat);
+    }
+  }
+
+  // The special case when q is 0
+  const __m128 q_zero = _mm_cmpeq_ps(dst.z, _mm_setzero_ps());
+  const __m128 two = _mm_set1_ps(2.0f);
+  dst.x = Select(q_zero, ClampOne(_mm_div_ps(dst.x, two)), dst.x);
+  dst.y = Select(q_zero, ClampOne(_mm_div_ps(dst.y, two)), dst.y);
+
+  Store(dst, [&](u32 lane) -> Vec3& { return dstVertices[lane].texCoords[coordNum]; });
+}
+
+static void AddScaledIntegerColor(const u8* src, __m128 scale, Vec3x4& dst)
+{
+  dst.x = _mm_add_ps(dst.x, _mm_mul_ps(_mm_set1_ps(src[1]), scale));
+  dst.y = _mm_add_ps(dst.y, _mm_mul_ps(_mm_set1_ps(src[2]), scale));
+  dst.z = _mm_add_ps(dst.z, _mm_mul_ps(_mm_set1_ps(src[3]), scale));
+}
+
+static __m128 SafeDivide(__m128 n, __m128 d)
+{
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 n_positive = _mm_and_ps(_mm_cmpgt_ps(n, zero), _mm_set1_ps(1.0f));
+  return Select(_mm_cmpeq_ps(d, zero), n_positive, _mm_div_ps(n, d));
+}
+
+static __m128 CalculateLightAttn(const LightPointer* light, Vec3x4* _ldir, const Vec3x4& normal,
+                                 const LitChannel& chan)
+{
+  const __m128 zero = _mm_setzero_ps();
+  __m128 attn = _mm_set1_ps(1.0f);
+  Vec3x4& ldir = *_ldir;
+
+  switch (chan.attnfunc)
+  {
+  case LIGHTATTN_NONE:
+  case LIGHTATTN_DIR:
+  {
+    ldir = Normalized(ldir);
+    const __m128 ldir_zero =
+        _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(ldir.x, zero), _mm_cmpeq_ps(ldir.y, zero)),
+                   _mm_cmpeq_ps(ldir.z, zero));
+    ldir = Select(ldir_zero, normal, ldir);
+    break;
+  }
+  case LIGHTATTN_SPEC:
+  {
+    ldir = Normalized(ldir);
+    attn = _mm_and_ps(_mm_cmpge_ps(Dot(ldir, normal), zero),
+                      MaxZero(Dot(Splat(light->dir), normal)));
+    const Vec3x4 attLen = {_mm_set1_ps(1.0f), attn, _mm_mul_ps(attn, attn)};
+    Vec3 distAttn = light->distatt;
+    if (chan.diffusefunc != LIGHTDIF_NONE)
+      distAttn = distAttn.Normalized();
+
+    attn = SafeDivide(MaxZero(Dot(attLen, Splat(light->cosatt))), Dot(attLen, Splat(distAttn)));
     break;
-    case XF_TEXGEN_COLOR_STRGBC0:
-      ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
-      ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
-      dst->texCoords[coordNum].x = (float)dst->color[0][0] / 255.0f;
-      dst->texCoords[coordNum].y = (float)dst->color[0][1] / 255.0f;
-      dst->texCoords[coordNum].z = 1.0f;
-      break;
-    case XF_TEXGEN_COLOR_STRGBC1:
-      ASSERT(texinfo.sourcerow == XF_SRCCOLORS_INROW);
-      ASSERT(texinfo.inputform == XF_TEXINPUT_AB11);
-      dst->texCoords[coordNum].x = (float)dst->color[1][0] / 255.0f;
-      dst->texCoords[coordNum].y = (float)dst->color[1][1] / 255.0f;
-      dst->texCoords[coordNum].z = 1.0f;
-      break;
-    default:
-      ERROR_LOG(VIDEO, "Bad tex gen type %i", texinfo.texgentype.Value());
+  }
+  case LIGHTATTN_SPOT:
+  {
+    const __m128 dist2 = Dot(ldir, ldir);
+    const __m128 dist = _mm_sqrt_ps(dist2);
+    ldir = Scale(ldir, _mm_div_ps(_mm_set1_ps(1.0f), dist));
+    attn = MaxZero(Dot(ldir, Splat(light->dir)));
+
+    const __m128 cosAtt = _mm_add_ps(
+        _mm_add_ps(_mm_set1_ps(light->cosatt.x), _mm_mul_ps(_mm_set1_ps(light->cosatt.y), attn)),
+        _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(light->cosatt.z), attn), attn));
+    const __m128 distAtt = _mm_add_ps(
+        _mm_add_ps(_mm_set1_ps(light->distatt.x), _mm_mul_ps(_mm_set1_ps(light->distatt.y), dist)),
+        _mm_mul_ps(_mm_set1_ps(light->distatt.z), dist2));
+    attn = SafeDivide(MaxZero(cosAtt), distAtt);
+    break;
+  }
+  default:
+    PanicAlert("LightColor");
+  }
+
+  return attn;
+}
+
+static void LightColor(const Vec3x4& pos, const Vec3x4& normal, u8 lightNum,
+                       const LitChannel& chan, Vec3x4& lightCol)
+{
+  const LightPointer* light = (const LightPointer*)&xfmem.lights[lightNum];
+
+  Vec3x4 ldir = Subtract(Splat(light->pos), pos);
+  __m128 attn = CalculateLightAttn(light, &ldir, normal, chan);
+
+  __m128 difAttn = Dot(ldir, normal);
+  switch (chan.diffusefunc)
+  {
+  case LIGHTDIF_NONE:
+    AddScaledIntegerColor(light->color, attn, lightCol);
+    break;
+  case LIGHTDIF_SIGN:
+    AddScaledIntegerColor(light->color, _mm_mul_ps(attn, difAttn), lightCol);
+    break;
+  case LIGHTDIF_CLAMP:
+    difAttn = MaxZero(difAttn);
+    AddScaledIntegerColor(light->color, _mm_mul_ps(attn, difAttn), lightCol);
+    break;
+  default:
+    ASSERT(0);
+  }
+}
+
+static void LightAlpha(const Vec3x4& pos, const Vec3x4& normal, u8 lightNum,
+                       const LitChannel& chan, __m128& lightCol)
+{
+  const LightPointer* light = (const LightPointer*)&xfmem.lights[lightNum];
+
+  Vec3x4 ldir = Subtract(Splat(light->pos), pos);
+  __m128 attn = CalculateLightAttn(light, &ldir, normal, chan);
+
+  __m128 difAttn = Dot(ldir, normal);
+  const __m128 color = _mm_set1_ps(light->color[0]);
+  switch (chan.diffusefunc)
+  {
+  case LIGHTDIF_NONE:
+    lightCol = _mm_add_ps(lightCol, _mm_mul_ps(color, attn));
+    break;
+  case LIGHTDIF_SIGN:
+    lightCol = _mm_add_ps(lightCol, _mm_mul_ps(_mm_mul_ps(color, attn), difAttn));
+    break;
+  case LIGHTDIF_CLAMP:
+    difAttn = MaxZero(difAttn);
+    lightCol = _mm_add_ps(lightCol, _mm_mul_ps(_mm_mul_ps(color, attn), difAttn));
+    break;
+  default:
+    ASSERT(0);
+  }
+}
+
+static void TransformColors(const InputVertexData* src, OutputVertexData* dst,
+                            const Vec3x4& mvPosition, const Vec3x4& normal)
+{
+  for (u32 chan = 0; chan < NUM_XF_COLOR_CHANNELS; chan++)
+  {
+    Vec3x4 lightCol = Splat(Vec3(0.0f));
+    const LitChannel& colorchan = xfmem.color[chan];
+    if (colorchan.enablelighting)
+    {
+      lightCol = Load([&](u32 lane) { return GetAmbientColor(&src[lane], chan); });
+
+      u8 mask = colorchan.GetFullLightMask();
+      for (int i = 0; i < 8; ++i)
+      {
+        if (mask & (1 << i))
+          LightColor(mvPosition, normal, i, colorchan, lightCol);
+      }
     }
+
+    __m128 lightAlpha = _mm_setzero_ps();
+    const LitChannel& alphachan = xfmem.alpha[chan];
+    if (alphachan.enablelighting)
+    {
+      lightAlpha = _mm_setr_ps(GetAmbientAlpha(&src[0], chan), GetAmbientAlpha(&src[1], chan),
+                               GetAmbientAlpha(&src[2], chan), GetAmbientAlpha(&src[3], chan));
+
+      u8 mask = alphachan.GetFullLightMask();
+      for (int i = 0; i < 8; ++i)
+      {
+        if (mask & (1 << i))
+          LightAlpha(mvPosition, normal, i, alphachan, lightAlpha);
+      }
+    }
+
+    Vec3 lightCols[BATCH_SIZE];
+    Store(lightCol, [&](u32 lane) -> Vec3& { return lightCols[lane]; });
+    alignas(16) float lightAlphas[BATCH_SIZE];
+    _mm_store_ps(lightAlphas, lightAlpha);
+    for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+      CombineColor(&src[lane], chan, lightCols[lane], lightAlphas[lane], &dst[lane]);
   }
+}
+
+static void TransformBatch(const InputVertexData* src, OutputVertexData* dst, bool normals,
+                           bool nbt, bool specialCase)
+{
+  Vec3x4 mvPosition;
+  TransformPositions(src, dst, &mvPosition);
+
+  Vec3x4 normal = Splat(Vec3(0.0f));
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+    dst[lane].normal.fill(Vec3(0.0f));
+  if (normals)
+    TransformNormals(src, nbt, dst, &normal);
+
+  TransformColors(src, dst, mvPosition, normal);
 
   for (u32 coordNum = 0; coordNum < xfmem.numTexGen.numTexGens; coordNum++)
   {
-    dst->texCoords[coordNum][0] *= (bpmem.texcoords[coordNum].s.scale_minus_1 + 1);
-    dst->texCoords[coordNum][1] *= (bpmem.texcoords[coordNum].t.scale_minus_1 + 1);
+    const TexMtxInfo& texinfo = xfmem.texMtxInfo[coordNum];
+    if (texinfo.texgentype == XF_TEXGEN_REGULAR)
+    {
+      TransformTexCoordsRegular(texinfo, coordNum, specialCase, src, dst);
+    }
+    else
+    {
+      for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+        TransformTexGen(texinfo, coordNum, specialCase, &src[lane], &dst[lane]);
+    }
   }
+
+  for (u32 lane = 0; lane < BATCH_SIZE; lane++)
+    ScaleTexCoords(&dst[lane]);
+}
+#endif
+
+void TransformVertices(const InputVertexData* src, OutputVertexData* dst, u32 count, bool normals,
+                       bool nbt, bool specialCase)
+{
+  u32 i = 0;
+#ifdef _M_X86_64
+  for (; i + BATCH_SIZE <= count; i += BATCH_SIZE)
+    TransformBatch(&src[i], &dst[i], normals, nbt, specialCase);
+#endif
+  for (; i < count; i++)
+    TransformVertex(&src[i], &dst[i], normals, nbt, specialCase);
 }
 }
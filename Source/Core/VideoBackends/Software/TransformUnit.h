@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include "Common/CommonTypes.h"
+
 struct InputVertexData;
 struct OutputVertexData;
 
@@ -13,4 +15,9 @@ void TransformPosition(const InputVertexData* src, OutputVertexData* dst);
 void TransformNormal(const InputVertexData* src, bool nbt, OutputVertexData* dst);
 void TransformColor(const InputVertexData* src, OutputVertexData* dst);
 void TransformTexCoord(const InputVertexData* src, OutputVertexData* dst, bool specialCase);
+
+// Transforms count vertices like the functions above. On x86-64, four vertices at a time are
+// transformed together with SSE.
+void TransformVertices(const InputVertexData* src, OutputVertexData* dst, u32 count, bool normals,
+                       bool nbt, bool specialCase);
 }
@@ -98,11 +98,8 @@ void TextureCache::ConvertTexture(TCacheEntry* destination, TCacheEntry* source,
                            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
-void TextureCache::CopyEFB(u8* dst, const EFBCopyParams& params, u32 native_width,
-                           u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride,
-                           const EFBRectangle& src_rect, bool scale_by_half, float y_scale,
-                           float gamma, bool clamp_top, bool clamp_bottom,
-                           const CopyFilterCoefficientArray& filter_coefficients)
+Texture2D* TextureCache::PrepareEFBForEncoding(bool depth, const EFBRectangle& src_rect,
+                                               VkImageLayout* original_layout)
 {
   // Flush EFB pokes first, as they're expected to be included.
   FramebufferManager::GetInstance()->FlushEFBPokes();
@@ -117,7 +114,7 @@ void TextureCache::CopyEFB(u8* dst, const EFBCopyParams& params, u32 native_widt
   region = Util::ClampRect2D(region, FramebufferManager::GetInstance()->GetEFBWidth(),
                              FramebufferManager::GetInstance()->GetEFBHeight());
   Texture2D* src_texture;
-  if (params.depth)
+  if (depth)
     src_texture = FramebufferManager::GetInstance()->ResolveEFBDepthTexture(region);
   else
     src_texture = FramebufferManager::GetInstance()->ResolveEFBColorTexture(region);
@@ -129,9 +126,20 @@ void TextureCache::CopyEFB(u8* dst, const EFBCopyParams& params, u32 native_widt
   StateTracker::GetInstance()->OnReadback();
 
   // Transition to shader resource before reading.
-  VkImageLayout original_layout = src_texture->GetLayout();
+  *original_layout = src_texture->GetLayout();
   src_texture->TransitionToLayout(g_command_buffer_mgr->GetCurrentCommandBuffer(),
                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  return src_texture;
+}
+
+void TextureCache::CopyEFB(u8* dst, const EFBCopyParams& params, u32 native_width,
+                           u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride,
+                           const EFBRectangle& src_rect, bool scale_by_half, float y_scale,
+                           float gamma, bool clamp_top, bool clamp_bottom,
+                           const CopyFilterCoefficientArray& filter_coefficients)
+{
+  VkImageLayout original_layout;
+  Texture2D* src_texture = PrepareEFBForEncoding(params.depth, src_rect, &original_layout);
 
   m_texture_converter->EncodeTextureToMemory(
       src_texture->GetView(), dst, params, native_width, bytes_per_row, num_blocks_y, memory_stride,
@@ -141,6 +149,24 @@ void TextureCache::CopyEFB(u8* dst, const EFBCopyParams& params, u32 native_widt
   src_texture->TransitionToLayout(g_command_buffer_mgr->GetCurrentCommandBuffer(), original_layout);
 }
 
+void TextureCache::CopyEFBToStagingTexture(AbstractStagingTexture* dst,
+                                           const EFBCopyParams& params, u32 native_width,
+                                           u32 bytes_per_row, u32 num_blocks_y,
+                                           const EFBRectangle& src_rect, bool scale_by_half,
+                                           float y_scale, float gamma, bool clamp_top,
+                                           bool clamp_bottom,
+                                           const CopyFilterCoefficientArray& filter_coefficients)
+{
+  VkImageLayout original_layout;
+  Texture2D* src_texture = PrepareEFBForEncoding(params.depth, src_rect, &original_layout);
+
+  m_texture_converter->EncodeTextureToStagingTexture(
+      src_texture->GetView(), dst, params, native_width, bytes_per_row, num_blocks_y, src_rect,
+      scale_by_half, y_scale, gamma, clamp_top, clamp_bottom, filter_coefficients);
+
+  src_texture->TransitionToLayout(g_command_buffer_mgr->GetCurrentCommandBuffer(), original_layout);
+}
+
 bool TextureCache::SupportsGPUTextureDecode(TextureFormat format, TLUTFormat palette_format)
 {
   return m_texture_converter->SupportsTextureDecoding(format, palette_format);
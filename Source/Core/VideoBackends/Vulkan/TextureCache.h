@@ -41,6 +41,12 @@ public:
                bool scale_by_half, float y_scale, float gamma, bool clamp_top, bool clamp_bottom,
                const CopyFilterCoefficientArray& filter_coefficients) override;
 
+  void CopyEFBToStagingTexture(AbstractStagingTexture* dst, const EFBCopyParams& params,
+                               u32 native_width, u32 bytes_per_row, u32 num_blocks_y,
+                               const EFBRectangle& src_rect, bool scale_by_half, float y_scale,
+                               float gamma, bool clamp_top, bool clamp_bottom,
+                               const CopyFilterCoefficientArray& filter_coefficients) override;
+
   bool SupportsGPUTextureDecode(TextureFormat format, TLUTFormat palette_format) override;
 
   void DecodeTextureOnGPU(TCacheEntry* entry, u32 dst_level, const u8* data, size_t data_size,
@@ -52,6 +58,11 @@ public:
   StreamBuffer* GetTextureUploadBuffer() const;
 
 private:
+  // Resolves the EFB for a copy to RAM and makes it readable by shaders. Returns the texture and
+  // the layout to restore afterwards.
+  Texture2D* PrepareEFBForEncoding(bool depth, const EFBRectangle& src_rect,
+                                   VkImageLayout* original_layout);
+
   void CopyEFBToCacheEntry(TCacheEntry* entry, bool is_depth_copy, const EFBRectangle& src_rect,
                            bool scale_by_half, EFBCopyFormat dst_format, bool is_intensity,
                            float gamma, bool clamp_top, bool clamp_bottom,
@@ -211,6 +211,20 @@ void TextureConverter::EncodeTextureToMemory(
     u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride, const EFBRectangle& src_rect,
     bool scale_by_half, float y_scale, float gamma, bool clamp_top, bool clamp_bottom,
     const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients)
+{
+  EncodeTextureToStagingTexture(src_texture, m_encoding_readback_texture.get(), params,
+                                native_width, bytes_per_row, num_blocks_y, src_rect, scale_by_half,
+                                y_scale, gamma, clamp_top, clamp_bottom, filter_coefficients);
+
+  MathUtil::Rectangle<int> copy_rect(0, 0, bytes_per_row / sizeof(u32), num_blocks_y);
+  m_encoding_readback_texture->ReadTexels(copy_rect, dest_ptr, memory_stride);
+}
+
+void TextureConverter::EncodeTextureToStagingTexture(
+    VkImageView src_texture, AbstractStagingTexture* dst, const EFBCopyParams& params,
+    u32 native_width, u32 bytes_per_row, u32 num_blocks_y, const EFBRectangle& src_rect,
+    bool scale_by_half, float y_scale, float gamma, bool clamp_top, bool clamp_bottom,
+    const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients)
 {
   VkShaderModule shader = GetEncodingShader(params);
   if (shader == VK_NULL_HANDLE)
@@ -273,9 +287,7 @@ void TextureConverter::EncodeTextureToMemory(
   draw.EndRenderPass();
 
   MathUtil::Rectangle<int> copy_rect(0, 0, render_width, render_height);
-  m_encoding_readback_texture->CopyFromTexture(m_encoding_render_texture.get(), copy_rect, 0, 0,
-                                               copy_rect);
-  m_encoding_readback_texture->ReadTexels(copy_rect, dest_ptr, memory_stride);
+  dst->CopyFromTexture(m_encoding_render_texture.get(), copy_rect, 0, 0, copy_rect);
 }
 
 bool TextureConverter::SupportsTextureDecoding(TextureFormat format, TLUTFormat palette_format)
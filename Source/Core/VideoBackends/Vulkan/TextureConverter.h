@@ -47,6 +47,14 @@ public:
                         float gamma, bool clamp_top, bool clamp_bottom,
                         const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients);
 
+  // Like EncodeTextureToMemory, but leaves the encoded rows in dst instead of reading them back.
+  // Doesn't execute the command buffer.
+  void EncodeTextureToStagingTexture(
+      VkImageView src_texture, AbstractStagingTexture* dst, const EFBCopyParams& params,
+      u32 native_width, u32 bytes_per_row, u32 num_blocks_y, const EFBRectangle& src_rect,
+      bool scale_by_half, float y_scale, float gamma, bool clamp_top, bool clamp_bottom,
+      const TextureCacheBase::CopyFilterCoefficientArray& filter_coefficients);
+
   bool SupportsTextureDecoding(TextureFormat format, TLUTFormat palette_format);
   void DecodeTexture(VkCommandBuffer command_buffer, TextureCache::TCacheEntry* entry,
                      u32 dst_level, const u8* data, size_t data_size, TextureFormat format,
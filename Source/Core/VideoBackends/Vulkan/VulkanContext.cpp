@@ -248,6 +248,8 @@ void VulkanContext::PopulateBackendInfo(VideoConfig* config)
   config->backend_info.bSupportsReversedDepthRange = false;  // No support yet due to driver bugs.
   config->backend_info.bSupportsLogicOp = false;             // Dependent on features.
   config->backend_info.bSupportsCopyToVram = true;           // Assumed support.
+  config->backend_info.bSupportsEFBPeekCache = true;         // Assumed support.
+  config->backend_info.bSupportsDeferredEFBCopies = true;    // Assumed support.
   config->backend_info.bSupportsFramebufferFetch = false;
 }
 
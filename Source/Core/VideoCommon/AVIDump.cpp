@@ -6,6 +6,7 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -20,6 +21,7 @@ extern "C" {
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/WorkerPool.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/SystemTimers.h"
@@ -27,6 +29,7 @@ extern "C" {
 #include "Core/Movie.h"
 
 #include "VideoCommon/AVIDump.h"
+#include "VideoCommon/FrameDumpConversion.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -53,6 +56,10 @@ static int s_file_index = 0;
 static int s_savestate_index = 0;
 static int s_last_savestate_index = 0;
 
+// Converts the frames to YUV in bands of rows, while the encoder works on the previous frames
+static Common::WorkerPool s_conversion_pool;
+static constexpr int CONVERSION_BAND_HEIGHT = 64;
+
 static void InitAVCodec()
 {
   static bool first_run = true;
@@ -196,6 +203,10 @@ bool AVIDump::CreateVideoFile()
   if (output_format->flags & AVFMT_GLOBALHEADER)
     s_codec_context->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
 
+  // Let the encoder work on several frames at once, or on slices of a frame, if it can.
+  s_codec_context->thread_count = 0;
+  s_codec_context->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+
   if (avcodec_open2(s_codec_context, codec, nullptr) < 0)
   {
     ERROR_LOG(VIDEO, "Could not open codec");
@@ -224,6 +235,9 @@ bool AVIDump::CreateVideoFile()
     return false;
   }
 
+  if (s_conversion_pool.GetThreadCount() == 0)
+    s_conversion_pool.Reset(Common::WorkerPool::GetDefaultThreadCount(), "Frame Dump Conversion");
+
   NOTICE_LOG(VIDEO, "Opening file %s for dumping", dump_path.c_str());
   if (avio_open(&s_format_context->pb, dump_path.c_str(), AVIO_FLAG_WRITE) < 0 ||
       avformat_write_header(s_format_context, nullptr))
@@ -312,14 +326,40 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
   s_src_frame->width = s_width;
   s_src_frame->height = s_height;
 
-  // Convert image from {BGR24, RGBA} to desired pixel format
-  s_sws_context =
-      sws_getCachedContext(s_sws_context, width, height, s_pix_fmt, s_width, s_height,
-                           s_codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
-  if (s_sws_context)
+#if LIBAVCODEC_VERSION_MAJOR >= 55
+  // The encoder may still reference the previous frame, if it works on several frames at once.
+  if (av_frame_make_writable(s_scaled_frame) < 0)
+  {
+    ERROR_LOG(VIDEO, "Could not allocate a frame to encode");
+    return;
+  }
+#endif
+
+  if (s_codec_context->pix_fmt == AV_PIX_FMT_YUV420P && width == s_width && height == s_height)
   {
-    sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, height,
-              s_scaled_frame->data, s_scaled_frame->linesize);
+    // The common case, converted by us in parallel
+    const FrameDumpConversion::YUV420Planes planes = {
+        s_scaled_frame->data[0],     s_scaled_frame->data[1],     s_scaled_frame->data[2],
+        s_scaled_frame->linesize[0], s_scaled_frame->linesize[1], s_scaled_frame->linesize[2]};
+    const u32 num_bands = (height + CONVERSION_BAND_HEIGHT - 1) / CONVERSION_BAND_HEIGHT;
+    s_conversion_pool.ParallelFor(num_bands, [&](u32 band) {
+      const int first_row = static_cast<int>(band) * CONVERSION_BAND_HEIGHT;
+      FrameDumpConversion::ConvertRGBAToYUV420(data, stride, width, height, planes, first_row,
+                                               std::min(first_row + CONVERSION_BAND_HEIGHT,
+                                                        height));
+    });
+  }
+  else
+  {
+    // Convert image from {BGR24, RGBA} to desired pixel format
+    s_sws_context =
+        sws_getCachedContext(s_sws_context, width, height, s_pix_fmt, s_width, s_height,
+                             s_codec_context->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr);
+    if (s_sws_context)
+    {
+      sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, height,
+                s_scaled_frame->data, s_scaled_frame->linesize);
+    }
   }
 
   // Encode and write the image.
@@ -391,6 +431,7 @@ void AVIDump::Stop()
   HandleDelayedPackets();
   av_write_trailer(s_format_context);
   CloseVideoFile();
+  s_conversion_pool.Shutdown();
   s_file_index = 0;
   NOTICE_LOG(VIDEO, "Stopping frame dump");
   OSD::AddMessage("Stopped dumping frames");
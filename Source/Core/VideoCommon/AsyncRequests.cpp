@@ -5,8 +5,10 @@
 #include <mutex>
 
 #include "VideoCommon/AsyncRequests.h"
+#include "VideoCommon/EFBPeekCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoCommon.h"
@@ -52,6 +54,7 @@ void AsyncRequests::PullEventsInternal()
 
       lock.unlock();
       g_renderer->PokeEFB(t, m_merged_efb_pokes.data(), m_merged_efb_pokes.size());
+      EFBPeekCache::Invalidate();
       lock.lock();
       continue;
     }
@@ -119,6 +122,7 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
   {
     EfbPokeData poke = {e.efb_poke.x, e.efb_poke.y, e.efb_poke.data};
     g_renderer->PokeEFB(EFBAccessType::PokeColor, &poke, 1);
+    EFBPeekCache::Invalidate();
   }
   break;
 
@@ -126,6 +130,7 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
   {
     EfbPokeData poke = {e.efb_poke.x, e.efb_poke.y, e.efb_poke.data};
     g_renderer->PokeEFB(EFBAccessType::PokeZ, &poke, 1);
+    EFBPeekCache::Invalidate();
   }
   break;
 
@@ -138,6 +143,10 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
     *e.efb_peek.data = g_renderer->AccessEFB(EFBAccessType::PeekZ, e.efb_peek.x, e.efb_peek.y, 0);
     break;
 
+  case Event::EFB_PEEK_TILES:
+    EFBPeekCache::ReadRequestedTiles();
+    break;
+
   case Event::SWAP_EVENT:
     g_renderer->Swap(e.swap_event.xfbAddr, e.swap_event.fbWidth, e.swap_event.fbStride,
                      e.swap_event.fbHeight, rc, e.time);
@@ -150,6 +159,11 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
   case Event::PERF_QUERY:
     g_perf_query->FlushResults();
     break;
+
+  case Event::FLUSH_EFB_COPIES:
+    if (g_texture_cache)
+      g_texture_cache->FlushEFBCopies(e.flush_efb_copies.address, e.flush_efb_copies.size);
+    break;
   }
 }
 
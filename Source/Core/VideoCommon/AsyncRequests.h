@@ -25,9 +25,11 @@ public:
       EFB_POKE_Z,
       EFB_PEEK_COLOR,
       EFB_PEEK_Z,
+      EFB_PEEK_TILES,
       SWAP_EVENT,
       BBOX_READ,
       PERF_QUERY,
+      FLUSH_EFB_COPIES,
     } type;
     u64 time;
 
@@ -64,6 +66,12 @@ public:
       struct
       {
       } perf_query;
+
+      struct
+      {
+        u32 address;
+        u32 size;
+      } flush_efb_copies;
     };
   };
 
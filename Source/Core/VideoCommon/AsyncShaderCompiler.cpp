@@ -3,9 +3,15 @@
 // Refer to the license.txt file included.
 
 #include "VideoCommon/AsyncShaderCompiler.h"
+
+#include <algorithm>
+#include <cinttypes>
 #include <thread>
+
 #include "Common/Assert.h"
 #include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
+#include "Common/StringUtil.h"
 
 namespace VideoCommon
 {
@@ -20,33 +26,81 @@ AsyncShaderCompiler::~AsyncShaderCompiler()
   ASSERT(!HasWorkerThreads());
 }
 
-void AsyncShaderCompiler::QueueWorkItem(WorkItemPtr item, u32 priority)
+bool AsyncShaderCompiler::QueueWorkItem(WorkItemPtr item, u32 priority, WorkItemKey key)
 {
-  // If no worker threads are available, compile synchronously.
-  if (!HasWorkerThreads())
-  {
-    item->Compile();
-    m_completed_work.push_back(std::move(item));
-  }
-  else
+  PendingWorkItem work = {std::move(item), key, Clock::now()};
   {
     std::lock_guard<std::mutex> guard(m_pending_work_lock);
-    m_pending_work.emplace(priority, std::move(item));
-    m_worker_thread_wake.notify_one();
+    if (key)
+    {
+      const auto iter = m_pending_keys.find(key);
+      if (iter != m_pending_keys.end() || m_active_keys.count(key))
+      {
+        m_merged_items++;
+        if (iter != m_pending_keys.end() && priority < iter->second->first)
+          BoostPendingWorkItem(iter, priority);
+        return false;
+      }
+    }
+
+    if (HasWorkerThreads())
+    {
+      const auto iter = m_pending_work.emplace(priority, std::move(work));
+      if (key)
+        m_pending_keys.emplace(key, iter);
+      m_worker_thread_wake.notify_one();
+      return true;
+    }
+
+    if (key)
+      m_active_keys.insert(key);
   }
+
+  // If no worker threads are available, compile synchronously.
+  CompileWorkItem(std::move(work));
+  return true;
+}
+
+bool AsyncShaderCompiler::BoostWorkItem(WorkItemKey key, u32 priority)
+{
+  std::lock_guard<std::mutex> guard(m_pending_work_lock);
+  const auto iter = m_pending_keys.find(key);
+  if (iter == m_pending_keys.end())
+    return false;
+
+  if (priority < iter->second->first)
+    BoostPendingWorkItem(iter, priority);
+  return true;
+}
+
+void AsyncShaderCompiler::BoostPendingWorkItem(PendingKeyMap::iterator iter, u32 priority)
+{
+  auto node = m_pending_work.extract(iter->second);
+  node.key() = priority;
+  iter->second = m_pending_work.insert(std::move(node));
+  m_boosted_items++;
 }
 
 void AsyncShaderCompiler::RetrieveWorkItems()
 {
-  std::deque<WorkItemPtr> completed_work;
+  std::deque<CompletedWorkItem> completed_work;
   {
     std::lock_guard<std::mutex> guard(m_completed_work_lock);
     m_completed_work.swap(completed_work);
   }
+  if (completed_work.empty())
+    return;
+
+  // Release the keys first, so that the work items can queue themselves again.
+  {
+    std::lock_guard<std::mutex> guard(m_pending_work_lock);
+    for (const CompletedWorkItem& work : completed_work)
+      m_active_keys.erase(work.key);
+  }
 
   while (!completed_work.empty())
   {
-    completed_work.front()->Retrieve();
+    completed_work.front().item->Retrieve();
     completed_work.pop_front();
   }
 }
@@ -63,6 +117,30 @@ bool AsyncShaderCompiler::HasCompletedWork()
   return !m_completed_work.empty();
 }
 
+void AsyncShaderCompiler::CancelWorkItems()
+{
+  {
+    std::lock_guard<std::mutex> guard(m_pending_work_lock);
+    m_cancelled_items += m_pending_work.size();
+    m_pending_work.clear();
+    m_pending_keys.clear();
+  }
+
+  // Work items which are being compiled can't be interrupted, so wait for them to complete.
+  while (m_busy_workers.load() != 0)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  std::deque<CompletedWorkItem> completed_work;
+  {
+    std::lock_guard<std::mutex> guard(m_completed_work_lock);
+    m_completed_work.swap(completed_work);
+  }
+  m_cancelled_items += completed_work.size();
+
+  std::lock_guard<std::mutex> guard(m_pending_work_lock);
+  m_active_keys.clear();
+}
+
 void AsyncShaderCompiler::WaitUntilCompletion()
 {
   while (HasPendingWork())
@@ -214,21 +292,24 @@ void AsyncShaderCompiler::WorkerThreadRun()
   std::unique_lock<std::mutex> pending_lock(m_pending_work_lock);
   while (!m_exit_flag.IsSet())
   {
-    m_worker_thread_wake.wait(pending_lock);
+    // Work may have been queued before this thread started waiting.
+    m_worker_thread_wake.wait(pending_lock,
+                              [this] { return !m_pending_work.empty() || m_exit_flag.IsSet(); });
 
     while (!m_pending_work.empty() && !m_exit_flag.IsSet())
     {
       m_busy_workers++;
       auto iter = m_pending_work.begin();
-      WorkItemPtr item(std::move(iter->second));
+      PendingWorkItem work(std::move(iter->second));
       m_pending_work.erase(iter);
-      pending_lock.unlock();
-
-      if (item->Compile())
+      if (work.key)
       {
-        std::lock_guard<std::mutex> completed_guard(m_completed_work_lock);
-        m_completed_work.push_back(std::move(item));
+        m_pending_keys.erase(work.key);
+        m_active_keys.insert(work.key);
       }
+      pending_lock.unlock();
+
+      CompileWorkItem(std::move(work));
 
       pending_lock.lock();
       m_busy_workers--;
@@ -236,4 +317,68 @@ void AsyncShaderCompiler::WorkerThreadRun()
   }
 }
 
+void AsyncShaderCompiler::CompileWorkItem(PendingWorkItem work)
+{
+  const Clock::time_point start_time = Clock::now();
+  AddTime(m_queue_time_histogram, start_time - work.queue_time);
+  const bool compiled = work.item->Compile();
+  AddTime(m_compile_time_histogram, Clock::now() - start_time);
+
+  if (compiled)
+  {
+    std::lock_guard<std::mutex> completed_guard(m_completed_work_lock);
+    m_completed_work.push_back({std::move(work.item), work.key});
+  }
+  else if (work.key)
+  {
+    std::lock_guard<std::mutex> pending_guard(m_pending_work_lock);
+    m_active_keys.erase(work.key);
+  }
+}
+
+void AsyncShaderCompiler::AddTime(Histogram& histogram, Clock::duration time)
+{
+  const u64 us =
+      static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+  const size_t bucket = us ? IntLog2(us) + 1 : 0;
+  histogram[std::min(bucket, histogram.size() - 1)]++;
+}
+
+std::string AsyncShaderCompiler::HistogramToString(const char* name, const Histogram& histogram)
+{
+  u64 total = 0;
+  for (const auto& bucket : histogram)
+    total += bucket.load();
+  if (!total)
+    return {};
+
+  std::string str = StringFromFormat("%s: %" PRIu64 "\n", name, total);
+  for (size_t i = 0; i < histogram.size(); i++)
+  {
+    const u64 count = histogram[i].load();
+    if (!count)
+      continue;
+
+    if (i + 1 == histogram.size())
+      str += StringFromFormat("  >= %u us: ", 1u << (i - 1));
+    else
+      str += StringFromFormat("   < %u us: ", 1u << i);
+    str += StringFromFormat("%" PRIu64 " (%.1f%%)\n", count, count * 100.0 / total);
+  }
+  return str;
+}
+
+std::string AsyncShaderCompiler::StatisticsToString() const
+{
+  std::string str = HistogramToString("Shader compiler queue times", m_queue_time_histogram);
+  str += HistogramToString("Shader compile times", m_compile_time_histogram);
+  if (str.empty())
+    return str;
+
+  str += StringFromFormat("Shader work items merged: %" PRIu64 ", boosted: %" PRIu64
+                          ", cancelled: %" PRIu64 "\n",
+                          m_merged_items.load(), m_boosted_items.load(), m_cancelled_items.load());
+  return str;
+}
+
 }  // namespace VideoCommon
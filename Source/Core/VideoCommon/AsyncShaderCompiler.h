@@ -4,14 +4,19 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -34,6 +39,10 @@ public:
 
   using WorkItemPtr = std::unique_ptr<WorkItem>;
 
+  // Identifies the shader or pipeline a work item produces. Only one work item per key is queued,
+  // compiled or waiting to be retrieved at a time. Work items without a key are never merged.
+  using WorkItemKey = const void*;
+
   AsyncShaderCompiler();
   virtual ~AsyncShaderCompiler();
 
@@ -45,11 +54,20 @@ public:
 
   // Queues a new work item to the compiler threads. The lower the priority, the sooner
   // this work item will be compiled, relative to the other work items.
-  void QueueWorkItem(WorkItemPtr item, u32 priority);
+  // If a work item with the same key is already in flight, the new one is dropped, and false is
+  // returned. A queued work item is boosted to the new priority if that one is lower.
+  bool QueueWorkItem(WorkItemPtr item, u32 priority, WorkItemKey key = nullptr);
+  // Moves a queued work item to the given priority if that is lower than its current one.
+  // Returns false if the work item isn't waiting to be compiled.
+  bool BoostWorkItem(WorkItemKey key, u32 priority);
   void RetrieveWorkItems();
   bool HasPendingWork();
   bool HasCompletedWork();
 
+  // Drops all queued and completed work items without retrieving them, after waiting for the
+  // work items which are being compiled. Work items must not be used after this returns.
+  void CancelWorkItems();
+
   // Simpler version without progress updates.
   void WaitUntilCompletion();
 
@@ -62,14 +80,44 @@ public:
   bool HasWorkerThreads() const;
   void StopWorkerThreads();
 
+  // How long work items waited in the queue and took to compile, as well as how many were
+  // merged, boosted and cancelled. Empty if nothing has been compiled.
+  std::string StatisticsToString() const;
+
 protected:
   virtual bool WorkerThreadInitMainThread(void** param);
   virtual bool WorkerThreadInitWorkerThread(void* param);
   virtual void WorkerThreadExit(void* param);
 
 private:
+  using Clock = std::chrono::steady_clock;
+
+  // Bucket i counts times of less than 2^i us, the last bucket everything longer.
+  using Histogram = std::array<std::atomic<u64>, 21>;
+
+  struct PendingWorkItem
+  {
+    WorkItemPtr item;
+    WorkItemKey key;
+    Clock::time_point queue_time;
+  };
+
+  struct CompletedWorkItem
+  {
+    WorkItemPtr item;
+    WorkItemKey key;
+  };
+
+  using PendingWorkMap = std::multimap<u32, PendingWorkItem>;
+  using PendingKeyMap = std::unordered_map<WorkItemKey, PendingWorkMap::iterator>;
+
   void WorkerThreadEntryPoint(void* param);
   void WorkerThreadRun();
+  void CompileWorkItem(PendingWorkItem work);
+  void BoostPendingWorkItem(PendingKeyMap::iterator iter, u32 priority);
+
+  static void AddTime(Histogram& histogram, Clock::duration time);
+  static std::string HistogramToString(const char* name, const Histogram& histogram);
 
   Common::Flag m_exit_flag;
   Common::Event m_init_event;
@@ -79,13 +127,23 @@ private:
 
   // A multimap is used to store the work items. We can't use a priority_queue here, because
   // there's no way to obtain a non-const reference, which we need for the unique_ptr.
-  std::multimap<u32, WorkItemPtr> m_pending_work;
+  PendingWorkMap m_pending_work;
+  // Keys of the queued work items, and of those being compiled or waiting to be retrieved.
+  // Guarded by m_pending_work_lock.
+  PendingKeyMap m_pending_keys;
+  std::unordered_set<WorkItemKey> m_active_keys;
   std::mutex m_pending_work_lock;
   std::condition_variable m_worker_thread_wake;
   std::atomic_size_t m_busy_workers{0};
 
-  std::deque<WorkItemPtr> m_completed_work;
+  std::deque<CompletedWorkItem> m_completed_work;
   std::mutex m_completed_work_lock;
+
+  Histogram m_queue_time_histogram{};
+  Histogram m_compile_time_histogram{};
+  std::atomic<u64> m_merged_items{0};
+  std::atomic<u64> m_boosted_items{0};
+  std::atomic<u64> m_cancelled_items{0};
 };
 
 }  // namespace VideoCommon
@@ -7,6 +7,7 @@
 
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/EFBPeekCache.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/RenderState.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -183,6 +184,7 @@ void ClearScreen(const EFBRectangle& rc)
       z = Z24ToZ16ToZ24(z);
     }
     g_renderer->ClearScreen(rc, colorEnable, alphaEnable, zEnable, color, z);
+    EFBPeekCache::Invalidate();
   }
 }
 
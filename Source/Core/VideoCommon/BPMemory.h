@@ -1104,5 +1104,7 @@ extern BPMemory bpmem;
 
 void LoadBPReg(u32 value0);
 void LoadBPRegPreprocess(u32 value0);
+// Returns true if LoadBPReg(value0) would neither change bpmem nor trigger any action.
+bool IsRedundantBPWrite(u32 value0);
 
 void GetBPRegInfo(const u8* data, std::string* name, std::string* desc);
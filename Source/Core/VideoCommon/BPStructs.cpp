@@ -21,6 +21,7 @@
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/EFBPeekCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/PerfQueryBase.h"
@@ -44,6 +45,29 @@ void BPInit()
   bpmem.bpMask = 0xFFFFFF;
 }
 
+// Writes to these registers start an action, so they have to be handled even if the value
+// doesn't change.
+static bool IsTriggerRegister(int address)
+{
+  switch (address)
+  {
+  case BPMEM_TRIGGER_EFB_COPY:
+  case BPMEM_CLEARBBOX1:
+  case BPMEM_CLEARBBOX2:
+  case BPMEM_SETDRAWDONE:
+  case BPMEM_PE_TOKEN_ID:
+  case BPMEM_PE_TOKEN_INT_ID:
+  case BPMEM_LOADTLUT0:
+  case BPMEM_LOADTLUT1:
+  case BPMEM_TEXINVALIDATE:
+  case BPMEM_PRELOAD_MODE:
+  case BPMEM_CLEAR_PIXEL_PERF:
+    return true;
+  default:
+    return false;
+  }
+}
+
 static void BPWritten(const BPCmd& bp)
 {
   /*
@@ -70,18 +94,8 @@ static void BPWritten(const BPCmd& bp)
   // check for invalid state, else unneeded configuration are built
   g_video_backend->CheckInvalidState();
 
-  if (((s32*)&bpmem)[bp.address] == bp.newvalue)
-  {
-    if (!(bp.address == BPMEM_TRIGGER_EFB_COPY || bp.address == BPMEM_CLEARBBOX1 ||
-          bp.address == BPMEM_CLEARBBOX2 || bp.address == BPMEM_SETDRAWDONE ||
-          bp.address == BPMEM_PE_TOKEN_ID || bp.address == BPMEM_PE_TOKEN_INT_ID ||
-          bp.address == BPMEM_LOADTLUT0 || bp.address == BPMEM_LOADTLUT1 ||
-          bp.address == BPMEM_TEXINVALIDATE || bp.address == BPMEM_PRELOAD_MODE ||
-          bp.address == BPMEM_CLEAR_PIXEL_PERF))
-    {
-      return;
-    }
-  }
+  if (((s32*)&bpmem)[bp.address] == bp.newvalue && !IsTriggerRegister(bp.address))
+    return;
 
   FlushPipeline();
 
@@ -306,6 +320,7 @@ static void BPWritten(const BPCmd& bp)
     if (!SConfig::GetInstance().bWii)
       addr = addr & 0x01FFFFFF;
 
+    g_texture_cache->FlushEFBCopies(addr, tlutXferCount);
     Memory::CopyFromEmu(texMem + tlutTMemAddr, addr, tlutXferCount);
 
     if (g_bRecordFifoData)
@@ -431,6 +446,9 @@ static void BPWritten(const BPCmd& bp)
 
   case BPMEM_ZCOMPARE:  // Set the Z-Compare and EFB pixel format
     OnPixelFormatChange();
+    // Peeks are converted to the pixel format.
+    if (bp.changes & 7)
+      EFBPeekCache::Invalidate();
     if (bp.changes & 7)
       SetBlendMode();  // dual source could be activated by changing to PIXELFMT_RGBA6_Z24
     PixelShaderManager::SetZModeControl();
@@ -507,10 +525,13 @@ static void BPWritten(const BPCmd& bp)
         if (tmem_addr_even + bytes_read > TMEM_SIZE)
           bytes_read = TMEM_SIZE - tmem_addr_even;
 
+        g_texture_cache->FlushEFBCopies(src_addr, bytes_read);
         Memory::CopyFromEmu(texMem + tmem_addr_even, src_addr, bytes_read);
       }
       else  // RGBA8 tiles (and CI14, but that might just be stupid libogc!)
       {
+        g_texture_cache->FlushEFBCopies(src_addr,
+                                        tmem_cfg.preload_tile_info.count * TMEM_LINE_SIZE * 2);
         u8* src_ptr = Memory::GetPointer(src_addr);
 
         // AR and GB tiles are stored in separate TMEM banks => can't use a single memcpy for
@@ -698,6 +719,16 @@ void LoadBPReg(u32 value0)
   BPWritten(bp);
 }
 
+bool IsRedundantBPWrite(u32 value0)
+{
+  // LoadBPReg resets a pending mask, which isn't a no-op.
+  if (bpmem.bpMask != 0xFFFFFF)
+    return false;
+
+  const int regNum = value0 >> 24;
+  return ((u32*)&bpmem)[regNum] == (value0 & 0xFFFFFF) && !IsTriggerRegister(regNum);
+}
+
 void LoadBPRegPreprocess(u32 value0)
 {
   int regNum = value0 >> 24;
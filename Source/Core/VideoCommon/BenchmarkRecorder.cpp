@@ -0,0 +1,194 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/BenchmarkRecorder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <utility>
+
+#include <picojson/picojson.h>
+
+#include "Common/CommonFuncs.h"
+#include "Common/Flag.h"
+#include "Common/Timer.h"
+
+namespace BenchmarkRecorder
+{
+static Common::Flag s_recording;
+static std::mutex s_mutex;
+static std::vector<Frame> s_frames;
+
+void Start()
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_frames.clear();
+  s_recording.Set();
+  StageTimings::SetBenchmarking(true);
+}
+
+std::vector<Frame> Stop()
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_recording.Clear();
+  StageTimings::SetBenchmarking(false);
+  return std::move(s_frames);
+}
+
+bool IsRecording()
+{
+  return s_recording.IsSet();
+}
+
+void OnFramePresented()
+{
+  if (!s_recording.IsSet())
+    return;
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  s_frames.push_back(
+      {Common::Timer::GetTimeUs(), stats.thisFrame, StageTimings::GetLastFrame().times});
+}
+
+namespace
+{
+struct Counter
+{
+  const char* name;
+  int Statistics::ThisFrame::*member;
+  // Display lists count their BP/CP/XF loads and primitives separately.
+  int Statistics::ThisFrame::*member_in_dl;
+};
+
+const Counter s_counters[] = {
+    {"fifo_bytes", &Statistics::ThisFrame::bytesFifoProcessed, nullptr},
+    {"bp_loads", &Statistics::ThisFrame::numBPLoads, &Statistics::ThisFrame::numBPLoadsInDL},
+    {"cp_loads", &Statistics::ThisFrame::numCPLoads, &Statistics::ThisFrame::numCPLoadsInDL},
+    {"xf_loads", &Statistics::ThisFrame::numXFLoads, &Statistics::ThisFrame::numXFLoadsInDL},
+    {"display_lists", &Statistics::ThisFrame::numDListsCalled, nullptr},
+    {"vertices", &Statistics::ThisFrame::numPrims, &Statistics::ThisFrame::numDLPrims},
+    {"primitive_joins", &Statistics::ThisFrame::numPrimitiveJoins, nullptr},
+    {"draw_calls", &Statistics::ThisFrame::numDrawCalls, nullptr},
+    {"shader_changes", &Statistics::ThisFrame::numShaderChanges, nullptr},
+    {"vertex_bytes_streamed", &Statistics::ThisFrame::bytesVertexStreamed, nullptr},
+    {"index_bytes_streamed", &Statistics::ThisFrame::bytesIndexStreamed, nullptr},
+    {"uniform_bytes_streamed", &Statistics::ThisFrame::bytesUniformStreamed, nullptr},
+    {"sw_vertices_loaded", &Statistics::ThisFrame::numVerticesLoaded, nullptr},
+    {"sw_triangles_in", &Statistics::ThisFrame::numTrianglesIn, nullptr},
+    {"sw_triangles_rejected", &Statistics::ThisFrame::numTrianglesRejected, nullptr},
+    {"sw_triangles_culled", &Statistics::ThisFrame::numTrianglesCulled, nullptr},
+    {"sw_triangles_clipped", &Statistics::ThisFrame::numTrianglesClipped, nullptr},
+    {"sw_triangles_drawn", &Statistics::ThisFrame::numTrianglesDrawn, nullptr},
+    {"sw_rasterized_pixels", &Statistics::ThisFrame::rasterizedPixels, nullptr},
+    {"sw_tev_pixels_in", &Statistics::ThisFrame::tevPixelsIn, nullptr},
+    {"sw_tev_pixels_out", &Statistics::ThisFrame::tevPixelsOut, nullptr},
+};
+
+double GetCount(const Counter& counter, const Statistics::ThisFrame& frame)
+{
+  double count = frame.*counter.member;
+  if (counter.member_in_dl)
+    count += frame.*counter.member_in_dl;
+  return count;
+}
+
+// Nearest-rank percentile of sorted values
+double Percentile(const std::vector<double>& sorted, double percent)
+{
+  const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * sorted.size()));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+}  // namespace
+
+Summary Summarize(const std::vector<Frame>& frames)
+{
+  Summary summary;
+  if (frames.size() < 2)
+    return summary;
+
+  std::vector<double> frame_times;
+  std::vector<StageTimings::Times> stage_times;
+  std::vector<double> totals(ArraySize(s_counters));
+  double fifo_bytes = 0.0;
+  double vertices = 0.0;
+  for (size_t i = 1; i < frames.size(); i++)
+  {
+    const Statistics::ThisFrame& frame = frames[i].stats;
+    frame_times.push_back((frames[i].end_time - frames[i - 1].end_time) / 1000.0);
+    stage_times.push_back(frames[i].stage_times);
+    for (size_t j = 0; j < totals.size(); j++)
+      totals[j] += GetCount(s_counters[j], frame);
+    fifo_bytes += frame.bytesFifoProcessed;
+    vertices += static_cast<double>(frame.numPrims) + frame.numDLPrims;
+  }
+
+  summary.num_frames = static_cast<u32>(frame_times.size());
+  summary.total_time = (frames.back().end_time - frames.front().end_time) / 1000000.0;
+  summary.frame_time_mean = summary.total_time * 1000.0 / summary.num_frames;
+
+  std::sort(frame_times.begin(), frame_times.end());
+  summary.frame_time_min = frame_times.front();
+  summary.frame_time_p50 = Percentile(frame_times, 50.0);
+  summary.frame_time_p90 = Percentile(frame_times, 90.0);
+  summary.frame_time_p99 = Percentile(frame_times, 99.0);
+  summary.frame_time_max = frame_times.back();
+
+  for (size_t j = 0; j < totals.size(); j++)
+    summary.averages.emplace_back(s_counters[j].name, totals[j] / summary.num_frames);
+  summary.stage_times = StageTimings::Summarize(stage_times);
+
+  if (summary.total_time > 0.0)
+  {
+    summary.frames_per_second = summary.num_frames / summary.total_time;
+    summary.fifo_bytes_per_second = fifo_bytes / summary.total_time;
+    summary.vertices_per_second = vertices / summary.total_time;
+  }
+
+  return summary;
+}
+
+std::string SummaryToJSON(const Summary& summary,
+                          const std::vector<std::pair<std::string, std::string>>& extra)
+{
+  picojson::object object;
+  for (const auto& entry : extra)
+    object[entry.first] = picojson::value(entry.second);
+
+  object["frames"] = picojson::value(static_cast<double>(summary.num_frames));
+  object["total_time_s"] = picojson::value(summary.total_time);
+  object["fps"] = picojson::value(summary.frames_per_second);
+  object["fifo_bytes_per_second"] = picojson::value(summary.fifo_bytes_per_second);
+  object["vertices_per_second"] = picojson::value(summary.vertices_per_second);
+
+  picojson::object frame_time;
+  frame_time["mean"] = picojson::value(summary.frame_time_mean);
+  frame_time["min"] = picojson::value(summary.frame_time_min);
+  frame_time["p50"] = picojson::value(summary.frame_time_p50);
+  frame_time["p90"] = picojson::value(summary.frame_time_p90);
+  frame_time["p99"] = picojson::value(summary.frame_time_p99);
+  frame_time["max"] = picojson::value(summary.frame_time_max);
+  object["frame_time_ms"] = picojson::value(frame_time);
+
+  picojson::object per_frame;
+  for (const auto& average : summary.averages)
+    per_frame[average.first] = picojson::value(average.second);
+  object["per_frame"] = picojson::value(per_frame);
+
+  picojson::object stage_times;
+  for (const StageTimings::StageSummary& stage : summary.stage_times)
+  {
+    picojson::object times;
+    times["mean"] = picojson::value(stage.mean);
+    times["p50"] = picojson::value(stage.p50);
+    times["p90"] = picojson::value(stage.p90);
+    times["p99"] = picojson::value(stage.p99);
+    times["max"] = picojson::value(stage.max);
+    stage_times[stage.name] = picojson::value(times);
+  }
+  object["stage_time_ms"] = picojson::value(stage_times);
+
+  return picojson::value(object).serialize(true);
+}
+}
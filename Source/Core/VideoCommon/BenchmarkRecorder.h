@@ -0,0 +1,66 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/StageTimings.h"
+#include "VideoCommon/Statistics.h"
+
+// Records when each frame was presented and the statistics of the frame, for benchmarks
+namespace BenchmarkRecorder
+{
+struct Frame
+{
+  // In microseconds, from Common::Timer::GetTimeUs()
+  u64 end_time;
+  Statistics::ThisFrame stats;
+  StageTimings::Times stage_times;
+};
+
+void Start();
+// Stops recording and returns the frames presented since Start()
+std::vector<Frame> Stop();
+bool IsRecording();
+
+// Called by the renderer when a frame was presented, before the frame statistics are reset
+void OnFramePresented();
+
+struct Summary
+{
+  // The first frame only marks the start of the measurement, so it isn't counted.
+  u32 num_frames = 0;
+  double total_time = 0.0;  // seconds
+
+  // Frame times in milliseconds
+  double frame_time_mean = 0.0;
+  double frame_time_min = 0.0;
+  double frame_time_p50 = 0.0;
+  double frame_time_p90 = 0.0;
+  double frame_time_p99 = 0.0;
+  double frame_time_max = 0.0;
+
+  double frames_per_second = 0.0;
+  double fifo_bytes_per_second = 0.0;
+  double vertices_per_second = 0.0;
+
+  // The per-frame averages of the statistics, by name
+  std::vector<std::pair<std::string, double>> averages;
+
+  // The percentiles of the time spent in each stage of the video thread per frame
+  std::vector<StageTimings::StageSummary> stage_times;
+};
+
+Summary Summarize(const std::vector<Frame>& frames);
+
+// Returns the summary as a JSON object, with the per-frame averages of the statistics and the
+// stage times. The extra
+// strings are added to the object as they are, e.g. to name the backend.
+std::string SummaryToJSON(const Summary& summary,
+                          const std::vector<std::pair<std::string, std::string>>& extra);
+}
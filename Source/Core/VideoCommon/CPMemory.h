@@ -264,6 +264,8 @@ extern CPState g_preprocess_cp_state;
 
 // Might move this into its own file later.
 void LoadCPReg(u32 SubCmd, u32 Value, bool is_preprocess = false);
+// Returns true if LoadCPReg(SubCmd, Value) wouldn't change the main CP state.
+bool IsRedundantCPWrite(u32 SubCmd, u32 Value);
 
 // Fills memory with data from CP regs
 void FillCPMemoryArray(u32* memory);
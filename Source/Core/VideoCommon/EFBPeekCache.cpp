@@ -0,0 +1,161 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/EFBPeekCache.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "VideoCommon/AsyncRequests.h"
+#include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/RenderBase.h"
+#include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace EFBPeekCache
+{
+namespace
+{
+constexpr u32 TILE_SIZE = 64;
+constexpr u32 TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+constexpr u32 TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+
+struct Tile
+{
+  std::vector<u32> values;
+  // The generation and the alpha read mode the values were read in
+  u32 generation = 0;
+  u16 alpha_read_mode = 0;
+  // Set by the CPU thread for the GPU thread
+  bool requested = false;
+  // Whether the tile was peeked in the current generation, or in the last generation before that
+  // with any peeks
+  bool peeked = false;
+  bool peeked_before = false;
+};
+
+// Depth tiles, then color tiles
+std::array<std::array<Tile, TILES_X * TILES_Y>, 2> s_tiles;
+
+// Increased on the GPU thread whenever the EFB may have changed. Zero is never valid.
+std::atomic<u32> s_generation{1};
+// The generation of the last peek, CPU thread only
+u32 s_peek_generation = 0;
+
+Tile& GetTile(bool color, u32 x, u32 y)
+{
+  return s_tiles[color][(y / TILE_SIZE) * TILES_X + x / TILE_SIZE];
+}
+
+bool IsValid(const Tile& tile, bool color, u32 generation, u16 alpha_read_mode)
+{
+  return tile.generation == generation && (!color || tile.alpha_read_mode == alpha_read_mode);
+}
+}  // namespace
+
+void Init()
+{
+  for (auto& tiles : s_tiles)
+    tiles.fill(Tile());
+  s_peek_generation = 0;
+  Invalidate();
+}
+
+u32 Peek(EFBAccessType type, u32 x, u32 y)
+{
+  const u32 generation = s_generation.load();
+  const u16 alpha_read_mode = PixelEngine::GetAlphaReadMode().Hex;
+
+  if (generation != s_peek_generation)
+  {
+    for (auto& tiles : s_tiles)
+    {
+      for (Tile& tile : tiles)
+      {
+        tile.peeked_before = tile.peeked;
+        tile.peeked = false;
+      }
+    }
+    s_peek_generation = generation;
+  }
+
+  const bool color = type == EFBAccessType::PeekColor;
+  Tile& tile = GetTile(color, x, y);
+  if (!IsValid(tile, color, generation, alpha_read_mode))
+  {
+    tile.requested = true;
+    if (g_ActiveConfig.bEFBAccessPrefetch)
+    {
+      for (u32 i = 0; i < s_tiles.size(); i++)
+      {
+        for (Tile& other : s_tiles[i])
+        {
+          if (other.peeked_before && !IsValid(other, i != 0, generation, alpha_read_mode))
+            other.requested = true;
+        }
+      }
+    }
+
+    AsyncRequests::Event e;
+    e.type = AsyncRequests::Event::EFB_PEEK_TILES;
+    e.time = 0;
+    AsyncRequests::GetInstance()->PushEvent(e, true);
+
+    // The request is dropped while the GPU thread is shutting down.
+    if (tile.values.empty())
+      return 0;
+  }
+
+  tile.peeked = true;
+  return tile.values[(y % TILE_SIZE) * TILE_SIZE + x % TILE_SIZE];
+}
+
+void InvalidatePokedTile(EFBAccessType type, u32 x, u32 y)
+{
+  // The tile is requested again by the next peek, which the GPU thread handles after the poke.
+  GetTile(type == EFBAccessType::PokeColor, x, y).generation = 0;
+}
+
+void Invalidate()
+{
+  s_generation++;
+}
+
+void ReadRequestedTiles()
+{
+  const u32 generation = s_generation.load();
+  const u16 alpha_read_mode = PixelEngine::GetAlphaReadMode().Hex;
+
+  for (u32 i = 0; i < s_tiles.size(); i++)
+  {
+    const EFBAccessType type = i != 0 ? EFBAccessType::PeekColor : EFBAccessType::PeekZ;
+    for (u32 j = 0; j < s_tiles[i].size(); j++)
+    {
+      Tile& tile = s_tiles[i][j];
+      if (!tile.requested)
+        continue;
+
+      // The backends read back whole tiles on the first access, the other pixels come from their
+      // own caches.
+      const u32 left = (j % TILES_X) * TILE_SIZE;
+      const u32 top = (j / TILES_X) * TILE_SIZE;
+      const u32 width = std::min<u32>(TILE_SIZE, EFB_WIDTH - left);
+      const u32 height = std::min<u32>(TILE_SIZE, EFB_HEIGHT - top);
+      tile.values.resize(TILE_SIZE * TILE_SIZE);
+      for (u32 y = 0; y < height; y++)
+      {
+        for (u32 x = 0; x < width; x++)
+          tile.values[y * TILE_SIZE + x] = g_renderer->AccessEFB(type, left + x, top + y, 0);
+      }
+
+      tile.generation = generation;
+      tile.alpha_read_mode = alpha_read_mode;
+      tile.requested = false;
+    }
+  }
+}
+}
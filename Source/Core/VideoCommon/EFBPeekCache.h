@@ -0,0 +1,32 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+enum class EFBAccessType;
+
+// Keeps the EFB peeks of the CPU thread in tiles, so that only the first peek of a tile waits for
+// the GPU thread. The tiles stay valid until the EFB may have changed, e.g. by a draw.
+namespace EFBPeekCache
+{
+void Init();
+
+// CPU thread: returns the color or depth at the given EFB coordinates, like Renderer::AccessEFB.
+// The tile of the pixel is read if it isn't cached. With prefetching, the tiles which were peeked
+// before the last invalidation are read along with it.
+u32 Peek(EFBAccessType type, u32 x, u32 y);
+
+// CPU thread: has to be called when a poke of the pixel is queued. The GPU thread only invalidates
+// the cache once it did the poke, so a peek right after it could see the old value otherwise.
+void InvalidatePokedTile(EFBAccessType type, u32 x, u32 y);
+
+// GPU thread: has to be called whenever the contents of the EFB or the format of the peeks may
+// have changed.
+void Invalidate();
+
+// GPU thread: reads the tiles the CPU thread is waiting for.
+void ReadRequestedTiles();
+}
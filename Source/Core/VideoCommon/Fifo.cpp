@@ -4,17 +4,25 @@
 
 #include "VideoCommon/Fifo.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cinttypes>
 #include <cstring>
+#include <string>
 
 #include "Common/Assert.h"
 #include "Common/Atomic.h"
+#include "Common/AtomicWait.h"
 #include "Common/BlockingLoop.h"
 #include "Common/ChunkFile.h"
-#include "Common/Event.h"
 #include "Common/FPURoundMode.h"
+#include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
@@ -26,6 +34,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoBackendBase.h"
@@ -68,9 +77,20 @@ static u8* s_video_buffer_pp_read_ptr;
 // polls, it's just atomic.
 // - The pp_read_ptr is the CPU preprocessing version of the read_ptr.
 
-static std::atomic<int> s_sync_ticks;
+static std::atomic<s32> s_sync_ticks;
 static bool s_syncing_suspended;
-static Common::Event s_sync_wakeup_event;
+
+// In SyncGPU mode the CPU thread blocks on s_sync_ticks when it is too far ahead. The GPU thread
+// only has to notify it if it is actually asleep, which is what s_sync_waiters tracks.
+static std::atomic<s32> s_sync_waiters;
+
+// The GPU thread usually catches up within a few microseconds, so spin for a short while before
+// going to sleep. Each iteration yields, so this needn't be many.
+static constexpr int SYNC_SPIN_ITERATIONS = 100;
+
+// How long the CPU thread waited for the GPU thread in SyncGPU mode. Bucket i counts the waits
+// shorter than 2^i microseconds, the last one all longer waits.
+static std::array<std::atomic<u64>, 16> s_sync_wait_histogram;
 
 void DoState(PointerWrap& p)
 {
@@ -118,6 +138,9 @@ void Init()
   if (SConfig::GetInstance().bCPUThread)
     s_gpu_mainloop.Prepare();
   s_sync_ticks.store(0);
+  s_sync_waiters.store(0);
+  for (auto& bucket : s_sync_wait_histogram)
+    bucket.store(0);
 }
 
 void Shutdown()
@@ -125,6 +148,10 @@ void Shutdown()
   if (s_gpu_mainloop.IsRunning())
     PanicAlert("Fifo shutting down while active");
 
+  const std::string histogram = SyncGPUWaitHistogramToString();
+  if (!histogram.empty())
+    INFO_LOG(VIDEO, "%s", histogram.c_str());
+
   Common::FreeMemoryPages(s_video_buffer, FIFO_SIZE + 4);
   s_video_buffer = nullptr;
   s_video_buffer_write_ptr = nullptr;
@@ -288,6 +315,68 @@ void ResetVideoBuffer()
   s_fifo_aux_read_ptr = s_fifo_aux_data;
 }
 
+// Called by the GPU thread when s_sync_ticks dropped below iSyncGpuMaxDistance.
+static void WakeupCPUThread()
+{
+  // Both sides use sequentially consistent accesses: either we see the waiter here, or the
+  // waiter sees the updated s_sync_ticks before going to sleep.
+  if (s_sync_waiters.load() != 0)
+    Common::AtomicNotifyAll(s_sync_ticks);
+}
+
+// Blocks the CPU thread until the GPU thread is less than max_distance ticks behind.
+static void WaitForSyncTicks(int max_distance)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  bool caught_up = false;
+  for (int i = 0; i < SYNC_SPIN_ITERATIONS; i++)
+  {
+    caught_up = s_sync_ticks.load(std::memory_order_relaxed) < max_distance;
+    if (caught_up)
+      break;
+    Common::YieldCPU();
+  }
+
+  if (!caught_up)
+  {
+    s_sync_waiters.fetch_add(1);
+    for (s32 ticks = s_sync_ticks.load(); ticks >= max_distance; ticks = s_sync_ticks.load())
+      Common::AtomicWait(s_sync_ticks, ticks);
+    s_sync_waiters.fetch_sub(1);
+  }
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  const u64 us = static_cast<u64>(elapsed.count());
+  const size_t bucket = us ? IntLog2(us) + 1 : 0;
+  s_sync_wait_histogram[std::min(bucket, s_sync_wait_histogram.size() - 1)]++;
+}
+
+std::string SyncGPUWaitHistogramToString()
+{
+  u64 total = 0;
+  for (const auto& bucket : s_sync_wait_histogram)
+    total += bucket.load();
+  if (!total)
+    return {};
+
+  std::string str = StringFromFormat("SyncGPU waits: %" PRIu64 "\n", total);
+  for (size_t i = 0; i < s_sync_wait_histogram.size(); i++)
+  {
+    const u64 count = s_sync_wait_histogram[i].load();
+    if (!count)
+      continue;
+
+    if (i + 1 == s_sync_wait_histogram.size())
+      str += StringFromFormat("  >= %u us: ", 1u << (i - 1));
+    else
+      str += StringFromFormat("   < %u us: ", 1u << i);
+    str += StringFromFormat("%" PRIu64 " (%.1f%%)\n", count, count * 100.0 / total);
+  }
+  return str;
+}
+
 // Description: Main FIFO update loop
 // Purpose: Keep the Core HW updated about the CPU-GPU distance
 void RunGpuLoop()
@@ -299,9 +388,13 @@ void RunGpuLoop()
       [] {
         const SConfig& param = SConfig::GetInstance();
 
-        // Do nothing while paused
+        // Do nothing while paused, except for requests like reading back deferred EFB copies
+        // for savestates
         if (!s_emu_running_state.IsSet())
+        {
+          AsyncRequests::GetInstance()->PullEvents();
           return;
+        }
 
         if (s_use_deterministic_gpu_thread)
         {
@@ -364,7 +457,7 @@ void RunGpuLoop()
               int old = s_sync_ticks.fetch_sub(cyclesExecuted);
               if (old >= param.iSyncGpuMaxDistance &&
                   old - (int)cyclesExecuted < param.iSyncGpuMaxDistance)
-                s_sync_wakeup_event.Set();
+                WakeupCPUThread();
             }
 
             // This call is pretty important in DualCore mode and must be called in the FIFO Loop.
@@ -379,7 +472,7 @@ void RunGpuLoop()
           {
             int old = s_sync_ticks.exchange(0);
             if (old >= param.iSyncGpuMaxDistance)
-              s_sync_wakeup_event.Set();
+              WakeupCPUThread();
           }
 
           // The fifo is empty and it's unlikely we will get any more work in the near future.
@@ -389,6 +482,10 @@ void RunGpuLoop()
       },
       100);
 
+  // Nothing would read the deferred EFB copies back after this.
+  if (g_texture_cache)
+    g_texture_cache->FlushEFBCopies();
+
   AsyncRequests::GetInstance()->SetEnable(false);
   AsyncRequests::GetInstance()->SetPassthrough(true);
 }
@@ -555,7 +652,7 @@ static int WaitForGpuThread(int ticks)
 
   // Wait for GPU
   if (now >= param.iSyncGpuMaxDistance)
-    s_sync_wakeup_event.Wait();
+    WaitForSyncTicks(param.iSyncGpuMaxDistance);
 
   return GPU_TIME_SLOT_SIZE;
 }
@@ -5,6 +5,8 @@
 #pragma once
 
 #include <cstddef>
+#include <string>
+
 #include "Common/CommonTypes.h"
 
 class PointerWrap;
@@ -33,6 +35,10 @@ enum class SyncGPUReason
 // In deterministic GPU thread mode this waits for the GPU to be done with pending work.
 void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr = true);
 
+// Histogram of the time the CPU thread spent waiting for the GPU thread in SyncGPU mode.
+// Empty if it never had to wait.
+std::string SyncGPUWaitHistogramToString();
+
 void PushFifoAuxBuffer(const void* ptr, size_t size);
 void* PopFifoAuxBuffer(size_t size);
 
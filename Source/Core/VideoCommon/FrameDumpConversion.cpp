@@ -0,0 +1,186 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/FrameDumpConversion.h"
+
+#include <algorithm>
+
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+
+namespace FrameDumpConversion
+{
+// The coefficients are scaled by 256. The offsets include the rounding, and keep the intermediate
+// values positive and below 65536, so that the SIMD version can do the math in 16 bits.
+static u8 Luma(u32 r, u32 g, u32 b)
+{
+  return static_cast<u8>((66 * r + 129 * g + 25 * b + 0x1080) >> 8);
+}
+
+static u8 BlueDifference(u32 r, u32 g, u32 b)
+{
+  return static_cast<u8>((112 * b + 0x8080 - 38 * r - 74 * g) >> 8);
+}
+
+static u8 RedDifference(u32 r, u32 g, u32 b)
+{
+  return static_cast<u8>((112 * r + 0x8080 - 94 * g - 18 * b) >> 8);
+}
+
+// Converts the pixels of two rows from the even column first_x on. The chroma samples are
+// computed from the average of each 2x2 block, with the last column repeated for odd widths.
+static void ConvertRowPairGeneric(const u8* row0, const u8* row1, bool write_row1, int width,
+                                  int first_x, u8* y0, u8* y1, u8* u, u8* v)
+{
+  for (int x = first_x; x < width; x += 2)
+  {
+    const int x1 = std::min(x + 1, width - 1);
+    const u8* pixels[4] = {&row0[x * 4], &row0[x1 * 4], &row1[x * 4], &row1[x1 * 4]};
+
+    y0[x] = Luma(pixels[0][0], pixels[0][1], pixels[0][2]);
+    if (x1 != x)
+      y0[x1] = Luma(pixels[1][0], pixels[1][1], pixels[1][2]);
+    if (write_row1)
+    {
+      y1[x] = Luma(pixels[2][0], pixels[2][1], pixels[2][2]);
+      if (x1 != x)
+        y1[x1] = Luma(pixels[3][0], pixels[3][1], pixels[3][2]);
+    }
+
+    u32 sum[3] = {};
+    for (const u8* pixel : pixels)
+    {
+      for (int channel = 0; channel < 3; channel++)
+        sum[channel] += pixel[channel];
+    }
+    const u32 r = (sum[0] + 2) >> 2;
+    const u32 g = (sum[1] + 2) >> 2;
+    const u32 b = (sum[2] + 2) >> 2;
+    u[x / 2] = BlueDifference(r, g, b);
+    v[x / 2] = RedDifference(r, g, b);
+  }
+}
+
+#ifdef _M_X86_64
+// One channel of 8 pixels per vector, as 16 bit values
+struct RGB16
+{
+  __m128i r;
+  __m128i g;
+  __m128i b;
+};
+
+static RGB16 Load8(const u8* src)
+{
+  const __m128i mask = _mm_set1_epi32(0xff);
+  const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+  const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+
+  RGB16 result;
+  result.r = _mm_packs_epi32(_mm_and_si128(p0, mask), _mm_and_si128(p1, mask));
+  result.g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 8), mask),
+                             _mm_and_si128(_mm_srli_epi32(p1, 8), mask));
+  result.b = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(p0, 16), mask),
+                             _mm_and_si128(_mm_srli_epi32(p1, 16), mask));
+  return result;
+}
+
+static __m128i Luma(const RGB16& c)
+{
+  __m128i y = _mm_mullo_epi16(c.r, _mm_set1_epi16(66));
+  y = _mm_add_epi16(y, _mm_mullo_epi16(c.g, _mm_set1_epi16(129)));
+  y = _mm_add_epi16(y, _mm_mullo_epi16(c.b, _mm_set1_epi16(25)));
+  y = _mm_add_epi16(y, _mm_set1_epi16(0x1080));
+  return _mm_srli_epi16(y, 8);
+}
+
+// The rounded averages of the 2x2 blocks of 16 pixels in two rows
+static __m128i Average(__m128i row0_lo, __m128i row0_hi, __m128i row1_lo, __m128i row1_hi)
+{
+  const __m128i mask = _mm_set1_epi32(0xffff);
+  const __m128i sum_lo = _mm_add_epi16(row0_lo, row1_lo);
+  const __m128i sum_hi = _mm_add_epi16(row0_hi, row1_hi);
+  const __m128i pairs_lo = _mm_add_epi32(_mm_and_si128(sum_lo, mask), _mm_srli_epi32(sum_lo, 16));
+  const __m128i pairs_hi = _mm_add_epi32(_mm_and_si128(sum_hi, mask), _mm_srli_epi32(sum_hi, 16));
+  const __m128i sum = _mm_packs_epi32(pairs_lo, pairs_hi);
+  return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+}
+
+// Computes a * ca + offset - b * cb - c * cc. The result is below 65536, so the wrapping 16 bit
+// math gives the exact result.
+static __m128i ColorDifference(__m128i a, int ca, __m128i b, int cb, __m128i c, int cc)
+{
+  __m128i result = _mm_mullo_epi16(a, _mm_set1_epi16(static_cast<s16>(ca)));
+  result = _mm_add_epi16(result, _mm_set1_epi16(static_cast<s16>(0x8080)));
+  result = _mm_sub_epi16(result, _mm_mullo_epi16(b, _mm_set1_epi16(static_cast<s16>(cb))));
+  result = _mm_sub_epi16(result, _mm_mullo_epi16(c, _mm_set1_epi16(static_cast<s16>(cc))));
+  return _mm_srli_epi16(result, 8);
+}
+
+// Converts the pixels of two rows in blocks of 16, and returns the first column left over
+static int ConvertRowPairSSE(const u8* row0, const u8* row1, bool write_row1, int width, u8* y0,
+                             u8* y1, u8* u, u8* v)
+{
+  const int end_x = width & ~15;
+  for (int x = 0; x < end_x; x += 16)
+  {
+    const RGB16 a0 = Load8(&row0[x * 4]);
+    const RGB16 a1 = Load8(&row0[x * 4 + 32]);
+    const RGB16 b0 = Load8(&row1[x * 4]);
+    const RGB16 b1 = Load8(&row1[x * 4 + 32]);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&y0[x]), _mm_packus_epi16(Luma(a0), Luma(a1)));
+    if (write_row1)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&y1[x]), _mm_packus_epi16(Luma(b0), Luma(b1)));
+
+    const __m128i r = Average(a0.r, a1.r, b0.r, b1.r);
+    const __m128i g = Average(a0.g, a1.g, b0.g, b1.g);
+    const __m128i b = Average(a0.b, a1.b, b0.b, b1.b);
+    const __m128i blue_difference = ColorDifference(b, 112, r, 38, g, 74);
+    const __m128i red_difference = ColorDifference(r, 112, g, 94, b, 18);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&u[x / 2]),
+                     _mm_packus_epi16(blue_difference, blue_difference));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&v[x / 2]),
+                     _mm_packus_epi16(red_difference, red_difference));
+  }
+  return end_x;
+}
+#endif
+
+template <bool use_simd>
+static void Convert(const u8* src, int src_stride, int width, int height, const YUV420Planes& dst,
+                    int first_row, int end_row)
+{
+  for (int y = first_row; y < end_row; y += 2)
+  {
+    // The last row of an odd height is its own pair.
+    const u8* row0 = src + y * src_stride;
+    const u8* row1 = y + 1 < height ? row0 + src_stride : row0;
+    const bool write_row1 = y + 1 < end_row;
+    u8* y0 = dst.y + y * dst.y_stride;
+    u8* y1 = y0 + dst.y_stride;
+    u8* u = dst.u + y / 2 * dst.u_stride;
+    u8* v = dst.v + y / 2 * dst.v_stride;
+
+    int first_x = 0;
+#ifdef _M_X86_64
+    if (use_simd)
+      first_x = ConvertRowPairSSE(row0, row1, write_row1, width, y0, y1, u, v);
+#endif
+    ConvertRowPairGeneric(row0, row1, write_row1, width, first_x, y0, y1, u, v);
+  }
+}
+
+void ConvertRGBAToYUV420(const u8* src, int src_stride, int width, int height,
+                         const YUV420Planes& dst, int first_row, int end_row)
+{
+  Convert<true>(src, src_stride, width, height, dst, first_row, end_row);
+}
+
+void ConvertRGBAToYUV420Generic(const u8* src, int src_stride, int width, int height,
+                                const YUV420Planes& dst, int first_row, int end_row)
+{
+  Convert<false>(src, src_stride, width, height, dst, first_row, end_row);
+}
+}
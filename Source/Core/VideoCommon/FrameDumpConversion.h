@@ -0,0 +1,31 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Converts the RGBA frames read back for frame dumps to the planar YUV 4:2:0 format which most
+// video encoders take, with the BT.601 limited range coefficients.
+namespace FrameDumpConversion
+{
+struct YUV420Planes
+{
+  u8* y;
+  u8* u;
+  u8* v;
+  int y_stride;
+  int u_stride;
+  int v_stride;
+};
+
+// Converts the rows [first_row, end_row) of the image. Each chroma sample covers two rows, so
+// first_row has to be even. Rows can be converted in bands on different threads this way.
+void ConvertRGBAToYUV420(const u8* src, int src_stride, int width, int height,
+                         const YUV420Planes& dst, int first_row, int end_row);
+
+// The same conversion without SIMD, which the function above uses for the columns left over
+void ConvertRGBAToYUV420Generic(const u8* src, int src_stride, int width, int height,
+                                const YUV420Planes& dst, int first_row, int end_row);
+}
@@ -0,0 +1,210 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/HiresTexturePack.h"
+
+#include <cstring>
+#include <limits>
+
+#include "Common/Align.h"
+#include "Common/Logging/Log.h"
+#include "VideoCommon/AbstractTexture.h"
+
+namespace VideoCommon
+{
+namespace
+{
+constexpr u32 PACK_MAGIC = 0x4B505444;  // "DTPK"
+constexpr u32 PACK_VERSION = 1;
+
+// Level data is aligned for the benefit of the uploads.
+constexpr u64 DATA_ALIGNMENT = 64;
+
+constexpr u32 TEXTURE_FLAG_ARBITRARY_MIPMAPS = 1;
+
+struct PackHeader
+{
+  u32 magic;
+  u32 version;
+  u32 texture_count;
+  u32 level_count;
+  u64 index_offset;
+  u64 names_size;
+};
+
+template <typename T>
+bool ReadArray(const u8* data, u64 size, u64* offset, u64 count, std::vector<T>* out)
+{
+  if (count > (size - *offset) / sizeof(T))
+    return false;
+  out->resize(count);
+  std::memcpy(out->data(), data + *offset, count * sizeof(T));
+  *offset += count * sizeof(T);
+  return true;
+}
+
+// Whether the data holds all rows an upload of the level reads
+bool IsLevelComplete(AbstractTextureFormat format, u32 width, u32 height, u32 row_length,
+                     u64 data_size)
+{
+  if (width == 0 || height == 0 || row_length < width)
+    return false;
+
+  const u64 stride = AbstractTexture::CalculateStrideForFormat(format, row_length);
+  const u64 rows =
+      AbstractTexture::IsCompressedFormat(format) ? (static_cast<u64>(height) + 3) / 4 : height;
+  return data_size / stride >= rows;
+}
+}  // namespace
+
+bool HiresTexturePack::Open(const std::string& filename)
+{
+  using TextureEntry = HiresTexturePackWriter::TextureEntry;
+  using LevelEntry = HiresTexturePackWriter::LevelEntry;
+
+  m_textures.clear();
+  m_levels.clear();
+  if (!m_file.Open(filename) || m_file.GetSize() < sizeof(PackHeader))
+    return false;
+
+  const u8* data = m_file.GetData();
+  const u64 size = m_file.GetSize();
+  PackHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != PACK_MAGIC || header.version != PACK_VERSION || header.index_offset > size)
+  {
+    ERROR_LOG(VIDEO, "%s is not a supported texture pack", filename.c_str());
+    m_file.Close();
+    return false;
+  }
+
+  u64 offset = header.index_offset;
+  std::vector<TextureEntry> texture_entries;
+  std::vector<LevelEntry> level_entries;
+  if (!ReadArray(data, size, &offset, header.texture_count, &texture_entries) ||
+      !ReadArray(data, size, &offset, header.level_count, &level_entries) ||
+      header.names_size > size - offset)
+  {
+    ERROR_LOG(VIDEO, "Texture pack %s is truncated", filename.c_str());
+    m_file.Close();
+    return false;
+  }
+  const char* names = reinterpret_cast<const char*>(data + offset);
+
+  m_levels.reserve(level_entries.size());
+  for (const LevelEntry& entry : level_entries)
+  {
+    const auto format = static_cast<AbstractTextureFormat>(entry.format);
+    if (entry.data_offset > header.index_offset ||
+        entry.data_size > header.index_offset - entry.data_offset ||
+        entry.format >= static_cast<u32>(AbstractTextureFormat::Undefined) ||
+        !IsLevelComplete(format, entry.width, entry.height, entry.row_length, entry.data_size))
+    {
+      ERROR_LOG(VIDEO, "Texture pack %s has an invalid level", filename.c_str());
+      m_file.Close();
+      m_levels.clear();
+      return false;
+    }
+    m_levels.push_back({format, entry.width, entry.height, entry.row_length,
+                        data + entry.data_offset, static_cast<size_t>(entry.data_size)});
+  }
+
+  for (const TextureEntry& entry : texture_entries)
+  {
+    if (entry.name_offset > header.names_size ||
+        entry.name_length > header.names_size - entry.name_offset ||
+        entry.first_level > m_levels.size() || entry.num_levels == 0 ||
+        entry.num_levels > m_levels.size() - entry.first_level)
+    {
+      ERROR_LOG(VIDEO, "Texture pack %s has an invalid texture", filename.c_str());
+      m_file.Close();
+      m_textures.clear();
+      m_levels.clear();
+      return false;
+    }
+    m_textures[std::string(names + entry.name_offset, entry.name_length)] = {
+        entry.first_level, entry.num_levels, (entry.flags & TEXTURE_FLAG_ARBITRARY_MIPMAPS) != 0};
+  }
+
+  return true;
+}
+
+std::vector<std::string> HiresTexturePack::GetTextureNames() const
+{
+  std::vector<std::string> names;
+  names.reserve(m_textures.size());
+  for (const auto& texture : m_textures)
+    names.push_back(texture.first);
+  return names;
+}
+
+bool HiresTexturePack::GetTexture(const std::string& name, std::vector<Level>* levels,
+                                  bool* has_arbitrary_mipmaps) const
+{
+  const auto iter = m_textures.find(name);
+  if (iter == m_textures.end())
+    return false;
+
+  const Texture& texture = iter->second;
+  levels->assign(m_levels.begin() + texture.first_level,
+                 m_levels.begin() + texture.first_level + texture.num_levels);
+  *has_arbitrary_mipmaps = texture.has_arbitrary_mipmaps;
+  return true;
+}
+
+bool HiresTexturePackWriter::Open(const std::string& filename)
+{
+  m_texture_entries.clear();
+  m_level_entries.clear();
+  m_names.clear();
+
+  // The header is written by Finish(), so that unfinished files are never valid packs.
+  m_offset = Common::AlignUp(sizeof(PackHeader), DATA_ALIGNMENT);
+  return m_file.Open(filename, "wb") && m_file.Seek(m_offset, SEEK_SET);
+}
+
+bool HiresTexturePackWriter::AddTexture(const std::string& name,
+                                        const std::vector<HiresTexturePack::Level>& levels,
+                                        bool has_arbitrary_mipmaps)
+{
+  if (levels.empty() || m_names.size() + name.size() > std::numeric_limits<u32>::max())
+    return false;
+
+  m_texture_entries.push_back({static_cast<u32>(m_names.size()), static_cast<u32>(name.size()),
+                               static_cast<u32>(m_level_entries.size()),
+                               static_cast<u32>(levels.size()),
+                               has_arbitrary_mipmaps ? TEXTURE_FLAG_ARBITRARY_MIPMAPS : 0, 0});
+  m_names += name;
+
+  static constexpr u8 zeros[DATA_ALIGNMENT] = {};
+  for (const HiresTexturePack::Level& level : levels)
+  {
+    m_level_entries.push_back({m_offset, level.size, static_cast<u32>(level.format), level.width,
+                               level.height, level.row_length});
+
+    const u64 padding = Common::AlignUp(level.size, DATA_ALIGNMENT) - level.size;
+    if (!m_file.WriteBytes(level.data, level.size) || !m_file.WriteBytes(zeros, padding))
+      return false;
+    m_offset += level.size + padding;
+  }
+
+  return true;
+}
+
+bool HiresTexturePackWriter::Finish()
+{
+  const PackHeader header = {PACK_MAGIC,
+                             PACK_VERSION,
+                             static_cast<u32>(m_texture_entries.size()),
+                             static_cast<u32>(m_level_entries.size()),
+                             m_offset,
+                             m_names.size()};
+  const bool success =
+      m_file.WriteArray(m_texture_entries.data(), m_texture_entries.size()) &&
+      m_file.WriteArray(m_level_entries.data(), m_level_entries.size()) &&
+      m_file.WriteBytes(m_names.data(), m_names.size()) && m_file.Seek(0, SEEK_SET) &&
+      m_file.WriteArray(&header, 1);
+  return m_file.Close() && success;
+}
+}  // namespace VideoCommon
@@ -0,0 +1,108 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/MappedFile.h"
+#include "VideoCommon/TextureConfig.h"
+
+namespace VideoCommon
+{
+// A single file holding the mipmap chains of a custom texture pack, in the formats they are
+// uploaded in. Textures are found by the name HiresTexture::GenBaseName() gives them, and their
+// levels are read straight from a memory mapping of the file.
+//
+// The file is a header, the level data, and then the index: one entry per texture, one entry
+// per level, and the texture names.
+class HiresTexturePack
+{
+public:
+  struct Level
+  {
+    AbstractTextureFormat format;
+    u32 width;
+    u32 height;
+    u32 row_length;
+    const u8* data;
+    size_t size;
+  };
+
+  static constexpr const char* EXTENSION = ".dtp";
+
+  HiresTexturePack() = default;
+  HiresTexturePack(const HiresTexturePack&) = delete;
+  HiresTexturePack& operator=(const HiresTexturePack&) = delete;
+
+  // Fails if the file is not a texture pack, if its index points outside of the file, or if a
+  // level has less data than its format and size need.
+  bool Open(const std::string& filename);
+
+  std::vector<std::string> GetTextureNames() const;
+  // Returns false if there is no texture with the given name. The level data stays valid for
+  // the lifetime of the pack.
+  bool GetTexture(const std::string& name, std::vector<Level>* levels,
+                  bool* has_arbitrary_mipmaps) const;
+
+private:
+  struct Texture
+  {
+    u32 first_level;
+    u32 num_levels;
+    bool has_arbitrary_mipmaps;
+  };
+
+  File::MappedFile m_file;
+  std::unordered_map<std::string, Texture> m_textures;
+  std::vector<Level> m_levels;
+};
+
+// Builds a texture pack. The level data is written as textures are added, and the index once
+// Finish() is called.
+class HiresTexturePackWriter
+{
+public:
+  bool Open(const std::string& filename);
+  bool AddTexture(const std::string& name, const std::vector<HiresTexturePack::Level>& levels,
+                  bool has_arbitrary_mipmaps);
+  bool Finish();
+
+  size_t GetTextureCount() const { return m_texture_entries.size(); }
+
+private:
+  struct TextureEntry
+  {
+    u32 name_offset;
+    u32 name_length;
+    u32 first_level;
+    u32 num_levels;
+    u32 flags;
+    u32 padding;
+  };
+
+  struct LevelEntry
+  {
+    u64 data_offset;
+    u64 data_size;
+    u32 format;
+    u32 width;
+    u32 height;
+    u32 row_length;
+  };
+
+  friend class HiresTexturePack;
+
+  File::IOFile m_file;
+  u64 m_offset = 0;
+  std::vector<TextureEntry> m_texture_entries;
+  std::vector<LevelEntry> m_level_entries;
+  std::string m_names;
+};
+}  // namespace VideoCommon
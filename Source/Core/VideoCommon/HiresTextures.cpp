@@ -6,12 +6,16 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <xxhash.h>
@@ -19,7 +23,6 @@
 #include "Common/File.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
-#include "Common/Flag.h"
 #include "Common/Hash.h"
 #include "Common/Image.h"
 #include "Common/Logging/Log.h"
@@ -28,8 +31,8 @@
 #include "Common/Swap.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
-#include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
+#include "VideoCommon/HiresTexturePack.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -37,160 +40,368 @@ struct DiskTexture
 {
   std::string path;
   bool has_arbitrary_mipmaps;
+  // Set for textures which come from a texture pack
+  std::shared_ptr<VideoCommon::HiresTexturePack> pack;
+};
+
+struct CachedTexture
+{
+  std::shared_ptr<HiresTexture> texture;
+  size_t size;
+  std::list<std::string>::iterator lru_position;
+};
+
+struct LoadRequest
+{
+  std::string base_filename;
+  u32 width;
+  u32 height;
 };
 
 static std::unordered_map<std::string, DiskTexture> s_textureMap;
-static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_textureCache;
+
+// Loaded textures, limited to s_cache_limit bytes. s_lru holds their names, starting with the most
+// recently used one. Everything below is guarded by s_textureCacheMutex.
+static std::unordered_map<std::string, CachedTexture> s_textureCache;
+static std::list<std::string> s_lru;
+static size_t s_cache_size = 0;
+static size_t s_cache_limit = 0;
+static std::unordered_set<std::string> s_failed_textures;
 static std::mutex s_textureCacheMutex;
-static Common::Flag s_textureCacheAbortLoading;
 
-static std::thread s_prefetcher;
+// Textures the texture cache is waiting for, starting with the most recently requested one. The
+// loader threads only prefetch when there are no requests.
+static std::deque<LoadRequest> s_requests;
+// Textures which are requested, or being loaded.
+static std::unordered_set<std::string> s_loading;
+static std::vector<std::string> s_prefetch_list;
+static size_t s_prefetch_position = 0;
+static size_t s_prefetch_remaining = 0;
+static u32 s_prefetch_start_time = 0;
+
+static std::vector<std::thread> s_loaders;
+static std::condition_variable s_loader_wakeup;
+static bool s_loader_exit = false;
+
+static HiresTexture::Statistics s_statistics;
 
 static const std::string s_format_prefix = "tex1_";
 
-void HiresTexture::Init()
+static size_t GetTextureSize(const HiresTexture& texture)
 {
-  Update();
+  size_t size = 0;
+  for (const HiresTexture::Level& level : texture.m_levels)
+    size += level.data.size();
+  return size;
 }
 
-void HiresTexture::Shutdown()
+// Loose files take precedence over texture packs, so that single textures of a pack can be
+// replaced.
+static void AddTexturesFromDirectory(const std::string& texture_directory, bool include_packs)
 {
-  if (s_prefetcher.joinable())
+  std::vector<std::string> extensions{".png", ".dds"};
+  if (include_packs)
+    extensions.push_back(VideoCommon::HiresTexturePack::EXTENSION);
+
+  const std::vector<std::string> texture_paths =
+      Common::DoFileSearch({texture_directory}, extensions, /*recursive*/ true);
+
+  for (auto& path : texture_paths)
   {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
+    std::string filename;
+    std::string extension;
+    SplitPath(path, nullptr, &filename, &extension);
+
+    if (include_packs && extension == VideoCommon::HiresTexturePack::EXTENSION)
+    {
+      auto pack = std::make_shared<VideoCommon::HiresTexturePack>();
+      if (!pack->Open(path))
+        continue;
+
+      for (const std::string& name : pack->GetTextureNames())
+        s_textureMap.emplace(name, DiskTexture{path, false, pack});
+    }
   }
 
-  s_textureMap.clear();
+  for (auto& path : texture_paths)
+  {
+    std::string filename;
+    std::string extension;
+    SplitPath(path, nullptr, &filename, &extension);
+
+    if (extension != VideoCommon::HiresTexturePack::EXTENSION &&
+        filename.substr(0, s_format_prefix.length()) == s_format_prefix)
+    {
+      const size_t arb_index = filename.rfind("_arb");
+      const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
+      if (has_arbitrary_mipmaps)
+        filename.erase(arb_index, 4);
+      s_textureMap[filename] = {path, has_arbitrary_mipmaps, nullptr};
+    }
+  }
+}
+
+static bool IsPacked(const std::string& base_filename)
+{
+  const auto iter = s_textureMap.find(base_filename);
+  return iter != s_textureMap.end() && iter->second.pack;
+}
+
+static size_t GetCacheLimit()
+{
+  if (g_ActiveConfig.iHiresTextureCacheSize > 0)
+    return static_cast<size_t>(g_ActiveConfig.iHiresTextureCacheSize) * 1024 * 1024;
+
+  size_t sys_mem = Common::MemPhysical();
+  size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
+  // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
+  return (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+}
+
+// Drops the least recently used textures until size more bytes fit into the cache.
+static void EvictTextures(size_t size)
+{
+  while (!s_lru.empty() && s_cache_size + size > s_cache_limit)
+  {
+    auto iter = s_textureCache.find(s_lru.back());
+    s_cache_size -= iter->second.size;
+    s_textureCache.erase(iter);
+    s_lru.pop_back();
+    s_statistics.evictions++;
+  }
+}
+
+static void InsertTexture(const std::string& base_filename, std::shared_ptr<HiresTexture> texture,
+                          bool used)
+{
+  if (s_textureCache.find(base_filename) != s_textureCache.end())
+    return;
+
+  // Textures which were only prefetched are the first ones to go.
+  const size_t size = GetTextureSize(*texture);
+  EvictTextures(size);
+  const auto lru_position =
+      used ? s_lru.insert(s_lru.begin(), base_filename) : s_lru.insert(s_lru.end(), base_filename);
+  s_textureCache.emplace(base_filename, CachedTexture{std::move(texture), size, lru_position});
+  s_cache_size += size;
+}
+
+static void ClearCache()
+{
   s_textureCache.clear();
+  s_lru.clear();
+  s_cache_size = 0;
+  s_failed_textures.clear();
 }
 
-void HiresTexture::Update()
+static void RequestLoad(const std::string& base_filename, u32 width, u32 height)
 {
-  if (s_prefetcher.joinable())
+  if (!s_loading.insert(base_filename).second)
   {
-    s_textureCacheAbortLoading.Set();
-    s_prefetcher.join();
+    // Move requests which are still waiting to the front.
+    auto iter = std::find_if(s_requests.begin(), s_requests.end(), [&](const LoadRequest& r) {
+      return r.base_filename == base_filename;
+    });
+    if (iter != s_requests.end() && iter != s_requests.begin())
+    {
+      LoadRequest request = std::move(*iter);
+      s_requests.erase(iter);
+      s_requests.push_front(std::move(request));
+    }
+    return;
   }
 
-  if (!g_ActiveConfig.bHiresTextures)
+  s_requests.push_front({base_filename, width, height});
+  s_loader_wakeup.notify_one();
+}
+
+static void RecordLoad(bool success, u64 load_time_us)
+{
+  if (!success)
   {
-    s_textureMap.clear();
-    s_textureCache.clear();
+    s_statistics.failed_loads++;
     return;
   }
+  s_statistics.loads++;
+  s_statistics.total_load_time_us += load_time_us;
+  s_statistics.max_load_time_us = std::max(s_statistics.max_load_time_us, load_time_us);
+}
+
+static void FinishPrefetch()
+{
+  if (s_prefetch_remaining == 0 || --s_prefetch_remaining != 0)
+    return;
+
+  const u32 stoptime = Common::Timer::GetTimeMs();
+  OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
+                                   s_cache_size / (1024.0 * 1024.0),
+                                   (stoptime - s_prefetch_start_time) / 1000.0),
+                  10000);
+}
 
-  if (!g_ActiveConfig.bCacheHiresTextures)
+static void StopLoaders()
+{
   {
-    s_textureCache.clear();
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+    s_loader_exit = true;
+    s_requests.clear();
+    s_loading.clear();
+    s_prefetch_list.clear();
+    s_prefetch_position = 0;
+    s_prefetch_remaining = 0;
   }
+  s_loader_wakeup.notify_all();
 
-  const std::string& game_id = SConfig::GetInstance().GetGameID();
-  const std::string texture_directory = GetTextureDirectory(game_id);
-  const std::vector<std::string> extensions{".png", ".dds"};
+  for (std::thread& loader : s_loaders)
+    loader.join();
+  s_loaders.clear();
+}
 
-  const std::vector<std::string> texture_paths =
-      Common::DoFileSearch({texture_directory}, extensions, /*recursive*/ true);
+void HiresTexture::Init()
+{
+  Update();
+}
+
+void HiresTexture::Shutdown()
+{
+  StopLoaders();
 
-  const std::string code = game_id + "_";
+  const std::string statistics = StatisticsToString();
+  if (!statistics.empty())
+    INFO_LOG(VIDEO, "%s", statistics.c_str());
 
-  for (auto& path : texture_paths)
+  s_textureMap.clear();
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  ClearCache();
+  s_statistics = {};
+}
+
+void HiresTexture::Update()
+{
+  StopLoaders();
+
+  if (!g_ActiveConfig.bHiresTextures)
   {
-    std::string filename;
-    SplitPath(path, nullptr, &filename, nullptr);
+    s_textureMap.clear();
+    std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+    ClearCache();
+    return;
+  }
+
+  const std::string& game_id = SConfig::GetInstance().GetGameID();
+  AddTexturesFromDirectory(GetTextureDirectory(game_id), true);
+
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
 
-    if (filename.substr(0, s_format_prefix.length()) == s_format_prefix)
+  // remove cached but deleted textures
+  auto iter = s_textureCache.begin();
+  while (iter != s_textureCache.end())
+  {
+    if (s_textureMap.find(iter->first) == s_textureMap.end())
     {
-      const size_t arb_index = filename.rfind("_arb");
-      const bool has_arbitrary_mipmaps = arb_index != std::string::npos;
-      if (has_arbitrary_mipmaps)
-        filename.erase(arb_index, 4);
-      s_textureMap[filename] = {path, has_arbitrary_mipmaps};
+      s_cache_size -= iter->second.size;
+      s_lru.erase(iter->second.lru_position);
+      iter = s_textureCache.erase(iter);
+    }
+    else
+    {
+      iter++;
     }
   }
+  s_failed_textures.clear();
+  s_cache_limit = GetCacheLimit();
+  EvictTextures(0);
 
   if (g_ActiveConfig.bCacheHiresTextures)
   {
-    // remove cached but deleted textures
-    auto iter = s_textureCache.begin();
-    while (iter != s_textureCache.end())
+    for (const auto& entry : s_textureMap)
     {
-      if (s_textureMap.find(iter->first) == s_textureMap.end())
-      {
-        iter = s_textureCache.erase(iter);
-      }
-      else
-      {
-        iter++;
-      }
+      if (entry.first.find("_mip") == std::string::npos)
+        s_prefetch_list.push_back(entry.first);
     }
-
-    s_textureCacheAbortLoading.Clear();
-    s_prefetcher = std::thread(Prefetch);
+    s_prefetch_remaining = s_prefetch_list.size();
+    s_prefetch_start_time = Common::Timer::GetTimeMs();
   }
+
+  s_loader_exit = false;
+  const u32 num_loaders = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+  for (u32 i = 0; i < num_loaders; i++)
+    s_loaders.emplace_back(LoaderThread);
 }
 
-void HiresTexture::Prefetch()
+void HiresTexture::LoaderThread()
 {
-  Common::SetCurrentThreadName("Prefetcher");
+  Common::SetCurrentThreadName("Custom Texture Loader");
 
-  size_t size_sum = 0;
-  size_t sys_mem = Common::MemPhysical();
-  size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
-  // keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
-  size_t max_mem =
-      (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
-  u32 starttime = Common::Timer::GetTimeMs();
-  for (const auto& entry : s_textureMap)
+  std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+  while (true)
   {
-    const std::string& base_filename = entry.first;
+    s_loader_wakeup.wait(lk, [] {
+      return s_loader_exit || !s_requests.empty() ||
+             s_prefetch_position < s_prefetch_list.size();
+    });
+    if (s_loader_exit)
+      return;
 
-    if (base_filename.find("_mip") == std::string::npos)
+    LoadRequest request;
+    const bool prefetch = s_requests.empty();
+    if (!prefetch)
     {
-      std::unique_lock<std::mutex> lk(s_textureCacheMutex);
-
-      auto iter = s_textureCache.find(base_filename);
-      if (iter == s_textureCache.end())
-      {
-        // unlock while loading a texture. This may result in a race condition where
-        // we'll load a texture twice, but it reduces the stuttering a lot.
-        lk.unlock();
-        std::unique_ptr<HiresTexture> texture = Load(base_filename, 0, 0);
-        lk.lock();
-        if (texture)
-        {
-          std::shared_ptr<HiresTexture> ptr(std::move(texture));
-          iter = s_textureCache.insert(iter, std::make_pair(base_filename, ptr));
-        }
-      }
-      if (iter != s_textureCache.end())
+      request = std::move(s_requests.front());
+      s_requests.pop_front();
+    }
+    else
+    {
+      request = {s_prefetch_list[s_prefetch_position++], 0, 0};
+      if (s_textureCache.count(request.base_filename) ||
+          s_failed_textures.count(request.base_filename) ||
+          !s_loading.insert(request.base_filename).second)
       {
-        for (const Level& l : iter->second->m_levels)
-          size_sum += l.data.size();
+        FinishPrefetch();
+        continue;
       }
     }
 
-    if (s_textureCacheAbortLoading.IsSet())
-    {
+    // Other threads can use the cache while the texture is loading.
+    lk.unlock();
+    const u64 start_time = Common::Timer::GetTimeUs();
+    std::shared_ptr<HiresTexture> texture = Load(request.base_filename, request.width,
+                                                 request.height);
+    const u64 load_time = Common::Timer::GetTimeUs() - start_time;
+    lk.lock();
+
+    if (s_loader_exit)
       return;
-    }
 
-    if (size_sum > max_mem)
+    s_loading.erase(request.base_filename);
+    RecordLoad(texture != nullptr, load_time);
+    if (!texture)
     {
-      Config::SetCurrent(Config::GFX_HIRES_TEXTURES, false);
-
-      OSD::AddMessage(
-          StringFromFormat(
-              "Custom Textures prefetching after %.1f MB aborted, not enough RAM available",
-              size_sum / (1024.0 * 1024.0)),
-          10000);
-      return;
+      s_failed_textures.insert(request.base_filename);
+    }
+    else if (prefetch && s_cache_size + GetTextureSize(*texture) > s_cache_limit)
+    {
+      // Prefetching stops at the cache limit instead of evicting textures which were used.
+      if (s_prefetch_remaining != 0)
+      {
+        OSD::AddMessage(StringFromFormat("Custom Textures prefetching stopped after %.1f MB, the "
+                                         "cache is full",
+                                         s_cache_size / (1024.0 * 1024.0)),
+                        10000);
+        s_prefetch_list.clear();
+        s_prefetch_position = 0;
+        s_prefetch_remaining = 0;
+      }
+      continue;
     }
+    else
+    {
+      InsertTexture(request.base_filename, std::move(texture), !prefetch);
+    }
+
+    if (prefetch)
+      FinishPrefetch();
   }
-  u32 stoptime = Common::Timer::GetTimeMs();
-  OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s",
-                                   size_sum / (1024.0 * 1024.0), (stoptime - starttime) / 1000.0),
-                  10000);
 }
 
 std::string HiresTexture::GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
@@ -282,29 +493,99 @@ u32 HiresTexture::CalculateMipCount(u32 width, u32 height)
 std::shared_ptr<HiresTexture> HiresTexture::Search(const u8* texture, size_t texture_size,
                                                    const u8* tlut, size_t tlut_size, u32 width,
                                                    u32 height, TextureFormat format,
-                                                   bool has_mipmaps)
+                                                   bool has_mipmaps, std::string* pending_name)
 {
   std::string base_filename =
       GenBaseName(texture, texture_size, tlut, tlut_size, width, height, format, has_mipmaps);
+  if (base_filename.empty())
+    return nullptr;
 
-  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  std::unique_lock<std::mutex> lk(s_textureCacheMutex);
 
   auto iter = s_textureCache.find(base_filename);
   if (iter != s_textureCache.end())
   {
-    return iter->second;
+    s_lru.splice(s_lru.begin(), s_lru, iter->second.lru_position);
+    s_statistics.hits++;
+    return iter->second.texture;
   }
 
+  if (s_failed_textures.count(base_filename))
+    return nullptr;
+
+  // Textures from packs don't need to be decoded, so there is no point in loading them in the
+  // background.
+  s_statistics.misses++;
+  if (g_ActiveConfig.bStreamHiresTextures && !IsPacked(base_filename))
+  {
+    RequestLoad(base_filename, width, height);
+    if (pending_name)
+      *pending_name = std::move(base_filename);
+    return nullptr;
+  }
+
+  // Don't hold up the loader threads while loading.
+  lk.unlock();
+  const u64 start_time = Common::Timer::GetTimeUs();
   std::shared_ptr<HiresTexture> ptr(Load(base_filename, width, height));
+  const u64 load_time = Common::Timer::GetTimeUs() - start_time;
+  lk.lock();
 
-  if (ptr && g_ActiveConfig.bCacheHiresTextures)
+  RecordLoad(ptr != nullptr, load_time);
+  if (!ptr)
   {
-    s_textureCache[base_filename] = ptr;
+    s_failed_textures.insert(base_filename);
+    return nullptr;
   }
 
+  InsertTexture(base_filename, ptr, true);
   return ptr;
 }
 
+bool HiresTexture::IsReady(const std::string& base_filename)
+{
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  if (s_textureCache.count(base_filename) || s_failed_textures.count(base_filename))
+    return true;
+
+  // The texture was evicted before it was used, or the loaders were restarted.
+  if (!s_loading.count(base_filename))
+    RequestLoad(base_filename, 0, 0);
+  return false;
+}
+
+HiresTexture::Statistics HiresTexture::GetStatistics()
+{
+  std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+  Statistics statistics = s_statistics;
+  statistics.cache_size = s_cache_size;
+  statistics.cache_limit = s_cache_limit;
+  statistics.queued_loads = s_loading.size();
+  return statistics;
+}
+
+std::string HiresTexture::StatisticsToString()
+{
+  const Statistics statistics = GetStatistics();
+  if (statistics.hits == 0 && statistics.misses == 0)
+    return {};
+
+  const double average_load_time =
+      statistics.loads ? statistics.total_load_time_us / 1000.0 / statistics.loads : 0.0;
+  std::string str = StringFromFormat("Custom textures: %.1f / %.1f MB, %zu loading\n",
+                                     statistics.cache_size / (1024.0 * 1024.0),
+                                     statistics.cache_limit / (1024.0 * 1024.0),
+                                     statistics.queued_loads);
+  str += StringFromFormat("Custom texture hits: %" PRIu64 ", misses: %" PRIu64
+                          ", evictions: %" PRIu64 "\n",
+                          statistics.hits, statistics.misses, statistics.evictions);
+  str += StringFromFormat("Custom texture loads: %" PRIu64 " (%" PRIu64
+                          " failed), avg %.1f ms, max %.1f ms\n",
+                          statistics.loads, statistics.failed_loads, average_load_time,
+                          statistics.max_load_time_us / 1000.0);
+  return str;
+}
+
 std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filename, u32 width,
                                                  u32 height)
 {
@@ -313,11 +594,14 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   if (filename_iter == s_textureMap.end())
     return nullptr;
 
+  const DiskTexture& first_mip_file = filename_iter->second;
+  if (first_mip_file.pack)
+    return LoadFromPack(first_mip_file.pack, base_filename);
+
   // Try to load level 0 (and any mipmaps) from a DDS file.
   // If this fails, it's fine, we'll just load level0 again using SOIL.
   // Can't use make_unique due to private constructor.
   std::unique_ptr<HiresTexture> ret = std::unique_ptr<HiresTexture>(new HiresTexture());
-  const DiskTexture& first_mip_file = filename_iter->second;
   ret->m_has_arbitrary_mipmaps = first_mip_file.has_arbitrary_mipmaps;
   LoadDDSTexture(ret.get(), first_mip_file.path);
 
@@ -419,6 +703,81 @@ std::unique_ptr<HiresTexture> HiresTexture::Load(const std::string& base_filenam
   return ret;
 }
 
+std::unique_ptr<HiresTexture>
+HiresTexture::LoadFromPack(const std::shared_ptr<VideoCommon::HiresTexturePack>& pack,
+                           const std::string& base_filename)
+{
+  std::vector<VideoCommon::HiresTexturePack::Level> packed_levels;
+  std::unique_ptr<HiresTexture> ret = std::unique_ptr<HiresTexture>(new HiresTexture());
+  if (!pack->GetTexture(base_filename, &packed_levels, &ret->m_has_arbitrary_mipmaps))
+    return nullptr;
+
+  // Packs keep compressed DDS textures compressed.
+  const AbstractTextureFormat format = packed_levels[0].format;
+  if (((format == AbstractTextureFormat::DXT1 || format == AbstractTextureFormat::DXT3 ||
+        format == AbstractTextureFormat::DXT5) &&
+       !g_ActiveConfig.backend_info.bSupportsST3CTextures) ||
+      (format == AbstractTextureFormat::BPTC && !g_ActiveConfig.backend_info.bSupportsBPTCTextures))
+  {
+    ERROR_LOG(VIDEO, "Custom texture %s uses a compressed format the backend doesn't support",
+              base_filename.c_str());
+    return nullptr;
+  }
+
+  ret->m_pack = pack;
+  for (const VideoCommon::HiresTexturePack::Level& packed_level : packed_levels)
+  {
+    Level level;
+    level.packed_data = packed_level.data;
+    level.packed_size = packed_level.size;
+    level.format = packed_level.format;
+    level.width = packed_level.width;
+    level.height = packed_level.height;
+    level.row_length = packed_level.row_length;
+    ret->m_levels.push_back(std::move(level));
+  }
+  return ret;
+}
+
+bool HiresTexture::WritePack(const std::string& texture_directory,
+                             const std::string& pack_filename, size_t* texture_count)
+{
+  s_textureMap.clear();
+  AddTexturesFromDirectory(texture_directory, false);
+
+  std::vector<std::string> names;
+  for (const auto& entry : s_textureMap)
+  {
+    if (entry.first.find("_mip") == std::string::npos)
+      names.push_back(entry.first);
+  }
+  std::sort(names.begin(), names.end());
+
+  VideoCommon::HiresTexturePackWriter writer;
+  bool success = writer.Open(pack_filename);
+  for (const std::string& name : names)
+  {
+    if (!success)
+      break;
+
+    const std::unique_ptr<HiresTexture> texture = Load(name, 0, 0);
+    if (!texture)
+      continue;
+
+    std::vector<VideoCommon::HiresTexturePack::Level> levels;
+    for (const Level& level : texture->m_levels)
+    {
+      levels.push_back({level.format, level.width, level.height, level.row_length,
+                        level.GetData(), level.GetSize()});
+    }
+    success = writer.AddTexture(name, levels, texture->m_has_arbitrary_mipmaps);
+  }
+
+  s_textureMap.clear();
+  *texture_count = writer.GetTextureCount();
+  return writer.Finish() && success;
+}
+
 bool HiresTexture::LoadTexture(Level& level, const std::vector<u8>& buffer)
 {
   if (!Common::LoadPNG(buffer, &level.data, &level.width, &level.height))
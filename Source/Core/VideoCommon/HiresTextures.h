@@ -13,6 +13,11 @@
 
 enum class TextureFormat;
 
+namespace VideoCommon
+{
+class HiresTexturePack;
+}
+
 class HiresTexture
 {
 public:
@@ -20,9 +25,16 @@ public:
   static void Update();
   static void Shutdown();
 
+  // Returns the custom texture for the given texture, if it is loaded. When streaming, missing
+  // textures are queued for loading, and their name is returned in pending_name.
   static std::shared_ptr<HiresTexture> Search(const u8* texture, size_t texture_size,
                                               const u8* tlut, size_t tlut_size, u32 width,
-                                              u32 height, TextureFormat format, bool has_mipmaps);
+                                              u32 height, TextureFormat format, bool has_mipmaps,
+                                              std::string* pending_name = nullptr);
+
+  // Whether a texture Search() reported as pending has finished loading, or failed to load.
+  // Queues it again if it was loaded, but evicted before it could be used.
+  static bool IsReady(const std::string& base_filename);
 
   static std::string GenBaseName(const u8* texture, size_t texture_size, const u8* tlut,
                                  size_t tlut_size, u32 width, u32 height, TextureFormat format,
@@ -30,6 +42,27 @@ public:
 
   static u32 CalculateMipCount(u32 width, u32 height);
 
+  // Loads every custom texture in texture_directory and stores them in a texture pack. Not to be
+  // used while custom textures are loaded.
+  static bool WritePack(const std::string& texture_directory, const std::string& pack_filename,
+                        size_t* texture_count);
+
+  struct Statistics
+  {
+    u64 hits = 0;
+    u64 misses = 0;
+    u64 loads = 0;
+    u64 failed_loads = 0;
+    u64 evictions = 0;
+    u64 total_load_time_us = 0;
+    u64 max_load_time_us = 0;
+    size_t cache_size = 0;
+    size_t cache_limit = 0;
+    size_t queued_loads = 0;
+  };
+  static Statistics GetStatistics();
+  static std::string StatisticsToString();
+
   ~HiresTexture();
 
   AbstractTextureFormat GetFormat() const;
@@ -37,7 +70,13 @@ public:
 
   struct Level
   {
+    const u8* GetData() const { return packed_data ? packed_data : data.data(); }
+    size_t GetSize() const { return packed_data ? packed_size : data.size(); }
+
     std::vector<u8> data;
+    // Levels from texture packs point into the pack instead of using data.
+    const u8* packed_data = nullptr;
+    size_t packed_size = 0;
     AbstractTextureFormat format = AbstractTextureFormat::RGBA8;
     u32 width = 0;
     u32 height = 0;
@@ -51,10 +90,15 @@ private:
   static bool LoadDDSTexture(HiresTexture* tex, const std::string& filename);
   static bool LoadDDSTexture(Level& level, const std::string& filename, u32 mip_level);
   static bool LoadTexture(Level& level, const std::vector<u8>& buffer);
-  static void Prefetch();
+  static std::unique_ptr<HiresTexture>
+  LoadFromPack(const std::shared_ptr<VideoCommon::HiresTexturePack>& pack,
+               const std::string& base_filename);
+  static void LoaderThread();
 
   static std::string GetTextureDirectory(const std::string& game_id);
 
   HiresTexture() {}
   bool m_has_arbitrary_mipmaps;
+  // Keeps packed level data mapped.
+  std::shared_ptr<VideoCommon::HiresTexturePack> m_pack;
 };
@@ -2,15 +2,22 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <array>
 #include <cstddef>
 
+#include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/Compiler.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VideoConfig.h"
 
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
 // Init
 u16* IndexGenerator::index_buffer_current;
 u16* IndexGenerator::BASEIptr;
@@ -19,10 +26,50 @@ u32 IndexGenerator::base_index;
 static const u16 s_primitive_restart = UINT16_MAX;
 
 static u16* (*primitive_table[8])(u16*, u32, u32);
+static bool s_primitive_restart_enabled;
+
+enum class VectorISA
+{
+  None,
+  SSE2,
+  AVX2,
+  NEON,
+};
+static VectorISA s_vector_isa;
 
-void IndexGenerator::Init()
+void IndexGenerator::Init(bool vectorized)
 {
-  if (g_Config.backend_info.bSupportsPrimitiveRestart)
+  s_vector_isa = VectorISA::None;
+  if (vectorized)
+  {
+#if defined(_M_X86_64)
+    s_vector_isa = cpu_info.bAVX2 ? VectorISA::AVX2 : VectorISA::SSE2;
+#elif defined(_M_ARM_64)
+    s_vector_isa = VectorISA::NEON;
+#endif
+  }
+
+  s_primitive_restart_enabled = g_Config.backend_info.bSupportsPrimitiveRestart;
+  if (s_vector_isa != VectorISA::None)
+  {
+    if (s_primitive_restart_enabled)
+    {
+      primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuadsVectorized<true>;
+      primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuads_nonstandard<true>;
+      primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = AddListVectorized<true>;
+      primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = AddStripVectorized<true>;
+      primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = AddFanVectorized<true>;
+    }
+    else
+    {
+      primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuadsVectorized<false>;
+      primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuads_nonstandard<false>;
+      primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLES] = AddListVectorized<false>;
+      primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP] = AddStripVectorized<false>;
+      primitive_table[OpcodeDecoder::GX_DRAW_TRIANGLE_FAN] = AddFanVectorized<false>;
+    }
+  }
+  else if (s_primitive_restart_enabled)
   {
     primitive_table[OpcodeDecoder::GX_DRAW_QUADS] = AddQuads<true>;
     primitive_table[OpcodeDecoder::GX_DRAW_QUADS_2] = AddQuads_nonstandard<true>;
@@ -56,6 +103,56 @@ void IndexGenerator::AddIndices(int primitive, u32 numVerts)
   base_index += numVerts;
 }
 
+u32 IndexGenerator::GetSplitGranularity(int primitive)
+{
+  switch (primitive)
+  {
+  case OpcodeDecoder::GX_DRAW_QUADS:
+  case OpcodeDecoder::GX_DRAW_QUADS_2:
+    return 4;
+  case OpcodeDecoder::GX_DRAW_TRIANGLES:
+    return 3;
+  case OpcodeDecoder::GX_DRAW_LINES:
+    return 2;
+  case OpcodeDecoder::GX_DRAW_POINTS:
+    return 1;
+  default:
+    return 0;
+  }
+}
+
+// Number of indices written for a splittable primitive, see the Add* functions below.
+u32 IndexGenerator::GetIndexCount(int primitive, u32 numVerts)
+{
+  const bool pr = s_primitive_restart_enabled;
+  switch (primitive)
+  {
+  case OpcodeDecoder::GX_DRAW_QUADS:
+  case OpcodeDecoder::GX_DRAW_QUADS_2:
+    return numVerts / 4 * (pr ? 5 : 6) + (numVerts % 4 == 3 ? (pr ? 4 : 3) : 0);
+  case OpcodeDecoder::GX_DRAW_TRIANGLES:
+    return numVerts / 3 * (pr ? 4 : 3);
+  case OpcodeDecoder::GX_DRAW_LINES:
+    return numVerts / 2 * 2;
+  case OpcodeDecoder::GX_DRAW_POINTS:
+    return numVerts;
+  default:
+    return 0;
+  }
+}
+
+void IndexGenerator::AddIndicesAt(int primitive, u32 first_vertex, u32 numVerts)
+{
+  u16* const Iptr = index_buffer_current + GetIndexCount(primitive, first_vertex);
+  primitive_table[primitive](Iptr, numVerts, base_index + first_vertex);
+}
+
+void IndexGenerator::CommitIndices(int primitive, u32 numVerts)
+{
+  index_buffer_current += GetIndexCount(primitive, numVerts);
+  base_index += numVerts;
+}
+
 // Triangles
 template <bool pr>
 DOLPHIN_FORCE_INLINE u16* IndexGenerator::WriteTriangle(u16* Iptr, u32 index1, u32 index2,
@@ -207,9 +304,271 @@ template <bool pr>
 u16* IndexGenerator::AddQuads_nonstandard(u16* Iptr, u32 numVerts, u32 index)
 {
   WARN_LOG(VIDEO, "Non-standard primitive drawing command GL_DRAW_QUADS_2");
+  if (s_vector_isa != VectorISA::None)
+    return AddQuadsVectorized<pr>(Iptr, numVerts, index);
   return AddQuads<pr>(Iptr, numVerts, index);
 }
 
+/*
+ * Vectorized generators
+ *
+ * All the triangle primitives produce a fixed pattern of indices per group of vertices, so the
+ * generators below describe that pattern once and let WritePattern() emit it a whole vector at a
+ * time. Pattern entries are offsets from the first vertex of the group, CENTER refers to the
+ * first vertex of the batch (the hub of a fan), RESTART is a primitive restart marker.
+ * The output is identical to the scalar generators above.
+ */
+namespace
+{
+constexpr s32 CENTER = -1;
+constexpr s32 RESTART = -2;
+
+constexpr size_t MAX_PATTERN_SIZE = 6;
+constexpr size_t MAX_LANES = 16;
+
+// One repetition of the pattern per vector lane, which makes up exactly N vectors.
+// A group of vertices k blocks later is produced by adding k * step to the advancing entries.
+struct PatternBlock
+{
+  alignas(32) std::array<u16, MAX_PATTERN_SIZE * MAX_LANES> value;
+  alignas(32) std::array<u16, MAX_PATTERN_SIZE * MAX_LANES> advance;
+  alignas(32) std::array<u16, MAX_PATTERN_SIZE * MAX_LANES> restart;
+  u16 step;
+};
+
+#if defined(_M_X86_64)
+template <size_t N>
+u16* WriteBlocksSSE2(u16* Iptr, const PatternBlock& block, u32 num_blocks)
+{
+  __m128i value[N], advance[N], restart[N];
+  for (size_t i = 0; i < N; i++)
+  {
+    value[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(&block.value[i * 8]));
+    advance[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(&block.advance[i * 8]));
+    restart[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(&block.restart[i * 8]));
+  }
+
+  const __m128i step = _mm_set1_epi16(block.step);
+  __m128i offset = _mm_setzero_si128();
+  for (u32 b = 0; b < num_blocks; b++)
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      const __m128i indices =
+          _mm_or_si128(_mm_add_epi16(value[i], _mm_and_si128(offset, advance[i])), restart[i]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(Iptr), indices);
+      Iptr += 8;
+    }
+    offset = _mm_add_epi16(offset, step);
+  }
+  return Iptr;
+}
+
+template <size_t N>
+FUNCTION_TARGET_AVX2 u16* WriteBlocksAVX2(u16* Iptr, const PatternBlock& block, u32 num_blocks)
+{
+  __m256i value[N], advance[N], restart[N];
+  for (size_t i = 0; i < N; i++)
+  {
+    value[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.value[i * 16]));
+    advance[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.advance[i * 16]));
+    restart[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.restart[i * 16]));
+  }
+
+  const __m256i step = _mm256_set1_epi16(block.step);
+  __m256i offset = _mm256_setzero_si256();
+  for (u32 b = 0; b < num_blocks; b++)
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      const __m256i indices = _mm256_or_si256(
+          _mm256_add_epi16(value[i], _mm256_and_si256(offset, advance[i])), restart[i]);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(Iptr), indices);
+      Iptr += 16;
+    }
+    offset = _mm256_add_epi16(offset, step);
+  }
+  return Iptr;
+}
+#elif defined(_M_ARM_64)
+template <size_t N>
+u16* WriteBlocksNEON(u16* Iptr, const PatternBlock& block, u32 num_blocks)
+{
+  uint16x8_t value[N], advance[N], restart[N];
+  for (size_t i = 0; i < N; i++)
+  {
+    value[i] = vld1q_u16(&block.value[i * 8]);
+    advance[i] = vld1q_u16(&block.advance[i * 8]);
+    restart[i] = vld1q_u16(&block.restart[i * 8]);
+  }
+
+  const uint16x8_t step = vdupq_n_u16(block.step);
+  uint16x8_t offset = vdupq_n_u16(0);
+  for (u32 b = 0; b < num_blocks; b++)
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      vst1q_u16(Iptr, vorrq_u16(vaddq_u16(value[i], vandq_u16(offset, advance[i])), restart[i]));
+      Iptr += 8;
+    }
+    offset = vaddq_u16(offset, step);
+  }
+  return Iptr;
+}
+#endif
+
+u32 GetVectorLanes()
+{
+  switch (s_vector_isa)
+  {
+  case VectorISA::SSE2:
+  case VectorISA::NEON:
+    return 8;
+  case VectorISA::AVX2:
+    return 16;
+  default:
+    return 0;
+  }
+}
+
+DOLPHIN_FORCE_INLINE u16 PatternIndex(s32 entry, u32 index, u32 offset)
+{
+  if (entry == RESTART)
+    return s_primitive_restart;
+  if (entry == CENTER)
+    return index;
+  return index + offset + entry;
+}
+
+// Writes reps groups of the pattern, the vertices of group r starting at index + r * step.
+template <size_t N>
+u16* WritePattern(u16* Iptr, const std::array<s32, N>& pattern, u32 step, u32 index, u32 reps)
+{
+  static_assert(N <= MAX_PATTERN_SIZE, "Pattern too large");
+
+  u32 rep = 0;
+  const u32 lanes = GetVectorLanes();
+  if (lanes && reps >= lanes)
+  {
+    PatternBlock block;
+    for (u32 i = 0; i < lanes * N; i++)
+    {
+      const s32 entry = pattern[i % N];
+      block.value[i] = entry == RESTART ? 0 : PatternIndex(entry, index, i / N * step);
+      block.advance[i] = entry >= 0 ? 0xFFFF : 0;
+      block.restart[i] = entry == RESTART ? 0xFFFF : 0;
+    }
+    block.step = static_cast<u16>(lanes * step);
+
+    const u32 num_blocks = reps / lanes;
+    switch (s_vector_isa)
+    {
+#if defined(_M_X86_64)
+    case VectorISA::SSE2:
+      Iptr = WriteBlocksSSE2<N>(Iptr, block, num_blocks);
+      break;
+    case VectorISA::AVX2:
+      Iptr = WriteBlocksAVX2<N>(Iptr, block, num_blocks);
+      break;
+#elif defined(_M_ARM_64)
+    case VectorISA::NEON:
+      Iptr = WriteBlocksNEON<N>(Iptr, block, num_blocks);
+      break;
+#endif
+    default:
+      break;
+    }
+    rep = num_blocks * lanes;
+  }
+
+  for (; rep < reps; ++rep)
+  {
+    for (s32 entry : pattern)
+      *Iptr++ = PatternIndex(entry, index, rep * step);
+  }
+  return Iptr;
+}
+}  // Anonymous namespace
+
+template <bool pr>
+u16* IndexGenerator::AddListVectorized(u16* Iptr, u32 numVerts, u32 index)
+{
+  if (pr)
+    return WritePattern<4>(Iptr, {{0, 1, 2, RESTART}}, 3, index, numVerts / 3);
+  else
+    return WritePattern<3>(Iptr, {{0, 1, 2}}, 3, index, numVerts / 3);
+}
+
+template <bool pr>
+u16* IndexGenerator::AddStripVectorized(u16* Iptr, u32 numVerts, u32 index)
+{
+  if (pr)
+  {
+    // Strips are passed through unchanged.
+    Iptr = WritePattern<1>(Iptr, {{0}}, 1, index, numVerts);
+    *Iptr++ = s_primitive_restart;
+    return Iptr;
+  }
+
+  if (numVerts < 3)
+    return Iptr;
+
+  // Two triangles per group, the second one with flipped winding.
+  const u32 pairs = (numVerts - 2) / 2;
+  Iptr = WritePattern<6>(Iptr, {{0, 1, 2, 1, 3, 2}}, 2, index, pairs);
+  if ((numVerts - 2) % 2)
+  {
+    const u32 i = index + pairs * 2;
+    Iptr = WriteTriangle<pr>(Iptr, i, i + 1, i + 2);
+  }
+  return Iptr;
+}
+
+template <bool pr>
+u16* IndexGenerator::AddFanVectorized(u16* Iptr, u32 numVerts, u32 index)
+{
+  if (numVerts < 3)
+    return Iptr;
+
+  if (!pr)
+    return WritePattern<3>(Iptr, {{CENTER, 1, 2}}, 1, index, numVerts - 2);
+
+  // Three triangles per strip of six indices, see AddFan().
+  const u32 groups = (numVerts - 2) / 3;
+  Iptr = WritePattern<6>(Iptr, {{1, 2, CENTER, 3, 4, RESTART}}, 3, index, groups);
+
+  u32 i = 2 + groups * 3;
+  if (i + 2 <= numVerts)
+  {
+    *Iptr++ = index + i - 1;
+    *Iptr++ = index + i + 0;
+    *Iptr++ = index;
+    *Iptr++ = index + i + 1;
+    *Iptr++ = s_primitive_restart;
+    i += 2;
+  }
+  for (; i < numVerts; ++i)
+    Iptr = WriteTriangle<pr>(Iptr, index, index + i - 1, index + i);
+  return Iptr;
+}
+
+template <bool pr>
+u16* IndexGenerator::AddQuadsVectorized(u16* Iptr, u32 numVerts, u32 index)
+{
+  if (pr)
+    Iptr = WritePattern<5>(Iptr, {{1, 2, 0, 3, RESTART}}, 4, index, numVerts / 4);
+  else
+    Iptr = WritePattern<6>(Iptr, {{0, 1, 2, 0, 2, 3}}, 4, index, numVerts / 4);
+
+  // three vertices remaining, so render a triangle
+  if (numVerts % 4 == 3)
+  {
+    Iptr =
+        WriteTriangle<pr>(Iptr, index + numVerts - 3, index + numVerts - 2, index + numVerts - 1);
+  }
+  return Iptr;
+}
+
 // Lines
 u16* IndexGenerator::AddLineList(u16* Iptr, u32 numVerts, u32 index)
 {
@@ -13,17 +13,30 @@ class IndexGenerator
 {
 public:
   // Init
-  static void Init();
+  // The vectorized generators are used when the host supports them, unless vectorized is false.
+  static void Init(bool vectorized = true);
   static void Start(u16* Indexptr);
 
   static void AddIndices(int primitive, u32 numVertices);
 
+  // Support for generating the indices of one batch on several threads.
+  // Returns how many vertices form one independent primitive, or 0 if the indices of a vertex
+  // depend on the preceding ones (strips and fans).
+  static u32 GetSplitGranularity(int primitive);
+  // Writes the indices for numVertices vertices starting at first_vertex of the pending batch.
+  // first_vertex has to be a multiple of the split granularity.
+  static void AddIndicesAt(int primitive, u32 first_vertex, u32 numVertices);
+  // Completes a batch whose indices were written by AddIndicesAt().
+  static void CommitIndices(int primitive, u32 numVertices);
+
   // returns numprimitives
   static u32 GetNumVerts() { return base_index; }
   static u32 GetIndexLen() { return (u32)(index_buffer_current - BASEIptr); }
   static u32 GetRemainingIndices();
 
 private:
+  static u32 GetIndexCount(int primitive, u32 numVertices);
+
   // Triangles
   template <bool pr>
   static u16* AddList(u16* Iptr, u32 numVerts, u32 index);
@@ -36,6 +49,15 @@ private:
   template <bool pr>
   static u16* AddQuads_nonstandard(u16* Iptr, u32 numVerts, u32 index);
 
+  template <bool pr>
+  static u16* AddListVectorized(u16* Iptr, u32 numVerts, u32 index);
+  template <bool pr>
+  static u16* AddStripVectorized(u16* Iptr, u32 numVerts, u32 index);
+  template <bool pr>
+  static u16* AddFanVectorized(u16* Iptr, u32 numVerts, u32 index);
+  template <bool pr>
+  static u16* AddQuadsVectorized(u16* Iptr, u32 numVerts, u32 index);
+
   // Lines
   static u16* AddLineList(u16* Iptr, u32 numVerts, u32 index);
   static u16* AddLineStrip(u16* Iptr, u32 numVerts, u32 index);
@@ -15,9 +15,18 @@
 // when they are called. The reason is that the vertex format affects the sizes of the vertices.
 
 #include "VideoCommon/OpcodeDecoding.h"
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 #include "Core/FifoPlayer/FifoRecorder.h"
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/BPMemory.h"
@@ -25,8 +34,11 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/XFMemory.h"
 
@@ -36,14 +48,25 @@ namespace OpcodeDecoder
 {
 static bool s_bFifoErrorSeen = false;
 
+// Register writes which don't change anything are dropped before they reach the BP/CP/XF
+// handlers. Counted per register (XF by start address) since the last Init().
+static std::array<u32, 0x100> s_redundant_bp_writes;
+static std::array<u32, 0x100> s_redundant_cp_writes;
+static std::array<u32, 0x1058> s_redundant_xf_writes;
+
 static u32 InterpretDisplayList(u32 address, u32 size)
 {
   u8* startAddress;
 
   if (Fifo::UseDeterministicGPUThread())
+  {
     startAddress = (u8*)Fifo::PopFifoAuxBuffer(size);
+  }
   else
+  {
+    g_texture_cache->FlushEFBCopies(address, size);
     startAddress = Memory::GetPointer(address);
+  }
 
   u32 cycles = 0;
 
@@ -78,12 +101,52 @@ static void InterpretDisplayListPreprocess(u32 address, u32 size)
 void Init()
 {
   s_bFifoErrorSeen = false;
+  s_redundant_bp_writes.fill(0);
+  s_redundant_cp_writes.fill(0);
+  s_redundant_xf_writes.fill(0);
+}
+
+template <size_t size>
+static std::string RedundantWritesToString(const char* name,
+                                           const std::array<u32, size>& counters)
+{
+  std::vector<std::pair<u32, u32>> registers;
+  u64 total = 0;
+  for (u32 i = 0; i < size; i++)
+  {
+    total += counters[i];
+    if (counters[i])
+      registers.emplace_back(counters[i], i);
+  }
+  if (!total)
+    return {};
+
+  // Only show the worst offenders, the overlay is crowded enough.
+  constexpr size_t MAX_REGISTERS = 4;
+  const size_t shown = std::min(registers.size(), MAX_REGISTERS);
+  std::partial_sort(registers.begin(), registers.begin() + shown, registers.end(),
+                    [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  std::string str = StringFromFormat("%s writes skipped: %" PRIu64 " (", name, total);
+  for (size_t i = 0; i < shown; i++)
+    str += StringFromFormat("%s%x: %u", i ? ", " : "", registers[i].second, registers[i].first);
+  str += registers.size() > shown ? ", ...)\n" : ")\n";
+  return str;
+}
+
+std::string RedundantWritesToString()
+{
+  return RedundantWritesToString("BP", s_redundant_bp_writes) +
+         RedundantWritesToString("CP", s_redundant_cp_writes) +
+         RedundantWritesToString("XF", s_redundant_xf_writes);
 }
 
 template <bool is_preprocess>
 u8* Run(DataReader src, u32* cycles, bool in_display_list)
 {
+  StageTimings::ScopedTimer timer(StageTimings::Stage::OpcodeDecode, !is_preprocess);
   u32 totalCycles = 0;
+  u8* const start = src.GetPointer();
   u8* opcodeStart;
   while (true)
   {
@@ -112,9 +175,18 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list)
       totalCycles += 12;
       u8 sub_cmd = src.Read<u8>();
       u32 value = src.Read<u32>();
-      LoadCPReg(sub_cmd, value, is_preprocess);
-      if (!is_preprocess)
+      if (is_preprocess)
+      {
+        LoadCPReg(sub_cmd, value, true);
+      }
+      else
+      {
+        if (IsRedundantCPWrite(sub_cmd, value))
+          s_redundant_cp_writes[sub_cmd]++;
+        else
+          LoadCPReg(sub_cmd, value);
         INCSTAT(stats.thisFrame.numCPLoads);
+      }
     }
     break;
 
@@ -130,7 +202,10 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list)
       if (!is_preprocess)
       {
         u32 xf_address = Cmd2 & 0xFFFF;
-        LoadXFReg(transfer_size, xf_address, src);
+        if (IsRedundantXFWrite(transfer_size, xf_address, src))
+          s_redundant_xf_writes[xf_address]++;
+        else
+          LoadXFReg(transfer_size, xf_address, src);
 
         INCSTAT(stats.thisFrame.numXFLoads);
       }
@@ -207,7 +282,13 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list)
         }
         else
         {
-          LoadBPReg(bp_cmd);
+          // LoadBPReg reloads the state after a savestate was loaded, which has to happen even
+          // when the write itself is skipped.
+          g_video_backend->CheckInvalidState();
+          if (IsRedundantBPWrite(bp_cmd))
+            s_redundant_bp_writes[bp_cmd >> 24]++;
+          else
+            LoadBPReg(bp_cmd);
           INCSTAT(stats.thisFrame.numBPLoads);
         }
       }
@@ -259,6 +340,9 @@ end:
   {
     *cycles = totalCycles;
   }
+  // Display lists are read from RAM, not from the FIFO.
+  if (!is_preprocess && !in_display_list)
+    ADDSTAT(stats.thisFrame.bytesFifoProcessed, static_cast<int>(opcodeStart - start));
   return opcodeStart;
 }
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <string>
+
 #include "Common/CommonTypes.h"
 
 class DataReader;
@@ -52,6 +54,9 @@ enum
 
 void Init();
 
+// Summary of the register writes that were skipped because they didn't change anything.
+std::string RedundantWritesToString();
+
 template <bool is_preprocess = false>
 u8* Run(DataReader src, u32* cycles, bool in_display_list);
 
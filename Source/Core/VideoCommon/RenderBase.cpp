@@ -14,8 +14,10 @@
 
 #include "VideoCommon/RenderBase.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -47,9 +49,11 @@
 #include "VideoCommon/AbstractStagingTexture.h"
 #include "VideoCommon/AbstractTexture.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BenchmarkRecorder.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Debugger.h"
+#include "VideoCommon/EFBPeekCache.h"
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/ImageWrite.h"
@@ -58,6 +62,7 @@
 #include "VideoCommon/PostProcessing.h"
 #include "VideoCommon/ShaderCache.h"
 #include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -71,6 +76,14 @@ int frameCount;
 
 std::unique_ptr<Renderer> g_renderer;
 
+// The number of frames whose readbacks are in flight while dumping frames. Each is mapped two
+// frames after it was rendered, so that the GPU has finished the copy by then.
+static constexpr size_t FRAME_DUMP_READBACK_DEPTH = 3;
+
+// How many read back frames may wait for the frame dumping thread before the GPU thread waits
+// for it. This covers encoder hiccups without stalling emulation.
+static constexpr size_t MAX_QUEUED_FRAME_DUMPS = 8;
+
 static float AspectToWidescreen(float aspect)
 {
   return aspect * ((16.0f / 9.0f) / (4.0f / 3.0f));
@@ -656,10 +669,10 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
       m_aspect_wide = flush_count_anamorphic > 0.75 * flush_total;
   }
 
-  // Ensure the last frame was written to the dump.
-  // This is required even if frame dumping has stopped, since the frame dump is one frame
-  // behind the renderer.
-  FlushFrameDump();
+  // Ensure the frames rendered a few frames ago were written to the dump.
+  // This is required even if frame dumping has stopped, since the frame dump is behind the
+  // renderer. Screenshots are taken on the next frame.
+  FlushFrameDump(SConfig::GetInstance().m_DumpFrames ? FRAME_DUMP_READBACK_DEPTH - 1 : 0);
 
   if (xfbAddr && fbWidth && fbStride && fbHeight)
   {
@@ -682,10 +695,14 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
 
       // TODO: merge more generic parts into VideoCommon
       {
+        StageTimings::ScopedTimer timer(StageTimings::Stage::Present);
         std::lock_guard<std::mutex> guard(m_swap_mutex);
         g_renderer->SwapImpl(xfb_entry->texture.get(), xfb_rect, ticks);
       }
 
+      // The backends may have resized or resolved the EFB.
+      EFBPeekCache::Invalidate();
+
       // Update the window size based on the frame that was just rendered.
       // Due to depending on guest state, we need to call this every frame.
       SetWindowSize(texture_config.width, texture_config.height);
@@ -701,6 +718,8 @@ void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const
       // Begin new frame
       // Set default viewport and scissor, for the clear to work correctly
       // New frame
+      StageTimings::OnFramePresented();
+      BenchmarkRecorder::OnFramePresented();
       stats.ResetFrame();
       g_shader_cache->RetrieveAsyncShaders();
 
@@ -784,42 +803,54 @@ void Renderer::RenderFrameDump()
 
 void Renderer::QueueFrameDumpReadback()
 {
-  // Index 0 was just sent to AVI dump. Swap with the second texture.
-  if (m_frame_dump_readback_textures[0])
-    std::swap(m_frame_dump_readback_textures[0], m_frame_dump_readback_textures[1]);
-
-  std::unique_ptr<AbstractStagingTexture>& rbtex = m_frame_dump_readback_textures[0];
-  if (!rbtex || rbtex->GetConfig() != m_frame_dump_render_texture->GetConfig())
+  const TextureConfig& config = m_frame_dump_render_texture->GetConfig();
+  FrameDumpReadback readback;
+  const auto iter =
+      std::find_if(m_frame_dump_free_readback_textures.begin(),
+                   m_frame_dump_free_readback_textures.end(),
+                   [&config](const auto& texture) { return texture->GetConfig() == config; });
+  if (iter != m_frame_dump_free_readback_textures.end())
   {
-    rbtex = CreateStagingTexture(StagingTextureType::Readback,
-                                 m_frame_dump_render_texture->GetConfig());
+    readback.texture = std::move(*iter);
+    m_frame_dump_free_readback_textures.erase(iter);
+  }
+  else
+  {
+    readback.texture = CreateStagingTexture(StagingTextureType::Readback, config);
   }
 
-  m_last_frame_state = AVIDump::FetchState(m_last_xfb_ticks);
-  m_last_frame_exported = true;
-  rbtex->CopyFromTexture(m_frame_dump_render_texture.get(), 0, 0);
+  readback.state = AVIDump::FetchState(m_last_xfb_ticks);
+  readback.screenshot = m_screenshot_request.TestAndClear();
+  readback.texture->CopyFromTexture(m_frame_dump_render_texture.get(), 0, 0);
+  m_frame_dump_readbacks.push_back(std::move(readback));
 }
 
-void Renderer::FlushFrameDump()
+void Renderer::FlushFrameDump(size_t max_pending_readbacks)
 {
-  if (!m_last_frame_exported)
+  if (m_frame_dump_readbacks.empty())
     return;
 
-  // Ensure the previously-queued frame was encoded.
-  FinishFrameData();
-
-  // Queue encoding of the last frame dumped.
-  std::unique_ptr<AbstractStagingTexture>& rbtex = m_frame_dump_readback_textures[0];
-  rbtex->Flush();
-  if (rbtex->Map())
+  // Queue encoding of the oldest frames dumped.
+  while (m_frame_dump_readbacks.size() > max_pending_readbacks)
   {
-    DumpFrameData(reinterpret_cast<u8*>(rbtex->GetMappedPointer()), rbtex->GetConfig().width,
-                  rbtex->GetConfig().height, static_cast<int>(rbtex->GetMappedStride()),
-                  m_last_frame_state);
-    rbtex->Unmap();
-  }
+    FrameDumpReadback readback = std::move(m_frame_dump_readbacks.front());
+    m_frame_dump_readbacks.pop_front();
+
+    AbstractStagingTexture* rbtex = readback.texture.get();
+    rbtex->Flush();
+    if (rbtex->Map())
+    {
+      DumpFrameData(reinterpret_cast<u8*>(rbtex->GetMappedPointer()), rbtex->GetConfig().width,
+                    rbtex->GetConfig().height, static_cast<int>(rbtex->GetMappedStride()),
+                    readback.state, readback.screenshot);
+      rbtex->Unmap();
+    }
 
-  m_last_frame_exported = false;
+    // Keep the most recently used textures, old ones may have a different size.
+    if (m_frame_dump_free_readback_textures.size() >= FRAME_DUMP_READBACK_DEPTH)
+      m_frame_dump_free_readback_textures.erase(m_frame_dump_free_readback_textures.begin());
+    m_frame_dump_free_readback_textures.push_back(std::move(readback.texture));
+  }
 
   // Shutdown frame dumping if it is no longer active.
   if (!IsFrameDumping())
@@ -828,29 +859,45 @@ void Renderer::FlushFrameDump()
 
 void Renderer::ShutdownFrameDumping()
 {
-  // Ensure the last queued readback has been sent to the encoder.
+  // Ensure the queued readbacks have been sent to the encoder.
   FlushFrameDump();
 
   if (!m_frame_dump_thread_running.IsSet())
     return;
 
-  // Ensure previous frame has been encoded.
+  // Ensure previous frames have been encoded.
   FinishFrameData();
 
   // Wake thread up, and wait for it to exit.
-  m_frame_dump_thread_running.Clear();
-  m_frame_dump_start.Set();
+  {
+    std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+    m_frame_dump_thread_running.Clear();
+  }
+  m_frame_dump_queue_changed.notify_all();
   if (m_frame_dump_thread.joinable())
     m_frame_dump_thread.join();
   m_frame_dump_render_texture.reset();
-  for (auto& tex : m_frame_dump_readback_textures)
-    tex.reset();
+  m_frame_dump_readbacks.clear();
+  m_frame_dump_free_readback_textures.clear();
+  m_frame_dump_free_buffers.clear();
+
+  if (m_frame_dump_num_frames > 0)
+  {
+    NOTICE_LOG(VIDEO,
+               "Frame dump: %u frames, waited %u times for the encoder for %" PRIu64
+               " ms in total, at most %zu frames queued",
+               m_frame_dump_num_frames, m_frame_dump_num_stalls,
+               m_frame_dump_stall_time_us / 1000, m_frame_dump_max_queued);
+  }
+  m_frame_dump_num_frames = 0;
+  m_frame_dump_num_stalls = 0;
+  m_frame_dump_stall_time_us = 0;
+  m_frame_dump_max_queued = 0;
 }
 
-void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state)
+void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state,
+                             bool screenshot)
 {
-  m_frame_dump_config = FrameDumpConfig{data, w, h, stride, state};
-
   if (!m_frame_dump_thread_running.IsSet())
   {
     if (m_frame_dump_thread.joinable())
@@ -859,18 +906,47 @@ void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVI
     m_frame_dump_thread = std::thread(&Renderer::RunFrameDumps, this);
   }
 
-  // Wake worker thread up.
-  m_frame_dump_start.Set();
-  m_frame_dump_frame_running = true;
+  std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+
+  // Back-pressure: the readbacks can't be kept around for long, so wait for the encoder here.
+  if (m_frame_dump_queue.size() >= MAX_QUEUED_FRAME_DUMPS)
+  {
+    const u64 start_time = Common::Timer::GetTimeUs();
+    m_frame_dump_queue_changed.wait(
+        lk, [this] { return m_frame_dump_queue.size() < MAX_QUEUED_FRAME_DUMPS; });
+    m_frame_dump_num_stalls++;
+    m_frame_dump_stall_time_us += Common::Timer::GetTimeUs() - start_time;
+  }
+
+  QueuedFrameDump frame;
+  if (!m_frame_dump_free_buffers.empty())
+  {
+    frame.data = std::move(m_frame_dump_free_buffers.back());
+    m_frame_dump_free_buffers.pop_back();
+  }
+  lk.unlock();
+
+  // The staging texture is reused for later frames, so the frame dumping thread gets a copy.
+  const size_t row_size = static_cast<size_t>(w) * 4;
+  frame.data.resize(row_size * h);
+  for (int y = 0; y < h; y++)
+    std::memcpy(&frame.data[row_size * y], data + static_cast<size_t>(stride) * y, row_size);
+  frame.config = FrameDumpConfig{nullptr, w, h, static_cast<int>(row_size), state};
+  frame.screenshot = screenshot;
+
+  lk.lock();
+  m_frame_dump_queue.push_back(std::move(frame));
+  m_frame_dump_max_queued = std::max(m_frame_dump_max_queued, m_frame_dump_queue.size());
+  m_frame_dump_num_frames++;
+  lk.unlock();
+  m_frame_dump_queue_changed.notify_all();
 }
 
 void Renderer::FinishFrameData()
 {
-  if (!m_frame_dump_frame_running)
-    return;
-
-  m_frame_dump_done.Wait();
-  m_frame_dump_frame_running = false;
+  std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+  m_frame_dump_queue_changed.wait(
+      lk, [this] { return m_frame_dump_queue.empty() && !m_frame_dump_frame_running; });
 }
 
 void Renderer::RunFrameDumps()
@@ -891,14 +967,26 @@ void Renderer::RunFrameDumps()
 
   while (true)
   {
-    m_frame_dump_start.Wait();
-    if (!m_frame_dump_thread_running.IsSet())
-      break;
+    QueuedFrameDump frame;
+    {
+      std::unique_lock<std::mutex> lk(m_frame_dump_queue_lock);
+      m_frame_dump_queue_changed.wait(lk, [this] {
+        return !m_frame_dump_queue.empty() || !m_frame_dump_thread_running.IsSet();
+      });
+      if (m_frame_dump_queue.empty())
+        break;
+
+      frame = std::move(m_frame_dump_queue.front());
+      m_frame_dump_queue.pop_front();
+      m_frame_dump_frame_running = true;
+    }
+    m_frame_dump_queue_changed.notify_all();
 
-    auto config = m_frame_dump_config;
+    auto config = frame.config;
+    config.data = frame.data.data();
 
     // Save screenshot
-    if (m_screenshot_request.TestAndClear())
+    if (frame.screenshot)
     {
       std::lock_guard<std::mutex> lk(m_screenshot_lock);
 
@@ -935,7 +1023,12 @@ void Renderer::RunFrameDumps()
       }
     }
 
-    m_frame_dump_done.Set();
+    {
+      std::lock_guard<std::mutex> lk(m_frame_dump_queue_lock);
+      m_frame_dump_free_buffers.push_back(std::move(frame.data));
+      m_frame_dump_frame_running = false;
+    }
+    m_frame_dump_queue_changed.notify_all();
   }
 
   if (frame_dump_started)
@@ -16,6 +16,7 @@
 
 #include <array>
 #include <condition_variable>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -258,11 +259,8 @@ private:
 
   // frame dumping
   std::thread m_frame_dump_thread;
-  Common::Event m_frame_dump_start;
-  Common::Event m_frame_dump_done;
   Common::Flag m_frame_dump_thread_running;
   u32 m_frame_dump_image_counter = 0;
-  bool m_frame_dump_frame_running = false;
   struct FrameDumpConfig
   {
     const u8* data;
@@ -270,13 +268,41 @@ private:
     int height;
     int stride;
     AVIDump::Frame state;
-  } m_frame_dump_config;
+  };
+
+  // A frame which was read back, waiting for the frame dumping thread
+  struct QueuedFrameDump
+  {
+    std::vector<u8> data;
+    FrameDumpConfig config;
+    bool screenshot;
+  };
+  std::mutex m_frame_dump_queue_lock;
+  std::condition_variable m_frame_dump_queue_changed;
+  std::deque<QueuedFrameDump> m_frame_dump_queue;
+  // Whether the frame dumping thread is still working on the frame it took from the queue
+  bool m_frame_dump_frame_running = false;
+  std::vector<std::vector<u8>> m_frame_dump_free_buffers;
+
+  // How much the frame dumping thread held the GPU thread back, logged when frame dumping stops
+  u32 m_frame_dump_num_frames = 0;
+  u32 m_frame_dump_num_stalls = 0;
+  u64 m_frame_dump_stall_time_us = 0;
+  size_t m_frame_dump_max_queued = 0;
 
   // Texture used for screenshot/frame dumping
   std::unique_ptr<AbstractTexture> m_frame_dump_render_texture;
-  std::array<std::unique_ptr<AbstractStagingTexture>, 2> m_frame_dump_readback_textures;
-  AVIDump::Frame m_last_frame_state;
-  bool m_last_frame_exported = false;
+
+  // The readbacks of the last frames, oldest first. They are mapped a few frames later, so that
+  // the GPU has finished the copies by then.
+  struct FrameDumpReadback
+  {
+    std::unique_ptr<AbstractStagingTexture> texture;
+    AVIDump::Frame state;
+    bool screenshot;
+  };
+  std::deque<FrameDumpReadback> m_frame_dump_readbacks;
+  std::vector<std::unique_ptr<AbstractStagingTexture>> m_frame_dump_free_readback_textures;
 
   // Tracking of XFB textures so we don't render duplicate frames.
   AbstractTexture* m_last_xfb_texture = nullptr;
@@ -308,14 +334,16 @@ private:
   // Fills the frame dump render texture with the current XFB texture.
   void RenderFrameDump();
 
-  // Queues the current frame for readback, which will be written to AVI next frame.
+  // Queues the current frame for readback, which will be written to AVI a few frames later.
   void QueueFrameDumpReadback();
 
-  // Asynchronously encodes the specified pointer of frame data to the frame dump.
-  void DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state);
+  // Copies the frame data and queues it for encoding. Waits if the frame dumping thread is too
+  // far behind.
+  void DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state,
+                     bool screenshot);
 
-  // Ensures all rendered frames are queued for encoding.
-  void FlushFrameDump();
+  // Queues the rendered frames for encoding, except for the last max_pending_readbacks ones.
+  void FlushFrameDump(size_t max_pending_readbacks = 0);
 
   // Ensures all encoded frames have been written to the output file.
   void FinishFrameData();
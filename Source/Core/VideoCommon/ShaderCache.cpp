@@ -60,6 +60,8 @@ void ShaderCache::SetHostConfig(const ShaderHostConfig& host_config, u32 efb_mul
   if (m_host_config.bits == host_config.bits && m_efb_multisamples == efb_multisamples)
     return;
 
+  // The compiler threads read the host config, so stop them from using it first.
+  m_async_shader_compiler->CancelWorkItems();
   m_host_config = host_config;
   m_efb_multisamples = efb_multisamples;
   Reload();
@@ -67,7 +69,8 @@ void ShaderCache::SetHostConfig(const ShaderHostConfig& host_config, u32 efb_mul
 
 void ShaderCache::Reload()
 {
-  WaitForAsyncCompiler();
+  // Whatever is still being compiled was compiled for the old configuration.
+  m_async_shader_compiler->CancelWorkItems();
   ClosePipelineUIDCache();
   InvalidateCachedPipelines();
   ClearShaderCaches();
@@ -97,6 +100,9 @@ void ShaderCache::Shutdown()
   // This may leave shaders uncommitted to the cache, but it's better than blocking shutdown
   // until everything has finished compiling.
   m_async_shader_compiler->StopWorkerThreads();
+  const std::string statistics = m_async_shader_compiler->StatisticsToString();
+  if (!statistics.empty())
+    INFO_LOG(VIDEO, "%s", statistics.c_str());
   ClosePipelineUIDCache();
   ClearShaderCaches();
   ClearPipelineCaches();
@@ -126,8 +132,10 @@ std::optional<const AbstractPipeline*> ShaderCache::GetPipelineForUidAsync(const
     // .second is the pending flag, i.e. compiling in the background.
     if (!it->second.second)
       return it->second.first.get();
-    else
-      return {};
+
+    // The pipeline is needed now, so compile it before those which may be needed later.
+    BoostPipelineCompile(it->first, COMPILE_PRIORITY_ONDEMAND_PIPELINE);
+    return {};
   }
 
   AppendGXPipelineUID(uid);
@@ -148,6 +156,11 @@ const AbstractPipeline* ShaderCache::GetUberPipelineForUid(const GXUberPipelineU
   return InsertGXUberPipeline(uid, std::move(pipeline));
 }
 
+std::string ShaderCache::CompilerStatisticsToString() const
+{
+  return m_async_shader_compiler ? m_async_shader_compiler->StatisticsToString() : std::string();
+}
+
 void ShaderCache::WaitForAsyncCompiler()
 {
   while (m_async_shader_compiler->HasPendingWork() || m_async_shader_compiler->HasCompletedWork())
@@ -161,83 +174,63 @@ void ShaderCache::WaitForAsyncCompiler()
   Host_UpdateProgressDialog("", -1, -1);
 }
 
-template <ShaderStage stage, typename K, typename T>
-static void LoadShaderCache(T& cache, APIType api_type, const char* type, bool include_gameid)
+// Finds the shader for uid, creating it from the disk cache if it was compiled in an earlier
+// session. Null if the shader has yet to be compiled.
+template <typename T, typename Uid>
+static typename T::Shader* FindShader(T& cache, const Uid& uid)
 {
-  class CacheReader : public LinearDiskCacheReader<K, u8>
-  {
-  public:
-    CacheReader(T& cache_) : cache(cache_) {}
-    void Read(const K& key, const u8* value, u32 value_size)
-    {
-      auto shader = g_renderer->CreateShaderFromBinary(stage, value, value_size);
-      if (shader)
-      {
-        auto& entry = cache.shader_map[key];
-        entry.shader = std::move(shader);
-        entry.pending = false;
+  auto iter = cache.shader_map.find(uid);
+  if (iter != cache.shader_map.end())
+    return &iter->second;
 
-        switch (stage)
-        {
-        case ShaderStage::Vertex:
-          INCSTAT(stats.numVertexShadersCreated);
-          INCSTAT(stats.numVertexShadersAlive);
-          break;
-        case ShaderStage::Pixel:
-          INCSTAT(stats.numPixelShadersCreated);
-          INCSTAT(stats.numPixelShadersAlive);
-          break;
-        default:
-          break;
-        }
-      }
-    }
+  size_t binary_size;
+  const u8* binary = cache.disk_cache->Lookup(cache.disk_cache_tag, uid, &binary_size);
+  if (!binary)
+    return nullptr;
 
-  private:
-    T& cache;
-  };
+  auto shader = g_renderer->CreateShaderFromBinary(cache.stage, binary, binary_size);
+  if (!shader)
+    return nullptr;
 
-  std::string filename = GetDiskShaderCacheFileName(api_type, type, include_gameid, true);
-  CacheReader reader(cache);
-  u32 count = cache.disk_cache.OpenAndRead(filename, reader);
-  INFO_LOG(VIDEO, "Loaded %u cached shaders from %s", count, filename.c_str());
-}
+  switch (cache.stage)
+  {
+  case ShaderStage::Vertex:
+    INCSTAT(stats.numVertexShadersCreated);
+    INCSTAT(stats.numVertexShadersAlive);
+    break;
+  case ShaderStage::Pixel:
+    INCSTAT(stats.numPixelShadersCreated);
+    INCSTAT(stats.numPixelShadersAlive);
+    break;
+  default:
+    break;
+  }
 
-template <typename T>
-static void ClearShaderCache(T& cache)
-{
-  cache.disk_cache.Sync();
-  cache.disk_cache.Close();
-  cache.shader_map.clear();
+  auto& entry = cache.shader_map[uid];
+  entry.shader = std::move(shader);
+  entry.pending = false;
+  return &entry;
 }
 
 void ShaderCache::LoadShaderCaches()
 {
-  // Ubershader caches, if present.
-  LoadShaderCache<ShaderStage::Vertex, UberShader::VertexShaderUid>(m_uber_vs_cache, m_api_type,
-                                                                    "uber-vs", false);
-  LoadShaderCache<ShaderStage::Pixel, UberShader::PixelShaderUid>(m_uber_ps_cache, m_api_type,
-                                                                  "uber-ps", false);
-
-  // We also share geometry shaders, as there aren't many variants.
-  if (m_host_config.backend_geometry_shaders)
-    LoadShaderCache<ShaderStage::Geometry, GeometryShaderUid>(m_gs_cache, m_api_type, "gs", false);
-
-  // Specialized shaders, gameid-specific.
-  LoadShaderCache<ShaderStage::Vertex, VertexShaderUid>(m_vs_cache, m_api_type, "specialized-vs",
-                                                        true);
-  LoadShaderCache<ShaderStage::Pixel, PixelShaderUid>(m_ps_cache, m_api_type, "specialized-ps",
-                                                      true);
+  // Shaders are only created from the binaries once they are used, so this is cheap.
+  m_shared_disk_cache.Open(GetDiskShaderCacheFileName(m_api_type, "shared", false, true));
+  m_specialized_disk_cache.Open(
+      GetDiskShaderCacheFileName(m_api_type, "specialized", true, true));
 }
 
 void ShaderCache::ClearShaderCaches()
 {
-  ClearShaderCache(m_vs_cache);
-  ClearShaderCache(m_gs_cache);
-  ClearShaderCache(m_ps_cache);
+  m_shared_disk_cache.Close();
+  m_specialized_disk_cache.Close();
 
-  ClearShaderCache(m_uber_vs_cache);
-  ClearShaderCache(m_uber_ps_cache);
+  m_vs_cache.shader_map.clear();
+  m_gs_cache.shader_map.clear();
+  m_ps_cache.shader_map.clear();
+
+  m_uber_vs_cache.shader_map.clear();
+  m_uber_ps_cache.shader_map.clear();
 
   SETSTAT(stats.numPixelShadersCreated, 0);
   SETSTAT(stats.numPixelShadersAlive, 0);
@@ -323,7 +316,7 @@ const AbstractShader* ShaderCache::InsertVertexShader(const VertexShaderUid& uid
     {
       auto binary = shader->GetBinary();
       if (!binary.empty())
-        m_vs_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
+        m_vs_cache.disk_cache->Append(m_vs_cache.disk_cache_tag, uid, binary.data(), binary.size());
     }
     INCSTAT(stats.numVertexShadersCreated);
     INCSTAT(stats.numVertexShadersAlive);
@@ -345,7 +338,10 @@ const AbstractShader* ShaderCache::InsertVertexUberShader(const UberShader::Vert
     {
       auto binary = shader->GetBinary();
       if (!binary.empty())
-        m_uber_vs_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
+      {
+        m_uber_vs_cache.disk_cache->Append(m_uber_vs_cache.disk_cache_tag, uid, binary.data(),
+                                            binary.size());
+      }
     }
     INCSTAT(stats.numVertexShadersCreated);
     INCSTAT(stats.numVertexShadersAlive);
@@ -367,7 +363,7 @@ const AbstractShader* ShaderCache::InsertPixelShader(const PixelShaderUid& uid,
     {
       auto binary = shader->GetBinary();
       if (!binary.empty())
-        m_ps_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
+        m_ps_cache.disk_cache->Append(m_ps_cache.disk_cache_tag, uid, binary.data(), binary.size());
     }
     INCSTAT(stats.numPixelShadersCreated);
     INCSTAT(stats.numPixelShadersAlive);
@@ -389,7 +385,10 @@ const AbstractShader* ShaderCache::InsertPixelUberShader(const UberShader::Pixel
     {
       auto binary = shader->GetBinary();
       if (!binary.empty())
-        m_uber_ps_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
+      {
+        m_uber_ps_cache.disk_cache->Append(m_uber_ps_cache.disk_cache_tag, uid, binary.data(),
+                                            binary.size());
+      }
     }
     INCSTAT(stats.numPixelShadersCreated);
     INCSTAT(stats.numPixelShadersAlive);
@@ -414,7 +413,7 @@ const AbstractShader* ShaderCache::CreateGeometryShader(const GeometryShaderUid&
     {
       auto binary = shader->GetBinary();
       if (!binary.empty())
-        m_gs_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
+        m_gs_cache.disk_cache->Append(m_gs_cache.disk_cache_tag, uid, binary.data(), binary.size());
     }
     entry.shader = std::move(shader);
   }
@@ -452,9 +451,9 @@ AbstractPipelineConfig ShaderCache::GetGXPipelineConfig(
 std::optional<AbstractPipelineConfig> ShaderCache::GetGXPipelineConfig(const GXPipelineUid& config)
 {
   const AbstractShader* vs;
-  auto vs_iter = m_vs_cache.shader_map.find(config.vs_uid);
-  if (vs_iter != m_vs_cache.shader_map.end() && !vs_iter->second.pending)
-    vs = vs_iter->second.shader.get();
+  auto* vs_entry = FindShader(m_vs_cache, config.vs_uid);
+  if (vs_entry && !vs_entry->pending)
+    vs = vs_entry->shader.get();
   else
     vs = InsertVertexShader(config.vs_uid, CompileVertexShader(config.vs_uid));
 
@@ -462,9 +461,9 @@ std::optional<AbstractPipelineConfig> ShaderCache::GetGXPipelineConfig(const GXP
   ClearUnusedPixelShaderUidBits(m_api_type, m_host_config, &ps_uid);
 
   const AbstractShader* ps;
-  auto ps_iter = m_ps_cache.shader_map.find(ps_uid);
-  if (ps_iter != m_ps_cache.shader_map.end() && !ps_iter->second.pending)
-    ps = ps_iter->second.shader.get();
+  auto* ps_entry = FindShader(m_ps_cache, ps_uid);
+  if (ps_entry && !ps_entry->pending)
+    ps = ps_entry->shader.get();
   else
     ps = InsertPixelShader(ps_uid, CompilePixelShader(ps_uid));
 
@@ -474,9 +473,9 @@ std::optional<AbstractPipelineConfig> ShaderCache::GetGXPipelineConfig(const GXP
   const AbstractShader* gs = nullptr;
   if (NeedsGeometryShader(config.gs_uid))
   {
-    auto gs_iter = m_gs_cache.shader_map.find(config.gs_uid);
-    if (gs_iter != m_gs_cache.shader_map.end() && !gs_iter->second.pending)
-      gs = gs_iter->second.shader.get();
+    auto* gs_entry = FindShader(m_gs_cache, config.gs_uid);
+    if (gs_entry && !gs_entry->pending)
+      gs = gs_entry->shader.get();
     else
       gs = CreateGeometryShader(config.gs_uid);
     if (!gs)
@@ -491,9 +490,9 @@ std::optional<AbstractPipelineConfig>
 ShaderCache::GetGXUberPipelineConfig(const GXUberPipelineUid& config)
 {
   const AbstractShader* vs;
-  auto vs_iter = m_uber_vs_cache.shader_map.find(config.vs_uid);
-  if (vs_iter != m_uber_vs_cache.shader_map.end() && !vs_iter->second.pending)
-    vs = vs_iter->second.shader.get();
+  auto* vs_entry = FindShader(m_uber_vs_cache, config.vs_uid);
+  if (vs_entry && !vs_entry->pending)
+    vs = vs_entry->shader.get();
   else
     vs = InsertVertexUberShader(config.vs_uid, CompileVertexUberShader(config.vs_uid));
 
@@ -501,9 +500,9 @@ ShaderCache::GetGXUberPipelineConfig(const GXUberPipelineUid& config)
   UberShader::ClearUnusedPixelShaderUidBits(m_api_type, m_host_config, &ps_uid);
 
   const AbstractShader* ps;
-  auto ps_iter = m_uber_ps_cache.shader_map.find(ps_uid);
-  if (ps_iter != m_uber_ps_cache.shader_map.end() && !ps_iter->second.pending)
-    ps = ps_iter->second.shader.get();
+  auto* ps_entry = FindShader(m_uber_ps_cache, ps_uid);
+  if (ps_entry && !ps_entry->pending)
+    ps = ps_entry->shader.get();
   else
     ps = InsertPixelUberShader(ps_uid, CompilePixelUberShader(ps_uid));
 
@@ -513,9 +512,9 @@ ShaderCache::GetGXUberPipelineConfig(const GXUberPipelineUid& config)
   const AbstractShader* gs = nullptr;
   if (NeedsGeometryShader(config.gs_uid))
   {
-    auto gs_iter = m_gs_cache.shader_map.find(config.gs_uid);
-    if (gs_iter != m_gs_cache.shader_map.end() && !gs_iter->second.pending)
-      gs = gs_iter->second.shader.get();
+    auto* gs_entry = FindShader(m_gs_cache, config.gs_uid);
+    if (gs_entry && !gs_entry->pending)
+      gs = gs_entry->shader.get();
     else
       gs = CreateGeometryShader(config.gs_uid);
     if (!gs)
@@ -695,9 +694,10 @@ void ShaderCache::QueueVertexShaderCompile(const VertexShaderUid& uid, u32 prior
     VertexShaderUid uid;
   };
 
-  m_vs_cache.shader_map[uid].pending = true;
+  auto& entry = m_vs_cache.shader_map[uid];
+  entry.pending = true;
   auto wi = m_async_shader_compiler->CreateWorkItem<VertexShaderWorkItem>(this, uid);
-  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
+  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority, &entry);
 }
 
 void ShaderCache::QueueVertexUberShaderCompile(const UberShader::VertexShaderUid& uid, u32 priority)
@@ -724,9 +724,10 @@ void ShaderCache::QueueVertexUberShaderCompile(const UberShader::VertexShaderUid
     UberShader::VertexShaderUid uid;
   };
 
-  m_uber_vs_cache.shader_map[uid].pending = true;
+  auto& entry = m_uber_vs_cache.shader_map[uid];
+  entry.pending = true;
   auto wi = m_async_shader_compiler->CreateWorkItem<VertexUberShaderWorkItem>(this, uid);
-  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
+  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority, &entry);
 }
 
 void ShaderCache::QueuePixelShaderCompile(const PixelShaderUid& uid, u32 priority)
@@ -753,9 +754,10 @@ void ShaderCache::QueuePixelShaderCompile(const PixelShaderUid& uid, u32 priorit
     PixelShaderUid uid;
   };
 
-  m_ps_cache.shader_map[uid].pending = true;
+  auto& entry = m_ps_cache.shader_map[uid];
+  entry.pending = true;
   auto wi = m_async_shader_compiler->CreateWorkItem<PixelShaderWorkItem>(this, uid);
-  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
+  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority, &entry);
 }
 
 void ShaderCache::QueuePixelUberShaderCompile(const UberShader::PixelShaderUid& uid, u32 priority)
@@ -782,9 +784,10 @@ void ShaderCache::QueuePixelUberShaderCompile(const UberShader::PixelShaderUid&
     UberShader::PixelShaderUid uid;
   };
 
-  m_uber_ps_cache.shader_map[uid].pending = true;
+  auto& entry = m_uber_ps_cache.shader_map[uid];
+  entry.pending = true;
   auto wi = m_async_shader_compiler->CreateWorkItem<PixelUberShaderWorkItem>(this, uid);
-  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
+  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority, &entry);
 }
 
 void ShaderCache::QueuePipelineCompile(const GXPipelineUid& uid, u32 priority)
@@ -805,17 +808,17 @@ void ShaderCache::QueuePipelineCompile(const GXPipelineUid& uid, u32 priority)
     {
       stages_ready = true;
 
-      auto vs_it = shader_cache->m_vs_cache.shader_map.find(uid.vs_uid);
-      stages_ready &= vs_it != shader_cache->m_vs_cache.shader_map.end() && !vs_it->second.pending;
-      if (vs_it == shader_cache->m_vs_cache.shader_map.end())
+      auto* vs = FindShader(shader_cache->m_vs_cache, uid.vs_uid);
+      stages_ready &= vs && !vs->pending;
+      if (!vs)
         shader_cache->QueueVertexShaderCompile(uid.vs_uid, priority);
 
       PixelShaderUid ps_uid = uid.ps_uid;
       ClearUnusedPixelShaderUidBits(shader_cache->m_api_type, shader_cache->m_host_config, &ps_uid);
 
-      auto ps_it = shader_cache->m_ps_cache.shader_map.find(ps_uid);
-      stages_ready &= ps_it != shader_cache->m_ps_cache.shader_map.end() && !ps_it->second.pending;
-      if (ps_it == shader_cache->m_ps_cache.shader_map.end())
+      auto* ps = FindShader(shader_cache->m_ps_cache, ps_uid);
+      stages_ready &= ps && !ps->pending;
+      if (!ps)
         shader_cache->QueuePixelShaderCompile(ps_uid, priority);
 
       return stages_ready;
@@ -839,7 +842,8 @@ void ShaderCache::QueuePipelineCompile(const GXPipelineUid& uid, u32 priority)
         // Re-queue for next frame.
         auto wi = shader_cache->m_async_shader_compiler->CreateWorkItem<PipelineWorkItem>(
             shader_cache, uid, priority);
-        shader_cache->m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
+        shader_cache->m_async_shader_compiler->QueueWorkItem(
+            std::move(wi), priority, &shader_cache->m_gx_pipeline_cache[uid]);
       }
     }
 
@@ -852,9 +856,28 @@ void ShaderCache::QueuePipelineCompile(const GXPipelineUid& uid, u32 priority)
     bool stages_ready;
   };
 
+  auto& entry = m_gx_pipeline_cache[uid];
   auto wi = m_async_shader_compiler->CreateWorkItem<PipelineWorkItem>(this, uid, priority);
-  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
-  m_gx_pipeline_cache[uid].second = true;
+  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority, &entry);
+  entry.second = true;
+}
+
+void ShaderCache::BoostPipelineCompile(const GXPipelineUid& uid, u32 priority)
+{
+  // The pipeline work item is queued again until its shaders are compiled, so boost those too.
+  auto pipeline_it = m_gx_pipeline_cache.find(uid);
+  if (pipeline_it != m_gx_pipeline_cache.end())
+    m_async_shader_compiler->BoostWorkItem(&pipeline_it->second, priority);
+
+  auto vs_it = m_vs_cache.shader_map.find(uid.vs_uid);
+  if (vs_it != m_vs_cache.shader_map.end() && vs_it->second.pending)
+    m_async_shader_compiler->BoostWorkItem(&vs_it->second, priority);
+
+  PixelShaderUid ps_uid = uid.ps_uid;
+  ClearUnusedPixelShaderUidBits(m_api_type, m_host_config, &ps_uid);
+  auto ps_it = m_ps_cache.shader_map.find(ps_uid);
+  if (ps_it != m_ps_cache.shader_map.end() && ps_it->second.pending)
+    m_async_shader_compiler->BoostWorkItem(&ps_it->second, priority);
 }
 
 void ShaderCache::QueueUberPipelineCompile(const GXUberPipelineUid& uid, u32 priority)
@@ -875,20 +898,18 @@ void ShaderCache::QueueUberPipelineCompile(const GXUberPipelineUid& uid, u32 pri
     {
       stages_ready = true;
 
-      auto vs_it = shader_cache->m_uber_vs_cache.shader_map.find(uid.vs_uid);
-      stages_ready &=
-          vs_it != shader_cache->m_uber_vs_cache.shader_map.end() && !vs_it->second.pending;
-      if (vs_it == shader_cache->m_uber_vs_cache.shader_map.end())
+      auto* vs = FindShader(shader_cache->m_uber_vs_cache, uid.vs_uid);
+      stages_ready &= vs && !vs->pending;
+      if (!vs)
         shader_cache->QueueVertexUberShaderCompile(uid.vs_uid, priority);
 
       UberShader::PixelShaderUid ps_uid = uid.ps_uid;
       UberShader::ClearUnusedPixelShaderUidBits(shader_cache->m_api_type,
                                                 shader_cache->m_host_config, &ps_uid);
 
-      auto ps_it = shader_cache->m_uber_ps_cache.shader_map.find(ps_uid);
-      stages_ready &=
-          ps_it != shader_cache->m_uber_ps_cache.shader_map.end() && !ps_it->second.pending;
-      if (ps_it == shader_cache->m_uber_ps_cache.shader_map.end())
+      auto* ps = FindShader(shader_cache->m_uber_ps_cache, ps_uid);
+      stages_ready &= ps && !ps->pending;
+      if (!ps)
         shader_cache->QueuePixelUberShaderCompile(ps_uid, priority);
 
       return stages_ready;
@@ -912,7 +933,8 @@ void ShaderCache::QueueUberPipelineCompile(const GXUberPipelineUid& uid, u32 pri
         // Re-queue for next frame.
         auto wi = shader_cache->m_async_shader_compiler->CreateWorkItem<UberPipelineWorkItem>(
             shader_cache, uid, priority);
-        shader_cache->m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
+        shader_cache->m_async_shader_compiler->QueueWorkItem(
+            std::move(wi), priority, &shader_cache->m_gx_uber_pipeline_cache[uid]);
       }
     }
 
@@ -925,9 +947,10 @@ void ShaderCache::QueueUberPipelineCompile(const GXUberPipelineUid& uid, u32 pri
     bool stages_ready;
   };
 
+  auto& entry = m_gx_uber_pipeline_cache[uid];
   auto wi = m_async_shader_compiler->CreateWorkItem<UberPipelineWorkItem>(this, uid, priority);
-  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority);
-  m_gx_uber_pipeline_cache[uid].second = true;
+  m_async_shader_compiler->QueueWorkItem(std::move(wi), priority, &entry);
+  entry.second = true;
 }
 
 void ShaderCache::QueueUberShaderPipelines()
@@ -16,7 +16,6 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
-#include "Common/LinearDiskCache.h"
 
 #include "VideoCommon/AbstractPipeline.h"
 #include "VideoCommon/AbstractShader.h"
@@ -25,6 +24,7 @@
 #include "VideoCommon/GeometryShaderGen.h"
 #include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/RenderState.h"
+#include "VideoCommon/ShaderDiskCache.h"
 #include "VideoCommon/UberShaderPixel.h"
 #include "VideoCommon/UberShaderVertex.h"
 #include "VideoCommon/VertexShaderGen.h"
@@ -64,6 +64,9 @@ public:
   // The optional will be empty if this pipeline is now background compiling.
   std::optional<const AbstractPipeline*> GetPipelineForUidAsync(const GXPipelineUid& uid);
 
+  // Queue and compile times of the async compiler, for the statistics display.
+  std::string CompilerStatisticsToString() const;
+
 private:
   void WaitForAsyncCompiler();
   void LoadShaderCaches();
@@ -115,6 +118,7 @@ private:
   void QueuePixelUberShaderCompile(const UberShader::PixelShaderUid& uid, u32 priority);
   void QueuePipelineCompile(const GXPipelineUid& uid, u32 priority);
   void QueueUberPipelineCompile(const GXUberPipelineUid& uid, u32 priority);
+  void BoostPipelineCompile(const GXPipelineUid& uid, u32 priority);
 
   // Priorities for compiling. The lower the value, the sooner the pipeline is compiled.
   // The shader cache is compiled last, as it is the least likely to be required. On demand
@@ -134,6 +138,21 @@ private:
   u32 m_efb_multisamples = 1;
   std::unique_ptr<AsyncShaderCompiler> m_async_shader_compiler;
 
+  // Shader binaries from earlier sessions. Ubershaders and geometry shaders are shared between
+  // games, as there is a limited number of them.
+  ShaderDiskCache m_shared_disk_cache;
+  ShaderDiskCache m_specialized_disk_cache;
+
+  // Tells the kinds of shaders in a disk cache apart.
+  enum : u32
+  {
+    DISK_CACHE_TAG_VERTEX_SHADER,
+    DISK_CACHE_TAG_GEOMETRY_SHADER,
+    DISK_CACHE_TAG_PIXEL_SHADER,
+    DISK_CACHE_TAG_VERTEX_UBER_SHADER,
+    DISK_CACHE_TAG_PIXEL_UBER_SHADER
+  };
+
   // GX Shader Caches
   template <typename Uid>
   struct ShaderModuleCache
@@ -143,14 +162,27 @@ private:
       std::unique_ptr<AbstractShader> shader;
       bool pending;
     };
+
+    ShaderModuleCache(ShaderStage stage_, ShaderDiskCache* disk_cache_, u32 disk_cache_tag_)
+        : stage(stage_), disk_cache(disk_cache_), disk_cache_tag(disk_cache_tag_)
+    {
+    }
+
     std::map<Uid, Shader> shader_map;
-    LinearDiskCache<Uid, u8> disk_cache;
+    ShaderStage stage;
+    ShaderDiskCache* disk_cache;
+    u32 disk_cache_tag;
   };
-  ShaderModuleCache<VertexShaderUid> m_vs_cache;
-  ShaderModuleCache<GeometryShaderUid> m_gs_cache;
-  ShaderModuleCache<PixelShaderUid> m_ps_cache;
-  ShaderModuleCache<UberShader::VertexShaderUid> m_uber_vs_cache;
-  ShaderModuleCache<UberShader::PixelShaderUid> m_uber_ps_cache;
+  ShaderModuleCache<VertexShaderUid> m_vs_cache{ShaderStage::Vertex, &m_specialized_disk_cache,
+                                                DISK_CACHE_TAG_VERTEX_SHADER};
+  ShaderModuleCache<GeometryShaderUid> m_gs_cache{ShaderStage::Geometry, &m_shared_disk_cache,
+                                                  DISK_CACHE_TAG_GEOMETRY_SHADER};
+  ShaderModuleCache<PixelShaderUid> m_ps_cache{ShaderStage::Pixel, &m_specialized_disk_cache,
+                                               DISK_CACHE_TAG_PIXEL_SHADER};
+  ShaderModuleCache<UberShader::VertexShaderUid> m_uber_vs_cache{
+      ShaderStage::Vertex, &m_shared_disk_cache, DISK_CACHE_TAG_VERTEX_UBER_SHADER};
+  ShaderModuleCache<UberShader::PixelShaderUid> m_uber_ps_cache{
+      ShaderStage::Pixel, &m_shared_disk_cache, DISK_CACHE_TAG_PIXEL_UBER_SHADER};
 
   // GX Pipeline Caches - .first - pipeline, .second - pending
   std::map<GXPipelineUid, std::pair<std::unique_ptr<AbstractPipeline>, bool>> m_gx_pipeline_cache;
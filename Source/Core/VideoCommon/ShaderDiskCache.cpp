@@ -0,0 +1,403 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/ShaderDiskCache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <xxhash.h>
+
+#include "Common/Align.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/Version.h"
+
+namespace VideoCommon
+{
+namespace
+{
+constexpr u32 FILE_MAGIC = 0x41435344;    // "DSCA"
+constexpr u32 RECORD_MAGIC = 0x44434552;  // "RECD"
+constexpr u32 FILE_VERSION = 1;
+
+constexpr u64 RECORD_ALIGNMENT = 8;
+
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  // Binaries may not be compatible with the ones other builds generate.
+  char scm_rev[40];
+  // Zero while the file is open, or if Dolphin didn't get to write the index.
+  u64 index_offset;
+  u64 index_size;
+  u64 index_checksum;
+};
+
+// Followed by the UID bytes and the binary.
+struct RecordHeader
+{
+  u32 magic;
+  u32 tag;
+  u32 key_size;
+  u32 data_size;
+  u64 checksum;
+};
+
+// Followed by the tag and the UID bytes.
+struct IndexEntry
+{
+  u64 offset;
+  u32 data_size;
+  u32 index_key_size;
+  u64 checksum;
+};
+
+static_assert(sizeof(FileHeader) % RECORD_ALIGNMENT == 0, "Header breaks the record alignment");
+static_assert(sizeof(RecordHeader) % RECORD_ALIGNMENT == 0, "Header breaks the record alignment");
+static_assert(sizeof(IndexEntry) % RECORD_ALIGNMENT == 0, "Entry breaks the index alignment");
+
+FileHeader MakeFileHeader(u64 index_offset, u64 index_size, u64 index_checksum)
+{
+  FileHeader header = {FILE_MAGIC, FILE_VERSION, {}, index_offset, index_size, index_checksum};
+  std::memcpy(header.scm_rev, Common::scm_rev_git_str.c_str(),
+              std::min(Common::scm_rev_git_str.size(), sizeof(header.scm_rev)));
+  return header;
+}
+
+u64 GetRecordSize(u64 key_size, u64 data_size)
+{
+  return Common::AlignUp(sizeof(RecordHeader) + key_size + data_size, RECORD_ALIGNMENT);
+}
+
+u64 ComputeChecksum(u32 tag, const void* key, size_t key_size, const u8* data, size_t data_size)
+{
+  return XXH64(data, data_size, XXH64(key, key_size, tag));
+}
+}  // namespace
+
+ShaderDiskCache::~ShaderDiskCache()
+{
+  Close();
+}
+
+bool ShaderDiskCache::Open(const std::string& filename)
+{
+  Close();
+  m_filename = filename;
+
+  if (!LoadIndex())
+  {
+    m_mapping.Close();
+    m_index.clear();
+    m_unused_size = 0;
+
+    File::CreateFullPath(filename);
+    File::IOFile file(filename, "wb");
+    const FileHeader header = MakeFileHeader(0, 0, 0);
+    if (!file.WriteArray(&header, 1))
+    {
+      ERROR_LOG(VIDEO, "Failed to create shader cache %s", filename.c_str());
+      return false;
+    }
+    m_end = sizeof(FileHeader);
+  }
+
+  if (!m_file.Open(filename, "r+b"))
+  {
+    m_mapping.Close();
+    m_index.clear();
+    return false;
+  }
+
+  // New records overwrite the index, and Close() writes it again. Drop it until then, so that
+  // the records are scanned if Dolphin crashes. The mapping has to go first, as mapped files
+  // can't be truncated everywhere.
+  if (m_file.GetSize() > m_end)
+  {
+    m_mapping.Close();
+    m_file.Resize(m_end);
+  }
+  const FileHeader header = MakeFileHeader(0, 0, 0);
+  m_file.WriteArray(&header, 1);
+  m_file.Seek(m_end, SEEK_SET);
+  m_write_failed = false;
+
+  INFO_LOG(VIDEO, "Opened shader cache %s with %zu entries", filename.c_str(), m_index.size());
+  return true;
+}
+
+void ShaderDiskCache::Close()
+{
+  if (!IsOpen())
+    return;
+
+  // Compact the file once a quarter of it is taken up by records which are no longer used.
+  if (m_unused_size > (m_end - sizeof(FileHeader)) / 4)
+  {
+    m_file.Close();
+    Compact();
+  }
+  else if (!WriteIndex(m_file, m_end))
+  {
+    ERROR_LOG(VIDEO, "Failed to write the index of shader cache %s", m_filename.c_str());
+  }
+
+  m_file.Close();
+  m_mapping.Close();
+  m_index.clear();
+  m_end = 0;
+  m_unused_size = 0;
+}
+
+const u8* ShaderDiskCache::Lookup(u32 tag, const void* key, size_t key_size, size_t* size)
+{
+  auto iter = m_index.find(MakeIndexKey(tag, key, key_size));
+  if (iter == m_index.end())
+    return nullptr;
+
+  Entry& entry = iter->second;
+  const u64 record_size = GetRecordSize(key_size, entry.data_size);
+  if (entry.offset + record_size > m_mapping.GetSize())
+  {
+    // The record was written after the file was mapped.
+    if (!m_file.Flush() || !m_mapping.Open(m_filename) ||
+        entry.offset + record_size > m_mapping.GetSize())
+    {
+      return nullptr;
+    }
+  }
+
+  const u8* record = m_mapping.GetData() + entry.offset;
+  const u8* data = record + sizeof(RecordHeader) + key_size;
+  if (!entry.verified)
+  {
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(header));
+    if (header.magic != RECORD_MAGIC || header.tag != tag || header.key_size != key_size ||
+        header.data_size != entry.data_size || header.checksum != entry.checksum ||
+        std::memcmp(record + sizeof(RecordHeader), key, key_size) != 0 ||
+        ComputeChecksum(tag, key, key_size, data, entry.data_size) != entry.checksum)
+    {
+      WARN_LOG(VIDEO, "Dropping damaged record from shader cache %s", m_filename.c_str());
+      m_unused_size += record_size;
+      m_index.erase(iter);
+      return nullptr;
+    }
+    entry.verified = true;
+  }
+
+  *size = entry.data_size;
+  return data;
+}
+
+void ShaderDiskCache::Append(u32 tag, const void* key, size_t key_size, const u8* data,
+                             size_t size)
+{
+  if (!IsOpen() || m_write_failed)
+    return;
+
+  static constexpr u8 zeros[RECORD_ALIGNMENT] = {};
+  const u64 checksum = ComputeChecksum(tag, key, key_size, data, size);
+  const RecordHeader header = {RECORD_MAGIC, tag, static_cast<u32>(key_size),
+                               static_cast<u32>(size), checksum};
+  const u64 record_size = GetRecordSize(key_size, size);
+  if (!m_file.WriteArray(&header, 1) || !m_file.WriteBytes(key, key_size) ||
+      !m_file.WriteBytes(data, size) ||
+      !m_file.WriteBytes(zeros, record_size - sizeof(RecordHeader) - key_size - size))
+  {
+    // The index is written over the partial record, but the file is likely full anyway.
+    ERROR_LOG(VIDEO, "Failed to write to shader cache %s", m_filename.c_str());
+    m_write_failed = true;
+    return;
+  }
+
+  AddEntry(MakeIndexKey(tag, key, key_size), {m_end, static_cast<u32>(size), checksum, true});
+  m_end += record_size;
+}
+
+std::string ShaderDiskCache::MakeIndexKey(u32 tag, const void* key, size_t key_size)
+{
+  std::string index_key(sizeof(tag) + key_size, '\0');
+  std::memcpy(&index_key[0], &tag, sizeof(tag));
+  std::memcpy(&index_key[sizeof(tag)], key, key_size);
+  return index_key;
+}
+
+bool ShaderDiskCache::LoadIndex()
+{
+  if (!m_mapping.Open(m_filename) || m_mapping.GetSize() < sizeof(FileHeader))
+    return false;
+
+  FileHeader header;
+  std::memcpy(&header, m_mapping.GetData(), sizeof(header));
+  const FileHeader expected_header = MakeFileHeader(0, 0, 0);
+  if (header.magic != FILE_MAGIC || header.version != FILE_VERSION ||
+      std::memcmp(header.scm_rev, expected_header.scm_rev, sizeof(header.scm_rev)) != 0)
+  {
+    WARN_LOG(VIDEO, "Discarding shader cache %s from another version", m_filename.c_str());
+    return false;
+  }
+
+  m_index.clear();
+  m_unused_size = 0;
+  if (header.index_offset != 0 &&
+      ReadIndex(header.index_offset, header.index_size, header.index_checksum))
+  {
+    return true;
+  }
+
+  if (header.index_offset != 0)
+    WARN_LOG(VIDEO, "Shader cache %s has a damaged index", m_filename.c_str());
+  m_index.clear();
+  ScanRecords();
+  return true;
+}
+
+bool ShaderDiskCache::ReadIndex(u64 index_offset, u64 index_size, u64 index_checksum)
+{
+  const u64 file_size = m_mapping.GetSize();
+  if (index_offset < sizeof(FileHeader) || index_offset > file_size ||
+      index_size > file_size - index_offset)
+  {
+    return false;
+  }
+
+  const u8* index = m_mapping.GetData() + index_offset;
+  if (XXH64(index, static_cast<size_t>(index_size), 0) != index_checksum)
+    return false;
+
+  u64 used_size = 0;
+  u64 offset = 0;
+  while (offset < index_size)
+  {
+    IndexEntry index_entry;
+    if (index_size - offset < sizeof(IndexEntry))
+      return false;
+    std::memcpy(&index_entry, index + offset, sizeof(index_entry));
+    offset += sizeof(IndexEntry);
+
+    const u64 padded_key_size = Common::AlignUp<u64>(index_entry.index_key_size, RECORD_ALIGNMENT);
+    if (index_entry.index_key_size < sizeof(u32) || padded_key_size > index_size - offset)
+      return false;
+
+    const u64 record_size =
+        GetRecordSize(index_entry.index_key_size - sizeof(u32), index_entry.data_size);
+    if (index_entry.offset < sizeof(FileHeader) || index_entry.offset > index_offset ||
+        record_size > index_offset - index_entry.offset)
+    {
+      return false;
+    }
+
+    const char* index_key = reinterpret_cast<const char*>(index + offset);
+    const Entry entry = {index_entry.offset, index_entry.data_size, index_entry.checksum, false};
+    m_index.emplace(std::string(index_key, index_entry.index_key_size), entry);
+    used_size += record_size;
+    offset += padded_key_size;
+  }
+
+  m_end = index_offset;
+  m_unused_size = m_end - sizeof(FileHeader) - std::min(used_size, m_end - sizeof(FileHeader));
+  return true;
+}
+
+void ShaderDiskCache::ScanRecords()
+{
+  const u8* data = m_mapping.GetData();
+  const u64 file_size = m_mapping.GetSize();
+
+  u64 offset = sizeof(FileHeader);
+  while (file_size - offset >= sizeof(RecordHeader))
+  {
+    RecordHeader header;
+    std::memcpy(&header, data + offset, sizeof(header));
+    const u64 record_size = GetRecordSize(header.key_size, header.data_size);
+    if (header.magic != RECORD_MAGIC || record_size > file_size - offset)
+      break;
+
+    AddEntry(MakeIndexKey(header.tag, data + offset + sizeof(RecordHeader), header.key_size),
+             {offset, header.data_size, header.checksum, false});
+    offset += record_size;
+  }
+  m_end = offset;
+}
+
+void ShaderDiskCache::AddEntry(std::string index_key, const Entry& entry)
+{
+  auto [iter, inserted] = m_index.emplace(std::move(index_key), entry);
+  if (inserted)
+    return;
+
+  m_unused_size += GetRecordSize(iter->first.size() - sizeof(u32), iter->second.data_size);
+  iter->second = entry;
+}
+
+bool ShaderDiskCache::WriteIndex(File::IOFile& file, u64 index_offset) const
+{
+  std::vector<u8> index;
+  for (const auto& [index_key, entry] : m_index)
+  {
+    const IndexEntry index_entry = {entry.offset, entry.data_size,
+                                    static_cast<u32>(index_key.size()), entry.checksum};
+    const size_t position = index.size();
+    index.resize(position + sizeof(IndexEntry) +
+                 Common::AlignUp(index_key.size(), static_cast<size_t>(RECORD_ALIGNMENT)));
+    std::memcpy(&index[position], &index_entry, sizeof(index_entry));
+    std::memcpy(&index[position + sizeof(IndexEntry)], index_key.data(), index_key.size());
+  }
+
+  // The header goes last, so that the index is only used once all of it has been written.
+  const FileHeader header =
+      MakeFileHeader(index_offset, index.size(), XXH64(index.data(), index.size(), 0));
+  return file.Seek(index_offset, SEEK_SET) && file.WriteBytes(index.data(), index.size()) &&
+         file.Flush() && file.Seek(0, SEEK_SET) && file.WriteArray(&header, 1);
+}
+
+void ShaderDiskCache::Compact()
+{
+  if (!m_mapping.Open(m_filename))
+    return;
+
+  // Keep the records in the order they were written.
+  std::vector<std::pair<u64, Entry*>> records;
+  records.reserve(m_index.size());
+  for (auto& [index_key, entry] : m_index)
+    records.emplace_back(GetRecordSize(index_key.size() - sizeof(u32), entry.data_size), &entry);
+  std::sort(records.begin(), records.end(),
+            [](const auto& a, const auto& b) { return a.second->offset < b.second->offset; });
+
+  const std::string temp_filename = m_filename + ".tmp";
+  File::IOFile file(temp_filename, "wb");
+  const FileHeader header = MakeFileHeader(0, 0, 0);
+  bool success = file.WriteArray(&header, 1);
+  u64 offset = sizeof(FileHeader);
+  for (auto& [record_size, entry] : records)
+  {
+    if (!success)
+      break;
+
+    success = entry->offset + record_size <= m_mapping.GetSize() &&
+              file.WriteBytes(m_mapping.GetData() + entry->offset, record_size);
+    entry->offset = offset;
+    offset += record_size;
+  }
+  success = success && WriteIndex(file, offset);
+  file.Close();
+  m_mapping.Close();
+
+  if (!success || !File::Rename(temp_filename, m_filename))
+  {
+    ERROR_LOG(VIDEO, "Failed to compact shader cache %s", m_filename.c_str());
+    File::Delete(temp_filename);
+    return;
+  }
+
+  INFO_LOG(VIDEO, "Compacted shader cache %s from %" PRIu64 " to %" PRIu64 " bytes",
+           m_filename.c_str(), m_end, offset);
+}
+}  // namespace VideoCommon
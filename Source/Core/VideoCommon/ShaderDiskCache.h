@@ -0,0 +1,92 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/MappedFile.h"
+
+namespace VideoCommon
+{
+// Shader binaries of several kinds in a single file, indexed by their UIDs. The tag of a record
+// tells the kinds apart, as UIDs of different stages may have the same bytes.
+//
+// The file is a header, the records, and an index of the records, which Close() writes after the
+// records. Opening the file only reads the index; the binaries are read through a memory mapping
+// when they are looked up, and their checksums are verified then. If the index is missing, e.g.
+// because Dolphin crashed, the records are scanned instead. Records which were replaced or are
+// damaged are dropped when too much of the file is taken up by them.
+class ShaderDiskCache
+{
+public:
+  ShaderDiskCache() = default;
+  ~ShaderDiskCache();
+
+  ShaderDiskCache(const ShaderDiskCache&) = delete;
+  ShaderDiskCache& operator=(const ShaderDiskCache&) = delete;
+
+  // Opens the cache file, or creates it if it is missing or was written by another version.
+  bool Open(const std::string& filename);
+  // Writes the index, compacting the file first if needed.
+  void Close();
+  bool IsOpen() const { return m_file.IsOpen(); }
+
+  // Returns the binary stored for the key, or nullptr if there is none or it is damaged. The
+  // pointer stays valid until the next call to Lookup(), Append() or Close().
+  const u8* Lookup(u32 tag, const void* key, size_t key_size, size_t* size);
+  // Adds a record, replacing the one with the same key if there is one.
+  void Append(u32 tag, const void* key, size_t key_size, const u8* data, size_t size);
+
+  template <typename K>
+  const u8* Lookup(u32 tag, const K& key, size_t* size)
+  {
+    return Lookup(tag, &key, sizeof(key), size);
+  }
+
+  template <typename K>
+  void Append(u32 tag, const K& key, const u8* data, size_t size)
+  {
+    Append(tag, &key, sizeof(key), data, size);
+  }
+
+  size_t GetEntryCount() const { return m_index.size(); }
+  // Size of the records which are no longer used.
+  u64 GetUnusedSize() const { return m_unused_size; }
+
+private:
+  struct Entry
+  {
+    // Offset of the record header in the file.
+    u64 offset;
+    u32 data_size;
+    u64 checksum;
+    bool verified;
+  };
+
+  static std::string MakeIndexKey(u32 tag, const void* key, size_t key_size);
+
+  bool LoadIndex();
+  bool ReadIndex(u64 index_offset, u64 index_size, u64 index_checksum);
+  void ScanRecords();
+  void AddEntry(std::string index_key, const Entry& entry);
+  bool WriteIndex(File::IOFile& file, u64 index_offset) const;
+  void Compact();
+
+  std::string m_filename;
+  File::IOFile m_file;
+  File::MappedFile m_mapping;
+  bool m_write_failed = false;
+
+  // The tag and the UID bytes of each record, to the record.
+  std::unordered_map<std::string, Entry> m_index;
+  // Where the records end, and the next one is written.
+  u64 m_end = 0;
+  u64 m_unused_size = 0;
+};
+}  // namespace VideoCommon
@@ -0,0 +1,280 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/StageTimings.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace StageTimings
+{
+std::atomic<bool> g_enabled{false};
+
+static const char* const s_stage_names[NUM_STAGES] = {
+    "opcode_decode", "vertex_load", "texture_load", "shader_lookup", "backend_draw", "present",
+};
+
+// In nanoseconds, for the frame which is being rendered
+static std::array<std::atomic<u64>, NUM_STAGES> s_current_times;
+static thread_local ScopedTimer* s_current_timer = nullptr;
+
+static bool s_benchmarking = false;
+static std::ofstream s_log_file;
+
+static std::mutex s_frames_lock;
+static std::vector<Frame> s_frames;
+static size_t s_next_frame = 0;
+static Frame s_last_frame;
+
+struct TraceEvent
+{
+  Stage stage;
+  int thread_id;
+  // In nanoseconds since the start of the trace
+  s64 start;
+  s64 duration;
+};
+static constexpr size_t MAX_TRACE_EVENTS = 1000000;
+static std::atomic<bool> s_tracing{false};
+static std::mutex s_trace_lock;
+static std::vector<TraceEvent> s_trace_events;
+static std::vector<s64> s_trace_frames;
+static std::chrono::steady_clock::time_point s_trace_start;
+
+const char* GetStageName(Stage stage)
+{
+  return s_stage_names[static_cast<size_t>(stage)];
+}
+
+static void UpdateEnabled()
+{
+  g_enabled.store(g_ActiveConfig.bLogRenderTimeToFile || s_benchmarking || s_tracing.load(),
+                  std::memory_order_relaxed);
+}
+
+static s64 SinceTraceStart(std::chrono::steady_clock::time_point time)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time - s_trace_start).count();
+}
+
+void ScopedTimer::Begin(Stage stage)
+{
+  m_stage = stage;
+  m_active = true;
+  m_parent = s_current_timer;
+  s_current_timer = this;
+  m_start = std::chrono::steady_clock::now();
+}
+
+void ScopedTimer::End()
+{
+  const auto end = std::chrono::steady_clock::now();
+  const auto elapsed = end - m_start;
+  s_current_timer = m_parent;
+  if (m_parent)
+    m_parent->m_nested_time += elapsed;
+
+  const auto own_time =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed - m_nested_time);
+  s_current_times[static_cast<size_t>(m_stage)].fetch_add(static_cast<u64>(own_time.count()),
+                                                          std::memory_order_relaxed);
+
+  if (s_tracing.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock(s_trace_lock);
+    if (s_trace_events.size() < MAX_TRACE_EVENTS)
+    {
+      s_trace_events.push_back({m_stage, Common::CurrentThreadId(), SinceTraceStart(m_start),
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                                    .count()});
+    }
+  }
+}
+
+void StartTrace()
+{
+  {
+    std::lock_guard<std::mutex> lock(s_trace_lock);
+    s_trace_events.clear();
+    s_trace_frames.clear();
+    s_trace_start = std::chrono::steady_clock::now();
+  }
+  s_tracing.store(true);
+  UpdateEnabled();
+}
+
+std::string StopTrace()
+{
+  s_tracing.store(false);
+  UpdateEnabled();
+
+  std::lock_guard<std::mutex> lock(s_trace_lock);
+  if (s_trace_events.size() >= MAX_TRACE_EVENTS)
+    WARN_LOG(VIDEO, "The stage trace was stopped at %zu events", MAX_TRACE_EVENTS);
+
+  // The timestamps are in microseconds.
+  std::ostringstream trace;
+  trace << std::fixed << std::setprecision(3);
+  trace << "{\"traceEvents\":[";
+  bool first = true;
+  for (const TraceEvent& event : s_trace_events)
+  {
+    trace << (first ? "\n" : ",\n");
+    first = false;
+    trace << "{\"name\":\"" << GetStageName(event.stage) << "\",\"cat\":\"video\",\"ph\":\"X\""
+          << ",\"ts\":" << event.start / 1000.0 << ",\"dur\":" << event.duration / 1000.0
+          << ",\"pid\":0,\"tid\":" << event.thread_id << "}";
+  }
+  for (s64 time : s_trace_frames)
+  {
+    trace << (first ? "\n" : ",\n");
+    first = false;
+    trace << "{\"name\":\"frame\",\"cat\":\"video\",\"ph\":\"i\",\"s\":\"g\",\"ts\":"
+          << time / 1000.0 << ",\"pid\":0,\"tid\":0}";
+  }
+  trace << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+  s_trace_events.clear();
+  s_trace_events.shrink_to_fit();
+  s_trace_frames.clear();
+  return trace.str();
+}
+
+void SetBenchmarking(bool benchmarking)
+{
+  s_benchmarking = benchmarking;
+  UpdateEnabled();
+}
+
+static void WriteCSVHeader(std::ostream& csv)
+{
+  csv << "end_time_us";
+  for (const char* name : s_stage_names)
+    csv << "," << name << "_us";
+  csv << "\n";
+}
+
+static void WriteCSVRow(std::ostream& csv, const Frame& frame)
+{
+  csv << frame.end_time;
+  for (double time : frame.times)
+    csv << "," << time;
+  csv << "\n";
+}
+
+static void LogFrame(const Frame& frame)
+{
+  if (!s_log_file.is_open())
+  {
+    File::OpenFStream(s_log_file, File::GetUserPath(D_LOGS_IDX) + "stage_times.csv",
+                      std::ios_base::out);
+    WriteCSVHeader(s_log_file);
+  }
+
+  WriteCSVRow(s_log_file, frame);
+}
+
+void OnFramePresented()
+{
+  const bool was_enabled = IsEnabled();
+  UpdateEnabled();
+  if (!was_enabled)
+    return;
+
+  Frame frame;
+  frame.end_time = Common::Timer::GetTimeUs();
+  for (size_t i = 0; i < NUM_STAGES; i++)
+    frame.times[i] = s_current_times[i].exchange(0, std::memory_order_relaxed) / 1000.0;
+
+  if (g_ActiveConfig.bLogRenderTimeToFile)
+    LogFrame(frame);
+
+  if (s_tracing.load(std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock(s_trace_lock);
+    s_trace_frames.push_back(SinceTraceStart(std::chrono::steady_clock::now()));
+  }
+
+  std::lock_guard<std::mutex> lock(s_frames_lock);
+  s_last_frame = frame;
+  if (s_frames.size() < MAX_FRAMES)
+  {
+    s_frames.push_back(frame);
+  }
+  else
+  {
+    s_frames[s_next_frame] = frame;
+    s_next_frame = (s_next_frame + 1) % MAX_FRAMES;
+  }
+}
+
+Frame GetLastFrame()
+{
+  std::lock_guard<std::mutex> lock(s_frames_lock);
+  return s_last_frame;
+}
+
+std::vector<Frame> GetFrames()
+{
+  std::lock_guard<std::mutex> lock(s_frames_lock);
+  std::vector<Frame> frames(s_frames.begin() + s_next_frame, s_frames.end());
+  frames.insert(frames.end(), s_frames.begin(), s_frames.begin() + s_next_frame);
+  return frames;
+}
+
+// Nearest-rank percentile of sorted values
+static double Percentile(const std::vector<double>& sorted, double percent)
+{
+  const size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * sorted.size()));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+std::vector<StageSummary> Summarize(const std::vector<Times>& frames)
+{
+  std::vector<StageSummary> summaries;
+  for (size_t i = 0; i < NUM_STAGES; i++)
+  {
+    StageSummary summary;
+    summary.name = s_stage_names[i];
+    if (!frames.empty())
+    {
+      std::vector<double> times;
+      double total = 0.0;
+      for (const Times& frame : frames)
+      {
+        times.push_back(frame[i] / 1000.0);
+        total += times.back();
+      }
+      std::sort(times.begin(), times.end());
+      summary.mean = total / times.size();
+      summary.p50 = Percentile(times, 50.0);
+      summary.p90 = Percentile(times, 90.0);
+      summary.p99 = Percentile(times, 99.0);
+      summary.max = times.back();
+    }
+    summaries.push_back(summary);
+  }
+  return summaries;
+}
+
+std::string FramesToCSV(const std::vector<Frame>& frames)
+{
+  std::ostringstream csv;
+  WriteCSVHeader(csv);
+  for (const Frame& frame : frames)
+    WriteCSVRow(csv, frame);
+  return csv.str();
+}
+}
@@ -0,0 +1,115 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// Measures how long the video thread spends in each stage of the pipeline, per frame, so that
+// stutter can be attributed to a stage. Timing is only done while it is enabled, either with the
+// render time log setting or while recording a benchmark or trace.
+namespace StageTimings
+{
+enum class Stage
+{
+  OpcodeDecode,
+  VertexLoad,
+  TextureLoad,
+  ShaderLookup,
+  BackendDraw,
+  Present,
+  NumStages
+};
+constexpr size_t NUM_STAGES = static_cast<size_t>(Stage::NumStages);
+
+const char* GetStageName(Stage stage);
+
+// The time spent in each stage, in microseconds. The time of nested stages is only counted for
+// the innermost one, e.g. decoding the opcodes doesn't include loading the vertices.
+using Times = std::array<double, NUM_STAGES>;
+
+struct Frame
+{
+  // In microseconds, from Common::Timer::GetTimeUs()
+  u64 end_time;
+  Times times;
+};
+
+extern std::atomic<bool> g_enabled;
+inline bool IsEnabled()
+{
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+// Keeps the timings of the last frames, for the render time log and the stutter summaries.
+constexpr size_t MAX_FRAMES = 3600;
+
+// Records every timed scope while enabled, for a trace which can be loaded in chrome://tracing.
+// The trace stops at a million events.
+void StartTrace();
+// Stops recording and returns the trace in the Chrome trace event format
+std::string StopTrace();
+
+// Enables timing for a benchmark, in addition to the render time log setting
+void SetBenchmarking(bool benchmarking);
+
+// Called by the renderer when a frame was presented. Ends the frame's timings, which
+// GetLastFrame() returns until the next frame.
+void OnFramePresented();
+Frame GetLastFrame();
+// The last frames, oldest first
+std::vector<Frame> GetFrames();
+
+// Percentiles of the time of a stage over frames, in milliseconds
+struct StageSummary
+{
+  const char* name;
+  double mean = 0.0;
+  double p50 = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+};
+std::vector<StageSummary> Summarize(const std::vector<Times>& frames);
+
+// One line per frame with the end time and the times of the stages in microseconds, after a
+// header line with the stage names
+std::string FramesToCSV(const std::vector<Frame>& frames);
+
+class ScopedTimer
+{
+public:
+  // Nothing is timed when enable is false, for the code shared with the CPU thread's preprocessing
+  explicit ScopedTimer(Stage stage, bool enable = true)
+  {
+    if (enable && IsEnabled())
+      Begin(stage);
+  }
+  ~ScopedTimer()
+  {
+    if (m_active)
+      End();
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  void Begin(Stage stage);
+  void End();
+
+  Stage m_stage;
+  bool m_active = false;
+  std::chrono::steady_clock::time_point m_start;
+  // The time spent in nested timers, which isn't counted for this stage
+  std::chrono::steady_clock::duration m_nested_time{};
+  ScopedTimer* m_parent = nullptr;
+};
+}
@@ -7,6 +7,10 @@
 #include <utility>
 
 #include "Common/StringUtil.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/ShaderCache.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
@@ -63,10 +67,16 @@ std::string Statistics::ToString()
   str += StringFromFormat("CP loads (DL): %i\n", stats.thisFrame.numCPLoadsInDL);
   str += StringFromFormat("BP loads: %i\n", stats.thisFrame.numBPLoads);
   str += StringFromFormat("BP loads (DL): %i\n", stats.thisFrame.numBPLoadsInDL);
+  str += StringFromFormat("FIFO processed: %i kB\n", stats.thisFrame.bytesFifoProcessed / 1024);
   str += StringFromFormat("Vertex streamed: %i kB\n", stats.thisFrame.bytesVertexStreamed / 1024);
   str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed / 1024);
   str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed / 1024);
   str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
+  str += Fifo::SyncGPUWaitHistogramToString();
+  str += OpcodeDecoder::RedundantWritesToString();
+  str += HiresTexture::StatisticsToString();
+  if (g_shader_cache)
+    str += g_shader_cache->CompilerStatisticsToString();
 
   std::string vertex_list = VertexLoaderManager::VertexLoadersToString();
 
@@ -47,6 +47,8 @@ struct Statistics
 
     int numDListsCalled;
 
+    int bytesFifoProcessed;
+
     int bytesVertexStreamed;
     int bytesIndexStreamed;
     int bytesUniformStreamed;
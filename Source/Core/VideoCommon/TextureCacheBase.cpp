@@ -6,6 +6,7 @@
 #include <cmath>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #if defined(_M_X86) || defined(_M_X86_64)
@@ -14,6 +15,7 @@
 
 #include "Common/Align.h"
 #include "Common/Assert.h"
+#include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/Hash.h"
@@ -23,12 +25,16 @@
 #include "Common/StringUtil.h"
 
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/FifoPlayer/FifoRecorder.h"
 #include "Core/HW/Memmap.h"
 
+#include "VideoCommon/AbstractStagingTexture.h"
+#include "VideoCommon/AsyncRequests.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/Debugger.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/RenderBase.h"
@@ -43,11 +49,33 @@ static const u64 TEXHASH_INVALID = 0;
 // Sonic the Fighters (inside Sonic Gems Collection) loops a 64 frames animation
 static const int TEXTURE_KILL_THRESHOLD = 64;
 static const int TEXTURE_POOL_KILL_THRESHOLD = 3;
+// Deferred EFB copies beyond this are read back, oldest first, to bound the staging textures
+// kept alive.
+static const size_t MAX_PENDING_EFB_COPIES = 64;
+static const size_t MAX_EFB_COPY_STAGING_TEXTURES = 16;
 
 std::unique_ptr<TextureCacheBase> g_texture_cache;
 
 std::bitset<8> TextureCacheBase::valid_bind_points;
 
+// Called by Memory from the fault handler of the thread which accessed the range of a deferred
+// EFB copy
+static void ReadBackEFBCopiesForAccess(u32 address, u32 size)
+{
+  // Reading the copies back needs the backend, which can't be used from the fault handler. The
+  // GPU thread flushes them before it reads RAM, so if it gets here anyway, that's a bug. The
+  // access is left unhandled, which makes it crash rather than see stale data.
+  if (Core::IsGPUThread())
+    return;
+
+  AsyncRequests::Event e;
+  e.type = AsyncRequests::Event::FLUSH_EFB_COPIES;
+  e.time = 0;
+  e.flush_efb_copies.address = address;
+  e.flush_efb_copies.size = size;
+  AsyncRequests::GetInstance()->PushEvent(e, true);
+}
+
 TextureCacheBase::TCacheEntry::TCacheEntry(std::unique_ptr<AbstractTexture> tex)
     : texture(std::move(tex))
 {
@@ -69,6 +97,29 @@ void TextureCacheBase::CheckTempSize(size_t required_size)
   temp = static_cast<u8*>(Common::AllocateAlignedMemory(temp_size, 16));
 }
 
+Common::WorkerPool* TextureCacheBase::GetDecoderPool()
+{
+  const u32 num_threads = g_ActiveConfig.GetTextureDecoderThreads();
+  if (decoder_pool.GetThreadCount() != num_threads)
+    decoder_pool.Reset(num_threads, "Texture Decoder");
+  return &decoder_pool;
+}
+
+void TextureCacheBase::UpdateDecodedTextureDiskCache()
+{
+  decoded_texture_disk_cache.Close();
+
+  const std::string& game_id = SConfig::GetInstance().GetGameID();
+  if (!backup_config.cache_decoded_textures || game_id.empty())
+    return;
+
+  const std::string filename =
+      File::GetUserPath(D_CACHE_IDX) + "DecodedTextures" DIR_SEP + game_id + ".cache";
+  const u64 size_limit =
+      static_cast<u64>(std::max(backup_config.decoded_texture_cache_size, 0)) * 1024 * 1024;
+  decoded_texture_disk_cache.Open(filename, size_limit);
+}
+
 TextureCacheBase::TextureCacheBase()
 {
   SetBackupConfig(g_ActiveConfig);
@@ -80,8 +131,12 @@ TextureCacheBase::TextureCacheBase()
                                      backup_config.texfmt_overlay_center);
 
   HiresTexture::Init();
+  UpdateDecodedTextureDiskCache();
+
+  Common::SetHash64Function(backup_config.full_texture_hash ? Common::Hash64Function::XXH3 :
+                                                              Common::Hash64Function::Sampled);
 
-  Common::SetHash64Function();
+  Memory::SetAccessHandler(ReadBackEFBCopiesForAccess);
 
   InvalidateAllBindPoints();
 }
@@ -94,18 +149,28 @@ void TextureCacheBase::Invalidate()
     bound_textures[i] = nullptr;
   }
 
-  for (auto& tex : textures_by_address)
+  for (TCacheEntry* entry : textures_by_address.All())
   {
-    delete tex.second;
+    entry_pool.Free(entry);
   }
-  textures_by_address.clear();
-  textures_by_hash.clear();
+  textures_by_address.Clear();
+  textures_by_hash.Clear();
+  memory_hashes.clear();
+
+  // The deferred EFB copies still have to reach RAM, just not their entries anymore.
+  for (PendingEFBCopy& copy : pending_efb_copies)
+    copy.entry = nullptr;
 
   texture_pool.clear();
 }
 
 TextureCacheBase::~TextureCacheBase()
 {
+  // The backend can't read the copies back anymore at this point.
+  DiscardEFBCopies();
+  efb_copy_staging_textures.clear();
+  Memory::SetAccessHandler(nullptr);
+
   HiresTexture::Shutdown();
   Invalidate();
   Common::FreeAlignedMemory(temp);
@@ -115,13 +180,15 @@ TextureCacheBase::~TextureCacheBase()
 void TextureCacheBase::OnConfigChanged(VideoConfig& config)
 {
   if (config.bHiresTextures != backup_config.hires_textures ||
-      config.bCacheHiresTextures != backup_config.cache_hires_textures)
+      config.bCacheHiresTextures != backup_config.cache_hires_textures ||
+      config.iHiresTextureCacheSize != backup_config.hires_texture_cache_size)
   {
     HiresTexture::Update();
   }
 
   // TODO: Invalidating texcache is really stupid in some of these cases
   if (config.iSafeTextureCache_ColorSamples != backup_config.color_samples ||
+      config.bFullTextureHash != backup_config.full_texture_hash ||
       config.bTexFmtOverlayEnable != backup_config.texfmt_overlay ||
       config.bTexFmtOverlayCenter != backup_config.texfmt_overlay_center ||
       config.bHiresTextures != backup_config.hires_textures ||
@@ -133,6 +200,8 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
 
     TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable,
                                        g_ActiveConfig.bTexFmtOverlayCenter);
+    Common::SetHash64Function(config.bFullTextureHash ? Common::Hash64Function::XXH3 :
+                                                        Common::Hash64Function::Sampled);
   }
 
   if ((config.stereo_mode != StereoMode::Off) != backup_config.stereo_3d ||
@@ -143,51 +212,48 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
       PanicAlert("Failed to recompile one or more texture conversion shaders.");
   }
 
+  const bool disk_cache_changed =
+      config.bCacheDecodedTextures != backup_config.cache_decoded_textures ||
+      config.iDecodedTextureCacheSize != backup_config.decoded_texture_cache_size;
+
   SetBackupConfig(config);
+
+  if (disk_cache_changed)
+    UpdateDecodedTextureDiskCache();
 }
 
 void TextureCacheBase::Cleanup(int _frameCount)
 {
-  TexAddrCache::iterator iter = textures_by_address.begin();
-  TexAddrCache::iterator tcend = textures_by_address.end();
-  while (iter != tcend)
+  // InvalidateTexture() only erases the entry the cursor is on, which it allows.
+  for (TCacheEntry* entry : textures_by_address.All())
   {
-    if (iter->second->tmem_only)
+    if (entry->tmem_only)
     {
-      iter = InvalidateTexture(iter);
+      InvalidateTexture(entry);
     }
-    else if (iter->second->frameCount == FRAMECOUNT_INVALID)
+    else if (entry->frameCount == FRAMECOUNT_INVALID)
     {
-      iter->second->frameCount = _frameCount;
-      ++iter;
+      entry->frameCount = _frameCount;
     }
-    else if (_frameCount > TEXTURE_KILL_THRESHOLD + iter->second->frameCount)
+    else if (_frameCount > TEXTURE_KILL_THRESHOLD + entry->frameCount)
     {
-      if (iter->second->IsCopy())
+      if (entry->IsCopy())
       {
         // Only remove EFB copies when they wouldn't be used anymore(changed hash), because EFB
         // copies living on the
         // host GPU are unrecoverable. Perform this check only every TEXTURE_KILL_THRESHOLD for
         // performance reasons
-        if ((_frameCount - iter->second->frameCount) % TEXTURE_KILL_THRESHOLD == 1 &&
-            iter->second->hash != iter->second->CalculateHash())
-        {
-          iter = InvalidateTexture(iter);
-        }
-        else
+        if ((_frameCount - entry->frameCount) % TEXTURE_KILL_THRESHOLD == 1 &&
+            !entry->HashMatchesMemory())
         {
-          ++iter;
+          InvalidateTexture(entry);
         }
       }
       else
       {
-        iter = InvalidateTexture(iter);
+        InvalidateTexture(entry);
       }
     }
-    else
-    {
-      ++iter;
-    }
   }
 
   TexPool::iterator iter2 = texture_pool.begin();
@@ -207,6 +273,16 @@ void TextureCacheBase::Cleanup(int _frameCount)
       ++iter2;
     }
   }
+
+  for (auto iter = memory_hashes.begin(); iter != memory_hashes.end();)
+  {
+    if (iter->second.frameCount == FRAMECOUNT_INVALID)
+      iter->second.frameCount = _frameCount;
+    if (_frameCount > TEXTURE_KILL_THRESHOLD + iter->second.frameCount)
+      iter = memory_hashes.erase(iter);
+    else
+      ++iter;
+  }
 }
 
 bool TextureCacheBase::TCacheEntry::OverlapsMemoryRange(u32 range_address, u32 range_size) const
@@ -223,10 +299,14 @@ bool TextureCacheBase::TCacheEntry::OverlapsMemoryRange(u32 range_address, u32 r
 void TextureCacheBase::SetBackupConfig(const VideoConfig& config)
 {
   backup_config.color_samples = config.iSafeTextureCache_ColorSamples;
+  backup_config.full_texture_hash = config.bFullTextureHash;
   backup_config.texfmt_overlay = config.bTexFmtOverlayEnable;
   backup_config.texfmt_overlay_center = config.bTexFmtOverlayCenter;
   backup_config.hires_textures = config.bHiresTextures;
   backup_config.cache_hires_textures = config.bCacheHiresTextures;
+  backup_config.hires_texture_cache_size = config.iHiresTextureCacheSize;
+  backup_config.cache_decoded_textures = config.bCacheDecodedTextures;
+  backup_config.decoded_texture_cache_size = config.iDecodedTextureCacheSize;
   backup_config.stereo_3d = config.stereo_mode != StereoMode::Off;
   backup_config.efb_mono_depth = config.bStereoEFBMonoDepth;
   backup_config.gpu_texture_decoding = config.bEnableGPUTextureDecoding;
@@ -255,7 +335,7 @@ TextureCacheBase::ApplyPaletteToEntry(TCacheEntry* entry, u8* palette, TLUTForma
   decoded_entry->may_have_overlapping_textures = entry->may_have_overlapping_textures;
 
   ConvertTexture(decoded_entry, entry, palette, tlutfmt);
-  textures_by_address.emplace(entry->addr, decoded_entry);
+  textures_by_address.Insert(decoded_entry, entry->addr, entry->size_in_bytes);
 
   return decoded_entry;
 }
@@ -325,16 +405,15 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
 
   u32 numBlocksX = (entry_to_update->native_width + block_width - 1) / block_width;
 
-  auto iter = FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes);
-  while (iter.first != iter.second)
+  for (TCacheEntry* entry :
+       FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes))
   {
-    TCacheEntry* entry = iter.first->second;
     if (entry != entry_to_update && entry->IsCopy() && !entry->tmem_only &&
         entry->references.count(entry_to_update) == 0 &&
         entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes) &&
         entry->memory_stride == numBlocksX * block_size)
     {
-      if (entry->hash == entry->CalculateHash())
+      if (entry->HashMatchesMemory())
       {
         if (isPaletteTexture)
         {
@@ -350,7 +429,6 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
           }
           else
           {
-            ++iter.first;
             continue;
           }
         }
@@ -423,7 +501,7 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
         {
           // Remove the temporary converted texture, it won't be used anywhere else
           // TODO: It would be nice to convert and copy in one step, but this code path isn't common
-          InvalidateTexture(GetTexCacheIter(entry));
+          InvalidateTexture(entry);
         }
         else
         {
@@ -436,11 +514,9 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
       else
       {
         // If the hash does not match, this EFB copy will not be used for anything, so remove it
-        iter.first = InvalidateTexture(iter.first);
-        continue;
+        InvalidateTexture(entry);
       }
     }
-    ++iter.first;
   }
   return entry_to_update;
 }
@@ -470,6 +546,13 @@ void TextureCacheBase::DumpTexture(TCacheEntry* entry, std::string basename, uns
     entry->texture->Save(filename, level);
 }
 
+// Entries which were created while their custom texture was loading are replaced once it's ready.
+static bool IsCustomTextureReady(const TextureCacheBase::TCacheEntry& entry)
+{
+  return !entry.pending_custom_texture.empty() &&
+         HiresTexture::IsReady(entry.pending_custom_texture);
+}
+
 static u32 CalculateLevelSize(u32 level_0_size, u32 level)
 {
   return std::max(level_0_size >> level, 1u);
@@ -724,9 +807,15 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   //       texture aliasing onto the same texture cache entry.
   const u8* src_data;
   if (from_tmem)
+  {
     src_data = &texMem[tmem_address_even];
+  }
   else
+  {
+    // EFB copies to the texture which are still on the GPU have to be hashed and decoded too.
+    FlushEFBCopies(address, texture_size + additional_mips_size);
     src_data = Memory::GetPointer(address);
+  }
 
   if (!src_data)
   {
@@ -742,7 +831,8 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
 
   // TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data
   // from the low tmem bank than it should)
-  base_hash = Common::GetHash64(src_data, texture_size, textureCacheSafetyColorSampleSize);
+  base_hash = HashTextureData(address, src_data, texture_size, textureCacheSafetyColorSampleSize,
+                              from_tmem);
   u32 palette_size = 0;
   if (isPaletteTexture)
   {
@@ -794,22 +884,16 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   // For efb copies, the entry created in CopyRenderTargetToTexture always has to be used, or else
   // it was
   // done in vain.
-  auto iter_range = textures_by_address.equal_range(address);
-  TexAddrCache::iterator iter = iter_range.first;
-  TexAddrCache::iterator oldest_entry = iter;
+  TCacheEntry* oldest_entry = nullptr;
   int temp_frameCount = 0x7fffffff;
-  TexAddrCache::iterator unconverted_copy = textures_by_address.end();
+  TCacheEntry* unconverted_copy = nullptr;
 
-  while (iter != iter_range.second)
+  // Only the entry under the cursor gets invalidated, which the cursor allows.
+  for (TCacheEntry* entry : textures_by_address.At(address))
   {
-    TCacheEntry* entry = iter->second;
-
     // Skip entries that are only left in our texture cache for the tmem cache emulation
     if (entry->tmem_only)
-    {
-      ++iter;
       continue;
-    }
 
     // Do not load strided EFB copies, they are not meant to be used directly.
     // Also do not directly load EFB copies, which were partly overwritten.
@@ -833,7 +917,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
         // perform the conversion later.  Currently, we only convert EFB copies to
         // palette textures; we could do other conversions if it proved to be
         // beneficial.
-        unconverted_copy = iter;
+        unconverted_copy = entry;
       }
       else
       {
@@ -841,7 +925,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
         // never be useful again.  It's theoretically possible for a game to do
         // something weird where the copy could become useful in the future, but in
         // practice it doesn't happen.
-        iter = InvalidateTexture(iter);
+        InvalidateTexture(entry);
         continue;
       }
     }
@@ -852,9 +936,12 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
           entry->native_levels >= tex_levels && entry->native_width == nativeW &&
           entry->native_height == nativeH)
       {
-        entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
+        if (!IsCustomTextureReady(*entry))
+          return DoPartialTextureUpdates(entry, &texMem[tlutaddr], tlutfmt);
 
-        return entry;
+        // Replace the native texture now that the custom one is loaded.
+        InvalidateTexture(entry);
+        continue;
       }
     }
 
@@ -867,15 +954,14 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
         !entry->IsEfbCopy() && !(isPaletteTexture && entry->base_hash == base_hash))
     {
       temp_frameCount = entry->frameCount;
-      oldest_entry = iter;
+      oldest_entry = entry;
     }
-    ++iter;
   }
 
-  if (unconverted_copy != textures_by_address.end())
+  if (unconverted_copy)
   {
     TCacheEntry* decoded_entry =
-        ApplyPaletteToEntry(unconverted_copy->second, &texMem[tlutaddr], tlutfmt);
+        ApplyPaletteToEntry(unconverted_copy, &texMem[tlutaddr], tlutfmt);
 
     if (decoded_entry)
     {
@@ -892,21 +978,25 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   if (textureCacheSafetyColorSampleSize == 0 ||
       std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
   {
-    auto hash_range = textures_by_hash.equal_range(full_hash);
-    TexHashCache::iterator hash_iter = hash_range.first;
-    while (hash_iter != hash_range.second)
+    TCacheEntry* replaced_entry = nullptr;
+    if (const auto* hash_matches = textures_by_hash.Find(full_hash))
     {
-      TCacheEntry* entry = hash_iter->second;
-      // All parameters, except the address, need to match here
-      if (entry->format == full_format && entry->native_levels >= tex_levels &&
-          entry->native_width == nativeW && entry->native_height == nativeH)
+      for (TCacheEntry* entry : *hash_matches)
       {
-        entry = DoPartialTextureUpdates(hash_iter->second, &texMem[tlutaddr], tlutfmt);
+        // All parameters, except the address, need to match here
+        if (entry->format == full_format && entry->native_levels >= tex_levels &&
+            entry->native_width == nativeW && entry->native_height == nativeH)
+        {
+          if (!IsCustomTextureReady(*entry))
+            return DoPartialTextureUpdates(entry, &texMem[tlutaddr], tlutfmt);
 
-        return entry;
+          replaced_entry = entry;
+          break;
+        }
       }
-      ++hash_iter;
     }
+    if (replaced_entry)
+      InvalidateTexture(replaced_entry);
   }
 
   // If at least one entry was not used for the same frame, overwrite the oldest one
@@ -917,10 +1007,11 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   }
 
   std::shared_ptr<HiresTexture> hires_tex;
+  std::string pending_custom_texture;
   if (g_ActiveConfig.bHiresTextures)
   {
     hires_tex = HiresTexture::Search(src_data, texture_size, &texMem[tlutaddr], palette_size, width,
-                                     height, texformat, use_mipmaps);
+                                     height, texformat, use_mipmaps, &pending_custom_texture);
 
     if (hires_tex)
     {
@@ -966,13 +1057,18 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   if (hires_tex)
   {
     const auto& level = hires_tex->m_levels[0];
-    entry->texture->Load(0, level.width, level.height, level.row_length, level.data.data(),
-                         level.data.size());
+    entry->texture->Load(0, level.width, level.height, level.row_length, level.GetData(),
+                         level.GetSize());
   }
 
   // Initialized to null because only software loading uses this buffer
   u8* dst_buffer = nullptr;
 
+  // Set if the decoded levels were found in the disk cache.
+  const u8* cached_levels = nullptr;
+  std::optional<VideoCommon::TextureDiskCache::Key> disk_cache_key;
+  size_t decoded_levels_size = 0;
+
   if (!hires_tex)
   {
     if (decode_on_gpu)
@@ -1004,37 +1100,66 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
 
       CheckTempSize(total_texture_size);
       dst_buffer = temp;
-      if (!(texformat == TextureFormat::RGBA8 && from_tmem))
+
+      // Textures decoded in an earlier session are uploaded straight from the disk cache. Like
+      // the lookup by hash, this needs a hash of the whole texture. The texture format overlay
+      // changes the decoded data, and the hash of RGBA8 textures from tmem misses the GB tiles.
+      if (decoded_texture_disk_cache.IsOpen() && !backup_config.texfmt_overlay &&
+          !(texformat == TextureFormat::RGBA8 && from_tmem) &&
+          (textureCacheSafetyColorSampleSize == 0 || backup_config.full_texture_hash ||
+           std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8))
       {
-        TexDecoder_Decode(dst_buffer, src_data, expandedWidth, expandedHeight, texformat, tlut,
-                          tlutfmt);
+        VideoCommon::TextureDiskCache::Key key = {};
+        key.base_hash = base_hash;
+        key.full_hash = full_hash;
+        key.format = static_cast<u32>(texformat) |
+                     (isPaletteTexture ? static_cast<u32>(tlutfmt) << 8 : 0) |
+                     (backup_config.full_texture_hash ? 1 << 16 : 0);
+        key.width = static_cast<u16>(width);
+        key.height = static_cast<u16>(height);
+        key.levels = tex_levels;
+        disk_cache_key = key;
+
+        for (u32 level = 0; level != tex_levels; ++level)
+        {
+          decoded_levels_size += Common::AlignUp(CalculateLevelSize(width, level), bsw) *
+                                 Common::AlignUp(CalculateLevelSize(height, level), bsh) *
+                                 sizeof(u32);
+        }
+        cached_levels = decoded_texture_disk_cache.Lookup(key, decoded_levels_size);
       }
-      else
+
+      // All levels are decoded together once the mipmaps have been located, so that they can
+      // be spread over the texture decoder threads.
+      decoder_levels.clear();
+      if (texformat == TextureFormat::RGBA8 && from_tmem)
       {
         u8* src_data_gb = &texMem[tmem_address_odd];
         TexDecoder_DecodeRGBA8FromTmem(dst_buffer, src_data, src_data_gb, expandedWidth,
                                        expandedHeight);
       }
-
-      entry->texture->Load(0, width, height, expandedWidth, dst_buffer, decoded_texture_size);
-
-      arbitrary_mip_detector.AddLevel(width, height, expandedWidth, dst_buffer);
+      else if (!cached_levels)
+      {
+        decoder_levels.push_back({dst_buffer, src_data, static_cast<int>(expandedWidth),
+                                  static_cast<int>(expandedHeight)});
+      }
 
       dst_buffer += decoded_texture_size;
     }
   }
 
-  iter = textures_by_address.emplace(address, entry);
+  textures_by_address.Insert(entry, address, texture_size);
   if (textureCacheSafetyColorSampleSize == 0 ||
       std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
   {
-    entry->textures_by_hash_iter = textures_by_hash.emplace(full_hash, entry);
+    AddToHashCache(entry, full_hash);
   }
 
   entry->SetGeneralParameters(address, texture_size, full_format, false);
   entry->SetDimensions(nativeW, nativeH, tex_levels);
   entry->SetHashes(base_hash, full_hash);
   entry->is_custom_tex = hires_tex != nullptr;
+  entry->pending_custom_texture = std::move(pending_custom_texture);
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
 
@@ -1051,7 +1176,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
     {
       const auto& level = hires_tex->m_levels[level_index];
       entry->texture->Load(level_index, level.width, level.height, level.row_length,
-                           level.data.data(), level.data.size());
+                           level.GetData(), level.GetSize());
     }
   }
   else
@@ -1089,18 +1214,46 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       {
         // No need to call CheckTempSize here, as the whole buffer is preallocated at the beginning
         size_t decoded_mip_size = expanded_mip_width * sizeof(u32) * expanded_mip_height;
-        TexDecoder_Decode(dst_buffer, mip_src_data, expanded_mip_width, expanded_mip_height,
-                          texformat, tlut, tlutfmt);
-        entry->texture->Load(level, mip_width, mip_height, expanded_mip_width, dst_buffer,
-                             decoded_mip_size);
-
-        arbitrary_mip_detector.AddLevel(mip_width, mip_height, expanded_mip_width, dst_buffer);
-
+        if (!cached_levels)
+        {
+          decoder_levels.push_back({dst_buffer, mip_src_data,
+                                    static_cast<int>(expanded_mip_width),
+                                    static_cast<int>(expanded_mip_height)});
+        }
         dst_buffer += decoded_mip_size;
       }
 
       mip_src_data += mip_size;
     }
+
+    if (!decode_on_gpu)
+    {
+      if (!cached_levels)
+      {
+        TexDecoder_DecodeLevels(GetDecoderPool(), decoder_levels.data(), decoder_levels.size(),
+                                texformat, tlut, tlutfmt);
+        if (disk_cache_key)
+          decoded_texture_disk_cache.Store(*disk_cache_key, temp, decoded_levels_size);
+      }
+
+      // Upload every level now that all of them are decoded. They are laid out one after the
+      // other at the start of temp, or of the disk cache entry.
+      const u8* level_data = cached_levels ? cached_levels : temp;
+      for (u32 level = 0; level != texLevels; ++level)
+      {
+        const u32 mip_width = CalculateLevelSize(width, level);
+        const u32 mip_height = CalculateLevelSize(height, level);
+        const u32 expanded_mip_width = Common::AlignUp(mip_width, bsw);
+        const u32 expanded_mip_height = Common::AlignUp(mip_height, bsh);
+        const size_t decoded_mip_size = expanded_mip_width * sizeof(u32) * expanded_mip_height;
+        entry->texture->Load(level, mip_width, mip_height, expanded_mip_width, level_data,
+                             decoded_mip_size);
+
+        arbitrary_mip_detector.AddLevel(mip_width, mip_height, expanded_mip_width, level_data);
+
+        level_data += decoded_mip_size;
+      }
+    }
   }
 
   entry->has_arbitrary_mips = hires_tex ? hires_tex->HasArbitraryMipmaps() :
@@ -1117,7 +1270,7 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   INCSTAT(stats.numTexturesUploaded);
   SETSTAT(stats.numTexturesAlive, textures_by_address.size());
 
-  entry = DoPartialTextureUpdates(iter->second, &texMem[tlutaddr], tlutfmt);
+  entry = DoPartialTextureUpdates(entry, &texMem[tlutaddr], tlutfmt);
 
   return entry;
 }
@@ -1218,6 +1371,9 @@ std::optional<TextureLookupInformation> TextureCacheBase::ComputeTextureInformat
   tex_info.total_bytes = TexDecoder_GetTextureSizeInBytes(tex_info.expanded_width,
                                                           tex_info.expanded_height, tex_format);
 
+  if (!from_tmem)
+    FlushEFBCopies(tex_info.address, tex_info.total_bytes);
+
   tex_info.native_width = width;
   tex_info.native_height = height;
   tex_info.native_levels = levels;
@@ -1234,8 +1390,9 @@ std::optional<TextureLookupInformation> TextureCacheBase::ComputeTextureInformat
 
   // TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data
   // from the low tmem bank than it should)
-  tex_info.base_hash = Common::GetHash64(tex_info.src_data, tex_info.total_bytes,
-                                         tex_info.texture_cache_safety_color_sample_size);
+  tex_info.base_hash =
+      HashTextureData(tex_info.address, tex_info.src_data, tex_info.total_bytes,
+                      tex_info.texture_cache_safety_color_sample_size, tex_info.from_tmem);
 
   tex_info.is_palette_texture = IsColorIndexed(tex_format);
 
@@ -1257,12 +1414,8 @@ std::optional<TextureLookupInformation> TextureCacheBase::ComputeTextureInformat
 TextureCacheBase::TCacheEntry*
 TextureCacheBase::GetXFBFromCache(const TextureLookupInformation& tex_info)
 {
-  auto iter_range = textures_by_address.equal_range(tex_info.address);
-  TexAddrCache::iterator iter = iter_range.first;
-
-  while (iter != iter_range.second)
+  for (TCacheEntry* entry : textures_by_address.At(tex_info.address))
   {
-    TCacheEntry* entry = iter->second;
 
     if ((entry->is_xfb_copy || entry->format.texfmt == TextureFormat::XFB) &&
         entry->native_width == tex_info.native_width &&
@@ -1278,12 +1431,9 @@ TextureCacheBase::GetXFBFromCache(const TextureLookupInformation& tex_info)
         // At this point, we either have an xfb copy that has changed its hash
         // or an xfb created by stitching or from memory that has been changed
         // we are safe to invalidate this
-        iter = InvalidateTexture(iter);
-        continue;
+        InvalidateTexture(entry);
       }
     }
-
-    ++iter;
   }
 
   return nullptr;
@@ -1296,16 +1446,15 @@ bool TextureCacheBase::LoadTextureFromOverlappingTextures(TCacheEntry* entry_to_
 
   u32 numBlocksX = entry_to_update->native_width / tex_info.block_width;
 
-  auto iter = FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes);
-  while (iter.first != iter.second)
+  for (TCacheEntry* entry :
+       FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes))
   {
-    TCacheEntry* entry = iter.first->second;
     if (entry != entry_to_update && entry->IsCopy() && !entry->tmem_only &&
         entry->references.count(entry_to_update) == 0 &&
         entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes) &&
         entry->memory_stride == entry_to_update->memory_stride)
     {
-      if (entry->hash == entry->CalculateHash())
+      if (entry->HashMatchesMemory())
       {
         if (tex_info.is_palette_texture)
         {
@@ -1322,7 +1471,6 @@ bool TextureCacheBase::LoadTextureFromOverlappingTextures(TCacheEntry* entry_to_
           }
           else
           {
-            ++iter.first;
             continue;
           }
         }
@@ -1398,7 +1546,7 @@ bool TextureCacheBase::LoadTextureFromOverlappingTextures(TCacheEntry* entry_to_
         {
           // Remove the temporary converted texture, it won't be used anywhere else
           // TODO: It would be nice to convert and copy in one step, but this code path isn't common
-          InvalidateTexture(GetTexCacheIter(entry));
+          InvalidateTexture(entry);
         }
         else
         {
@@ -1411,11 +1559,9 @@ bool TextureCacheBase::LoadTextureFromOverlappingTextures(TCacheEntry* entry_to_
       else
       {
         // If the hash does not match, this EFB copy will not be used for anything, so remove it
-        iter.first = InvalidateTexture(iter.first);
-        continue;
+        InvalidateTexture(entry);
       }
     }
-    ++iter.first;
   }
 
   return updated_entry;
@@ -1438,12 +1584,12 @@ TextureCacheBase::CreateNormalTexture(const TextureLookupInformation& tex_info)
   if (!entry)
     return nullptr;
 
-  textures_by_address.emplace(tex_info.address, entry);
+  textures_by_address.Insert(entry, tex_info.address, tex_info.total_bytes);
   if (tex_info.texture_cache_safety_color_sample_size == 0 ||
       std::max(tex_info.total_bytes, tex_info.palette_size) <=
           (u32)tex_info.texture_cache_safety_color_sample_size * 8)
   {
-    entry->textures_by_hash_iter = textures_by_hash.emplace(tex_info.full_hash, entry);
+    AddToHashCache(entry, tex_info.full_hash);
   }
 
   entry->SetGeneralParameters(tex_info.address, tex_info.total_bytes, tex_info.full_format, false);
@@ -1495,8 +1641,11 @@ void TextureCacheBase::LoadTextureLevelZeroFromMemory(TCacheEntry* entry_to_upda
     CheckTempSize(decoded_texture_size);
     if (!(tex_info.full_format.texfmt == TextureFormat::RGBA8 && tex_info.from_tmem))
     {
-      TexDecoder_Decode(temp, tex_info.src_data, tex_info.expanded_width, tex_info.expanded_height,
-                        tex_info.full_format.texfmt, tlut, tex_info.full_format.tlutfmt);
+      const TexDecoderLevel level = {temp, tex_info.src_data,
+                                     static_cast<int>(tex_info.expanded_width),
+                                     static_cast<int>(tex_info.expanded_height)};
+      TexDecoder_DecodeLevels(GetDecoderPool(), &level, 1, tex_info.full_format.texfmt, tlut,
+                              tex_info.full_format.tlutfmt);
     }
     else
     {
@@ -1670,14 +1819,34 @@ void TextureCacheBase::CopyRenderTargetToTexture(
   const u32 bytes_per_row = num_blocks_x * bytes_per_block;
   const u32 covered_range = num_blocks_y * dstStride;
 
+  AbstractStagingTexture* deferred_copy = nullptr;
   if (copy_to_ram)
   {
+    // Deferred copies to the same memory must not overwrite this copy later.
+    ResolveEFBCopiesOverlapping(dstAddr, dstStride, bytes_per_row, num_blocks_y);
+
     CopyFilterCoefficientArray coefficients = GetRAMCopyFilterCoefficients(filter_coefficients);
     PEControl::PixelFormat srcFormat = bpmem.zcontrol.pixel_format;
     EFBCopyParams format(srcFormat, dstFormat, is_depth_copy, isIntensity,
                          NeedsCopyFilterInShader(coefficients));
-    CopyEFB(dst, format, tex_w, bytes_per_row, num_blocks_y, dstStride, srcRect, scaleByHalf,
-            y_scale, gamma, clamp_top, clamp_bottom, coefficients);
+
+    // Reading a deferred copy back makes the accessing thread wait for the GPU thread, so that
+    // has to be a thread of its own.
+    const bool defer = !is_xfb_copy && g_ActiveConfig.bDeferEFBCopies &&
+                       g_ActiveConfig.backend_info.bSupportsDeferredEFBCopies &&
+                       SConfig::GetInstance().bCPUThread && !Fifo::UseDeterministicGPUThread() &&
+                       dstStride >= bytes_per_row;
+    if (defer)
+    {
+      deferred_copy = DeferEFBCopy(dstAddr, dstStride, format, tex_w, bytes_per_row, num_blocks_y,
+                                   srcRect, scaleByHalf, y_scale, gamma, clamp_top, clamp_bottom,
+                                   coefficients);
+    }
+    if (!deferred_copy)
+    {
+      CopyEFB(dst, format, tex_w, bytes_per_row, num_blocks_y, dstStride, srcRect, scaleByHalf,
+              y_scale, gamma, clamp_top, clamp_bottom, coefficients);
+    }
   }
   else
   {
@@ -1731,10 +1900,8 @@ void TextureCacheBase::CopyRenderTargetToTexture(
   // as our efb copy are marked to check them for partial texture updates.
   // TODO: The logic to detect overlapping strided efb copies is not 100% accurate.
   bool strided_efb_copy = dstStride != bytes_per_row;
-  auto iter = FindOverlappingTextures(dstAddr, covered_range);
-  while (iter.first != iter.second)
+  for (TCacheEntry* entry : FindOverlappingTextures(dstAddr, covered_range))
   {
-    TCacheEntry* entry = iter.first->second;
 
     if (entry->addr == dstAddr && entry->is_xfb_copy)
     {
@@ -1752,7 +1919,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
           (!strided_efb_copy && entry->size_in_bytes == overlap_range) ||
           (strided_efb_copy && entry->size_in_bytes == overlap_range && entry->addr == dstAddr))
       {
-        iter.first = InvalidateTexture(iter.first);
+        InvalidateTexture(entry);
         continue;
       }
       entry->may_have_overlapping_textures = true;
@@ -1767,18 +1934,13 @@ void TextureCacheBase::CopyRenderTargetToTexture(
       // to mitigate this
       if (entry->is_xfb_copy && copy_to_ram)
       {
-        entry->hash = entry->CalculateHash();
+        entry->UpdateHashFromMemory();
       }
 
       // Do not load textures by hash, if they were at least partly overwritten by an efb copy.
       // In this case, comparing the hash is not enough to check, if two textures are identical.
-      if (entry->textures_by_hash_iter != textures_by_hash.end())
-      {
-        textures_by_hash.erase(entry->textures_by_hash_iter);
-        entry->textures_by_hash_iter = textures_by_hash.end();
-      }
+      RemoveFromHashCache(entry);
     }
-    ++iter.first;
   }
 
   if (copy_to_vram)
@@ -1813,8 +1975,21 @@ void TextureCacheBase::CopyRenderTargetToTexture(
                           clamp_top, clamp_bottom,
                           GetVRAMCopyFilterCoefficients(filter_coefficients));
 
-      u64 hash = entry->CalculateHash();
-      entry->SetHashes(hash, hash);
+      // A deferred copy isn't in RAM yet, so the entry is hashed once it is read back. It may
+      // have been read back already, if hashing the textures it overlaps accessed it.
+      const auto pending = std::find_if(
+          pending_efb_copies.begin(), pending_efb_copies.end(),
+          [&](const PendingEFBCopy& copy) { return copy.texture.get() == deferred_copy; });
+      if (deferred_copy && pending != pending_efb_copies.end())
+      {
+        entry->SetHashes(TEXHASH_INVALID, TEXHASH_INVALID);
+        pending->entry = entry;
+      }
+      else
+      {
+        entry->UpdateHashFromMemory();
+        entry->base_hash = entry->hash;
+      }
 
       if (g_ActiveConfig.bDumpEFBTarget && !is_xfb_copy)
       {
@@ -1834,11 +2009,166 @@ void TextureCacheBase::CopyRenderTargetToTexture(
                              0);
       }
 
-      textures_by_address.emplace(dstAddr, entry);
+      textures_by_address.Insert(entry, dstAddr, entry->size_in_bytes);
     }
   }
 }
 
+AbstractStagingTexture* TextureCacheBase::DeferEFBCopy(
+    u32 dst_addr, u32 dst_stride, const EFBCopyParams& params, u32 native_width, u32 bytes_per_row,
+    u32 num_blocks_y, const EFBRectangle& src_rect, bool scale_by_half, float y_scale, float gamma,
+    bool clamp_top, bool clamp_bottom, const CopyFilterCoefficientArray& filter_coefficients)
+{
+  const u32 covered_range = num_blocks_y * dst_stride;
+  if (!Memory::ProtectFromAccess(dst_addr, covered_range))
+    return nullptr;
+
+  const u32 width = bytes_per_row / sizeof(u32);
+  std::unique_ptr<AbstractStagingTexture> texture;
+  const auto iter = std::find_if(efb_copy_staging_textures.begin(),
+                                 efb_copy_staging_textures.end(), [&](const auto& staging) {
+                                   return staging->GetConfig().width >= width &&
+                                          staging->GetConfig().height >= num_blocks_y;
+                                 });
+  if (iter != efb_copy_staging_textures.end())
+  {
+    texture = std::move(*iter);
+    efb_copy_staging_textures.erase(iter);
+  }
+  else
+  {
+    const TextureConfig config(width, num_blocks_y, 1, 1, 1, AbstractTextureFormat::BGRA8, false);
+    texture = g_renderer->CreateStagingTexture(StagingTextureType::Readback, config);
+    if (!texture)
+    {
+      Memory::UnprotectFromAccess(dst_addr, covered_range);
+      return nullptr;
+    }
+  }
+
+  CopyEFBToStagingTexture(texture.get(), params, native_width, bytes_per_row, num_blocks_y,
+                          src_rect, scale_by_half, y_scale, gamma, clamp_top, clamp_bottom,
+                          filter_coefficients);
+
+  if (pending_efb_copies.size() >= MAX_PENDING_EFB_COPIES)
+  {
+    PendingEFBCopy oldest = std::move(pending_efb_copies.front());
+    pending_efb_copies.erase(pending_efb_copies.begin());
+    ReadBackEFBCopy(oldest);
+  }
+
+  AbstractStagingTexture* const result = texture.get();
+  pending_efb_copies.push_back(
+      {dst_addr, dst_stride, bytes_per_row, num_blocks_y, std::move(texture), nullptr});
+  return result;
+}
+
+void TextureCacheBase::ResolveEFBCopiesOverlapping(u32 address, u32 stride, u32 bytes_per_row,
+                                                   u32 num_blocks_y)
+{
+  if (pending_efb_copies.empty())
+    return;
+
+  const u64 end = static_cast<u64>(address) + num_blocks_y * stride;
+  std::vector<PendingEFBCopy> overlapping;
+  for (auto iter = pending_efb_copies.begin(); iter != pending_efb_copies.end();)
+  {
+    if (iter->address < end && iter->address + static_cast<u64>(iter->CoveredRange()) > address)
+    {
+      overlapping.push_back(std::move(*iter));
+      iter = pending_efb_copies.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  for (PendingEFBCopy& copy : overlapping)
+  {
+    if (copy.address == address && copy.stride == stride && copy.bytes_per_row <= bytes_per_row &&
+        copy.num_blocks_y <= num_blocks_y)
+    {
+      ReleaseEFBCopy(copy);
+    }
+    else
+    {
+      ReadBackEFBCopy(copy);
+    }
+  }
+}
+
+void TextureCacheBase::ReadBackEFBCopy(PendingEFBCopy& copy)
+{
+  u8* dst = Memory::GetUnprotectedPointer(copy.address, copy.CoveredRange());
+  if (dst)
+  {
+    const MathUtil::Rectangle<int> rect(0, 0, copy.bytes_per_row / sizeof(u32), copy.num_blocks_y);
+    copy.texture->ReadTexels(rect, dst, copy.stride);
+  }
+
+  TCacheEntry* const entry = copy.entry;
+  ReleaseEFBCopy(copy);
+  if (entry)
+  {
+    entry->UpdateHashFromMemory();
+    entry->base_hash = entry->hash;
+  }
+}
+
+void TextureCacheBase::ReleaseEFBCopy(PendingEFBCopy& copy)
+{
+  Memory::UnprotectFromAccess(copy.address, copy.CoveredRange());
+  if (efb_copy_staging_textures.size() < MAX_EFB_COPY_STAGING_TEXTURES)
+    efb_copy_staging_textures.push_back(std::move(copy.texture));
+  copy.texture.reset();
+  copy.entry = nullptr;
+}
+
+void TextureCacheBase::FlushEFBCopies(u32 address, u32 size)
+{
+  if (pending_efb_copies.empty())
+    return;
+
+  // Accesses fault for whole pages, so all copies touching them have to be read back. They are
+  // taken out of the list first, in case reading back one of them accesses another one.
+  const u32 page_size = Memory::GetTrackedPageSize();
+  const u64 start = Common::AlignDown(address, page_size);
+  const u64 end = Common::AlignUp(static_cast<u64>(address) + size, page_size);
+  std::vector<PendingEFBCopy> overlapping;
+  for (auto iter = pending_efb_copies.begin(); iter != pending_efb_copies.end();)
+  {
+    if (iter->address < end && iter->address + static_cast<u64>(iter->CoveredRange()) > start)
+    {
+      overlapping.push_back(std::move(*iter));
+      iter = pending_efb_copies.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  for (PendingEFBCopy& copy : overlapping)
+    ReadBackEFBCopy(copy);
+}
+
+void TextureCacheBase::FlushEFBCopies()
+{
+  std::vector<PendingEFBCopy> copies = std::move(pending_efb_copies);
+  pending_efb_copies.clear();
+  for (PendingEFBCopy& copy : copies)
+    ReadBackEFBCopy(copy);
+}
+
+void TextureCacheBase::DiscardEFBCopies()
+{
+  std::vector<PendingEFBCopy> copies = std::move(pending_efb_copies);
+  pending_efb_copies.clear();
+  for (PendingEFBCopy& copy : copies)
+    ReleaseEFBCopy(copy);
+}
+
 void TextureCacheBase::UninitializeXFBMemory(u8* dst, u32 stride, u32 bytes_per_row,
                                              u32 num_blocks_y)
 {
@@ -1890,8 +2220,7 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::AllocateCacheEntry(const Textur
   {
     return nullptr;
   }
-  TCacheEntry* cacheEntry = new TCacheEntry(std::move(texture));
-  cacheEntry->textures_by_hash_iter = textures_by_hash.end();
+  TCacheEntry* cacheEntry = entry_pool.Allocate(std::move(texture));
   cacheEntry->id = last_entry_id++;
   return cacheEntry;
 }
@@ -1932,52 +2261,31 @@ TextureCacheBase::FindMatchingTextureFromPool(const TextureConfig& config)
   return matching_iter != range.second ? matching_iter : texture_pool.end();
 }
 
-TextureCacheBase::TexAddrCache::iterator
-TextureCacheBase::GetTexCacheIter(TextureCacheBase::TCacheEntry* entry)
+void TextureCacheBase::AddToHashCache(TCacheEntry* entry, u64 hash)
 {
-  auto iter_range = textures_by_address.equal_range(entry->addr);
-  TexAddrCache::iterator iter = iter_range.first;
-  while (iter != iter_range.second)
-  {
-    if (iter->second == entry)
-    {
-      return iter;
-    }
-    ++iter;
-  }
-  return textures_by_address.end();
+  textures_by_hash.Add(hash, entry);
+  entry->textures_by_hash_key = hash;
 }
 
-std::pair<TextureCacheBase::TexAddrCache::iterator, TextureCacheBase::TexAddrCache::iterator>
-TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes)
+void TextureCacheBase::RemoveFromHashCache(TCacheEntry* entry)
 {
-  // We index by the starting address only, so there is no way to query all textures
-  // which end after the given addr. But the GC textures have a limited size, so we
-  // look for all textures which have a start address bigger than addr minus the maximal
-  // texture size. But this yields false-positives which must be checked later on.
-
-  // 1024 x 1024 texel times 8 nibbles per texel
-  constexpr u32 max_texture_size = 1024 * 1024 * 4;
-  u32 lower_addr = addr > max_texture_size ? addr - max_texture_size : 0;
-  auto begin = textures_by_address.lower_bound(lower_addr);
-  auto end = textures_by_address.upper_bound(addr + size_in_bytes);
-
-  return std::make_pair(begin, end);
+  if (!entry->textures_by_hash_key)
+    return;
+
+  textures_by_hash.Remove(*entry->textures_by_hash_key,
+                          [entry](const TCacheEntry* other) { return other == entry; });
+  entry->textures_by_hash_key.reset();
 }
 
-TextureCacheBase::TexAddrCache::iterator
-TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter)
+std::vector<TextureCacheBase::TCacheEntry*>
+TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes) const
 {
-  if (iter == textures_by_address.end())
-    return textures_by_address.end();
-
-  TCacheEntry* entry = iter->second;
+  return textures_by_address.FindOverlapping(addr, size_in_bytes);
+}
 
-  if (entry->textures_by_hash_iter != textures_by_hash.end())
-  {
-    textures_by_hash.erase(entry->textures_by_hash_iter);
-    entry->textures_by_hash_iter = textures_by_hash.end();
-  }
+void TextureCacheBase::InvalidateTexture(TCacheEntry* entry)
+{
+  RemoveFromHashCache(entry);
 
   for (size_t i = 0; i < bound_textures.size(); ++i)
   {
@@ -1987,14 +2295,28 @@ TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter)
     if (bound_textures[i] == entry && IsValidBindPoint(static_cast<u32>(i)))
     {
       bound_textures[i]->tmem_only = true;
-      return ++iter;
+      return;
     }
   }
 
   auto config = entry->texture->GetConfig();
   texture_pool.emplace(config, TexPoolEntry(std::move(entry->texture)));
 
-  return textures_by_address.erase(iter);
+  textures_by_address.Erase(entry, entry->addr);
+
+  // Invalidated bind points may still point to this entry, don't leave them dangling.
+  for (TCacheEntry*& bound_texture : bound_textures)
+  {
+    if (bound_texture == entry)
+      bound_texture = nullptr;
+  }
+  for (PendingEFBCopy& copy : pending_efb_copies)
+  {
+    if (copy.entry == entry)
+      copy.entry = nullptr;
+  }
+
+  entry_pool.Free(entry);
 }
 
 u32 TextureCacheBase::TCacheEntry::BytesPerRow() const
@@ -2089,3 +2411,49 @@ u64 TextureCacheBase::TCacheEntry::CalculateHash() const
     return temp_hash;
   }
 }
+
+void TextureCacheBase::TCacheEntry::UpdateHashFromMemory()
+{
+  // Start tracking before hashing, so writes racing with the hash aren't missed.
+  hash_write_token = g_ActiveConfig.bTrackTextureWrites ?
+                         Memory::TrackWrites(addr, size_in_bytes) :
+                         Memory::WRITE_TOKEN_INVALID;
+  hash = CalculateHash();
+}
+
+bool TextureCacheBase::TCacheEntry::HashMatchesMemory()
+{
+  if (!g_ActiveConfig.bTrackTextureWrites)
+    return CalculateHash() == hash;
+
+  if (Memory::IsUnchangedSince(addr, size_in_bytes, hash_write_token))
+    return true;
+
+  const u64 write_token = Memory::TrackWrites(addr, size_in_bytes);
+  if (CalculateHash() != hash)
+    return false;
+
+  hash_write_token = write_token;
+  return true;
+}
+
+u64 TextureCacheBase::HashTextureData(u32 address, const u8* src_data, u32 size, int sample_size,
+                                      bool from_tmem)
+{
+  if (from_tmem || !g_ActiveConfig.bTrackTextureWrites)
+    return Common::GetHash64(src_data, size, sample_size);
+
+  MemoryHash& cached = memory_hashes[address];
+  cached.frameCount = FRAMECOUNT_INVALID;
+  if (cached.size == size && cached.sample_size == sample_size &&
+      Memory::IsUnchangedSince(address, size, cached.write_token))
+  {
+    return cached.hash;
+  }
+
+  cached.size = size;
+  cached.sample_size = sample_size;
+  cached.write_token = Memory::TrackWrites(address, size);
+  cached.hash = Common::GetHash64(src_data, size, sample_size);
+  return cached.hash;
+}
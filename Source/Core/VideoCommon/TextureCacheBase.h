@@ -6,19 +6,23 @@
 
 #include <array>
 #include <bitset>
-#include <map>
 #include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/WorkerPool.h"
+#include "VideoCommon/AbstractStagingTexture.h"
 #include "VideoCommon/AbstractTexture.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureCacheIndex.h"
 #include "VideoCommon/TextureConfig.h"
 #include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/TextureDiskCache.h"
 #include "VideoCommon/VideoCommon.h"
 
 struct VideoConfig;
@@ -119,10 +123,14 @@ public:
     u32 size_in_bytes;
     u64 base_hash;
     u64 hash;  // for paletted textures, hash = base_hash ^ palette_hash
+    // Memory::TrackWrites() token of the range hash was calculated from, for copies
+    u64 hash_write_token = 0;
     TextureAndTLUTFormat format;
     u32 memory_stride;
     bool is_efb_copy;
     bool is_custom_tex;
+    // Name of the custom texture which was still loading when this entry was created
+    std::string pending_custom_texture;
     bool may_have_overlapping_textures = true;
     bool tmem_only = false;           // indicates that this texture only exists in the tmem cache
     bool has_arbitrary_mips = false;  // indicates that the mips in this texture are arbitrary
@@ -140,9 +148,8 @@ public:
     // used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
     int frameCount = FRAMECOUNT_INVALID;
 
-    // Keep an iterator to the entry in textures_by_hash, so it does not need to be searched when
-    // removing the cache entry
-    std::multimap<u64, TCacheEntry*>::iterator textures_by_hash_iter;
+    // The key this entry is stored under in textures_by_hash, if it is in there at all
+    std::optional<u64> textures_by_hash_key;
 
     // This is used to keep track of both:
     //   * efb copies used by this partially updated texture
@@ -175,6 +182,7 @@ public:
     {
       base_hash = _base_hash;
       hash = _hash;
+      hash_write_token = 0;
     }
 
     // This texture entry is used by the other entry as a sub-texture
@@ -197,6 +205,11 @@ public:
     u32 BytesPerRow() const;
 
     u64 CalculateHash() const;
+    // Sets hash to the current hash of the memory range, and starts tracking writes to it.
+    void UpdateHashFromMemory();
+    // Whether hash still matches the memory range. Doesn't need to hash anything if the range
+    // wasn't written to since the hash was last checked.
+    bool HashMatchesMemory();
 
     int HashSampleSize() const;
     u32 GetWidth() const { return texture->GetConfig().width; }
@@ -216,12 +229,33 @@ public:
 
   void Invalidate();
 
+  // Reads back the deferred EFB copies which touch the pages of the range. The GPU thread has to
+  // do this before it reads RAM which may hold them.
+  void FlushEFBCopies(u32 address, u32 size);
+  void FlushEFBCopies();
+  // Drops the deferred EFB copies without reading them back, e.g. after RAM was loaded from a
+  // savestate.
+  void DiscardEFBCopies();
+  bool HasPendingEFBCopies() const { return !pending_efb_copies.empty(); }
+
   virtual void CopyEFB(u8* dst, const EFBCopyParams& params, u32 native_width, u32 bytes_per_row,
                        u32 num_blocks_y, u32 memory_stride, const EFBRectangle& src_rect,
                        bool scale_by_half, float y_scale, float gamma, bool clamp_top,
                        bool clamp_bottom,
                        const CopyFilterCoefficientArray& filter_coefficients) = 0;
 
+  // Encodes like CopyEFB, but leaves the rows in dst, a BGRA8 readback texture of at least
+  // bytes_per_row / 4 by num_blocks_y texels. Only used if the backend supports deferred EFB
+  // copies.
+  virtual void CopyEFBToStagingTexture(AbstractStagingTexture* dst, const EFBCopyParams& params,
+                                       u32 native_width, u32 bytes_per_row, u32 num_blocks_y,
+                                       const EFBRectangle& src_rect, bool scale_by_half,
+                                       float y_scale, float gamma, bool clamp_top,
+                                       bool clamp_bottom,
+                                       const CopyFilterCoefficientArray& filter_coefficients)
+  {
+  }
+
   virtual bool CompileShaders() = 0;
   virtual void DeleteShaders() = 0;
 
@@ -298,10 +332,25 @@ private:
     int frameCount = FRAMECOUNT_INVALID;
     TexPoolEntry(std::unique_ptr<AbstractTexture> tex) : texture(std::move(tex)) {}
   };
-  using TexAddrCache = std::multimap<u32, TCacheEntry*>;
-  using TexHashCache = std::multimap<u64, TCacheEntry*>;
+  using TexAddrCache = VideoCommon::PagedRangeIndex<TCacheEntry*>;
+  using TexHashCache = VideoCommon::FlatMultiIndex<u64, TCacheEntry*>;
   using TexPool = std::unordered_multimap<TextureConfig, TexPoolEntry>;
 
+  // An EFB copy to RAM which is still in a staging texture. Its range is protected from access
+  // until it is read back.
+  struct PendingEFBCopy
+  {
+    u32 address;
+    u32 stride;
+    u32 bytes_per_row;
+    u32 num_blocks_y;
+    std::unique_ptr<AbstractStagingTexture> texture;
+    // The VRAM copy of the same EFB copy, which is hashed once the data is in RAM
+    TCacheEntry* entry;
+
+    u32 CoveredRange() const { return num_blocks_y * stride; }
+  };
+
   void SetBackupConfig(const VideoConfig& config);
 
   TCacheEntry* ApplyPaletteToEntry(TCacheEntry* entry, u8* palette, TLUTFormat tlutfmt);
@@ -311,16 +360,25 @@ private:
 
   void DumpTexture(TCacheEntry* entry, std::string basename, unsigned int level, bool is_arbitrary);
   void CheckTempSize(size_t required_size);
+  // Returns the pool for TexDecoder_DecodeLevels(), sized to the current configuration.
+  Common::WorkerPool* GetDecoderPool();
+  // Opens or closes the decoded texture disk cache to match the backup config.
+  void UpdateDecodedTextureDiskCache();
 
   TCacheEntry* AllocateCacheEntry(const TextureConfig& config);
   std::unique_ptr<AbstractTexture> AllocateTexture(const TextureConfig& config);
   TexPool::iterator FindMatchingTextureFromPool(const TextureConfig& config);
-  TexAddrCache::iterator GetTexCacheIter(TCacheEntry* entry);
 
-  // Return all possible overlapping textures. As addr+size of the textures is not
-  // indexed, this may return false positives.
-  std::pair<TexAddrCache::iterator, TexAddrCache::iterator>
-  FindOverlappingTextures(u32 addr, u32 size_in_bytes);
+  // Hashes texture data. For textures in RAM, with texture write tracking enabled, the previous
+  // hash of the same range is reused if nothing was written to the range since.
+  u64 HashTextureData(u32 address, const u8* src_data, u32 size, int sample_size, bool from_tmem);
+
+  void AddToHashCache(TCacheEntry* entry, u64 hash);
+  void RemoveFromHashCache(TCacheEntry* entry);
+
+  // Returns all textures overlapping the given range, ordered by address. Textures which start at
+  // addr are always included, even if they are empty.
+  std::vector<TCacheEntry*> FindOverlappingTextures(u32 addr, u32 size_in_bytes) const;
 
   virtual void CopyEFBToCacheEntry(TCacheEntry* entry, bool is_depth_copy,
                                    const EFBRectangle& src_rect, bool scale_by_half,
@@ -329,29 +387,67 @@ private:
                                    const CopyFilterCoefficientArray& filter_coefficients) = 0;
 
   // Removes and unlinks texture from texture cache and returns it to the pool
-  TexAddrCache::iterator InvalidateTexture(TexAddrCache::iterator t_iter);
+  void InvalidateTexture(TCacheEntry* entry);
 
   void UninitializeXFBMemory(u8* dst, u32 stride, u32 bytes_per_row, u32 num_blocks_y);
 
+  // Leaves an EFB copy to RAM in a staging texture until its range is accessed. Returns the
+  // staging texture, or null if the copy has to be read back right away instead.
+  AbstractStagingTexture*
+  DeferEFBCopy(u32 dst_addr, u32 dst_stride, const EFBCopyParams& params, u32 native_width,
+               u32 bytes_per_row, u32 num_blocks_y, const EFBRectangle& src_rect,
+               bool scale_by_half, float y_scale, float gamma, bool clamp_top, bool clamp_bottom,
+               const CopyFilterCoefficientArray& filter_coefficients);
+  // Drops the deferred EFB copies which an EFB copy to the given rows overwrites completely, and
+  // reads back the other ones it overlaps, so that they reach RAM first.
+  void ResolveEFBCopiesOverlapping(u32 address, u32 stride, u32 bytes_per_row, u32 num_blocks_y);
+  void ReadBackEFBCopy(PendingEFBCopy& copy);
+  void ReleaseEFBCopy(PendingEFBCopy& copy);
+
   // Precomputing the coefficients for the previous, current, and next lines for the copy filter.
   CopyFilterCoefficientArray
   GetRAMCopyFilterCoefficients(const CopyFilterCoefficients::Values& coefficients) const;
   CopyFilterCoefficientArray
   GetVRAMCopyFilterCoefficients(const CopyFilterCoefficients::Values& coefficients) const;
 
+  VideoCommon::ObjectPool<TCacheEntry> entry_pool;
   TexAddrCache textures_by_address;
   TexHashCache textures_by_hash;
   TexPool texture_pool;
   u64 last_entry_id = 0;
 
+  struct MemoryHash
+  {
+    u32 size;
+    int sample_size;
+    u64 write_token;
+    u64 hash;
+    // Dropped like textures which aren't used for TEXTURE_KILL_THRESHOLD frames
+    int frameCount = FRAMECOUNT_INVALID;
+  };
+  std::unordered_map<u32, MemoryHash> memory_hashes;
+
+  std::vector<PendingEFBCopy> pending_efb_copies;
+  std::vector<std::unique_ptr<AbstractStagingTexture>> efb_copy_staging_textures;
+
+  Common::WorkerPool decoder_pool;
+  std::vector<TexDecoderLevel> decoder_levels;
+
+  // Decoded textures from earlier sessions of the running game.
+  VideoCommon::TextureDiskCache decoded_texture_disk_cache;
+
   // Backup configuration values
   struct BackupConfig
   {
     int color_samples;
+    bool full_texture_hash;
     bool texfmt_overlay;
     bool texfmt_overlay_center;
     bool hires_textures;
     bool cache_hires_textures;
+    int hires_texture_cache_size;
+    bool cache_decoded_textures;
+    int decoded_texture_cache_size;
     bool copy_cache_enable;
     bool stereo_3d;
     bool efb_mono_depth;
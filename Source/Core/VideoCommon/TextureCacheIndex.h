@@ -0,0 +1,466 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Common/Assert.h"
+#include "Common/CommonTypes.h"
+
+// Containers backing the texture cache lookups.
+//
+// The texture cache used to keep its entries in std::multimaps keyed by address and by hash.
+// Every lookup walked a tree, and looking for textures overlapping a memory range had to scan
+// everything which started up to 4 MiB before the range. These containers keep the same
+// ordering guarantees, but store their data in flat arrays and index memory ranges by page.
+
+namespace VideoCommon
+{
+// Open-addressed hash table mapping a key to the list of values added for it, in insertion order.
+template <typename Key, typename Value>
+class FlatMultiIndex
+{
+public:
+  using List = std::vector<Value>;
+
+  static constexpr size_t NO_CELL = SIZE_MAX;
+
+  // Returns nullptr if nothing is stored under key.
+  const List* Find(Key key) const
+  {
+    const size_t cell = FindCell(key);
+    return cell != NO_CELL ? &m_lists[m_cells[cell].list] : nullptr;
+  }
+
+  // The cells can be walked by their index to look at the lists in place. Removing values moves
+  // neither the cells nor the lists, only adding values does.
+  size_t FindCell(Key key) const
+  {
+    if (m_cells.empty())
+      return NO_CELL;
+
+    for (size_t i = Hash(key) & m_mask;; i = (i + 1) & m_mask)
+    {
+      const Cell& cell = m_cells[i];
+      if (cell.list == EMPTY)
+        return NO_CELL;
+      if (cell.list != TOMBSTONE && cell.key == key)
+        return i;
+    }
+  }
+
+  size_t GetCellCount() const { return m_cells.size(); }
+
+  // Returns nullptr if the cell holds no list.
+  const List* GetCellList(size_t index, Key* key) const
+  {
+    const Cell& cell = m_cells[index];
+    if (cell.list == EMPTY || cell.list == TOMBSTONE)
+      return nullptr;
+    *key = cell.key;
+    return &m_lists[cell.list];
+  }
+
+  void Add(Key key, Value value)
+  {
+    if ((m_used + 1) * 4 > m_cells.size() * 3)
+    {
+      // Only grow if the live keys need it; otherwise dropping the tombstones is enough.
+      const size_t size = m_live * 4 > m_cells.size() ? m_cells.size() * 2 : m_cells.size();
+      Rehash(std::max<size_t>(16, size));
+    }
+
+    size_t insert_at = SIZE_MAX;
+    for (size_t i = Hash(key) & m_mask;; i = (i + 1) & m_mask)
+    {
+      Cell& cell = m_cells[i];
+      if (cell.list == EMPTY)
+      {
+        if (insert_at == SIZE_MAX)
+        {
+          insert_at = i;
+          m_used++;
+        }
+        break;
+      }
+      if (cell.list == TOMBSTONE)
+      {
+        if (insert_at == SIZE_MAX)
+          insert_at = i;
+        continue;
+      }
+      if (cell.key == key)
+      {
+        m_lists[cell.list].push_back(std::move(value));
+        return;
+      }
+    }
+
+    Cell& cell = m_cells[insert_at];
+    cell.key = key;
+    cell.list = AllocateList();
+    m_lists[cell.list].push_back(std::move(value));
+    m_live++;
+  }
+
+  // Removes the first value stored under key for which pred returns true.
+  template <typename Pred>
+  bool Remove(Key key, Pred pred)
+  {
+    if (m_cells.empty())
+      return false;
+
+    for (size_t i = Hash(key) & m_mask;; i = (i + 1) & m_mask)
+    {
+      Cell& cell = m_cells[i];
+      if (cell.list == EMPTY)
+        return false;
+      if (cell.list == TOMBSTONE || cell.key != key)
+        continue;
+
+      List& list = m_lists[cell.list];
+      auto it = std::find_if(list.begin(), list.end(), pred);
+      if (it == list.end())
+        return false;
+
+      list.erase(it);
+      if (list.empty())
+      {
+        m_free_lists.push_back(cell.list);
+        cell.list = TOMBSTONE;
+        m_live--;
+      }
+      return true;
+    }
+  }
+
+  template <typename F>
+  void ForEachList(F f) const
+  {
+    for (const Cell& cell : m_cells)
+    {
+      if (cell.list != EMPTY && cell.list != TOMBSTONE)
+        f(cell.key, m_lists[cell.list]);
+    }
+  }
+
+  void Clear()
+  {
+    m_cells.clear();
+    m_lists.clear();
+    m_free_lists.clear();
+    m_mask = 0;
+    m_used = 0;
+    m_live = 0;
+  }
+
+private:
+  static constexpr u32 EMPTY = UINT32_MAX;
+  static constexpr u32 TOMBSTONE = UINT32_MAX - 1;
+
+  struct Cell
+  {
+    Key key;
+    u32 list = EMPTY;
+  };
+
+  static size_t Hash(Key key)
+  {
+    // Fibonacci hashing; the keys are addresses or already well mixed hashes.
+    const u64 h = static_cast<u64>(key) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h ^ (h >> 32));
+  }
+
+  u32 AllocateList()
+  {
+    if (!m_free_lists.empty())
+    {
+      const u32 list = m_free_lists.back();
+      m_free_lists.pop_back();
+      return list;
+    }
+    m_lists.emplace_back();
+    return static_cast<u32>(m_lists.size() - 1);
+  }
+
+  void Rehash(size_t new_size)
+  {
+    std::vector<Cell> old_cells(new_size);
+    std::swap(old_cells, m_cells);
+    m_mask = new_size - 1;
+    m_used = m_live;
+
+    for (const Cell& old_cell : old_cells)
+    {
+      if (old_cell.list == EMPTY || old_cell.list == TOMBSTONE)
+        continue;
+
+      size_t i = Hash(old_cell.key) & m_mask;
+      while (m_cells[i].list != EMPTY)
+        i = (i + 1) & m_mask;
+      m_cells[i] = old_cell;
+    }
+  }
+
+  std::vector<Cell> m_cells;
+  std::vector<List> m_lists;
+  std::vector<u32> m_free_lists;
+  size_t m_mask = 0;
+  size_t m_used = 0;  // live and tombstoned cells
+  size_t m_live = 0;
+};
+
+// Indexes values by the guest memory range they cover. A value is filed under every page its
+// range touches, so overlap queries only have to look at the pages of the queried range.
+template <typename T>
+class PagedRangeIndex
+{
+  struct Slot;
+  using Pages = FlatMultiIndex<u32, Slot>;
+
+public:
+  static constexpr u32 PAGE_SHIFT = 14;
+
+  // Walks the values in place, without copying them out. The value under the cursor may be erased
+  // before moving on, but nothing else may be inserted or erased while a cursor is in use.
+  class Cursor
+  {
+  public:
+    T operator*() const { return m_value; }
+
+    Cursor& operator++()
+    {
+      // If the current value was erased, the next one has already moved into its position.
+      if (m_pos < m_list->size() && (*m_list)[m_pos].value == m_value)
+        m_pos++;
+      Settle();
+      return *this;
+    }
+
+    bool operator!=(const Cursor& other) const
+    {
+      return m_cell != other.m_cell || m_pos != other.m_pos;
+    }
+
+  private:
+    friend class PagedRangeIndex;
+
+    // Without an address, the values are visited on the first page they cover.
+    Cursor(const Pages* pages, size_t cell, size_t end_cell, const u32* address)
+        : m_pages(pages), m_cell(cell), m_end_cell(end_cell), m_match_address(address != nullptr),
+          m_address(address ? *address : 0)
+    {
+      if (m_cell != m_end_cell)
+        m_list = m_pages->GetCellList(m_cell, &m_page);
+      Settle();
+    }
+
+    // Moves to the first matching value from the current position on.
+    void Settle()
+    {
+      while (m_cell != m_end_cell)
+      {
+        for (; m_list && m_pos < m_list->size(); m_pos++)
+        {
+          const Slot& slot = (*m_list)[m_pos];
+          if (m_match_address ? slot.address == m_address : slot.address >> PAGE_SHIFT == m_page)
+          {
+            m_value = slot.value;
+            return;
+          }
+        }
+
+        m_cell++;
+        m_pos = 0;
+        m_list = m_cell != m_end_cell ? m_pages->GetCellList(m_cell, &m_page) : nullptr;
+      }
+    }
+
+    const Pages* m_pages;
+    const std::vector<Slot>* m_list = nullptr;
+    size_t m_cell;
+    size_t m_end_cell;
+    size_t m_pos = 0;
+    bool m_match_address;
+    u32 m_address;
+    u32 m_page = 0;
+    T m_value{};
+  };
+
+  class Range
+  {
+  public:
+    Cursor begin() const { return m_begin; }
+    Cursor end() const { return m_end; }
+
+  private:
+    friend class PagedRangeIndex;
+    Range(Cursor begin, Cursor end) : m_begin(begin), m_end(end) {}
+
+    Cursor m_begin;
+    Cursor m_end;
+  };
+
+  void Insert(T value, u32 address, u32 size)
+  {
+    const Slot slot{value, address, RangeEnd(address, size), m_next_sequence++};
+    for (u32 page = address >> PAGE_SHIFT; page <= (slot.end - 1) >> PAGE_SHIFT; page++)
+      m_pages.Add(page, slot);
+    m_size++;
+  }
+
+  // address has to be the one value was inserted with.
+  void Erase(T value, u32 address)
+  {
+    const auto* list = m_pages.Find(address >> PAGE_SHIFT);
+    if (!list)
+    {
+      ASSERT_MSG(VIDEO, false, "Erasing value which isn't indexed at %08x", address);
+      return;
+    }
+    const auto it = std::find_if(list->begin(), list->end(), [&](const Slot& slot) {
+      return slot.value == value && slot.address == address;
+    });
+    if (it == list->end())
+    {
+      ASSERT_MSG(VIDEO, false, "Erasing value which isn't indexed at %08x", address);
+      return;
+    }
+
+    const u32 end = it->end;
+    for (u32 page = address >> PAGE_SHIFT; page <= (end - 1) >> PAGE_SHIFT; page++)
+      m_pages.Remove(page, [&](const Slot& slot) { return slot.value == value; });
+    m_size--;
+  }
+
+  // All values inserted at exactly this address, oldest first.
+  Range At(u32 address) const
+  {
+    const size_t cell = m_pages.FindCell(address >> PAGE_SHIFT);
+    if (cell == Pages::NO_CELL)
+      return Range(Cursor(&m_pages, 0, 0, &address), Cursor(&m_pages, 0, 0, &address));
+    return Range(Cursor(&m_pages, cell, cell + 1, &address),
+                 Cursor(&m_pages, cell + 1, cell + 1, &address));
+  }
+
+  // All values, in no particular order.
+  Range All() const
+  {
+    const size_t num_cells = m_pages.GetCellCount();
+    return Range(Cursor(&m_pages, 0, num_cells, nullptr),
+                 Cursor(&m_pages, num_cells, num_cells, nullptr));
+  }
+
+  // All values whose range overlaps [address, address + size), or which start at address.
+  // Sorted by address, values at the same address oldest first. The values are copied, so the
+  // index can be changed while going through them.
+  std::vector<T> FindOverlapping(u32 address, u32 size) const
+  {
+    const u32 end = RangeEnd(address, size);
+    const u32 first_page = address >> PAGE_SHIFT;
+    std::vector<Slot> slots;
+    for (u32 page = first_page; page <= (end - 1) >> PAGE_SHIFT; page++)
+    {
+      const auto* list = m_pages.Find(page);
+      if (!list)
+        continue;
+
+      for (const Slot& slot : *list)
+      {
+        // Values spanning several of the queried pages are only reported on the first one.
+        if (slot.address < end && slot.end > address &&
+            std::max(slot.address >> PAGE_SHIFT, first_page) == page)
+        {
+          slots.push_back(slot);
+        }
+      }
+    }
+    return SortedValues(&slots);
+  }
+
+  size_t size() const { return m_size; }
+
+  void Clear()
+  {
+    m_pages.Clear();
+    m_size = 0;
+  }
+
+private:
+  struct Slot
+  {
+    T value;
+    u32 address;
+    u32 end;
+    u64 sequence;
+  };
+
+  // Empty ranges still have to be found by their address.
+  static u32 RangeEnd(u32 address, u32 size) { return address + std::max<u32>(size, 1); }
+
+  static std::vector<T> SortedValues(std::vector<Slot>* slots)
+  {
+    std::sort(slots->begin(), slots->end(), [](const Slot& a, const Slot& b) {
+      return a.address != b.address ? a.address < b.address : a.sequence < b.sequence;
+    });
+    std::vector<T> result;
+    result.reserve(slots->size());
+    for (const Slot& slot : *slots)
+      result.push_back(slot.value);
+    return result;
+  }
+
+  Pages m_pages;
+  size_t m_size = 0;
+  u64 m_next_sequence = 0;
+};
+
+// Allocates objects in fixed size chunks and recycles freed slots, so creating and destroying
+// cache entries doesn't go through the general purpose allocator every time.
+template <typename T, size_t CHUNK_SIZE = 256>
+class ObjectPool
+{
+public:
+  ObjectPool() = default;
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+  // All objects have to be freed before the pool goes away.
+  ~ObjectPool() = default;
+
+  template <typename... Args>
+  T* Allocate(Args&&... args)
+  {
+    if (m_free.empty())
+    {
+      m_chunks.push_back(std::make_unique<Storage[]>(CHUNK_SIZE));
+      Storage* chunk = m_chunks.back().get();
+      for (size_t i = CHUNK_SIZE; i > 0; i--)
+        m_free.push_back(&chunk[i - 1]);
+    }
+
+    Storage* storage = m_free.back();
+    m_free.pop_back();
+    return new (storage) T(std::forward<Args>(args)...);
+  }
+
+  void Free(T* object)
+  {
+    object->~T();
+    m_free.push_back(reinterpret_cast<Storage*>(object));
+  }
+
+private:
+  using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+  std::vector<std::unique_ptr<Storage[]>> m_chunks;
+  std::vector<Storage*> m_free;
+};
+
+}  // namespace VideoCommon
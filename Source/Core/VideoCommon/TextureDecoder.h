@@ -4,9 +4,15 @@
 
 #pragma once
 
+#include <cstddef>
 #include <tuple>
 #include "Common/CommonTypes.h"
 
+namespace Common
+{
+class WorkerPool;
+}
+
 enum
 {
   TMEM_SIZE = 1024 * 1024,
@@ -112,6 +118,20 @@ void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFor
                        const u8* tlut, TLUTFormat tlutfmt);
 void TexDecoder_DecodeRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* src_gb, int width,
                                     int height);
+
+struct TexDecoderLevel
+{
+  u8* dst;
+  const u8* src;
+  int width;
+  int height;
+};
+
+// Decodes every level like TexDecoder_Decode() does. Large levels are split into bands of block
+// rows, and the bands of all levels are decoded on pool and the calling thread together.
+void TexDecoder_DecodeLevels(Common::WorkerPool* pool, const TexDecoderLevel* levels,
+                             size_t num_levels, TextureFormat texformat, const u8* tlut,
+                             TLUTFormat tlutfmt);
 void TexDecoder_DecodeTexel(u8* dst, const u8* src, int s, int t, int imageWidth,
                             TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt);
 void TexDecoder_DecodeTexelRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* src_gb, int s, int t,
@@ -119,6 +139,12 @@ void TexDecoder_DecodeTexelRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* sr
 
 void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
 
-/* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
+/* Internal method, implemented by TextureDecoder_x64 and TextureDecoder_ARM64, or by
+ * TextureDecoder_Generic on other hosts. The palette formats may read the two bytes after the
+ * last TLUT entry they use. */
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
                             const u8* tlut, TLUTFormat tlutfmt);
+/* The plain C++ decoders from TextureDecoder_Generic, which are built on every host so that the
+ * vectorized decoders can be checked against them. */
+void _TexDecoder_DecodeImpl_Generic(u32* dst, const u8* src, int width, int height,
+                                    TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt);
@@ -0,0 +1,426 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <arm_neon.h>
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/TextureDecoder_Util.h"
+
+// NEON texture decoders. Texels are decoded four at a time into 32-bit lanes, which is a row of a
+// 4-texel wide tile or half a row of an 8-texel wide one. Formats without a NEON path use the
+// generic decoder.
+
+namespace
+{
+// Expands 4, 5 and 6 bit channels to 8 bits, like the Convert*To8 functions.
+uint32x4_t Expand4To8(uint32x4_t v)
+{
+  return vorrq_u32(vshlq_n_u32(v, 4), v);
+}
+
+uint32x4_t Expand5To8(uint32x4_t v)
+{
+  return vorrq_u32(vshlq_n_u32(v, 3), vshrq_n_u32(v, 2));
+}
+
+uint32x4_t Expand6To8(uint32x4_t v)
+{
+  return vorrq_u32(vshlq_n_u32(v, 2), vshrq_n_u32(v, 4));
+}
+
+uint32x4_t PackRGBA(uint32x4_t r, uint32x4_t g, uint32x4_t b, uint32x4_t a)
+{
+  return vorrq_u32(vorrq_u32(r, vshlq_n_u32(g, 8)),
+                   vorrq_u32(vshlq_n_u32(b, 16), vshlq_n_u32(a, 24)));
+}
+
+// Four big endian 16-bit values, in host order.
+uint32x4_t LoadShorts(const u8* src)
+{
+  return vmovl_u16(vreinterpret_u16_u8(vrev16_u8(vld1_u8(src))));
+}
+
+// The 16-bit decoders take texels in host order.
+uint32x4_t DecodeIA8(uint32x4_t val)
+{
+  const uint32x4_t i = vandq_u32(val, vdupq_n_u32(0xFF));
+  return vorrq_u32(vmulq_n_u32(i, 0x010101), vshlq_n_u32(vshrq_n_u32(val, 8), 24));
+}
+
+uint32x4_t DecodeRGB565(uint32x4_t val)
+{
+  const uint32x4_t r = Expand5To8(vshrq_n_u32(val, 11));
+  const uint32x4_t g = Expand6To8(vandq_u32(vshrq_n_u32(val, 5), vdupq_n_u32(0x3F)));
+  const uint32x4_t b = Expand5To8(vandq_u32(val, vdupq_n_u32(0x1F)));
+  return PackRGBA(r, g, b, vdupq_n_u32(0xFF));
+}
+
+uint32x4_t DecodeRGB5A3(uint32x4_t val)
+{
+  const uint32x4_t mask5 = vdupq_n_u32(0x1F);
+  const uint32x4_t mask4 = vdupq_n_u32(0xF);
+
+  // Top bit set: RGB555.
+  const uint32x4_t rgb555 =
+      PackRGBA(Expand5To8(vandq_u32(vshrq_n_u32(val, 10), mask5)),
+               Expand5To8(vandq_u32(vshrq_n_u32(val, 5), mask5)),
+               Expand5To8(vandq_u32(val, mask5)), vdupq_n_u32(0xFF));
+
+  // Top bit clear: RGB4A3.
+  const uint32x4_t a3 = vandq_u32(vshrq_n_u32(val, 12), vdupq_n_u32(0x7));
+  const uint32x4_t a =
+      vorrq_u32(vorrq_u32(vshlq_n_u32(a3, 5), vshlq_n_u32(a3, 2)), vshrq_n_u32(a3, 1));
+  const uint32x4_t rgb4a3 = PackRGBA(Expand4To8(vandq_u32(vshrq_n_u32(val, 8), mask4)),
+                                     Expand4To8(vandq_u32(vshrq_n_u32(val, 4), mask4)),
+                                     Expand4To8(vandq_u32(val, mask4)), a);
+
+  return vbslq_u32(vtstq_u32(val, vdupq_n_u32(0x8000)), rgb555, rgb4a3);
+}
+
+template <TLUTFormat tlutfmt>
+uint32x4_t DecodeTLUTEntries(uint32x4_t entries)
+{
+  switch (tlutfmt)
+  {
+  case TLUTFormat::IA8:
+    return DecodeIA8(entries);
+  case TLUTFormat::RGB565:
+    return DecodeRGB565(entries);
+  case TLUTFormat::RGB5A3:
+  default:
+    return DecodeRGB5A3(entries);
+  }
+}
+
+// NEON has no gather, so the entries are loaded one lane at a time and decoded together.
+template <TLUTFormat tlutfmt>
+uint32x4_t LookUpTLUT(const u8* tlut, u32 i0, u32 i1, u32 i2, u32 i3)
+{
+  const u16* entries = reinterpret_cast<const u16*>(tlut);
+  uint16x4_t raw = vdup_n_u16(0);
+  raw = vld1_lane_u16(entries + i0, raw, 0);
+  raw = vld1_lane_u16(entries + i1, raw, 1);
+  raw = vld1_lane_u16(entries + i2, raw, 2);
+  raw = vld1_lane_u16(entries + i3, raw, 3);
+  return DecodeTLUTEntries<tlutfmt>(
+      vmovl_u16(vreinterpret_u16_u8(vrev16_u8(vreinterpret_u8_u16(raw)))));
+}
+
+// Turns four palette indices below 16 into byte indices of a table of 32-bit colors.
+uint8x16_t ToByteIndices(uint32x4_t indices)
+{
+  return vreinterpretq_u8_u32(vmlaq_n_u32(vdupq_n_u32(0x03020100), indices, 0x04040404));
+}
+
+// Splits the 8 nibbles of 4 bytes into two vectors, high nibble first.
+void UnpackNibbles(const u8* src, uint32x4_t* left, uint32x4_t* right)
+{
+  u32 bytes;
+  std::memcpy(&bytes, src, sizeof(bytes));
+  const uint32x4_t splat = vdupq_n_u32(bytes);
+  const int32x4_t left_shifts = {-4, 0, -12, -8};
+  const int32x4_t right_shifts = {-20, -16, -28, -24};
+  *left = vandq_u32(vshlq_u32(splat, left_shifts), vdupq_n_u32(0xF));
+  *right = vandq_u32(vshlq_u32(splat, right_shifts), vdupq_n_u32(0xF));
+}
+
+void UnpackBytes(const u8* src, uint32x4_t* left, uint32x4_t* right)
+{
+  const uint16x8_t shorts = vmovl_u8(vld1_u8(src));
+  *left = vmovl_u16(vget_low_u16(shorts));
+  *right = vmovl_u16(vget_high_u16(shorts));
+}
+
+u32* Row(u32* dst, int width, int x, int y)
+{
+  return dst + y * width + x;
+}
+
+// 8x8 tiles of 4-bit texels.
+template <TextureFormat format, TLUTFormat tlutfmt>
+void Decode4Bit(u32* dst, const u8* src, int width, int height, const u8* tlut)
+{
+  // The whole palette fits in four registers.
+  uint8x16x4_t palette;
+  if (format == TextureFormat::C4)
+  {
+    palette.val[0] = vreinterpretq_u8_u32(DecodeTLUTEntries<tlutfmt>(LoadShorts(tlut)));
+    palette.val[1] = vreinterpretq_u8_u32(DecodeTLUTEntries<tlutfmt>(LoadShorts(tlut + 8)));
+    palette.val[2] = vreinterpretq_u8_u32(DecodeTLUTEntries<tlutfmt>(LoadShorts(tlut + 16)));
+    palette.val[3] = vreinterpretq_u8_u32(DecodeTLUTEntries<tlutfmt>(LoadShorts(tlut + 24)));
+  }
+
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      for (int iy = 0; iy < 8; iy++, src += 4)
+      {
+        uint32x4_t left, right;
+        UnpackNibbles(src, &left, &right);
+        u32* row = Row(dst, width, x, y + iy);
+        if (format == TextureFormat::C4)
+        {
+          vst1q_u8(reinterpret_cast<u8*>(row), vqtbl4q_u8(palette, ToByteIndices(left)));
+          vst1q_u8(reinterpret_cast<u8*>(row + 4), vqtbl4q_u8(palette, ToByteIndices(right)));
+        }
+        else  // I4
+        {
+          vst1q_u32(row, vmulq_n_u32(left, 0x11111111));
+          vst1q_u32(row + 4, vmulq_n_u32(right, 0x11111111));
+        }
+      }
+    }
+  }
+}
+
+template <TextureFormat format>
+uint32x4_t Decode8BitTexels(uint32x4_t bytes)
+{
+  if (format == TextureFormat::IA4)
+  {
+    return vorrq_u32(vmulq_n_u32(vshrq_n_u32(bytes, 4), 0x11000000),
+                     vmulq_n_u32(vandq_u32(bytes, vdupq_n_u32(0xF)), 0x111111));
+  }
+  else  // I8
+  {
+    return vmulq_n_u32(bytes, 0x01010101);
+  }
+}
+
+// 8x4 tiles of 8-bit texels.
+template <TextureFormat format, TLUTFormat tlutfmt>
+void Decode8Bit(u32* dst, const u8* src, int width, int height, const u8* tlut)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      for (int iy = 0; iy < 4; iy++, src += 8)
+      {
+        u32* row = Row(dst, width, x, y + iy);
+        if (format == TextureFormat::C8)
+        {
+          vst1q_u32(row, LookUpTLUT<tlutfmt>(tlut, src[0], src[1], src[2], src[3]));
+          vst1q_u32(row + 4, LookUpTLUT<tlutfmt>(tlut, src[4], src[5], src[6], src[7]));
+        }
+        else
+        {
+          uint32x4_t left, right;
+          UnpackBytes(src, &left, &right);
+          vst1q_u32(row, Decode8BitTexels<format>(left));
+          vst1q_u32(row + 4, Decode8BitTexels<format>(right));
+        }
+      }
+    }
+  }
+}
+
+// 4x4 tiles of 16-bit texels.
+template <TextureFormat format, TLUTFormat tlutfmt>
+void Decode16Bit(u32* dst, const u8* src, int width, int height, const u8* tlut)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4)
+    {
+      for (int iy = 0; iy < 4; iy++, src += 8)
+      {
+        uint32x4_t texels;
+        if (format == TextureFormat::C14X2)
+        {
+          const uint32x4_t indices = vandq_u32(LoadShorts(src), vdupq_n_u32(0x3FFF));
+          texels = LookUpTLUT<tlutfmt>(tlut, vgetq_lane_u32(indices, 0),
+                                       vgetq_lane_u32(indices, 1), vgetq_lane_u32(indices, 2),
+                                       vgetq_lane_u32(indices, 3));
+        }
+        else if (format == TextureFormat::IA8)
+        {
+          texels = DecodeIA8(LoadShorts(src));
+        }
+        else if (format == TextureFormat::RGB565)
+        {
+          texels = DecodeRGB565(LoadShorts(src));
+        }
+        else  // RGB5A3
+        {
+          texels = DecodeRGB5A3(LoadShorts(src));
+        }
+        vst1q_u32(Row(dst, width, x, y + iy), texels);
+      }
+    }
+  }
+}
+
+void DecodeRGBA8(u32* dst, const u8* src, int width, int height)
+{
+  // Each 4x4 tile holds 16 AR pairs followed by 16 GB pairs.
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4, src += 64)
+    {
+      for (int iy = 0; iy < 4; iy++)
+      {
+        const uint32x4_t ar = vmovl_u16(vreinterpret_u16_u8(vld1_u8(src + iy * 8)));
+        const uint32x4_t gb = vmovl_u16(vreinterpret_u16_u8(vld1_u8(src + 32 + iy * 8)));
+        const uint32x4_t texels =
+            vorrq_u32(vorrq_u32(vshlq_n_u32(ar, 24), vshrq_n_u32(ar, 8)), vshlq_n_u32(gb, 8));
+        vst1q_u32(Row(dst, width, x, y + iy), texels);
+      }
+    }
+  }
+}
+
+// (v1 * 3 + v2 * 5) / 8, like DXTBlend.
+uint32x4_t DXTBlend(uint32x4_t v1, uint32x4_t v2)
+{
+  return vshrq_n_u32(vmlaq_n_u32(vmulq_n_u32(v1, 3), v2, 5), 3);
+}
+
+void DecodeCMPR(u32* dst, const u8* src, int width, int height)
+{
+  const int32x4_t selector_shifts = {-6, -4, -2, 0};
+  const uint32x4_t opaque = vdupq_n_u32(0xFF000000);
+
+  // Each 8x8 tile holds four DXT blocks: top left, top right, bottom left, bottom right.
+  // The palettes of all four are built at once, one block per lane.
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0; x < width; x += 8, src += 32)
+    {
+      const uint16x4x4_t halves = vld4_u16(reinterpret_cast<const u16*>(src));
+      const uint32x4_t c1 =
+          vmovl_u16(vreinterpret_u16_u8(vrev16_u8(vreinterpret_u8_u16(halves.val[0]))));
+      const uint32x4_t c2 =
+          vmovl_u16(vreinterpret_u16_u8(vrev16_u8(vreinterpret_u8_u16(halves.val[1]))));
+
+      const uint32x4_t r1 = Expand5To8(vshrq_n_u32(c1, 11));
+      const uint32x4_t g1 = Expand6To8(vandq_u32(vshrq_n_u32(c1, 5), vdupq_n_u32(0x3F)));
+      const uint32x4_t b1 = Expand5To8(vandq_u32(c1, vdupq_n_u32(0x1F)));
+      const uint32x4_t r2 = Expand5To8(vshrq_n_u32(c2, 11));
+      const uint32x4_t g2 = Expand6To8(vandq_u32(vshrq_n_u32(c2, 5), vdupq_n_u32(0x3F)));
+      const uint32x4_t b2 = Expand5To8(vandq_u32(c2, vdupq_n_u32(0x1F)));
+
+      const uint32x4_t color0 = vorrq_u32(PackRGBA(r1, g1, b1, vdupq_n_u32(0)), opaque);
+      const uint32x4_t color1 = vorrq_u32(PackRGBA(r2, g2, b2, vdupq_n_u32(0)), opaque);
+
+      // Color 3 is transparent when it's the average.
+      const uint32x4_t average =
+          PackRGBA(vshrq_n_u32(vaddq_u32(r1, r2), 1), vshrq_n_u32(vaddq_u32(g1, g2), 1),
+                   vshrq_n_u32(vaddq_u32(b1, b2), 1), vdupq_n_u32(0));
+      const uint32x4_t blend2 = vorrq_u32(
+          PackRGBA(DXTBlend(r2, r1), DXTBlend(g2, g1), DXTBlend(b2, b1), vdupq_n_u32(0)), opaque);
+      const uint32x4_t blend3 = vorrq_u32(
+          PackRGBA(DXTBlend(r1, r2), DXTBlend(g1, g2), DXTBlend(b1, b2), vdupq_n_u32(0)), opaque);
+      const uint32x4_t c1_greater = vcgtq_u32(c1, c2);
+      const uint32x4_t color2 = vbslq_u32(c1_greater, blend2, vorrq_u32(average, opaque));
+      const uint32x4_t color3 = vbslq_u32(c1_greater, blend3, average);
+
+      // Transpose, so each block gets its palette in one register.
+      const uint32x4_t t0 = vzip1q_u32(color0, color2);
+      const uint32x4_t t1 = vzip2q_u32(color0, color2);
+      const uint32x4_t t2 = vzip1q_u32(color1, color3);
+      const uint32x4_t t3 = vzip2q_u32(color1, color3);
+      const uint8x16_t palettes[4] = {
+          vreinterpretq_u8_u32(vzip1q_u32(t0, t2)), vreinterpretq_u8_u32(vzip2q_u32(t0, t2)),
+          vreinterpretq_u8_u32(vzip1q_u32(t1, t3)), vreinterpretq_u8_u32(vzip2q_u32(t1, t3))};
+
+      for (int block = 0; block < 4; block++)
+      {
+        const u8* lines = src + block * 8 + 4;
+        u32* block_dst = Row(dst, width, x + (block & 1) * 4, y + (block >> 1) * 4);
+        for (int row = 0; row < 4; row++)
+        {
+          const uint32x4_t indices =
+              vandq_u32(vshlq_u32(vdupq_n_u32(lines[row]), selector_shifts), vdupq_n_u32(3));
+          vst1q_u8(reinterpret_cast<u8*>(block_dst + row * width),
+                   vqtbl1q_u8(palettes[block], ToByteIndices(indices)));
+        }
+      }
+    }
+  }
+}
+
+template <TLUTFormat tlutfmt>
+bool DecodePaletted(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
+                    const u8* tlut)
+{
+  switch (texformat)
+  {
+  case TextureFormat::C4:
+    Decode4Bit<TextureFormat::C4, tlutfmt>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::C8:
+    Decode8Bit<TextureFormat::C8, tlutfmt>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::C14X2:
+    Decode16Bit<TextureFormat::C14X2, tlutfmt>(dst, src, width, height, tlut);
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool DecodeNEON(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
+                const u8* tlut, TLUTFormat tlutfmt)
+{
+  constexpr TLUTFormat NO_TLUT = TLUTFormat::IA8;
+  switch (texformat)
+  {
+  case TextureFormat::I4:
+    Decode4Bit<TextureFormat::I4, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::I8:
+    Decode8Bit<TextureFormat::I8, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::IA4:
+    Decode8Bit<TextureFormat::IA4, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::IA8:
+    Decode16Bit<TextureFormat::IA8, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::RGB565:
+    Decode16Bit<TextureFormat::RGB565, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::RGB5A3:
+    Decode16Bit<TextureFormat::RGB5A3, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::RGBA8:
+    DecodeRGBA8(dst, src, width, height);
+    return true;
+  case TextureFormat::CMPR:
+    DecodeCMPR(dst, src, width, height);
+    return true;
+  case TextureFormat::XFB:
+    TexDecoder_DecodeXFB(dst, src, width, height);
+    return true;
+  case TextureFormat::C4:
+  case TextureFormat::C8:
+  case TextureFormat::C14X2:
+    switch (tlutfmt)
+    {
+    case TLUTFormat::IA8:
+      return DecodePaletted<TLUTFormat::IA8>(dst, src, width, height, texformat, tlut);
+    case TLUTFormat::RGB565:
+      return DecodePaletted<TLUTFormat::RGB565>(dst, src, width, height, texformat, tlut);
+    case TLUTFormat::RGB5A3:
+      return DecodePaletted<TLUTFormat::RGB5A3>(dst, src, width, height, texformat, tlut);
+    default:
+      return false;
+    }
+  default:
+    return false;
+  }
+}
+}  // namespace
+
+void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
+                            const u8* tlut, TLUTFormat tlutfmt)
+{
+  if (!DecodeNEON(dst, src, width, height, texformat, tlut, tlutfmt))
+    _TexDecoder_DecodeImpl_Generic(dst, src, width, height, texformat, tlut, tlutfmt);
+}
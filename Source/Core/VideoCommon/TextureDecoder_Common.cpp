@@ -5,11 +5,13 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
+#include "Common/WorkerPool.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -357,9 +359,10 @@ static void TexDecoder_DrawOverlay(u8* dst, int width, int height, TextureFormat
       xcnt++;
     }
 
-    for (int y = 0; y < 10; y++)
+    // Clip the text to the texture, small mipmap levels are packed right after each other.
+    for (int y = 0; y < h; y++)
     {
-      for (int x = 0; x < xcnt; x++)
+      for (int x = 0; x < xcnt && x + xoff < width; x++)
       {
         int* dtp = (int*)dst;
         dtp[(y + yoff) * width + x + xoff] = ptr[x] ? 0xFFFFFFFF : 0xFF000000;
@@ -380,6 +383,102 @@ void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFor
     TexDecoder_DrawOverlay(dst, width, height, texformat);
 }
 
+void TexDecoder_DecodeXFB(u32* dst, const u8* src, int width, int height)
+{
+  for (int y = 0; y < height; y += 1)
+  {
+    for (int x = 0; x < width; x += 2)
+    {
+      size_t offset = static_cast<size_t>((y * width + x) * 2);
+
+      // We do this one color sample (aka 2 RGB pixles) at a time
+      int Y1 = int(src[offset]) - 16;
+      int U = int(src[offset + 1]) - 128;
+      int Y2 = int(src[offset + 2]) - 16;
+      int V = int(src[offset + 3]) - 128;
+
+      // We do the inverse BT.601 conversion for YCbCr to RGB
+      // http://www.equasys.de/colorconversion.html#YCbCr-RGBColorFormatConversion
+      u8 R1 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y1 + 1.596f * V), 0, 255));
+      u8 G1 =
+          static_cast<u8>(MathUtil::Clamp(int(1.164f * Y1 - 0.392f * U - 0.813f * V), 0, 255));
+      u8 B1 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y1 + 2.017f * U), 0, 255));
+
+      u8 R2 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y2 + 1.596f * V), 0, 255));
+      u8 G2 =
+          static_cast<u8>(MathUtil::Clamp(int(1.164f * Y2 - 0.392f * U - 0.813f * V), 0, 255));
+      u8 B2 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y2 + 2.017f * U), 0, 255));
+
+      dst[y * width + x] = 0xff000000 | B1 << 16 | G1 << 8 | R1;
+      dst[y * width + x + 1] = 0xff000000 | B2 << 16 | G2 << 8 | R2;
+    }
+  }
+}
+
+// Textures are only split up when every band decodes to at least this many bytes, which keeps
+// the hand-off to the workers cheap compared to the decoding itself.
+constexpr size_t MIN_PARALLEL_DECODE_BYTES = 64 * 1024;
+
+void TexDecoder_DecodeLevels(Common::WorkerPool* pool, const TexDecoderLevel* levels,
+                             size_t num_levels, TextureFormat texformat, const u8* tlut,
+                             TLUTFormat tlutfmt)
+{
+  struct Band
+  {
+    const TexDecoderLevel* level;
+    int first_row;
+    int num_rows;
+  };
+
+  const int block_width = TexDecoder_GetBlockWidthInTexels(texformat);
+  const int block_height = TexDecoder_GetBlockHeightInTexels(texformat);
+  const int bytes_per_block =
+      block_width * block_height * TexDecoder_GetTexelSizeInNibbles(texformat) / 2;
+
+  size_t total_size = 0;
+  for (size_t i = 0; i < num_levels; i++)
+    total_size += static_cast<size_t>(levels[i].width) * levels[i].height * sizeof(u32);
+
+  if (pool->GetThreadCount() == 0 || total_size < MIN_PARALLEL_DECODE_BYTES * 2)
+  {
+    for (size_t i = 0; i < num_levels; i++)
+    {
+      TexDecoder_Decode(levels[i].dst, levels[i].src, levels[i].width, levels[i].height,
+                        texformat, tlut, tlutfmt);
+    }
+    return;
+  }
+
+  // Bands are whole rows of blocks, which are contiguous in both the source and the decoded data.
+  std::vector<Band> bands;
+  for (size_t i = 0; i < num_levels; i++)
+  {
+    const TexDecoderLevel& level = levels[i];
+    const int num_rows = level.height / block_height;
+    const size_t row_size = static_cast<size_t>(level.width) * block_height * sizeof(u32);
+    const int rows_per_band = std::max(static_cast<int>(MIN_PARALLEL_DECODE_BYTES / row_size), 1);
+    for (int row = 0; row < num_rows; row += rows_per_band)
+      bands.push_back({&level, row, std::min(rows_per_band, num_rows - row)});
+  }
+
+  pool->ParallelFor(static_cast<u32>(bands.size()), [&](u32 index) {
+    const Band& band = bands[index];
+    const TexDecoderLevel& level = *band.level;
+    const size_t src_offset =
+        static_cast<size_t>(band.first_row) * (level.width / block_width) * bytes_per_block;
+    const size_t dst_offset =
+        static_cast<size_t>(band.first_row) * block_height * level.width * sizeof(u32);
+    _TexDecoder_DecodeImpl(reinterpret_cast<u32*>(level.dst + dst_offset), level.src + src_offset,
+                           level.width, band.num_rows * block_height, texformat, tlut, tlutfmt);
+  });
+
+  if (TexFmt_Overlay_Enable)
+  {
+    for (size_t i = 0; i < num_levels; i++)
+      TexDecoder_DrawOverlay(levels[i].dst, levels[i].width, levels[i].height, texformat);
+  }
+}
+
 static inline u32 DecodePixel_IA8(u16 val)
 {
   int a = val & 0xFF;
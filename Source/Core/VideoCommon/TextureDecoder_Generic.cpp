@@ -195,8 +195,8 @@ static void DecodeDXTBlock(u32* dst, const DXTBlock* src, int pitch)
 // TODO: complete SSE2 optimization of less often used texture formats.
 // TODO: refactor algorithms using _mm_loadl_epi64 unaligned loads to prefer 128-bit aligned loads.
 
-void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
-                            const u8* tlut, TLUTFormat tlutfmt)
+void _TexDecoder_DecodeImpl_Generic(u32* dst, const u8* src, int width, int height,
+                                    TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt)
 {
   const int Wsteps4 = (width + 3) / 4;
   const int Wsteps8 = (width + 7) / 8;
@@ -346,5 +346,18 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
       }
       break;
     }
+  case TextureFormat::XFB:
+    TexDecoder_DecodeXFB(dst, src, width, height);
+    break;
+  default:
+    break;
   }
 }
+
+#if !defined(_M_X86) && !defined(_M_ARM_64)
+void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
+                            const u8* tlut, TLUTFormat tlutfmt)
+{
+  _TexDecoder_DecodeImpl_Generic(dst, src, width, height, texformat, tlut, tlutfmt);
+}
+#endif
@@ -23,3 +23,6 @@ constexpr int DXTBlend(int v1, int v2)
   // 3/8 blend, which is close to 1/3
   return ((v1 * 3 + v2 * 5) >> 3);
 }
+
+// Decodes YUYV, which is the same for every host.
+void TexDecoder_DecodeXFB(u32* dst, const u8* src, int width, int height);
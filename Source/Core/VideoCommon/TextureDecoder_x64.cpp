@@ -1410,9 +1410,464 @@ static void TexDecoder_DecodeImpl_CMPR(u32* dst, const u8* src, int width, int h
   }
 }
 
+// AVX2 decoders. Every texture format is handled eight texels at a time: 8-texel wide tiles are
+// decoded a row at a time, 4-texel wide tiles two rows at a time. Palette lookups gather the
+// TLUT entries and decode them in registers.
+
+// Expands 4, 5 and 6 bit channels to 8 bits, like the Convert*To8 functions.
+FUNCTION_TARGET_AVX2
+static inline __m256i Expand4To8_AVX2(__m256i v)
+{
+  return _mm256_or_si256(_mm256_slli_epi32(v, 4), v);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Expand5To8_AVX2(__m256i v)
+{
+  return _mm256_or_si256(_mm256_slli_epi32(v, 3), _mm256_srli_epi32(v, 2));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Expand6To8_AVX2(__m256i v)
+{
+  return _mm256_or_si256(_mm256_slli_epi32(v, 2), _mm256_srli_epi32(v, 4));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i PackRGBA_AVX2(__m256i r, __m256i g, __m256i b, __m256i a)
+{
+  return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                         _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+}
+
+// The 16-bit decoders take the texels as loaded from memory, i.e. byteswapped, in the low half
+// of each lane. The upper half is ignored.
+FUNCTION_TARGET_AVX2
+static inline __m256i ByteSwap16_AVX2(__m256i v)
+{
+  const __m256i mask = _mm256_set1_epi32(0xFF);
+  return _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(v, 8), mask),
+                         _mm256_slli_epi32(_mm256_and_si256(v, mask), 8));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeIA8_AVX2(__m256i v)
+{
+  // The first byte is alpha, the second one intensity.
+  const __m256i mask = _mm256_set1_epi32(0xFF);
+  const __m256i a = _mm256_slli_epi32(v, 24);
+  const __m256i i = _mm256_and_si256(_mm256_srli_epi32(v, 8), mask);
+  return _mm256_or_si256(a, _mm256_mullo_epi32(i, _mm256_set1_epi32(0x010101)));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB565_AVX2(__m256i v)
+{
+  const __m256i val = ByteSwap16_AVX2(v);
+  const __m256i r = Expand5To8_AVX2(_mm256_srli_epi32(val, 11));
+  const __m256i g =
+      Expand6To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 5), _mm256_set1_epi32(0x3F)));
+  const __m256i b = Expand5To8_AVX2(_mm256_and_si256(val, _mm256_set1_epi32(0x1F)));
+  return PackRGBA_AVX2(r, g, b, _mm256_set1_epi32(0xFF));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB5A3_AVX2(__m256i v)
+{
+  const __m256i val = ByteSwap16_AVX2(v);
+  const __m256i mask5 = _mm256_set1_epi32(0x1F);
+  const __m256i mask4 = _mm256_set1_epi32(0xF);
+
+  // Top bit set: RGB555.
+  const __m256i rgb555 =
+      PackRGBA_AVX2(Expand5To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 10), mask5)),
+                    Expand5To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 5), mask5)),
+                    Expand5To8_AVX2(_mm256_and_si256(val, mask5)), _mm256_set1_epi32(0xFF));
+
+  // Top bit clear: RGB4A3.
+  const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(val, 12), _mm256_set1_epi32(0x7));
+  const __m256i a = _mm256_or_si256(
+      _mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_slli_epi32(a3, 2)),
+      _mm256_srli_epi32(a3, 1));
+  const __m256i rgb4a3 =
+      PackRGBA_AVX2(Expand4To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 8), mask4)),
+                    Expand4To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(val, 4), mask4)),
+                    Expand4To8_AVX2(_mm256_and_si256(val, mask4)), a);
+
+  const __m256i top_bit = _mm256_set1_epi32(0x8000);
+  const __m256i is_rgb555 = _mm256_cmpeq_epi32(_mm256_and_si256(val, top_bit), top_bit);
+  return _mm256_blendv_epi8(rgb4a3, rgb555, is_rgb555);
+}
+
+template <TLUTFormat tlutfmt>
+FUNCTION_TARGET_AVX2 static inline __m256i LookUpTLUT_AVX2(const u8* tlut, __m256i indices)
+{
+  // Gathering 32 bits reads two bytes past each entry, which the decoders ignore.
+  const __m256i entries = _mm256_i32gather_epi32(reinterpret_cast<const int*>(tlut), indices, 2);
+  switch (tlutfmt)
+  {
+  case TLUTFormat::IA8:
+    return DecodeIA8_AVX2(entries);
+  case TLUTFormat::RGB565:
+    return DecodeRGB565_AVX2(entries);
+  case TLUTFormat::RGB5A3:
+  default:
+    return DecodeRGB5A3_AVX2(entries);
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static inline void StoreTwoRows_AVX2(u32* dst, int width, __m256i texels)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(texels));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + width), _mm256_extracti128_si256(texels, 1));
+}
+
+// Spreads the nibbles of four bytes to eight lanes, high nibble first.
+FUNCTION_TARGET_AVX2
+static inline __m256i UnpackNibbles_AVX2(const u8* src)
+{
+  u32 bytes;
+  std::memcpy(&bytes, src, sizeof(bytes));
+  const __m128i doubled = _mm_shuffle_epi8(_mm_cvtsi32_si128(bytes),
+                                           _mm_setr_epi8(0, 0, 1, 1, 2, 2, 3, 3, -1, -1, -1, -1,
+                                                         -1, -1, -1, -1));
+  const __m256i shifted =
+      _mm256_srlv_epi32(_mm256_cvtepu8_epi32(doubled), _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0));
+  return _mm256_and_si256(shifted, _mm256_set1_epi32(0xF));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i UnpackBytes_AVX2(const u8* src)
+{
+  return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i UnpackShorts_AVX2(const u8* src)
+{
+  return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+}
+
+// Repeats each of the low eight bytes four times.
+FUNCTION_TARGET_AVX2
+static inline __m256i SplatBytes_AVX2(__m128i bytes)
+{
+  return _mm256_shuffle_epi8(_mm256_broadcastq_epi64(bytes),
+                             _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,  //
+                                              4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7));
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeI4_AVX2(const u8* src)
+{
+  u32 bytes;
+  std::memcpy(&bytes, src, sizeof(bytes));
+  const __m128i packed = _mm_cvtsi32_si128(bytes);
+  const __m128i mask = _mm_set1_epi8(0xF);
+  const __m128i nibbles = _mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(packed, 4), mask),
+                                            _mm_and_si128(packed, mask));
+  return SplatBytes_AVX2(_mm_or_si128(_mm_slli_epi16(nibbles, 4), nibbles));
+}
+
+// 8x8 tiles of 4-bit texels.
+template <TextureFormat format, TLUTFormat tlutfmt>
+FUNCTION_TARGET_AVX2 static void TexDecoder_DecodeImpl_4Bit_AVX2(u32* dst, const u8* src,
+                                                                 int width, int height,
+                                                                 const u8* tlut)
+{
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      for (int iy = 0; iy < 8; iy++, src += 4)
+      {
+        __m256i texels;
+        if (format == TextureFormat::C4)
+          texels = LookUpTLUT_AVX2<tlutfmt>(tlut, UnpackNibbles_AVX2(src));
+        else  // I4
+          texels = DecodeI4_AVX2(src);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (y + iy) * width + x), texels);
+      }
+    }
+  }
+}
+
+// 8x4 tiles of 8-bit texels.
+template <TextureFormat format, TLUTFormat tlutfmt>
+FUNCTION_TARGET_AVX2 static void TexDecoder_DecodeImpl_8Bit_AVX2(u32* dst, const u8* src,
+                                                                 int width, int height,
+                                                                 const u8* tlut)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 8)
+    {
+      for (int iy = 0; iy < 4; iy++, src += 8)
+      {
+        __m256i texels;
+        if (format == TextureFormat::C8)
+        {
+          texels = LookUpTLUT_AVX2<tlutfmt>(tlut, UnpackBytes_AVX2(src));
+        }
+        else if (format == TextureFormat::IA4)
+        {
+          const __m256i bytes = UnpackBytes_AVX2(src);
+          const __m256i a = _mm256_srli_epi32(bytes, 4);
+          const __m256i l = _mm256_and_si256(bytes, _mm256_set1_epi32(0xF));
+          texels = _mm256_or_si256(_mm256_mullo_epi32(a, _mm256_set1_epi32(0x11000000)),
+                                   _mm256_mullo_epi32(l, _mm256_set1_epi32(0x111111)));
+        }
+        else  // I8
+        {
+          texels = SplatBytes_AVX2(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (y + iy) * width + x), texels);
+      }
+    }
+  }
+}
+
+// 4x4 tiles of 16-bit texels, decoded two rows at a time.
+template <TextureFormat format, TLUTFormat tlutfmt>
+FUNCTION_TARGET_AVX2 static void TexDecoder_DecodeImpl_16Bit_AVX2(u32* dst, const u8* src,
+                                                                  int width, int height,
+                                                                  const u8* tlut)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4)
+    {
+      for (int iy = 0; iy < 4; iy += 2, src += 16)
+      {
+        const __m256i shorts = UnpackShorts_AVX2(src);
+        __m256i texels;
+        if (format == TextureFormat::C14X2)
+        {
+          const __m256i indices =
+              _mm256_and_si256(ByteSwap16_AVX2(shorts), _mm256_set1_epi32(0x3FFF));
+          texels = LookUpTLUT_AVX2<tlutfmt>(tlut, indices);
+        }
+        else if (format == TextureFormat::IA8)
+        {
+          texels = DecodeIA8_AVX2(shorts);
+        }
+        else if (format == TextureFormat::RGB565)
+        {
+          texels = DecodeRGB565_AVX2(shorts);
+        }
+        else  // RGB5A3
+        {
+          texels = DecodeRGB5A3_AVX2(shorts);
+        }
+        StoreTwoRows_AVX2(dst + (y + iy) * width + x, width, texels);
+      }
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGBA8_AVX2(u32* dst, const u8* src, int width, int height)
+{
+  // Each 4x4 tile holds 16 AR pairs followed by 16 GB pairs.
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0; x < width; x += 4, src += 64)
+    {
+      for (int iy = 0; iy < 4; iy += 2)
+      {
+        const __m256i ar = UnpackShorts_AVX2(src + iy * 8);
+        const __m256i gb = UnpackShorts_AVX2(src + 32 + iy * 8);
+        const __m256i texels =
+            _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(ar, 24), _mm256_srli_epi32(ar, 8)),
+                            _mm256_slli_epi32(gb, 8));
+        StoreTwoRows_AVX2(dst + (y + iy) * width + x, width, texels);
+      }
+    }
+  }
+}
+
+// (v1 * 3 + v2 * 5) / 8, like DXTBlend.
+FUNCTION_TARGET_AVX2
+static inline __m256i DXTBlend_AVX2(__m256i v1, __m256i v2)
+{
+  return _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(v1, 1), v1),
+                                            _mm256_add_epi32(_mm256_slli_epi32(v2, 2), v2)),
+                           3);
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i Average_AVX2(__m256i v1, __m256i v2)
+{
+  return _mm256_srli_epi32(_mm256_add_epi32(v1, v2), 1);
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_CMPR_AVX2(u32* dst, const u8* src, int width, int height)
+{
+  // Each 8x8 tile holds four DXT blocks: top left, top right, bottom left, bottom right.
+  // 128-bit lane n of a tile holds blocks 2n and 2n + 1.
+  const __m256i gather_colors = _mm256_setr_epi8(
+      1, 0, -1, -1, 9, 8, -1, -1, 3, 2, -1, -1, 11, 10, -1, -1,  //
+      1, 0, -1, -1, 9, 8, -1, -1, 3, 2, -1, -1, 11, 10, -1, -1);
+  const __m256i alpha = _mm256_set1_epi32(0xFF);
+  const __m256i row_offsets = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+  const __m256i mask2 = _mm256_set1_epi32(3);
+
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0; x < width; x += 8, src += 32)
+    {
+      const __m256i tile = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+
+      // Lanes 0-3 hold color 1 of blocks 0-3, lanes 4-7 color 2.
+      const __m256i colors = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(tile, gather_colors),
+                                                      _MM_SHUFFLE(3, 1, 2, 0));
+      const __m256i swapped = _mm256_permute2x128_si256(colors, colors, 0x01);
+
+      const __m256i r = Expand5To8_AVX2(_mm256_srli_epi32(colors, 11));
+      const __m256i g =
+          Expand6To8_AVX2(_mm256_and_si256(_mm256_srli_epi32(colors, 5), _mm256_set1_epi32(0x3F)));
+      const __m256i b = Expand5To8_AVX2(_mm256_and_si256(colors, _mm256_set1_epi32(0x1F)));
+      const __m256i r_swapped = _mm256_permute2x128_si256(r, r, 0x01);
+      const __m256i g_swapped = _mm256_permute2x128_si256(g, g, 0x01);
+      const __m256i b_swapped = _mm256_permute2x128_si256(b, b, 0x01);
+
+      // colors01 holds colors 0 and 1 of each block, colors23 colors 2 and 3.
+      const __m256i colors01 = PackRGBA_AVX2(r, g, b, alpha);
+      const __m256i blended =
+          PackRGBA_AVX2(DXTBlend_AVX2(r_swapped, r), DXTBlend_AVX2(g_swapped, g),
+                        DXTBlend_AVX2(b_swapped, b), alpha);
+      // Color 3 is transparent when it's the average.
+      const __m256i averaged =
+          PackRGBA_AVX2(Average_AVX2(r, r_swapped), Average_AVX2(g, g_swapped),
+                        Average_AVX2(b, b_swapped),
+                        _mm256_setr_epi32(0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0));
+      const __m256i c1_greater = _mm256_cmpgt_epi32(colors, swapped);
+      const __m256i use_blend = _mm256_permute2x128_si256(c1_greater, c1_greater, 0x00);
+      const __m256i colors23 = _mm256_blendv_epi8(averaged, blended, use_blend);
+
+      for (int half = 0; half < 2; half++)
+      {
+        // The palettes of the left and right block, and their selectors.
+        const int left = half * 2;
+        const __m256i palette = _mm256_blend_epi32(
+            _mm256_permutevar8x32_epi32(colors01,
+                                        _mm256_setr_epi32(left, left + 4, 0, 0, left + 1,
+                                                          left + 5, 0, 0)),
+            _mm256_permutevar8x32_epi32(colors23,
+                                        _mm256_setr_epi32(0, 0, left, left + 4, 0, 0, left + 1,
+                                                          left + 5)),
+            0xCC);
+        const __m256i selectors = _mm256_permutevar8x32_epi32(
+            tile, _mm256_setr_epi32(left * 2 + 1, left * 2 + 1, left * 2 + 1, left * 2 + 1,
+                                    left * 2 + 3, left * 2 + 3, left * 2 + 3, left * 2 + 3));
+
+        for (int row = 0; row < 4; row++)
+        {
+          const int shift = row * 8;
+          const __m256i indices = _mm256_add_epi32(
+              _mm256_and_si256(
+                  _mm256_srlv_epi32(selectors,
+                                    _mm256_setr_epi32(shift + 6, shift + 4, shift + 2, shift,
+                                                      shift + 6, shift + 4, shift + 2, shift)),
+                  mask2),
+              row_offsets);
+          _mm256_storeu_si256(
+              reinterpret_cast<__m256i*>(dst + (y + half * 4 + row) * width + x),
+              _mm256_permutevar8x32_epi32(palette, indices));
+        }
+      }
+    }
+  }
+}
+
+template <TLUTFormat tlutfmt>
+FUNCTION_TARGET_AVX2 static bool TexDecoder_DecodeImpl_Paletted_AVX2(u32* dst, const u8* src,
+                                                                     int width, int height,
+                                                                     TextureFormat texformat,
+                                                                     const u8* tlut)
+{
+  switch (texformat)
+  {
+  case TextureFormat::C4:
+    TexDecoder_DecodeImpl_4Bit_AVX2<TextureFormat::C4, tlutfmt>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::C8:
+    TexDecoder_DecodeImpl_8Bit_AVX2<TextureFormat::C8, tlutfmt>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::C14X2:
+    TexDecoder_DecodeImpl_16Bit_AVX2<TextureFormat::C14X2, tlutfmt>(dst, src, width, height, tlut);
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Returns false if the format needs to be decoded by the other decoders.
+static bool TexDecoder_DecodeImpl_AVX2(u32* dst, const u8* src, int width, int height,
+                                       TextureFormat texformat, const u8* tlut, TLUTFormat tlutfmt)
+{
+  constexpr TLUTFormat NO_TLUT = TLUTFormat::IA8;
+  switch (texformat)
+  {
+  case TextureFormat::I4:
+    TexDecoder_DecodeImpl_4Bit_AVX2<TextureFormat::I4, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::I8:
+    TexDecoder_DecodeImpl_8Bit_AVX2<TextureFormat::I8, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::IA4:
+    TexDecoder_DecodeImpl_8Bit_AVX2<TextureFormat::IA4, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::IA8:
+    TexDecoder_DecodeImpl_16Bit_AVX2<TextureFormat::IA8, NO_TLUT>(dst, src, width, height, tlut);
+    return true;
+  case TextureFormat::RGB565:
+    TexDecoder_DecodeImpl_16Bit_AVX2<TextureFormat::RGB565, NO_TLUT>(dst, src, width, height,
+                                                                     tlut);
+    return true;
+  case TextureFormat::RGB5A3:
+    TexDecoder_DecodeImpl_16Bit_AVX2<TextureFormat::RGB5A3, NO_TLUT>(dst, src, width, height,
+                                                                     tlut);
+    return true;
+  case TextureFormat::RGBA8:
+    TexDecoder_DecodeImpl_RGBA8_AVX2(dst, src, width, height);
+    return true;
+  case TextureFormat::CMPR:
+    TexDecoder_DecodeImpl_CMPR_AVX2(dst, src, width, height);
+    return true;
+  case TextureFormat::C4:
+  case TextureFormat::C8:
+  case TextureFormat::C14X2:
+    switch (tlutfmt)
+    {
+    case TLUTFormat::IA8:
+      return TexDecoder_DecodeImpl_Paletted_AVX2<TLUTFormat::IA8>(dst, src, width, height,
+                                                                  texformat, tlut);
+    case TLUTFormat::RGB565:
+      return TexDecoder_DecodeImpl_Paletted_AVX2<TLUTFormat::RGB565>(dst, src, width, height,
+                                                                     texformat, tlut);
+    case TLUTFormat::RGB5A3:
+      return TexDecoder_DecodeImpl_Paletted_AVX2<TLUTFormat::RGB5A3>(dst, src, width, height,
+                                                                     texformat, tlut);
+    default:
+      return false;
+    }
+  default:
+    return false;
+  }
+}
+
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
                             const u8* tlut, TLUTFormat tlutfmt)
 {
+  if (cpu_info.bAVX2 &&
+      TexDecoder_DecodeImpl_AVX2(dst, src, width, height, texformat, tlut, tlutfmt))
+  {
+    return;
+  }
+
   int Wsteps4 = (width + 3) / 4;
   int Wsteps8 = (width + 7) / 8;
 
@@ -1488,37 +1943,8 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::XFB:
-  {
-    for (int y = 0; y < height; y += 1)
-    {
-      for (int x = 0; x < width; x += 2)
-      {
-        size_t offset = static_cast<size_t>((y * width + x) * 2);
-
-        // We do this one color sample (aka 2 RGB pixles) at a time
-        int Y1 = int(src[offset]) - 16;
-        int U = int(src[offset + 1]) - 128;
-        int Y2 = int(src[offset + 2]) - 16;
-        int V = int(src[offset + 3]) - 128;
-
-        // We do the inverse BT.601 conversion for YCbCr to RGB
-        // http://www.equasys.de/colorconversion.html#YCbCr-RGBColorFormatConversion
-        u8 R1 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y1 + 1.596f * V), 0, 255));
-        u8 G1 =
-            static_cast<u8>(MathUtil::Clamp(int(1.164f * Y1 - 0.392f * U - 0.813f * V), 0, 255));
-        u8 B1 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y1 + 2.017f * U), 0, 255));
-
-        u8 R2 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y2 + 1.596f * V), 0, 255));
-        u8 G2 =
-            static_cast<u8>(MathUtil::Clamp(int(1.164f * Y2 - 0.392f * U - 0.813f * V), 0, 255));
-        u8 B2 = static_cast<u8>(MathUtil::Clamp(int(1.164f * Y2 + 2.017f * U), 0, 255));
-
-        dst[y * width + x] = 0xff000000 | B1 << 16 | G1 << 8 | R1;
-        dst[y * width + x + 1] = 0xff000000 | B2 << 16 | G2 << 8 | R2;
-      }
-    }
-  }
-  break;
+    TexDecoder_DecodeXFB(dst, src, width, height);
+    break;
 
   default:
     PanicAlert("Invalid Texture Format (0x%X)! (_TexDecoder_DecodeImpl)",
@@ -0,0 +1,341 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/TextureDiskCache.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+
+#include "Common/Align.h"
+#include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
+
+namespace VideoCommon
+{
+namespace
+{
+constexpr u32 FILE_MAGIC = 0x43545844;    // "DXTC"
+constexpr u32 RECORD_MAGIC = 0x44434552;  // "RECD"
+constexpr u32 FILE_VERSION = 1;
+
+// Records are padded so that the data stays 16-byte aligned in the mapping.
+constexpr u64 RECORD_ALIGNMENT = 16;
+
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 session;
+  u32 padding;
+};
+
+struct RecordHeader
+{
+  TextureDiskCache::Key key;
+  u64 size;
+  u32 last_session;
+  u32 magic;
+};
+
+static_assert(sizeof(FileHeader) % RECORD_ALIGNMENT == 0, "Header breaks the data alignment");
+static_assert(sizeof(RecordHeader) % RECORD_ALIGNMENT == 0, "Header breaks the data alignment");
+
+u64 GetRecordSize(u64 data_size)
+{
+  return sizeof(RecordHeader) + Common::AlignUp(data_size, RECORD_ALIGNMENT);
+}
+
+bool WriteRecordToFile(File::IOFile& file, const TextureDiskCache::Key& key, u32 last_session,
+                       const u8* data, u64 size)
+{
+  static constexpr u8 zeros[RECORD_ALIGNMENT] = {};
+  const RecordHeader header = {key, size, last_session, RECORD_MAGIC};
+  return file.WriteArray(&header, 1) && file.WriteBytes(data, size) &&
+         file.WriteBytes(zeros, Common::AlignUp(size, RECORD_ALIGNMENT) - size);
+}
+}  // namespace
+
+bool TextureDiskCache::Key::operator==(const Key& other) const
+{
+  return std::memcmp(this, &other, sizeof(Key)) == 0;
+}
+
+size_t TextureDiskCache::KeyHash::operator()(const Key& key) const
+{
+  return static_cast<size_t>(key.full_hash ^ (key.base_hash << 1) ^
+                             (static_cast<u64>(key.format) << 32) ^
+                             (static_cast<u64>(key.width) << 16) ^ key.height ^ key.levels);
+}
+
+TextureDiskCache::~TextureDiskCache()
+{
+  Close();
+}
+
+bool TextureDiskCache::Open(const std::string& filename, u64 size_limit)
+{
+  Close();
+  m_filename = filename;
+  m_size_limit = size_limit;
+
+  if (!LoadIndex())
+  {
+    m_mapping.Close();
+    m_index.clear();
+    m_records_size = 0;
+
+    File::CreateFullPath(filename);
+    File::IOFile file(filename, "wb");
+    const FileHeader header = {FILE_MAGIC, FILE_VERSION, 0, 0};
+    if (!file.WriteArray(&header, 1))
+    {
+      ERROR_LOG(VIDEO, "Failed to create texture disk cache %s", filename.c_str());
+      return false;
+    }
+    m_session = 1;
+    m_end = sizeof(FileHeader);
+  }
+
+  if (m_records_size > m_size_limit)
+    Trim();
+
+  if (!m_file.Open(filename, "r+b"))
+  {
+    m_mapping.Close();
+    m_index.clear();
+    return false;
+  }
+
+  // Drop what's left of a record that was cut off by a crash. The mapping has to go first, as
+  // mapped files can't be truncated everywhere.
+  if (m_file.GetSize() > m_end)
+  {
+    m_mapping.Close();
+    m_file.Resize(m_end);
+  }
+
+  m_file.Seek(offsetof(FileHeader, session), SEEK_SET);
+  m_file.WriteArray(&m_session, 1);
+  m_file.Seek(m_end, SEEK_SET);
+  m_write_failed = false;
+
+  INFO_LOG(VIDEO, "Opened texture disk cache %s with %zu entries, %" PRIu64 " bytes",
+           filename.c_str(), m_index.size(), m_records_size);
+
+  m_writer.Reset([this](PendingWrite write) { WriteRecord(std::move(write)); });
+  return true;
+}
+
+void TextureDiskCache::Close()
+{
+  if (!IsOpen())
+    return;
+
+  m_writer.Shutdown();
+  WriteUsage();
+  m_file.Close();
+
+  if (m_records_size > m_size_limit)
+    Trim();
+
+  m_mapping.Close();
+  m_index.clear();
+  m_records_size = 0;
+}
+
+const u8* TextureDiskCache::Lookup(const Key& key, size_t size)
+{
+  std::lock_guard<std::mutex> guard(m_index_lock);
+  auto iter = m_index.find(key);
+  if (iter == m_index.end() || !iter->second.written || iter->second.size != size)
+    return nullptr;
+
+  Entry& entry = iter->second;
+  if (entry.offset + entry.size > m_mapping.GetSize())
+  {
+    // The record was written after the file was mapped.
+    if (!m_mapping.Open(m_filename) || entry.offset + entry.size > m_mapping.GetSize())
+      return nullptr;
+  }
+
+  entry.last_session = m_session;
+  entry.used = true;
+  return m_mapping.GetData() + entry.offset;
+}
+
+void TextureDiskCache::Store(const Key& key, const u8* data, size_t size)
+{
+  if (!IsOpen())
+    return;
+
+  {
+    std::lock_guard<std::mutex> guard(m_index_lock);
+    if (m_records_size > m_size_limit ||
+        !m_index.emplace(key, Entry{0, size, m_session, false, false}).second)
+    {
+      return;
+    }
+    m_records_size += GetRecordSize(size);
+  }
+
+  m_writer.EmplaceItem(PendingWrite{key, std::vector<u8>(data, data + size)});
+}
+
+u64 TextureDiskCache::GetSize() const
+{
+  std::lock_guard<std::mutex> guard(m_index_lock);
+  return m_records_size;
+}
+
+size_t TextureDiskCache::GetEntryCount() const
+{
+  std::lock_guard<std::mutex> guard(m_index_lock);
+  return m_index.size();
+}
+
+bool TextureDiskCache::LoadIndex()
+{
+  if (!m_mapping.Open(m_filename) || m_mapping.GetSize() < sizeof(FileHeader))
+    return false;
+
+  const u8* data = m_mapping.GetData();
+  const u64 file_size = m_mapping.GetSize();
+  FileHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != FILE_MAGIC || header.version != FILE_VERSION)
+  {
+    WARN_LOG(VIDEO, "Discarding texture disk cache %s from another version", m_filename.c_str());
+    return false;
+  }
+
+  m_session = header.session + 1;
+  m_index.clear();
+  m_records_size = 0;
+
+  u64 offset = sizeof(FileHeader);
+  while (file_size - offset >= sizeof(RecordHeader))
+  {
+    RecordHeader record;
+    std::memcpy(&record, data + offset, sizeof(record));
+    if (record.magic != RECORD_MAGIC || record.size > file_size ||
+        GetRecordSize(record.size) > file_size - offset)
+    {
+      break;
+    }
+
+    const Entry entry = {offset + sizeof(RecordHeader), record.size, record.last_session, true,
+                         false};
+    m_index[record.key] = entry;
+    m_records_size += GetRecordSize(record.size);
+    offset += GetRecordSize(record.size);
+  }
+  m_end = offset;
+  return true;
+}
+
+void TextureDiskCache::WriteRecord(PendingWrite write)
+{
+  const u64 offset = m_end;
+  const bool success =
+      !m_write_failed &&
+      WriteRecordToFile(m_file, write.key, m_session, write.data.data(), write.data.size()) &&
+      m_file.Flush();
+
+  std::lock_guard<std::mutex> guard(m_index_lock);
+  auto iter = m_index.find(write.key);
+  if (!success)
+  {
+    // Anything written after a partial record would be lost, so stop writing altogether.
+    if (!m_write_failed)
+      ERROR_LOG(VIDEO, "Failed to write to texture disk cache %s", m_filename.c_str());
+    m_write_failed = true;
+    m_records_size -= GetRecordSize(write.data.size());
+    m_index.erase(iter);
+    return;
+  }
+
+  iter->second.offset = offset + sizeof(RecordHeader);
+  iter->second.written = true;
+  m_end = offset + GetRecordSize(write.data.size());
+}
+
+void TextureDiskCache::WriteUsage()
+{
+  for (const auto& [key, entry] : m_index)
+  {
+    if (!entry.used)
+      continue;
+
+    m_file.Seek(entry.offset - sizeof(RecordHeader) + offsetof(RecordHeader, last_session),
+                SEEK_SET);
+    m_file.WriteArray(&entry.last_session, 1);
+  }
+}
+
+void TextureDiskCache::Trim()
+{
+  if (!m_mapping.Open(m_filename))
+    return;
+
+  // Keep the most recently used records, preferring ones which were added later.
+  std::vector<std::pair<Key, Entry>> entries;
+  for (const auto& [key, entry] : m_index)
+  {
+    if (entry.written && entry.offset + entry.size <= m_mapping.GetSize())
+      entries.emplace_back(key, entry);
+  }
+  std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+    return std::tie(a.second.last_session, a.second.offset) >
+           std::tie(b.second.last_session, b.second.offset);
+  });
+
+  const u64 target_size = m_size_limit / 4 * 3;
+  u64 kept_size = 0;
+  size_t kept_count = 0;
+  while (kept_count < entries.size() &&
+         kept_size + GetRecordSize(entries[kept_count].second.size) <= target_size)
+  {
+    kept_size += GetRecordSize(entries[kept_count].second.size);
+    kept_count++;
+  }
+  entries.resize(kept_count);
+  std::sort(entries.begin(), entries.end(),
+            [](const auto& a, const auto& b) { return a.second.offset < b.second.offset; });
+
+  const std::string temp_filename = m_filename + ".tmp";
+  File::IOFile file(temp_filename, "wb");
+  const FileHeader header = {FILE_MAGIC, FILE_VERSION, m_session, 0};
+  bool success = file.WriteArray(&header, 1);
+  u64 offset = sizeof(FileHeader);
+  for (auto& [key, entry] : entries)
+  {
+    if (!success)
+      break;
+    success = WriteRecordToFile(file, key, entry.last_session,
+                                m_mapping.GetData() + entry.offset, entry.size);
+    entry.offset = offset + sizeof(RecordHeader);
+    offset += GetRecordSize(entry.size);
+  }
+  file.Close();
+  m_mapping.Close();
+
+  if (!success || !File::Rename(temp_filename, m_filename))
+  {
+    ERROR_LOG(VIDEO, "Failed to trim texture disk cache %s", m_filename.c_str());
+    File::Delete(temp_filename);
+    return;
+  }
+
+  INFO_LOG(VIDEO, "Trimmed texture disk cache %s from %" PRIu64 " to %" PRIu64 " bytes",
+           m_filename.c_str(), m_records_size, kept_size);
+  m_index.clear();
+  for (const auto& [key, entry] : entries)
+    m_index.emplace(key, entry);
+  m_records_size = kept_size;
+  m_end = offset;
+}
+}  // namespace VideoCommon
@@ -0,0 +1,114 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/MappedFile.h"
+#include "Common/WorkQueueThread.h"
+
+namespace VideoCommon
+{
+// Decoded mipmap chains, kept on disk between sessions so that textures which were decoded before
+// can be uploaded straight from the file.
+//
+// The file is a header followed by records, each of which is a record header and the decoded
+// levels. Records are appended on a worker thread, and looked up through a memory mapping of the
+// file. Every record remembers the last session which used it. Once the file grows past its size
+// limit, no more records are added, and Close() drops the least recently used records until the
+// file is back to three quarters of the limit.
+class TextureDiskCache
+{
+public:
+  // Everything the decoded data depends on. The hashes have to cover all of the texture and
+  // palette data for this to identify a texture.
+  struct Key
+  {
+    u64 base_hash;
+    u64 full_hash;
+    // Texture format | TLUT format << 8 | hash function << 16
+    u32 format;
+    u16 width;
+    u16 height;
+    u32 levels;
+    u32 padding;
+
+    bool operator==(const Key& other) const;
+  };
+
+  TextureDiskCache() = default;
+  ~TextureDiskCache();
+
+  TextureDiskCache(const TextureDiskCache&) = delete;
+  TextureDiskCache& operator=(const TextureDiskCache&) = delete;
+
+  // Opens the cache file, or creates it if it is missing or unreadable.
+  bool Open(const std::string& filename, u64 size_limit);
+  // Finishes pending writes, records which entries were used, and trims the file to its limit.
+  void Close();
+  bool IsOpen() const { return m_file.IsOpen(); }
+
+  // Returns the data stored for key, or nullptr if there is no entry of the given size. The
+  // pointer stays valid until the next call to Lookup() or Close().
+  const u8* Lookup(const Key& key, size_t size);
+  // Copies the data, which is then appended to the file in the background.
+  void Store(const Key& key, const u8* data, size_t size);
+
+  // Size of all records, including ones which are still being written.
+  u64 GetSize() const;
+  size_t GetEntryCount() const;
+
+private:
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry
+  {
+    // Offset of the data in the file. Only valid once written is set.
+    u64 offset;
+    u64 size;
+    u32 last_session;
+    bool written;
+    bool used;
+  };
+
+  struct PendingWrite
+  {
+    Key key;
+    std::vector<u8> data;
+  };
+
+  bool LoadIndex();
+  void WriteRecord(PendingWrite write);
+  void WriteUsage();
+  void Trim();
+
+  std::string m_filename;
+  u64 m_size_limit = 0;
+  u32 m_session = 0;
+
+  // Only used by the writer thread while the cache is open.
+  File::IOFile m_file;
+  u64 m_end = 0;
+  bool m_write_failed = false;
+
+  File::MappedFile m_mapping;
+
+  // Guards the index against the writer thread.
+  mutable std::mutex m_index_lock;
+  std::unordered_map<Key, Entry, KeyHash> m_index;
+  u64 m_records_size = 0;
+
+  Common::WorkQueueThread<PendingWrite> m_writer;
+};
+}  // namespace VideoCommon
@@ -12,6 +12,7 @@ using namespace Arm64Gen;
 constexpr ARM64Reg src_reg = X0;
 constexpr ARM64Reg dst_reg = X1;
 constexpr ARM64Reg count_reg = W2;
+constexpr ARM64Reg zfreeze_reg = W3;
 constexpr ARM64Reg skipped_reg = W17;
 constexpr ARM64Reg scratch1_reg = W16;
 constexpr ARM64Reg scratch2_reg = W15;
@@ -191,7 +192,7 @@ int VertexLoaderARM64::ReadVertex(u64 attribute, int format, int count_in, int c
   // Z-Freeze
   if (native_format == &m_native_vtx_decl.position)
   {
-    CMP(count_reg, 3);
+    CMP(count_reg, zfreeze_reg);
     FixupBranch dont_store = B(CC_GT);
     MOVP2R(EncodeRegTo64(scratch2_reg), VertexLoaderManager::position_cache);
     ADD(EncodeRegTo64(scratch1_reg), EncodeRegTo64(scratch2_reg), EncodeRegTo64(count_reg),
@@ -358,6 +359,7 @@ void VertexLoaderARM64::GenerateVertexLoader()
   // R0 - Source pointer
   // R1 - Destination pointer
   // R2 - Count
+  // R3 - Number of vertices at the end to store in the zfreeze caches, 3 or 0
   // R30 - LR
   //
   // R0 return how many
@@ -406,7 +408,7 @@ void VertexLoaderARM64::GenerateVertexLoader()
     STR(INDEX_UNSIGNED, scratch1_reg, dst_reg, m_dst_ofs);
 
     // Z-Freeze
-    CMP(count_reg, 3);
+    CMP(count_reg, zfreeze_reg);
     FixupBranch dont_store = B(CC_GT);
     MOVP2R(EncodeRegTo64(scratch2_reg), VertexLoaderManager::position_matrix_index);
     STR(INDEX_UNSIGNED, scratch1_reg, EncodeRegTo64(scratch2_reg), 0);
@@ -611,6 +613,13 @@ void VertexLoaderARM64::GenerateVertexLoader()
 int VertexLoaderARM64::RunVertices(DataReader src, DataReader dst, int count)
 {
   m_numLoadedVertices += count;
-  return ((int (*)(u8 * src, u8 * dst, int count)) region)(src.GetPointer(), dst.GetPointer(),
-                                                           count);
+  return ((int (*)(u8 * src, u8 * dst, int count, int zfreeze)) region)(
+      src.GetPointer(), dst.GetPointer(), count, 3);
+}
+
+int VertexLoaderARM64::RunVerticesWithoutZFreeze(DataReader src, DataReader dst, int count)
+{
+  m_numLoadedVertices += count;
+  return ((int (*)(u8 * src, u8 * dst, int count, int zfreeze)) region)(
+      src.GetPointer(), dst.GetPointer(), count, 0);
 }
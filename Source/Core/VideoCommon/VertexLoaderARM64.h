@@ -18,7 +18,10 @@ public:
 protected:
   std::string GetName() const override { return "VertexLoaderARM64"; }
   bool IsInitialized() override { return true; }
+  // All per-vertex state lives in registers.
+  bool IsThreadSafe() const override { return true; }
   int RunVertices(DataReader src, DataReader dst, int count) override;
+  int RunVerticesWithoutZFreeze(DataReader src, DataReader dst, int count) override;
 
 private:
   u32 m_src_ofs = 0;
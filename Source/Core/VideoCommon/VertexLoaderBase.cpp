@@ -72,6 +72,11 @@ void VertexLoaderBase::SetVAT(const VAT& vat)
   m_VtxAttr.texCoord[7].Frac = vat.g2.Tex7Frac;
 };
 
+int VertexLoaderBase::RunVerticesWithoutZFreeze(DataReader src, DataReader dst, int count)
+{
+  return RunVertices(src, dst, count);
+}
+
 std::string VertexLoaderBase::ToString() const
 {
   std::string dest;
@@ -137,7 +142,7 @@ std::string VertexLoaderBase::ToString() const
                                pos_mode[tex_mode[i]], pos_formats[m_VtxAttr.texCoord[i].Format]);
     }
   }
-  dest += StringFromFormat(" - %i v", m_numLoadedVertices);
+  dest += StringFromFormat(" - %i v", m_numLoadedVertices.load());
   return dest;
 }
 
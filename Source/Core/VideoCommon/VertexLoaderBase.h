@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -67,6 +68,13 @@ public:
 
   virtual bool IsInitialized() = 0;
 
+  // Whether RunVertices() may be called from several threads at once on disjoint ranges. Only
+  // one of them may store the zfreeze caches, the others have to use RunVerticesWithoutZFreeze().
+  virtual bool IsThreadSafe() const { return false; }
+  // Like RunVertices(), but leaves position_cache and position_matrix_index alone. Loaders which
+  // aren't thread safe never convert a batch in pieces, so they needn't implement it.
+  virtual int RunVerticesWithoutZFreeze(DataReader src, DataReader dst, int count);
+
   // For debugging / profiling
   std::string ToString() const;
 
@@ -79,7 +87,7 @@ public:
 
   // used by VertexLoaderManager
   NativeVertexFormat* m_native_vertex_format = nullptr;
-  int m_numLoadedVertices = 0;
+  std::atomic<int> m_numLoadedVertices{0};
 
 protected:
   VertexLoaderBase(const TVtxDesc& vtx_desc, const VAT& vtx_attr);
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -13,17 +15,21 @@
 #include "Common/Assert.h"
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/WorkerPool.h"
 #include "Core/HW/Memmap.h"
 
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
 
 namespace VertexLoaderManager
 {
@@ -44,6 +50,14 @@ static VertexLoaderMap s_vertex_loader_map;
 
 u8* cached_arraybases[12];
 
+// Each job of a parallel conversion should produce at least this many bytes of native vertices,
+// smaller batches are cheaper to convert on the GPU thread than to hand off to the workers.
+constexpr u32 MIN_PARALLEL_JOB_BYTES = 32 * 1024;
+constexpr int MIN_PARALLEL_JOB_VERTICES = 256;
+constexpr u32 MAX_PARALLEL_JOBS = 16;
+
+static Common::WorkerPool s_worker_pool;
+
 void Init()
 {
   MarkAllDirty();
@@ -54,6 +68,11 @@ void Init()
   SETSTAT(stats.numVertexLoaders, 0);
 }
 
+void Shutdown()
+{
+  s_worker_pool.Shutdown();
+}
+
 void Clear()
 {
   std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
@@ -248,6 +267,142 @@ static VertexLoaderBase* RefreshLoader(int vtx_attr_group, bool preprocess = fal
   return loader;
 }
 
+static u32 GetParallelJobCount(const VertexLoaderBase* loader, int count)
+{
+  if (!loader->IsThreadSafe())
+    return 1;
+
+  const u32 stride = loader->m_native_vtx_decl.stride;
+  const int min_job_vertices =
+      std::max(MIN_PARALLEL_JOB_VERTICES, static_cast<int>(MIN_PARALLEL_JOB_BYTES / stride));
+  if (count < min_job_vertices * 2)
+    return 1;
+
+  const u32 num_threads = g_ActiveConfig.GetVertexLoaderThreads();
+  if (s_worker_pool.GetThreadCount() != num_threads)
+    s_worker_pool.Reset(num_threads, "Vertex Loader");
+
+  // The GPU thread converts a share of the vertices itself.
+  return std::min({num_threads + 1, static_cast<u32>(count / min_job_vertices), MAX_PARALLEL_JOBS});
+}
+
+// Converts the batch in num_jobs pieces which are written to disjoint ranges of dst.
+static int ConvertVerticesParallel(VertexLoaderBase* loader, int primitive, int count,
+                                   DataReader src, DataReader dst, u32 num_jobs)
+{
+  const u32 src_stride = loader->m_VertexSize;
+  const u32 dst_stride = loader->m_native_vtx_decl.stride;
+
+  // Keep the jobs aligned to whole primitives so that every job can also write its indices.
+  const u32 granularity = IndexGenerator::GetSplitGranularity(primitive);
+  const u32 alignment = std::max(granularity, 1u);
+  const u32 job_size =
+      (static_cast<u32>(count) + num_jobs - 1) / num_jobs / alignment * alignment + alignment;
+  num_jobs = (static_cast<u32>(count) + job_size - 1) / job_size;
+  // Only the last job stores the zfreeze caches, so it has to convert the last three vertices.
+  if (static_cast<u32>(count) - (num_jobs - 1) * job_size < 3)
+    num_jobs--;
+
+  std::array<int, MAX_PARALLEL_JOBS> loaded_per_job;
+  u8* const src_end = src.GetPointer() + count * src_stride;
+  u8* const dst_end = dst.GetPointer() + dst.size();
+
+  const auto convert = [&](u32 job, bool pad_last_vertex) {
+    const u32 first = job * job_size;
+    const u32 last = job + 1 == num_jobs ? count : first + job_size;
+    const u32 job_count = last - first;
+    u8* const job_src = src.GetPointer() + first * src_stride;
+    u8* const job_dst = dst.GetPointer() + first * dst_stride;
+
+    // The zfreeze caches are shared, so they are left to the job which ends the batch.
+    int loaded;
+    if (pad_last_vertex)
+    {
+      // The loaders may write up to 4 bytes past the last vertex, which is owned by the next job.
+      // Convert the last vertex into a scratch buffer instead.
+      alignas(16) std::array<u8, 256> scratch;
+      DEBUG_ASSERT(dst_stride + 4 <= scratch.size());
+      loaded = loader->RunVerticesWithoutZFreeze(DataReader(job_src, src_end),
+                                                 DataReader(job_dst, dst_end), job_count - 1);
+      if (loader->RunVerticesWithoutZFreeze(
+              DataReader(job_src + (job_count - 1) * src_stride, src_end),
+              DataReader(scratch.data(), scratch.data() + scratch.size()), 1))
+      {
+        std::memcpy(job_dst + loaded * dst_stride, scratch.data(), dst_stride);
+        loaded++;
+      }
+    }
+    else
+    {
+      loaded = loader->RunVertices(DataReader(job_src, src_end), DataReader(job_dst, dst_end),
+                                   job_count);
+    }
+
+    // Skipped vertices shift the following ones, so indices are only valid for complete jobs.
+    if (granularity && loaded == static_cast<int>(job_count))
+      IndexGenerator::AddIndicesAt(primitive, first, job_count);
+
+    loaded_per_job[job] = loaded;
+  };
+
+  s_worker_pool.ParallelFor(num_jobs, [&](u32 job) { convert(job, job + 1 != num_jobs); });
+
+  int total = 0;
+  bool complete = true;
+  for (u32 job = 0; job < num_jobs; job++)
+  {
+    const u32 first = job * job_size;
+    const u32 last = job + 1 == num_jobs ? count : first + job_size;
+    const int loaded = loaded_per_job[job];
+    if (static_cast<int>(first) != total)
+    {
+      std::memmove(dst.GetPointer() + total * dst_stride, dst.GetPointer() + first * dst_stride,
+                   loaded * dst_stride);
+    }
+    complete &= loaded == static_cast<int>(last - first);
+    total += loaded;
+  }
+
+  if (granularity && complete)
+    IndexGenerator::CommitIndices(primitive, total);
+  else
+    IndexGenerator::AddIndices(primitive, total);
+
+  return total;
+}
+
+int ConvertVertices(VertexLoaderBase* loader, int primitive, int count, DataReader src,
+                    DataReader dst)
+{
+  const u32 num_jobs = GetParallelJobCount(loader, count);
+  if (num_jobs > 1)
+    return ConvertVerticesParallel(loader, primitive, count, src, dst, num_jobs);
+
+  count = loader->RunVertices(src, dst, count);
+  IndexGenerator::AddIndices(primitive, count);
+  return count;
+}
+
+// Reads back the deferred EFB copies which the indexed vertex arrays may cover, since the loaders
+// mustn't run into them.
+static void FlushEFBCopiesForVertexArrays()
+{
+  if (!g_texture_cache || !g_texture_cache->HasPendingEFBCopies())
+    return;
+
+  for (int i = 0; i < 12; i++)
+  {
+    const u64 status = g_main_cp_state.vtx_desc.GetVertexArrayStatus(i);
+    if (!(status & MASK_INDEXED))
+      continue;
+
+    const u32 max_index = status == INDEX8 ? 0xFF : 0xFFFF;
+    const u32 stride = g_main_cp_state.array_strides[i];
+    g_texture_cache->FlushEFBCopies(g_main_cp_state.array_bases[i],
+                                    max_index * stride + std::max(stride, 1u));
+  }
+}
+
 int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool is_preprocess)
 {
   if (!count)
@@ -268,6 +423,10 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   {
     g_vertex_manager->Flush();
   }
+
+  FlushEFBCopiesForVertexArrays();
+
+  StageTimings::ScopedTimer timer(StageTimings::Stage::VertexLoad);
   s_current_vtx_fmt = loader->m_native_vertex_format;
   g_current_components = loader->m_native_components;
   VertexShaderManager::SetVertexFormat(loader->m_native_components);
@@ -280,9 +439,7 @@ int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bo
   DataReader dst = g_vertex_manager->PrepareForAdditionalData(
       primitive, count, loader->m_native_vtx_decl.stride, cullall);
 
-  count = loader->RunVertices(src, dst, count);
-
-  IndexGenerator::AddIndices(primitive, count);
+  count = ConvertVertices(loader, primitive, count, src, dst);
 
   g_vertex_manager->FlushData(count, loader->m_native_vtx_decl.stride);
 
@@ -358,6 +515,43 @@ void LoadCPReg(u32 sub_cmd, u32 value, bool is_preprocess)
   }
 }
 
+bool IsRedundantCPWrite(u32 sub_cmd, u32 value)
+{
+  const CPState& state = g_main_cp_state;
+  switch (sub_cmd & 0xF0)
+  {
+  // The matrix indices are shared with XF, so a write may still be a change there.
+  case 0x30:
+  case 0x40:
+    return false;
+
+  case 0x50:
+    return ((state.vtx_desc.Hex & ~0x1FFFFull) | value) == state.vtx_desc.Hex;
+
+  case 0x60:
+    return ((state.vtx_desc.Hex & 0x1FFFF) | (u64)value << 17) == state.vtx_desc.Hex;
+
+  case 0x70:
+    return (sub_cmd & 0x0F) < 8 && state.vtx_attr[sub_cmd & 7].g0.Hex == value;
+
+  case 0x80:
+    return (sub_cmd & 0x0F) < 8 && state.vtx_attr[sub_cmd & 7].g1.Hex == value;
+
+  case 0x90:
+    return (sub_cmd & 0x0F) < 8 && state.vtx_attr[sub_cmd & 7].g2.Hex == value;
+
+  case 0xA0:
+    return state.array_bases[sub_cmd & 0xF] == value;
+
+  case 0xB0:
+    return state.array_strides[sub_cmd & 0xF] == (value & 0xFF);
+
+  // Unknown registers aren't tracked, so they can't be known to be unchanged.
+  default:
+    return false;
+  }
+}
+
 void FillCPMemoryArray(u32* memory)
 {
   memory[0x30] = g_main_cp_state.matrix_index_a.Hex;
@@ -12,6 +12,7 @@
 
 class DataReader;
 class NativeVertexFormat;
+class VertexLoaderBase;
 struct PortableVertexDeclaration;
 
 namespace VertexLoaderManager
@@ -20,6 +21,7 @@ using NativeVertexFormatMap =
     std::unordered_map<PortableVertexDeclaration, std::unique_ptr<NativeVertexFormat>>;
 
 void Init();
+void Shutdown();
 void Clear();
 
 void MarkAllDirty();
@@ -37,6 +39,11 @@ NativeVertexFormat* GetUberVertexFormat(const PortableVertexDeclaration& decl);
 // Returns -1 if buf_size is insufficient, else the amount of bytes consumed
 int RunVertices(int vtx_attr_group, int primitive, int count, DataReader src, bool is_preprocess);
 
+// Converts count vertices to dst and generates their indices. Large batches are split across
+// the vertex loader worker threads. Returns the number of vertices written to dst.
+int ConvertVertices(VertexLoaderBase* loader, int primitive, int count, DataReader src,
+                    DataReader dst);
+
 // For debugging
 std::string VertexLoadersToString();
 
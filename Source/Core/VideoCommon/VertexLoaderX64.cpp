@@ -27,6 +27,7 @@ static const X64Reg scratch3 = ABI_PARAM4;
 static const X64Reg count_reg = R10;
 static const X64Reg skipped_reg = R11;
 static const X64Reg base_reg = RBX;
+static const X64Reg zfreeze_reg = R12;
 
 static const u8* memory_base_ptr = (u8*)&g_main_cp_state.array_strides;
 
@@ -221,7 +222,7 @@ int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count
       // zfreeze
       if (native_format == &m_native_vtx_decl.position)
       {
-        CMP(32, R(count_reg), Imm8(3));
+        CMP(32, R(count_reg), R(zfreeze_reg));
         FixupBranch dont_store = J_CC(CC_A);
         LEA(32, scratch3, MScaled(count_reg, SCALE_4, -4));
         MOVUPS(MPIC(VertexLoaderManager::position_cache, scratch3, SCALE_4), coords);
@@ -255,7 +256,7 @@ int VertexLoaderX64::ReadVertex(OpArg data, u64 attribute, int format, int count
   // zfreeze
   if (native_format == &m_native_vtx_decl.position)
   {
-    CMP(32, R(count_reg), Imm8(3));
+    CMP(32, R(count_reg), R(zfreeze_reg));
     FixupBranch dont_store = J_CC(CC_A);
     LEA(32, scratch3, MScaled(count_reg, SCALE_4, -4));
     MOVUPS(MPIC(VertexLoaderManager::position_cache, scratch3, SCALE_4), coords);
@@ -386,8 +387,16 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 
 void VertexLoaderX64::GenerateVertexLoader()
 {
-  BitSet32 regs = {src_reg,  dst_reg,   scratch1,    scratch2,
-                   scratch3, count_reg, skipped_reg, base_reg};
+  // The zfreeze caches are filled from the last three vertices. The second entry point skips
+  // that, for batches which are converted in several pieces.
+  MOV(32, R(scratch1), Imm32(3));
+  FixupBranch entered = J();
+  m_no_zfreeze_entry = GetCodePtr();
+  XOR(32, R(scratch1), R(scratch1));
+  SetJumpTarget(entered);
+
+  BitSet32 regs = {src_reg,   dst_reg,     scratch1, scratch2,   scratch3,
+                   count_reg, skipped_reg, base_reg, zfreeze_reg};
   regs &= ABI_ALL_CALLEE_SAVED;
   ABI_PushRegistersAndAdjustStack(regs, 0);
 
@@ -398,6 +407,7 @@ void VertexLoaderX64::GenerateVertexLoader()
   MOV(32, R(count_reg), R(ABI_PARAM3));
 
   MOV(64, R(base_reg), R(ABI_PARAM4));
+  MOV(32, R(zfreeze_reg), R(scratch1));
 
   if (m_VtxDesc.Position & MASK_INDEXED)
     XOR(32, R(skipped_reg), R(skipped_reg));
@@ -413,7 +423,7 @@ void VertexLoaderX64::GenerateVertexLoader()
     MOV(32, MDisp(dst_reg, m_dst_ofs), R(scratch1));
 
     // zfreeze
-    CMP(32, R(count_reg), Imm8(3));
+    CMP(32, R(count_reg), R(zfreeze_reg));
     FixupBranch dont_store = J_CC(CC_A);
     MOV(32, MPIC(VertexLoaderManager::position_matrix_index, count_reg, SCALE_4), R(scratch1));
     SetJumpTarget(dont_store);
@@ -561,3 +571,10 @@ int VertexLoaderX64::RunVertices(DataReader src, DataReader dst, int count)
   return ((int (*)(u8*, u8*, int, const void*))region)(src.GetPointer(), dst.GetPointer(), count,
                                                        memory_base_ptr);
 }
+
+int VertexLoaderX64::RunVerticesWithoutZFreeze(DataReader src, DataReader dst, int count)
+{
+  m_numLoadedVertices += count;
+  return ((int (*)(u8*, u8*, int, const void*))m_no_zfreeze_entry)(
+      src.GetPointer(), dst.GetPointer(), count, memory_base_ptr);
+}
@@ -14,11 +14,15 @@ public:
 protected:
   std::string GetName() const override { return "VertexLoaderX64"; }
   bool IsInitialized() override { return true; }
+  // All per-vertex state lives in registers.
+  bool IsThreadSafe() const override { return true; }
   int RunVertices(DataReader src, DataReader dst, int count) override;
+  int RunVerticesWithoutZFreeze(DataReader src, DataReader dst, int count) override;
 
 private:
   u32 m_src_ofs = 0;
   u32 m_dst_ofs = 0;
+  const u8* m_no_zfreeze_entry = nullptr;
   Gen::FixupBranch m_skip_vertex;
   Gen::OpArg GetVertexAddr(int array, u64 attribute);
   int ReadVertex(Gen::OpArg data, u64 attribute, int format, int count_in, int count_out,
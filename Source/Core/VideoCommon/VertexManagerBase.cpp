@@ -19,6 +19,7 @@
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Debugger.h"
+#include "VideoCommon/EFBPeekCache.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
@@ -27,6 +28,7 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/SamplerCommon.h"
+#include "VideoCommon/StageTimings.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -321,6 +323,7 @@ void VertexManagerBase::Flush()
   // calculate the zfreeze refrence slope
   if (!m_cull_all)
   {
+    StageTimings::ScopedTimer timer(StageTimings::Stage::TextureLoad);
     BitSet32 usedtextures;
     for (u32 i = 0; i < bpmem.genMode.numtevstages + 1u; ++i)
       if (bpmem.tevorders[i / 2].getEnable(i & 1))
@@ -385,18 +388,23 @@ void VertexManagerBase::Flush()
   if (!m_cull_all)
   {
     // Update the pipeline, or compile one if needed.
-    UpdatePipelineConfig();
-    UpdatePipelineObject();
+    {
+      StageTimings::ScopedTimer timer(StageTimings::Stage::ShaderLookup);
+      UpdatePipelineConfig();
+      UpdatePipelineObject();
+    }
 
     // set the rest of the global constants
     GeometryShaderManager::SetConstants();
     PixelShaderManager::SetConstants();
 
+    StageTimings::ScopedTimer timer(StageTimings::Stage::BackendDraw);
     if (PerfQueryBase::ShouldEmulate())
       g_perf_query->EnableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
     g_vertex_manager->vFlush();
     if (PerfQueryBase::ShouldEmulate())
       g_perf_query->DisableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
+    EFBPeekCache::Invalidate();
   }
 
   GFX_DEBUGGER_PAUSE_AT(NEXT_FLUSH, true);
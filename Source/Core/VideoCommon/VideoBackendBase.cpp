@@ -31,6 +31,7 @@
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/EFBPeekCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/IndexGenerator.h"
@@ -109,9 +110,15 @@ u32 VideoBackendBase::Video_AccessEFB(EFBAccessType type, u32 x, u32 y, u32 data
     e.efb_poke.data = data;
     e.efb_poke.x = x;
     e.efb_poke.y = y;
+    if (g_ActiveConfig.backend_info.bSupportsEFBPeekCache)
+      EFBPeekCache::InvalidatePokedTile(type, x, y);
     AsyncRequests::GetInstance()->PushEvent(e, false);
     return 0;
   }
+  else if (g_ActiveConfig.backend_info.bSupportsEFBPeekCache)
+  {
+    return EFBPeekCache::Peek(type, x, y);
+  }
   else
   {
     AsyncRequests::Event e;
@@ -264,6 +271,8 @@ void VideoBackendBase::CheckInvalidState()
     m_invalid = false;
 
     BPReload();
+    // RAM was loaded from the savestate, so the deferred EFB copies are outdated.
+    g_texture_cache->DiscardEFBCopies();
     g_texture_cache->Invalidate();
   }
 }
@@ -284,6 +293,7 @@ void VideoBackendBase::InitializeShared()
   frameCount = 0;
 
   CommandProcessor::Init();
+  EFBPeekCache::Init();
   Fifo::Init();
   OpcodeDecoder::Init();
   PixelEngine::Init();
@@ -305,6 +315,7 @@ void VideoBackendBase::ShutdownShared()
 
   m_initialized = false;
 
+  VertexLoaderManager::Shutdown();
   VertexLoaderManager::Clear();
   Fifo::Shutdown();
 }
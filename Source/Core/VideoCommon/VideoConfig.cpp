@@ -7,6 +7,7 @@
 #include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
 #include "Common/StringUtil.h"
+#include "Common/WorkerPool.h"
 #include "Core/Config/GraphicsSettings.h"
 #include "Core/Core.h"
 #include "Core/Movie.h"
@@ -67,6 +68,7 @@ void VideoConfig::Refresh()
     aspect_mode = config_aspect_mode;
   bCrop = Config::Get(Config::GFX_CROP);
   iSafeTextureCache_ColorSamples = Config::Get(Config::GFX_SAFE_TEXTURE_CACHE_COLOR_SAMPLES);
+  bFullTextureHash = Config::Get(Config::GFX_FULL_TEXTURE_HASH);
   bShowFPS = Config::Get(Config::GFX_SHOW_FPS);
   bShowNetPlayPing = Config::Get(Config::GFX_SHOW_NETPLAY_PING);
   bShowNetPlayMessages = Config::Get(Config::GFX_SHOW_NETPLAY_MESSAGES);
@@ -76,6 +78,10 @@ void VideoConfig::Refresh()
   bDumpTextures = Config::Get(Config::GFX_DUMP_TEXTURES);
   bHiresTextures = Config::Get(Config::GFX_HIRES_TEXTURES);
   bCacheHiresTextures = Config::Get(Config::GFX_CACHE_HIRES_TEXTURES);
+  bStreamHiresTextures = Config::Get(Config::GFX_STREAM_HIRES_TEXTURES);
+  iHiresTextureCacheSize = Config::Get(Config::GFX_HIRES_TEXTURE_CACHE_SIZE);
+  bCacheDecodedTextures = Config::Get(Config::GFX_CACHE_DECODED_TEXTURES);
+  iDecodedTextureCacheSize = Config::Get(Config::GFX_DECODED_TEXTURE_CACHE_SIZE);
   bDumpEFBTarget = Config::Get(Config::GFX_DUMP_EFB_TARGET);
   bDumpXFBTarget = Config::Get(Config::GFX_DUMP_XFB_TARGET);
   bDumpFramesAsImages = Config::Get(Config::GFX_DUMP_FRAMES_AS_IMAGES);
@@ -106,6 +112,8 @@ void VideoConfig::Refresh()
   iShaderCompilationMode = Config::Get(Config::GFX_SHADER_COMPILATION_MODE);
   iShaderCompilerThreads = Config::Get(Config::GFX_SHADER_COMPILER_THREADS);
   iShaderPrecompilerThreads = Config::Get(Config::GFX_SHADER_PRECOMPILER_THREADS);
+  iVertexLoaderThreads = Config::Get(Config::GFX_VERTEX_LOADER_THREADS);
+  iTextureDecoderThreads = Config::Get(Config::GFX_TEXTURE_DECODER_THREADS);
 
   bZComploc = Config::Get(Config::GFX_SW_ZCOMPLOC);
   bZFreeze = Config::Get(Config::GFX_SW_ZFREEZE);
@@ -114,6 +122,7 @@ void VideoConfig::Refresh()
   bDumpTevTextureFetches = Config::Get(Config::GFX_SW_DUMP_TEV_TEX_FETCHES);
   drawStart = Config::Get(Config::GFX_SW_DRAW_START);
   drawEnd = Config::Get(Config::GFX_SW_DRAW_END);
+  iSWRasterizerThreads = Config::Get(Config::GFX_SW_RASTERIZER_THREADS);
 
   bForceFiltering = Config::Get(Config::GFX_ENHANCE_FORCE_FILTERING);
   iMaxAnisotropy = Config::Get(Config::GFX_ENHANCE_MAX_ANISOTROPY);
@@ -133,11 +142,14 @@ void VideoConfig::Refresh()
   iStereoDepthPercentage = Config::Get(Config::GFX_STEREO_DEPTH_PERCENTAGE);
 
   bEFBAccessEnable = Config::Get(Config::GFX_HACK_EFB_ACCESS_ENABLE);
+  bEFBAccessPrefetch = Config::Get(Config::GFX_HACK_EFB_ACCESS_PREFETCH);
   bBBoxEnable = Config::Get(Config::GFX_HACK_BBOX_ENABLE);
   bBBoxPreferStencilImplementation =
       Config::Get(Config::GFX_HACK_BBOX_PREFER_STENCIL_IMPLEMENTATION);
   bForceProgressive = Config::Get(Config::GFX_HACK_FORCE_PROGRESSIVE);
   bSkipEFBCopyToRam = Config::Get(Config::GFX_HACK_SKIP_EFB_COPY_TO_RAM);
+  bDeferEFBCopies = Config::Get(Config::GFX_HACK_DEFER_EFB_COPIES);
+  bTrackTextureWrites = Config::Get(Config::GFX_HACK_TRACK_TEXTURE_WRITES);
   bSkipXFBCopyToRam = Config::Get(Config::GFX_HACK_SKIP_XFB_COPY_TO_RAM);
   bDisableCopyToVRAM = Config::Get(Config::GFX_HACK_DISABLE_COPY_TO_VRAM);
   bImmediateXFB = Config::Get(Config::GFX_HACK_IMMEDIATE_XFB);
@@ -214,3 +226,29 @@ u32 VideoConfig::GetShaderPrecompilerThreads() const
   else
     return GetNumAutoShaderCompilerThreads();
 }
+
+u32 VideoConfig::GetVertexLoaderThreads() const
+{
+  if (iVertexLoaderThreads >= 0)
+    return static_cast<u32>(iVertexLoaderThreads);
+  else
+    return Common::WorkerPool::GetDefaultThreadCount();
+}
+
+u32 VideoConfig::GetTextureDecoderThreads() const
+{
+  if (iTextureDecoderThreads >= 0)
+    return static_cast<u32>(iTextureDecoderThreads);
+  else
+    return Common::WorkerPool::GetDefaultThreadCount();
+}
+
+u32 VideoConfig::GetSWRasterizerThreads() const
+{
+  if (iSWRasterizerThreads >= 0)
+    return static_cast<u32>(iSWRasterizerThreads);
+
+  // Drawing scales with the number of cores, so use all of them but the CPU thread's and the GPU
+  // thread's, which draws tiles itself.
+  return static_cast<u32>(std::max(cpu_info.num_cores - 2, 0));
+}
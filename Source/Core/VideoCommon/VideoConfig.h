@@ -95,6 +95,13 @@ struct VideoConfig final
   bool bDumpTextures;
   bool bHiresTextures;
   bool bCacheHiresTextures;
+  // Load custom textures in the background, using the native texture until they are ready.
+  bool bStreamHiresTextures;
+  // Memory limit for loaded custom textures in MiB, or 0 to pick one based on the system RAM.
+  int iHiresTextureCacheSize;
+  // Keep decoded textures on disk between sessions, up to iDecodedTextureCacheSize MiB per game.
+  bool bCacheDecodedTextures;
+  int iDecodedTextureCacheSize;
   bool bDumpEFBTarget;
   bool bDumpXFBTarget;
   bool bDumpFramesAsImages;
@@ -111,6 +118,7 @@ struct VideoConfig final
 
   // Hacks
   bool bEFBAccessEnable;
+  bool bEFBAccessPrefetch;
   bool bPerfQueriesEnable;
   bool bBBoxEnable;
   bool bBBoxPreferStencilImplementation;  // OpenGL-only, to see how slow it is compared to SSBOs
@@ -118,11 +126,14 @@ struct VideoConfig final
 
   bool bEFBEmulateFormatChanges;
   bool bSkipEFBCopyToRam;
+  bool bDeferEFBCopies;
+  bool bTrackTextureWrites;
   bool bSkipXFBCopyToRam;
   bool bDisableCopyToVRAM;
   bool bImmediateXFB;
   bool bCopyEFBScaled;
   int iSafeTextureCache_ColorSamples;
+  bool bFullTextureHash;
   float fAspectRatioHackW, fAspectRatioHackH;
   bool bEnablePixelLighting;
   bool bFastDepthCalc;
@@ -151,6 +162,11 @@ struct VideoConfig final
   bool bDumpTevStages;
   bool bDumpTevTextureFetches;
 
+  // Number of additional threads the software renderer draws tiles of the EFB on.
+  // 0 draws everything on the GPU thread.
+  // -1 uses an automatic number based on the CPU threads.
+  int iSWRasterizerThreads;
+
   // Enable API validation layers, currently only supported with Vulkan.
   bool bEnableValidationLayer;
 
@@ -171,6 +187,16 @@ struct VideoConfig final
   int iShaderCompilerThreads;
   int iShaderPrecompilerThreads;
 
+  // Number of additional threads used to convert large vertex batches.
+  // 0 converts all vertices on the GPU thread.
+  // -1 uses an automatic number based on the CPU threads.
+  int iVertexLoaderThreads;
+
+  // Number of additional threads used to decode large textures and mipmap chains on the CPU.
+  // 0 decodes all textures on the GPU thread.
+  // -1 uses an automatic number based on the CPU threads.
+  int iTextureDecoderThreads;
+
   // Static config per API
   // TODO: Move this out of VideoConfig
   struct
@@ -213,6 +239,11 @@ struct VideoConfig final
     bool bSupportsBPTCTextures;
     bool bSupportsFramebufferFetch;  // Used as an alternative to dual-source blend on GLES
     bool bSupportsBackgroundCompiling;
+    // Renderer::AccessEFB is cheap for the other pixels of a tile once one pixel was read, so the
+    // CPU thread can cache whole tiles of peeks.
+    bool bSupportsEFBPeekCache;
+    // EFB copies to RAM can be left in staging textures until the memory is accessed.
+    bool bSupportsDeferredEFBCopies;
   } backend_info;
 
   // Utility
@@ -235,6 +266,9 @@ struct VideoConfig final
   bool UsingUberShaders() const;
   u32 GetShaderCompilerThreads() const;
   u32 GetShaderPrecompilerThreads() const;
+  u32 GetVertexLoaderThreads() const;
+  u32 GetTextureDecoderThreads() const;
+  u32 GetSWRasterizerThreads() const;
 };
 
 extern VideoConfig g_Config;
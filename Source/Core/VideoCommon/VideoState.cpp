@@ -9,6 +9,7 @@
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/EFBPeekCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/PixelEngine.h"
@@ -63,5 +64,9 @@ void VideoCommon_DoState(PointerWrap& p)
   BoundingBox::DoState(p);
   p.DoMarker("BoundingBox");
 
+  // Peeks depend on the registers that were just loaded.
+  if (p.GetMode() == PointerWrap::MODE_READ)
+    EFBPeekCache::Invalidate();
+
   // TODO: search for more data that should be saved and add it here
 }
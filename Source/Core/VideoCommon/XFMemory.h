@@ -292,5 +292,7 @@ struct XFMemory
 extern XFMemory xfmem;
 
 void LoadXFReg(u32 transferSize, u32 address, DataReader src);
+// Returns true if LoadXFReg(transferSize, address, src) wouldn't change xfmem.
+bool IsRedundantXFWrite(u32 transferSize, u32 address, DataReader src);
 void LoadIndexedXF(u32 val, int array);
 void PreprocessIndexedXF(u32 val, int refarray);
@@ -13,6 +13,7 @@
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/XFMemory.h"
@@ -253,6 +254,25 @@ void LoadXFReg(u32 transferSize, u32 baseAddress, DataReader src)
   }
 }
 
+bool IsRedundantXFWrite(u32 transferSize, u32 baseAddress, DataReader src)
+{
+  // Leave clamped writes to LoadXFReg so they still get logged.
+  if (baseAddress + transferSize > 0x1058)
+    return false;
+
+  // The matrix indices are shared with CP, so a write may still be a change there.
+  if (baseAddress <= XFMEM_SETMATRIXINDB && baseAddress + transferSize > XFMEM_SETMATRIXINDA)
+    return false;
+
+  const u32* current = (u32*)&xfmem + baseAddress;
+  for (u32 i = 0; i < transferSize; i++)
+  {
+    if (current[i] != src.Peek<u32>(i * sizeof(u32)))
+      return false;
+  }
+  return true;
+}
+
 // TODO - verify that it is correct. Seems to work, though.
 void LoadIndexedXF(u32 val, int refarray)
 {
@@ -269,8 +289,10 @@ void LoadIndexedXF(u32 val, int refarray)
   }
   else
   {
-    newData = (u32*)Memory::GetPointer(g_main_cp_state.array_bases[refarray] +
-                                       g_main_cp_state.array_strides[refarray] * index);
+    const u32 array_address =
+        g_main_cp_state.array_bases[refarray] + g_main_cp_state.array_strides[refarray] * index;
+    g_texture_cache->FlushEFBCopies(array_address, size * sizeof(u32));
+    newData = (u32*)Memory::GetPointer(array_address);
   }
   bool changed = false;
   for (int i = 0; i < size; ++i)
@@ -0,0 +1,38 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <string>
+
+#include "VideoCommon/HiresTexturePack.h"
+#include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/VideoConfig.h"
+
+// Packs a directory of custom textures into a single file, which Dolphin loads instead of the
+// separate PNG and DDS files when it is placed into the texture directory of the game.
+int main(int argc, const char* argv[])
+{
+  if (argc != 3)
+  {
+    printf("USAGE: texturepacktool <texture directory> <output file>\n\n"
+           "Output files have to end in %s to be picked up by Dolphin.\n",
+           VideoCommon::HiresTexturePack::EXTENSION);
+    return 1;
+  }
+
+  // Keep compressed DDS textures as they are. Dolphin checks whether the backend supports them
+  // when it loads the pack.
+  g_ActiveConfig.backend_info.bSupportsST3CTextures = true;
+  g_ActiveConfig.backend_info.bSupportsBPTCTextures = true;
+
+  size_t texture_count = 0;
+  if (!HiresTexture::WritePack(argv[1], argv[2], &texture_count))
+  {
+    fprintf(stderr, "Failed to write %s\n", argv[2]);
+    return 1;
+  }
+
+  printf("Packed %zu textures into %s\n", texture_count, argv[2]);
+  return 0;
+}
@@ -0,0 +1,108 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+
+namespace
+{
+std::vector<u8> GenerateData(size_t size)
+{
+  std::vector<u8> data(size);
+  for (size_t i = 0; i < size; i++)
+    data[i] = static_cast<u8>((((i * 31 + 7) >> 3) ^ (i * 13)) & 0xFF);
+  return data;
+}
+
+// Hashes of the first length bytes of GenerateData(), from the reference XXH3_64bits().
+struct KnownHash
+{
+  u32 length;
+  u64 hash;
+};
+
+constexpr KnownHash XXH3_KNOWN_HASHES[] = {
+    {0, 0x2D06800538D394C2},     {1, 0xC44BDFF4074EECDB},     {3, 0xB60E9BD66B8D7641},
+    {4, 0x9184FBE6D70CC1FD},     {8, 0x0FB1C5053F9023C5},     {9, 0xA24771C6BC821AE9},
+    {16, 0x9B93EF6632716FA2},    {17, 0x7D8F2AE20E159E0B},    {32, 0x897B15A6D524D5EC},
+    {33, 0xD840E30189C409C4},    {64, 0xFAC8E3F04758D613},    {65, 0xD94E9CBC9FD387D3},
+    {96, 0xC7A6FAF80C730EAA},    {97, 0x5C1207DDF1B6F72B},    {128, 0xB43C60ED7C7DD9E3},
+    {129, 0x9B0C2CA22938A567},   {200, 0x68B848BACEA6C022},   {240, 0x9A791F06F41A0EC6},
+    {241, 0xFD7586FA9790BBA3},   {255, 0x60AA663381973585},   {256, 0xE747065C87D7C997},
+    {1024, 0x844CBA228E60C45F},  {1025, 0x6C828B357F6FB5A4},  {4096, 0x6EA83D30916B638C},
+    {5000, 0x4CF9B28B9EC6F262},  {16384, 0x375F857A12EC65A1}, {16447, 0x91BE72ED951CDACF},
+};
+
+void CheckKnownHashes()
+{
+  const std::vector<u8> data = GenerateData(20000);
+  for (const KnownHash& known : XXH3_KNOWN_HASHES)
+  {
+    // The sample count must not matter.
+    EXPECT_EQ(known.hash, Common::GetHash64(data.data(), known.length, 0))
+        << "length " << known.length;
+    EXPECT_EQ(known.hash, Common::GetHash64(data.data(), known.length, 128))
+        << "length " << known.length;
+  }
+}
+
+double MeasureThroughput(const std::vector<u8>& data, u32 size, u32 samples)
+{
+  // Hash roughly 256 MiB per size, so small sizes get enough iterations to be measurable.
+  const size_t iterations = std::max<size_t>(256 * 1024 * 1024 / size, 1);
+  u64 checksum = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++)
+    checksum += Common::GetHash64(data.data() + (i & 63), size, samples);
+  const auto end = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(end - start).count();
+  // Keep the loop from being optimized away.
+  EXPECT_NE(checksum, 1u);
+  return static_cast<double>(size) * iterations / (1024 * 1024) / std::max(seconds, 1e-9);
+}
+}  // namespace
+
+TEST(Hash, XXH3MatchesReference)
+{
+  Common::SetHash64Function(Common::Hash64Function::XXH3);
+  CheckKnownHashes();
+
+#if defined(_M_X86_64)
+  // Also check the SSE2 fallback when the host would otherwise use AVX2.
+  if (cpu_info.bAVX2)
+  {
+    cpu_info.bAVX2 = false;
+    Common::SetHash64Function(Common::Hash64Function::XXH3);
+    CheckKnownHashes();
+    cpu_info.bAVX2 = true;
+  }
+#endif
+
+  Common::SetHash64Function();
+}
+
+TEST(Hash, DISABLED_Throughput)
+{
+  const std::vector<u8> data = GenerateData(4 * 1024 * 1024 + 64);
+
+  printf("%10s %16s %16s %16s\n", "size", "sampled (128)", "sampled (all)", "xxh3");
+  for (u32 size = 32; size <= 4 * 1024 * 1024; size *= 4)
+  {
+    Common::SetHash64Function(Common::Hash64Function::Sampled);
+    const double sampled = MeasureThroughput(data, size, 128);
+    const double sampled_full = MeasureThroughput(data, size, 0);
+    Common::SetHash64Function(Common::Hash64Function::XXH3);
+    const double xxh3 = MeasureThroughput(data, size, 0);
+    printf("%10u %11.0f MB/s %11.0f MB/s %11.0f MB/s\n", size, sampled, sampled_full, xxh3);
+  }
+  Common::SetHash64Function();
+}
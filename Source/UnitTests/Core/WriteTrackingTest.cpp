@@ -0,0 +1,270 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/MemTools.h"
+#include "Core/PowerPC/MMU.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+int s_handled_accesses = 0;
+
+// Fills in protected pages with the offsets into them, like a deferred copy would.
+void FillPage(u32 address, u32 size)
+{
+  s_handled_accesses++;
+  u8* pointer = Memory::GetUnprotectedPointer(address, size);
+  for (u32 i = 0; i < size; i++)
+    pointer[i] = static_cast<u8>(i + 1);
+  Memory::UnprotectFromAccess(address, size);
+}
+}  // namespace
+
+class WriteTrackingTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    if (!EMM::IsExceptionHandlerProcessWide())
+      return;
+
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+    EMM::InstallExceptionHandler();
+    Memory::EnableWriteTracking();
+  }
+
+  void TearDown() override
+  {
+    if (!EMM::IsExceptionHandlerProcessWide())
+      return;
+
+    Memory::SetAccessHandler(nullptr);
+    Memory::DisableWriteTracking();
+    EMM::UninstallExceptionHandler();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+private:
+  std::string m_profile_path;
+};
+
+TEST_F(WriteTrackingTest, DetectsWrites)
+{
+  if (!EMM::IsExceptionHandlerProcessWide())
+    return;
+
+  u64 token = Memory::TrackWrites(0x1000, 0x2000);
+  ASSERT_NE(Memory::WRITE_TOKEN_INVALID, token);
+  EXPECT_TRUE(Memory::IsUnchangedSince(0x1000, 0x2000, token));
+  EXPECT_TRUE(Memory::IsUnchangedSince(0x80001000, 0x2000, token));
+
+  // Reads and writes outside of the range don't count.
+  EXPECT_EQ(0, Memory::m_pRAM[0x1800]);
+  Memory::m_pRAM[0x3000] = 1;
+  EXPECT_TRUE(Memory::IsUnchangedSince(0x1000, 0x2000, token));
+
+  Memory::m_pRAM[0x2ffc] = 2;
+  EXPECT_EQ(2, Memory::m_pRAM[0x2ffc]);
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x1000, 0x2000, token));
+
+  // Tracking a range again makes it writable only once more.
+  token = Memory::TrackWrites(0x1000, 0x2000);
+  EXPECT_TRUE(Memory::IsUnchangedSince(0x1000, 0x2000, token));
+  Memory::Write_U32(0x12345678, 0x1000);
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x1000, 0x2000, token));
+  EXPECT_EQ(0x12345678u, Memory::Read_U32(0x1000));
+}
+
+TEST_F(WriteTrackingTest, OverlappingRanges)
+{
+  if (!EMM::IsExceptionHandlerProcessWide())
+    return;
+
+  const u64 first = Memory::TrackWrites(0x10000, 0x4000);
+  const u64 second = Memory::TrackWrites(0x12000, 0x4000);
+
+  // Retracking a page the first range shares must not hide writes from it.
+  Memory::m_pRAM[0x12000] = 1;
+  const u64 third = Memory::TrackWrites(0x12000, 0x1000);
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x10000, 0x4000, first));
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x12000, 0x4000, second));
+  EXPECT_TRUE(Memory::IsUnchangedSince(0x12000, 0x1000, third));
+
+  // Ranges outside of RAM can't be tracked.
+  EXPECT_EQ(Memory::WRITE_TOKEN_INVALID, Memory::TrackWrites(Memory::RAM_SIZE - 0x1000, 0x2000));
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x12000, 0x1000, Memory::WRITE_TOKEN_INVALID));
+}
+
+TEST_F(WriteTrackingTest, WritesFromOtherThreadsAndMappings)
+{
+  if (!EMM::IsExceptionHandlerProcessWide())
+    return;
+
+  // Map logical 0x80000000 to physical 0 like the default BATs do.
+  PowerPC::BatTable dbat_table{};
+  for (u32 i = 0; i < Memory::RAM_SIZE / PowerPC::BAT_PAGE_SIZE; i++)
+  {
+    dbat_table[(0x80000000 >> PowerPC::BAT_INDEX_SHIFT) + i] =
+        (i << PowerPC::BAT_INDEX_SHIFT) | PowerPC::BAT_PHYSICAL_BIT;
+  }
+  Memory::UpdateLogicalMemory(dbat_table);
+
+  u64 token = Memory::TrackWrites(0x20000, 0x1000);
+  std::thread([] { Memory::m_pRAM[0x20010] = 3; }).join();
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x20000, 0x1000, token));
+  EXPECT_EQ(3, Memory::m_pRAM[0x20010]);
+
+  token = Memory::TrackWrites(0x20000, 0x1000);
+  Memory::logical_base[0x80020020] = 4;
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x20000, 0x1000, token));
+  EXPECT_EQ(4, Memory::m_pRAM[0x20020]);
+
+  // Protection is carried over to new logical mappings.
+  token = Memory::TrackWrites(0x20000, 0x1000);
+  Memory::UpdateLogicalMemory(dbat_table);
+  EXPECT_TRUE(Memory::IsUnchangedSince(0x20000, 0x1000, token));
+  Memory::logical_base[0x80020030] = 5;
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x20000, 0x1000, token));
+  EXPECT_EQ(5, Memory::m_pRAM[0x20030]);
+}
+
+#ifndef _WIN32
+TEST_F(WriteTrackingTest, WritesFromSystemCalls)
+{
+  if (!EMM::IsExceptionHandlerProcessWide())
+    return;
+
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+  ASSERT_EQ(4, write(pipe_fds[1], "abcd", 4));
+
+  // The kernel can't write to the protected page, but through this it doesn't have to.
+  const u64 token = Memory::TrackWrites(0x30000, 0x1000);
+  {
+    Memory::HostPointer buffer(0x30010, 4, Memory::HostAccess::Write);
+    EXPECT_EQ(4, read(pipe_fds[0], buffer.Get(), 4));
+  }
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x30000, 0x1000, token));
+  EXPECT_EQ('a', Memory::m_pRAM[0x30010]);
+  EXPECT_EQ('d', Memory::m_pRAM[0x30013]);
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+
+TEST_F(WriteTrackingTest, SystemCallsOnProtectedPages)
+{
+  if (!EMM::IsExceptionHandlerProcessWide())
+    return;
+
+  Memory::SetAccessHandler(FillPage);
+  s_handled_accesses = 0;
+  int pipe_fds[2];
+  ASSERT_EQ(0, pipe(pipe_fds));
+
+  // Protected pages are filled in before the kernel reads them.
+  ASSERT_TRUE(Memory::ProtectFromAccess(0x60000, 0x100));
+  {
+    Memory::HostPointer buffer(0x60004, 4, Memory::HostAccess::Read);
+    EXPECT_EQ(4, write(pipe_fds[1], buffer.Get(), 4));
+  }
+  EXPECT_EQ(1, s_handled_accesses);
+  u8 data[4] = {};
+  ASSERT_EQ(4, read(pipe_fds[0], data, 4));
+  EXPECT_EQ(5, data[0]);
+  EXPECT_EQ(8, data[3]);
+
+  // And before it writes them, so that filling them in doesn't overwrite what it wrote.
+  ASSERT_TRUE(Memory::ProtectFromAccess(0x60000, 0x100));
+  ASSERT_EQ(4, write(pipe_fds[1], "abcd", 4));
+  {
+    Memory::HostPointer buffer(0x60010, 4, Memory::HostAccess::Write);
+    EXPECT_EQ(2, s_handled_accesses);
+    EXPECT_EQ(4, read(pipe_fds[0], buffer.Get(), 4));
+  }
+  EXPECT_EQ('a', Memory::m_pRAM[0x60010]);
+  EXPECT_EQ(0x15, Memory::m_pRAM[0x60014]);
+  EXPECT_EQ(2, s_handled_accesses);
+
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+}
+#endif
+
+TEST_F(WriteTrackingTest, AccessProtection)
+{
+  if (!EMM::IsExceptionHandlerProcessWide())
+    return;
+
+  Memory::SetAccessHandler(FillPage);
+  s_handled_accesses = 0;
+  const u32 page_size = Memory::GetTrackedPageSize();
+
+  // Protecting a range counts as writing it.
+  const u64 token = Memory::TrackWrites(0x40000, page_size * 2);
+  ASSERT_TRUE(Memory::ProtectFromAccess(0x40000, page_size * 2));
+  EXPECT_FALSE(Memory::IsUnchangedSince(0x40000, page_size * 2, token));
+
+  // Each page is filled in on its first access, from whichever thread.
+  EXPECT_EQ(6, Memory::m_pRAM[0x40005]);
+  EXPECT_EQ(1, s_handled_accesses);
+  u8 value = 0;
+  std::thread([&] { value = Memory::m_pRAM[0x40000 + page_size + 7]; }).join();
+  EXPECT_EQ(8, value);
+  EXPECT_EQ(2, s_handled_accesses);
+  Memory::m_pRAM[0x40006] = 0;
+  EXPECT_EQ(2, s_handled_accesses);
+
+  // Ranges outside of RAM can't be protected.
+  EXPECT_FALSE(Memory::ProtectFromAccess(Memory::RAM_SIZE - 0x1000, 0x2000));
+  EXPECT_EQ(nullptr, Memory::GetUnprotectedPointer(Memory::RAM_SIZE - 0x1000, 0x2000));
+}
+
+TEST_F(WriteTrackingTest, NestedAccessProtection)
+{
+  if (!EMM::IsExceptionHandlerProcessWide())
+    return;
+
+  Memory::SetAccessHandler(FillPage);
+  s_handled_accesses = 0;
+
+  // A page stays protected until it was unprotected as often as it was protected.
+  ASSERT_TRUE(Memory::ProtectFromAccess(0x50000, 0x100));
+  ASSERT_TRUE(Memory::ProtectFromAccess(0x50080, 0x100));
+  Memory::UnprotectFromAccess(0x50000, 0x100);
+  EXPECT_EQ(0x11, Memory::m_pRAM[0x50010]);
+  EXPECT_EQ(1, s_handled_accesses);
+
+  ASSERT_TRUE(Memory::ProtectFromAccess(0x50000, 0x100));
+  Memory::UnprotectFromAccess(0x50000, 0x100);
+  Memory::m_pRAM[0x50010] = 0;
+  EXPECT_EQ(1, s_handled_accesses);
+
+  // Without a handler, the access crashes instead of seeing what was there before.
+  Memory::SetAccessHandler(nullptr);
+  ASSERT_TRUE(Memory::ProtectFromAccess(0x50000, 0x100));
+  EXPECT_DEATH(static_cast<volatile u8*>(Memory::m_pRAM)[0x50010], "");
+  Memory::UnprotectFromAccess(0x50000, 0x100);
+}
@@ -0,0 +1,145 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+class SWRasterizerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::memset(&bpmem, 0, sizeof(bpmem));
+    bpmem.genMode.numcolchans = 1;
+
+    // Whole EFB
+    bpmem.scissorOffset.x = 171;
+    bpmem.scissorOffset.y = 171;
+    bpmem.scissorTL.x = 342;
+    bpmem.scissorTL.y = 342;
+    bpmem.scissorBR.x = 342 + EFB_WIDTH - 1;
+    bpmem.scissorBR.y = 342 + EFB_HEIGHT - 1;
+
+    // A single stage which outputs the rasterized color
+    bpmem.tevksel[0].swap1 = 0;
+    bpmem.tevksel[0].swap2 = 1;
+    bpmem.tevksel[1].swap1 = 2;
+    bpmem.tevksel[1].swap2 = 3;
+    TevStageCombiner::ColorCombiner& cc = bpmem.combiners[0].colorC;
+    cc.a = TEVCOLORARG_ZERO;
+    cc.b = TEVCOLORARG_ZERO;
+    cc.c = TEVCOLORARG_ZERO;
+    cc.d = TEVCOLORARG_RASC;
+    cc.clamp = 1;
+    TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[0].alphaC;
+    ac.a = TEVALPHAARG_ZERO;
+    ac.b = TEVALPHAARG_ZERO;
+    ac.c = TEVALPHAARG_ZERO;
+    ac.d = TEVALPHAARG_RASA;
+    ac.clamp = 1;
+    bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+    bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+
+    // Blending makes the result depend on the order in which triangles are drawn.
+    bpmem.zcontrol.pixel_format = PEControl::RGBA6_Z24;
+    bpmem.zmode.testenable = 1;
+    bpmem.zmode.func = ZMode::ALWAYS;
+    bpmem.zmode.updateenable = 1;
+    bpmem.blendmode.blendenable = 1;
+    bpmem.blendmode.srcfactor = BlendMode::SRCALPHA;
+    bpmem.blendmode.dstfactor = BlendMode::INVSRCALPHA;
+    bpmem.blendmode.colorupdate = 1;
+    bpmem.blendmode.alphaupdate = 1;
+
+    g_ActiveConfig.bZComploc = false;
+    g_ActiveConfig.bZFreeze = false;
+    g_ActiveConfig.bDumpTevStages = false;
+    g_ActiveConfig.bDumpTevTextureFetches = false;
+
+    Rasterizer::Init();
+  }
+
+  void TearDown() override { Rasterizer::Shutdown(); }
+
+  // Draws the same scene of overlapping triangles, and returns the colors and depths of the EFB.
+  static std::vector<u32> DrawScene(int num_threads)
+  {
+    g_ActiveConfig.iSWRasterizerThreads = num_threads;
+
+    const u32 clear_color = 0;
+    for (u16 y = 0; y < EFB_HEIGHT; y++)
+    {
+      for (u16 x = 0; x < EFB_WIDTH; x++)
+      {
+        EfbInterface::SetColor(x, y, (u8*)&clear_color);
+        EfbInterface::SetDepth(x, y, 0);
+      }
+    }
+    BoundingBox::coords[BoundingBox::LEFT] = BoundingBox::coords[BoundingBox::TOP] = 0xffff;
+    BoundingBox::coords[BoundingBox::RIGHT] = BoundingBox::coords[BoundingBox::BOTTOM] = 0;
+
+    u32 seed = 1;
+    auto random = [&seed](u32 range) {
+      seed = seed * 1103515245 + 12345;
+      return (seed >> 8) % range;
+    };
+
+    std::array<OutputVertexData, 3> vertices;
+    for (int batch = 0; batch < 4; batch++)
+    {
+      for (int triangle = 0; triangle < 100; triangle++)
+      {
+        for (OutputVertexData& vertex : vertices)
+        {
+          vertex.screenPosition.x = static_cast<float>(random(EFB_WIDTH + 64)) - 32.0f;
+          vertex.screenPosition.y = static_cast<float>(random(EFB_HEIGHT + 64)) - 32.0f;
+          vertex.screenPosition.z = static_cast<float>(random(0x1000000));
+          vertex.projectedPosition.w = 1.0f;
+          for (u8& component : vertex.color[0])
+            component = static_cast<u8>(random(256));
+        }
+
+        // Only one of the two windings is drawn.
+        Rasterizer::DrawTriangleFrontFace(&vertices[0], &vertices[1], &vertices[2]);
+        Rasterizer::DrawTriangleFrontFace(&vertices[0], &vertices[2], &vertices[1]);
+      }
+      Rasterizer::Flush();
+    }
+
+    std::vector<u32> result;
+    for (u16 y = 0; y < EFB_HEIGHT; y++)
+    {
+      for (u16 x = 0; x < EFB_WIDTH; x++)
+      {
+        result.push_back(EfbInterface::GetColor(x, y));
+        result.push_back(EfbInterface::GetDepth(x, y));
+      }
+    }
+    for (u16 coord : BoundingBox::coords)
+      result.push_back(coord);
+    return result;
+  }
+};
+
+TEST_F(SWRasterizerTest, DrawsTheSameWithThreads)
+{
+  const std::vector<u32> expected = DrawScene(0);
+  // Something was drawn.
+  ASSERT_NE(0u, expected[expected.size() - 3]);
+
+  for (int num_threads : {1, 3, 7})
+    EXPECT_TRUE(expected == DrawScene(num_threads)) << num_threads << " threads";
+}
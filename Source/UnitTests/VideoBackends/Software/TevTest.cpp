@@ -0,0 +1,216 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+constexpr int AREA_WIDTH = 32;
+constexpr int AREA_HEIGHT = 16;
+
+class Random
+{
+public:
+  u32 operator()(u32 range)
+  {
+    m_seed = m_seed * 1103515245 + 12345;
+    return (m_seed >> 8) % range;
+  }
+
+private:
+  u32 m_seed = 1;
+};
+
+u64 HashEFB()
+{
+  // FNV-1a, so the hash is the same on every host.
+  u64 hash = 14695981039346656037ULL;
+  for (u16 y = 0; y < EFB_HEIGHT; y++)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; x++)
+    {
+      const u32 color = EfbInterface::GetColor(x, y);
+      for (int i = 0; i < 4; i++)
+        hash = (hash ^ ((color >> (i * 8)) & 0xff)) * 1099511628211ULL;
+    }
+  }
+  return hash;
+}
+
+// Sets up random TEV stages without textures, and a random alpha test.
+void RandomizeTev(Random& random)
+{
+  static const u32 color_channels[] = {0, 1, 5, 6, 7};
+
+  bpmem.genMode.numtevstages = random(16);
+  for (int i = 0; i < 8; i++)
+  {
+    bpmem.tevorders[i].hex = 0;
+    bpmem.tevorders[i].colorchan0 = color_channels[random(5)];
+    bpmem.tevorders[i].colorchan1 = color_channels[random(5)];
+
+    bpmem.tevksel[i].swap1 = random(4);
+    bpmem.tevksel[i].swap2 = random(4);
+    bpmem.tevksel[i].kcsel0 = random(32);
+    bpmem.tevksel[i].kasel0 = random(32);
+    bpmem.tevksel[i].kcsel1 = random(32);
+    bpmem.tevksel[i].kasel1 = random(32);
+  }
+
+  for (TevStageCombiner& combiner : bpmem.combiners)
+  {
+    TevStageCombiner::ColorCombiner& cc = combiner.colorC;
+    cc.a = random(16);
+    cc.b = random(16);
+    cc.c = random(16);
+    cc.d = random(16);
+    cc.bias = random(4);
+    cc.op = random(2);
+    cc.clamp = random(2);
+    cc.shift = random(4);
+    cc.dest = random(4);
+
+    TevStageCombiner::AlphaCombiner& ac = combiner.alphaC;
+    ac.rswap = random(4);
+    ac.tswap = random(4);
+    ac.a = random(8);
+    ac.b = random(8);
+    ac.c = random(8);
+    ac.d = random(8);
+    ac.bias = random(4);
+    ac.op = random(2);
+    ac.clamp = random(2);
+    ac.shift = random(4);
+    ac.dest = random(4);
+  }
+
+  bpmem.alpha_test.ref0 = random(256);
+  bpmem.alpha_test.ref1 = random(256);
+  bpmem.alpha_test.comp0 = static_cast<AlphaTest::CompareMode>(random(8));
+  bpmem.alpha_test.comp1 = static_cast<AlphaTest::CompareMode>(random(8));
+  bpmem.alpha_test.logic = static_cast<AlphaTest::Op>(random(4));
+}
+}  // namespace
+
+class SWTevTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    std::memset(&bpmem, 0, sizeof(bpmem));
+    bpmem.genMode.numcolchans = 2;
+    bpmem.blendmode.colorupdate = 1;
+    bpmem.blendmode.alphaupdate = 1;
+
+    g_ActiveConfig.bZComploc = false;
+    g_ActiveConfig.bDumpTevStages = false;
+    g_ActiveConfig.bDumpTevTextureFetches = false;
+
+    m_tev = std::make_unique<Tev>();
+  }
+
+  void TearDown() override { Tev::ClearPrograms(); }
+
+  // Draws random pixels with a different random TEV configuration in each area of the EFB. The
+  // pixels are drawn in 2x2 blocks, some of which are only partially covered.
+  void DrawScene(bool vectorized, bool jit, PEControl::PixelFormat format)
+  {
+    m_tev->Init(vectorized, jit);
+    bpmem.zcontrol.pixel_format = format;
+
+    const u32 clear_color = 0;
+    for (u16 y = 0; y < EFB_HEIGHT; y++)
+    {
+      for (u16 x = 0; x < EFB_WIDTH; x++)
+        EfbInterface::SetColor(x, y, (u8*)&clear_color);
+    }
+
+    Random random;
+    for (int area_y = 0; area_y + AREA_HEIGHT <= EFB_HEIGHT; area_y += AREA_HEIGHT)
+    {
+      for (int area_x = 0; area_x + AREA_WIDTH <= EFB_WIDTH; area_x += AREA_WIDTH)
+      {
+        RandomizeTev(random);
+        for (int reg = 0; reg < 4; reg++)
+        {
+          for (int comp = 0; comp < 4; comp++)
+          {
+            PixelShaderManager::constants.colors[reg][comp] = static_cast<int>(random(2048)) - 1024;
+            m_tev->SetRegColor(reg, comp, static_cast<s16>(static_cast<int>(random(2048)) - 1024));
+          }
+        }
+        m_tev->PrepareDraw();
+
+        for (int y = area_y; y < area_y + AREA_HEIGHT; y += 2)
+        {
+          for (int x = area_x; x < area_x + AREA_WIDTH; x += 2)
+          {
+            // Most blocks are fully covered.
+            const u32 mask = random(4) ? 0xf : random(16);
+            for (int lane = 0; lane < Tev::NUM_LANES; lane++)
+            {
+              m_tev->Position[lane][0] = x + (lane & 1);
+              m_tev->Position[lane][1] = y + (lane >> 1);
+              m_tev->Position[lane][2] = 0;
+              for (auto& color : m_tev->Color[lane])
+              {
+                for (u8& component : color)
+                  component = static_cast<u8>(random(256));
+              }
+            }
+            m_tev->Draw(mask);
+          }
+        }
+      }
+    }
+  }
+
+  std::unique_ptr<Tev> m_tev;
+};
+
+TEST_F(SWTevTest, VectorizedMatchesGeneric)
+{
+  for (PEControl::PixelFormat format : {PEControl::RGB8_Z24, PEControl::RGBA6_Z24})
+  {
+    DrawScene(false, false, format);
+    const u64 expected = HashEFB();
+    DrawScene(true, false, format);
+    EXPECT_EQ(expected, HashEFB()) << format;
+  }
+}
+
+TEST_F(SWTevTest, CompiledMatchesGeneric)
+{
+  for (PEControl::PixelFormat format : {PEControl::RGB8_Z24, PEControl::RGBA6_Z24})
+  {
+    DrawScene(false, false, format);
+    const u64 expected = HashEFB();
+    DrawScene(true, true, format);
+    EXPECT_EQ(expected, HashEFB()) << format;
+  }
+}
+
+TEST_F(SWTevTest, MatchesScalarTev)
+{
+  // Hashes of the scenes drawn one pixel at a time by the TEV before it drew 2x2 blocks.
+  const u64 expected_rgb8 = 0x700ddfa87ff2982e;
+  const u64 expected_rgba6 = 0xbb735798ad3a8585;
+
+  DrawScene(true, true, PEControl::RGB8_Z24);
+  EXPECT_EQ(expected_rgb8, HashEFB());
+  DrawScene(true, true, PEControl::RGBA6_Z24);
+  EXPECT_EQ(expected_rgba6, HashEFB());
+}
@@ -0,0 +1,150 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "UICommon/UICommon.h"
+#include "VideoBackends/Software/TextureSampler.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+class Random
+{
+public:
+  u32 operator()(u32 range)
+  {
+    m_seed = m_seed * 1103515245 + 12345;
+    return (m_seed >> 8) % range;
+  }
+
+private:
+  u32 m_seed = 1;
+};
+
+// The textures in RAM are in the first megabyte.
+constexpr u32 TEXTURE_RAM_SIZE = 1024 * 1024;
+
+void RandomizeMemory(Random& random)
+{
+  for (u8& byte : texMem)
+    byte = static_cast<u8>(random(256));
+  for (u32 i = 0; i < TEXTURE_RAM_SIZE; i++)
+    Memory::m_pRAM[i] = static_cast<u8>(random(256));
+}
+
+// Sets up random textures in TMEM or RAM for all texmaps
+void RandomizeTextures(Random& random)
+{
+  static const TextureFormat formats[] = {
+      TextureFormat::I4,     TextureFormat::I8,    TextureFormat::IA4, TextureFormat::IA8,
+      TextureFormat::RGB565, TextureFormat::RGB5A3, TextureFormat::RGBA8, TextureFormat::C4,
+      TextureFormat::C8,     TextureFormat::C14X2, TextureFormat::CMPR};
+  static const u32 sizes[] = {1, 4, 8, 13, 32, 64};
+
+  std::memset(&bpmem, 0, sizeof(bpmem));
+  for (u8 texmap = 0; texmap < 8; texmap++)
+  {
+    FourTexUnits& texUnit = bpmem.tex[texmap >> 2];
+    const u8 subTexmap = texmap & 3;
+
+    // The textures and their mip levels stay well inside of TMEM.
+    TexImage0& ti0 = texUnit.texImage0[subTexmap];
+    ti0.width = sizes[random(6)] - 1;
+    ti0.height = sizes[random(6)] - 1;
+    ti0.format = static_cast<u32>(formats[random(11)]);
+    texUnit.texImage1[subTexmap].image_type = random(2);
+    texUnit.texImage1[subTexmap].tmem_even = random(TMEM_SIZE / 2 / TMEM_LINE_SIZE);
+    texUnit.texImage2[subTexmap].tmem_odd = random(TMEM_SIZE / 2 / TMEM_LINE_SIZE);
+    texUnit.texImage3[subTexmap].image_base = random(TEXTURE_RAM_SIZE / 2 / 32);
+    texUnit.texTlut[subTexmap].tmem_offset = random(1024);
+    texUnit.texTlut[subTexmap].tlut_format = random(3);
+
+    TexMode0& tm0 = texUnit.texMode0[subTexmap];
+    tm0.wrap_s = random(3);
+    tm0.wrap_t = random(3);
+    tm0.min_filter = random(8);
+  }
+}
+}  // namespace
+
+class SWTextureSamplerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    Memory::Init();
+  }
+
+  void TearDown() override
+  {
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+private:
+  std::string m_profile_path;
+};
+
+TEST_F(SWTextureSamplerTest, TexelCacheMatchesSample)
+{
+  Random random;
+  TextureSampler::TexelCache cache;
+
+  for (int draw = 0; draw < 20; draw++)
+  {
+    // The cache has to pick up new textures after a reset.
+    RandomizeMemory(random);
+    RandomizeTextures(random);
+    cache.Reset();
+
+    for (int block = 0; block < 2000; block++)
+    {
+      const u8 texmap = static_cast<u8>(random(8));
+      const s32 lod = static_cast<s32>(random(320)) - 64;
+      const bool linear = random(2) != 0;
+      const u32 lane_mask = random(4) ? 0xf : random(16);
+
+      // Outside of the texture now and then, to test the wrap modes
+      const u32 range = 64 * 128 * 3;
+      s32 s[TextureSampler::TexelCache::NUM_LANES];
+      s32 t[TextureSampler::TexelCache::NUM_LANES];
+      for (int lane = 0; lane < TextureSampler::TexelCache::NUM_LANES; lane++)
+      {
+        s[lane] = static_cast<s32>(random(range)) - static_cast<s32>(range / 3);
+        t[lane] = static_cast<s32>(random(range)) - static_cast<s32>(range / 3);
+      }
+
+      u8 samples[TextureSampler::TexelCache::NUM_LANES][4];
+      cache.Sample(s, t, lod, linear, texmap, lane_mask, samples);
+
+      for (int lane = 0; lane < TextureSampler::TexelCache::NUM_LANES; lane++)
+      {
+        if (!(lane_mask & (1 << lane)))
+          continue;
+
+        u8 expected[4];
+        TextureSampler::Sample(s[lane], t[lane], lod, linear, texmap, expected);
+        ASSERT_EQ(0, std::memcmp(expected, samples[lane], sizeof(expected)))
+            << "texmap " << int{texmap} << " lod " << lod << " linear " << linear << " lane "
+            << lane;
+      }
+    }
+  }
+}
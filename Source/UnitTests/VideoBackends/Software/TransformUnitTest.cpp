@@ -0,0 +1,219 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/TransformUnit.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace
+{
+class Random
+{
+public:
+  u32 operator()(u32 range)
+  {
+    m_seed = m_seed * 1103515245 + 12345;
+    return (m_seed >> 8) % range;
+  }
+
+  // Zero now and then, to hit the special cases for zero vectors and q
+  float Float()
+  {
+    if (!(*this)(8))
+      return 0.0f;
+    return (static_cast<float>((*this)(2001)) - 1000.0f) / 250.0f;
+  }
+
+private:
+  u32 m_seed = 1;
+};
+
+// The matrix indices keep all matrices inside of their arrays.
+constexpr u32 NUM_POS_MATRICES = 30;
+constexpr u32 NUM_POST_MATRICES = 62;
+
+void RandomizeXF(Random& random, bool special_case)
+{
+  std::memset(&xfmem, 0, sizeof(xfmem));
+  std::memset(&bpmem, 0, sizeof(bpmem));
+
+  for (float& value : xfmem.posMatrices)
+    value = random.Float();
+  for (float& value : xfmem.normalMatrices)
+    value = random.Float();
+  for (float& value : xfmem.postMatrices)
+    value = random.Float();
+
+  for (Light& light : xfmem.lights)
+  {
+    for (u8& component : light.color)
+      component = static_cast<u8>(random(256));
+    for (int i = 0; i < 3; i++)
+    {
+      light.cosatt[i] = random.Float();
+      light.distatt[i] = random.Float();
+      light.dpos[i] = random.Float();
+      light.ddir[i] = random.Float();
+    }
+  }
+
+  xfmem.projection.type = random(2) ? GX_PERSPECTIVE : GX_ORTHOGRAPHIC;
+  for (float& value : xfmem.projection.rawProjection)
+    value = random.Float();
+
+  for (u32 chan = 0; chan < NUM_XF_COLOR_CHANNELS; chan++)
+  {
+    xfmem.ambColor[chan] = random(0x10000) << 16 | random(0x10000);
+    xfmem.matColor[chan] = random(0x10000) << 16 | random(0x10000);
+    for (LitChannel* channel : {&xfmem.color[chan], &xfmem.alpha[chan]})
+    {
+      channel->hex = random(1 << 15);
+      channel->diffusefunc = random(3);
+    }
+  }
+
+  xfmem.dualTexTrans.enabled = random(2);
+  xfmem.numTexGen.numTexGens = random(9);
+  for (u32 i = 0; i < 8; i++)
+  {
+    static const u32 regular_rows[] = {0, 1, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+
+    TexMtxInfo& texinfo = xfmem.texMtxInfo[i];
+    texinfo.hex = 0;
+    texinfo.texgentype = random(4) ? XF_TEXGEN_REGULAR : random(4);
+    // Emboss maps offset one of the texture coordinates generated before them.
+    if (i == 0 && texinfo.texgentype == XF_TEXGEN_EMBOSS_MAP)
+      texinfo.texgentype = XF_TEXGEN_REGULAR;
+    if (texinfo.texgentype == XF_TEXGEN_REGULAR || texinfo.texgentype == XF_TEXGEN_EMBOSS_MAP)
+    {
+      texinfo.projection = special_case ? XF_TEXPROJ_ST : random(2);
+      texinfo.inputform = random(2);
+      texinfo.sourcerow = regular_rows[random(12)];
+      texinfo.embosssourceshift = i ? random(i) : 0;
+      texinfo.embosslightshift = random(8);
+    }
+    else
+    {
+      texinfo.inputform = XF_TEXINPUT_AB11;
+      texinfo.sourcerow = XF_SRCCOLORS_INROW;
+    }
+
+    xfmem.postMtxInfo[i].index = random(NUM_POST_MATRICES);
+    xfmem.postMtxInfo[i].normalize = random(2);
+
+    bpmem.texcoords[i].s.scale_minus_1 = random(16);
+    bpmem.texcoords[i].t.scale_minus_1 = random(16);
+  }
+}
+
+void RandomizeVertices(Random& random, std::vector<InputVertexData>* vertices)
+{
+  // Most vertices of a draw share their matrices.
+  const u32 shared_matrix = random(NUM_POS_MATRICES);
+  for (InputVertexData& vertex : *vertices)
+  {
+    vertex.posMtx = random(4) ? shared_matrix : random(NUM_POS_MATRICES);
+    for (u8& index : vertex.texMtx)
+      index = random(4) ? shared_matrix : random(NUM_POS_MATRICES);
+
+    vertex.position = Vec3(random.Float(), random.Float(), random.Float());
+    for (Vec3& normal : vertex.normal)
+      normal = Vec3(random.Float(), random.Float(), random.Float());
+    for (auto& color : vertex.color)
+    {
+      for (u8& component : color)
+        component = static_cast<u8>(random(256));
+    }
+    for (auto& coords : vertex.texCoords)
+    {
+      for (float& coord : coords)
+        coord = random.Float();
+    }
+  }
+}
+
+bool SameFloat(float expected, float actual)
+{
+  if (std::isnan(expected))
+    return std::isnan(actual);
+  return std::memcmp(&expected, &actual, sizeof(float)) == 0;
+}
+
+bool SameVec3(const Vec3& expected, const Vec3& actual)
+{
+  return SameFloat(expected.x, actual.x) && SameFloat(expected.y, actual.y) &&
+         SameFloat(expected.z, actual.z);
+}
+
+// Only compares what is transformed, as Vec3 doesn't initialize the other components.
+bool SameVertex(const OutputVertexData& expected, const OutputVertexData& actual)
+{
+  if (!SameVec3(expected.mvPosition, actual.mvPosition) ||
+      !SameFloat(expected.projectedPosition.x, actual.projectedPosition.x) ||
+      !SameFloat(expected.projectedPosition.y, actual.projectedPosition.y) ||
+      !SameFloat(expected.projectedPosition.z, actual.projectedPosition.z) ||
+      !SameFloat(expected.projectedPosition.w, actual.projectedPosition.w) ||
+      expected.color != actual.color)
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < expected.normal.size(); i++)
+  {
+    if (!SameVec3(expected.normal[i], actual.normal[i]))
+      return false;
+  }
+  for (size_t i = 0; i < xfmem.numTexGen.numTexGens; i++)
+  {
+    if (!SameVec3(expected.texCoords[i], actual.texCoords[i]))
+      return false;
+  }
+  return true;
+}
+}  // namespace
+
+TEST(SWTransformUnit, TransformVerticesMatchesSingleVertices)
+{
+  // Not a multiple of the batch size, so that the remaining vertices are tested too.
+  constexpr u32 NUM_VERTICES = 1023;
+
+  Random random;
+  for (int draw = 0; draw < 200; draw++)
+  {
+    const bool special_case = random(8) == 0;
+    const bool normals = random(4) != 0;
+    const bool nbt = normals && random(2);
+    RandomizeXF(random, special_case);
+
+    std::vector<InputVertexData> vertices(NUM_VERTICES);
+    RandomizeVertices(random, &vertices);
+
+    std::vector<OutputVertexData> transformed(NUM_VERTICES);
+    TransformUnit::TransformVertices(vertices.data(), transformed.data(), NUM_VERTICES, normals,
+                                     nbt, special_case);
+
+    for (u32 i = 0; i < NUM_VERTICES; i++)
+    {
+      OutputVertexData expected;
+      TransformUnit::TransformPosition(&vertices[i], &expected);
+      expected.normal.fill(Vec3(0.0f));
+      if (normals)
+        TransformUnit::TransformNormal(&vertices[i], nbt, &expected);
+      TransformUnit::TransformColor(&vertices[i], &expected);
+      TransformUnit::TransformTexCoord(&vertices[i], &expected, special_case);
+
+      ASSERT_TRUE(SameVertex(expected, transformed[i]))
+          << "draw " << draw << " vertex " << i << " normals " << normals << " nbt " << nbt
+          << " special case " << special_case;
+    }
+  }
+}
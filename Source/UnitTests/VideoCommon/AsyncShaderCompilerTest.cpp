@@ -0,0 +1,184 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/Event.h"
+#include "VideoCommon/AsyncShaderCompiler.h"
+
+using VideoCommon::AsyncShaderCompiler;
+
+namespace
+{
+struct CompileLog
+{
+  void Add(int id)
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    ids.push_back(id);
+  }
+
+  std::vector<int> Get()
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    return ids;
+  }
+
+  std::mutex lock;
+  std::vector<int> ids;
+};
+
+class LoggingWorkItem : public AsyncShaderCompiler::WorkItem
+{
+public:
+  LoggingWorkItem(int id_, CompileLog* compiled_, std::vector<int>* retrieved_)
+      : id(id_), compiled(compiled_), retrieved(retrieved_)
+  {
+  }
+
+  bool Compile() override
+  {
+    compiled->Add(id);
+    return true;
+  }
+
+  void Retrieve() override { retrieved->push_back(id); }
+
+private:
+  int id;
+  CompileLog* compiled;
+  std::vector<int>* retrieved;
+};
+
+// Keeps a worker thread busy until it is released.
+class BlockingWorkItem final : public AsyncShaderCompiler::WorkItem
+{
+public:
+  BlockingWorkItem(Common::Event* started_, Common::Event* release_)
+      : started(started_), release(release_)
+  {
+  }
+
+  bool Compile() override
+  {
+    started->Set();
+    release->Wait();
+    return true;
+  }
+
+  void Retrieve() override {}
+
+private:
+  Common::Event* started;
+  Common::Event* release;
+};
+}  // namespace
+
+class AsyncShaderCompilerTest : public testing::Test
+{
+protected:
+  void TearDown() override { m_compiler.StopWorkerThreads(); }
+
+  AsyncShaderCompiler::WorkItemPtr MakeItem(int id)
+  {
+    return AsyncShaderCompiler::CreateWorkItem<LoggingWorkItem>(id, &m_compiled, &m_retrieved);
+  }
+
+  // Occupies the only worker thread, so that work items stay queued.
+  void BlockWorker()
+  {
+    ASSERT_TRUE(m_compiler.StartWorkerThreads(1));
+    m_compiler.QueueWorkItem(
+        AsyncShaderCompiler::CreateWorkItem<BlockingWorkItem>(&m_started, &m_release), 0);
+    m_started.Wait();
+  }
+
+  void WaitAndRetrieve()
+  {
+    m_compiler.WaitUntilCompletion();
+    m_compiler.RetrieveWorkItems();
+  }
+
+  AsyncShaderCompiler m_compiler;
+  CompileLog m_compiled;
+  std::vector<int> m_retrieved;
+  Common::Event m_started;
+  Common::Event m_release;
+  // Any address works as a key.
+  const int m_keys[3] = {};
+};
+
+TEST_F(AsyncShaderCompilerTest, MergesWorkItemsWithTheSameKey)
+{
+  // Without worker threads, work items are compiled right away.
+  EXPECT_TRUE(m_compiler.QueueWorkItem(MakeItem(1), 100, &m_keys[0]));
+  EXPECT_FALSE(m_compiler.QueueWorkItem(MakeItem(2), 100, &m_keys[0]));
+  EXPECT_TRUE(m_compiler.QueueWorkItem(MakeItem(3), 100, &m_keys[1]));
+  EXPECT_TRUE(m_compiler.QueueWorkItem(MakeItem(4), 100));
+  EXPECT_TRUE(m_compiler.QueueWorkItem(MakeItem(5), 100));
+  m_compiler.RetrieveWorkItems();
+  EXPECT_EQ(std::vector<int>({1, 3, 4, 5}), m_retrieved);
+
+  // Once retrieved, the key can be used again.
+  EXPECT_TRUE(m_compiler.QueueWorkItem(MakeItem(6), 100, &m_keys[0]));
+
+  // The same goes for queued work items.
+  BlockWorker();
+  EXPECT_TRUE(m_compiler.QueueWorkItem(MakeItem(7), 100, &m_keys[2]));
+  EXPECT_FALSE(m_compiler.QueueWorkItem(MakeItem(8), 100, &m_keys[2]));
+  m_release.Set();
+  WaitAndRetrieve();
+  EXPECT_EQ(std::vector<int>({1, 3, 4, 5, 6, 7}), m_retrieved);
+  EXPECT_NE(std::string::npos, m_compiler.StatisticsToString().find("merged: 2"));
+}
+
+TEST_F(AsyncShaderCompilerTest, CompilesBoostedWorkItemsFirst)
+{
+  BlockWorker();
+  m_compiler.QueueWorkItem(MakeItem(1), 300, &m_keys[0]);
+  m_compiler.QueueWorkItem(MakeItem(2), 200);
+  m_compiler.QueueWorkItem(MakeItem(3), 300, &m_keys[1]);
+  EXPECT_TRUE(m_compiler.BoostWorkItem(&m_keys[0], 100));
+  // Queueing a work item again with a lower priority boosts it as well.
+  EXPECT_FALSE(m_compiler.QueueWorkItem(MakeItem(4), 50, &m_keys[1]));
+  // Boosting never lowers the priority.
+  EXPECT_TRUE(m_compiler.BoostWorkItem(&m_keys[0], 400));
+  EXPECT_FALSE(m_compiler.BoostWorkItem(&m_keys[2], 100));
+
+  m_release.Set();
+  WaitAndRetrieve();
+  EXPECT_EQ(std::vector<int>({3, 1, 2}), m_compiled.Get());
+}
+
+TEST_F(AsyncShaderCompilerTest, CancelsQueuedWorkItems)
+{
+  BlockWorker();
+  m_compiler.QueueWorkItem(MakeItem(1), 100, &m_keys[0]);
+  m_compiler.QueueWorkItem(MakeItem(2), 100);
+
+  // Cancelling waits for the work item being compiled.
+  std::thread release_thread([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    m_release.Set();
+  });
+  m_compiler.CancelWorkItems();
+  release_thread.join();
+
+  EXPECT_FALSE(m_compiler.HasPendingWork());
+  EXPECT_FALSE(m_compiler.HasCompletedWork());
+  m_compiler.RetrieveWorkItems();
+  EXPECT_TRUE(m_compiled.Get().empty());
+  EXPECT_TRUE(m_retrieved.empty());
+
+  // Keys of cancelled work items can be used again.
+  EXPECT_TRUE(m_compiler.QueueWorkItem(MakeItem(3), 100, &m_keys[0]));
+  WaitAndRetrieve();
+  EXPECT_EQ(std::vector<int>({3}), m_retrieved);
+}
@@ -0,0 +1,102 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <picojson/picojson.h>
+
+#include "VideoCommon/BenchmarkRecorder.h"
+
+namespace
+{
+// Ten frames after the first one, nine of them 10 ms long and one 30 ms long, which spent 5 ms
+// loading vertices instead of 1 ms
+std::vector<BenchmarkRecorder::Frame> CreateFrames()
+{
+  std::vector<BenchmarkRecorder::Frame> frames(11);
+  u64 time = 1000;
+  for (size_t i = 0; i < frames.size(); i++)
+  {
+    BenchmarkRecorder::Frame& frame = frames[i];
+    std::memset(&frame.stats, 0, sizeof(frame.stats));
+    frame.stats.bytesFifoProcessed = 4096;
+    frame.stats.numPrims = 100;
+    frame.stats.numDLPrims = 50;
+    frame.stats.numDrawCalls = 3;
+    frame.stage_times[static_cast<size_t>(StageTimings::Stage::VertexLoad)] =
+        i == 4 ? 5000 : 1000;
+
+    if (i != 0)
+      time += i == 4 ? 30000 : 10000;
+    frame.end_time = time;
+  }
+  return frames;
+}
+}  // namespace
+
+TEST(BenchmarkRecorder, Summarize)
+{
+  const BenchmarkRecorder::Summary summary = BenchmarkRecorder::Summarize(CreateFrames());
+
+  EXPECT_EQ(10u, summary.num_frames);
+  EXPECT_DOUBLE_EQ(0.12, summary.total_time);
+  EXPECT_DOUBLE_EQ(12.0, summary.frame_time_mean);
+  EXPECT_DOUBLE_EQ(10.0, summary.frame_time_min);
+  EXPECT_DOUBLE_EQ(10.0, summary.frame_time_p50);
+  EXPECT_DOUBLE_EQ(10.0, summary.frame_time_p90);
+  EXPECT_DOUBLE_EQ(30.0, summary.frame_time_p99);
+  EXPECT_DOUBLE_EQ(30.0, summary.frame_time_max);
+
+  EXPECT_DOUBLE_EQ(10 / 0.12, summary.frames_per_second);
+  EXPECT_DOUBLE_EQ(4096 * 10 / 0.12, summary.fifo_bytes_per_second);
+  EXPECT_DOUBLE_EQ(150 * 10 / 0.12, summary.vertices_per_second);
+
+  ASSERT_EQ(StageTimings::NUM_STAGES, summary.stage_times.size());
+  const StageTimings::StageSummary& vertex_load =
+      summary.stage_times[static_cast<size_t>(StageTimings::Stage::VertexLoad)];
+  EXPECT_STREQ("vertex_load", vertex_load.name);
+  EXPECT_DOUBLE_EQ(1.4, vertex_load.mean);
+  EXPECT_DOUBLE_EQ(1.0, vertex_load.p90);
+  EXPECT_DOUBLE_EQ(5.0, vertex_load.p99);
+  EXPECT_EQ(0.0, summary.stage_times[static_cast<size_t>(StageTimings::Stage::Present)].max);
+}
+
+TEST(BenchmarkRecorder, SummarizeWithoutFrames)
+{
+  const BenchmarkRecorder::Summary summary =
+      BenchmarkRecorder::Summarize(std::vector<BenchmarkRecorder::Frame>(1));
+
+  EXPECT_EQ(0u, summary.num_frames);
+  EXPECT_EQ(0.0, summary.frames_per_second);
+  EXPECT_TRUE(summary.averages.empty());
+}
+
+TEST(BenchmarkRecorder, SummaryToJSON)
+{
+  const BenchmarkRecorder::Summary summary = BenchmarkRecorder::Summarize(CreateFrames());
+  const std::string json =
+      BenchmarkRecorder::SummaryToJSON(summary, {{"video_backend", "Null"}});
+
+  picojson::value value;
+  ASSERT_EQ("", picojson::parse(value, json));
+  ASSERT_TRUE(value.is<picojson::object>());
+
+  EXPECT_EQ("Null", value.get("video_backend").get<std::string>());
+  EXPECT_EQ(10.0, value.get("frames").get<double>());
+  EXPECT_DOUBLE_EQ(10 / 0.12, value.get("fps").get<double>());
+  EXPECT_EQ(30.0, value.get("frame_time_ms").get("p99").get<double>());
+
+  const picojson::value& per_frame = value.get("per_frame");
+  EXPECT_EQ(4096.0, per_frame.get("fifo_bytes").get<double>());
+  EXPECT_EQ(150.0, per_frame.get("vertices").get<double>());
+  EXPECT_EQ(3.0, per_frame.get("draw_calls").get<double>());
+
+  const picojson::value& stage_times = value.get("stage_time_ms");
+  EXPECT_EQ(5.0, stage_times.get("vertex_load").get("max").get<double>());
+  EXPECT_EQ(0.0, stage_times.get("present").get("p50").get<double>());
+}
@@ -0,0 +1,85 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/FrameDumpConversion.h"
+
+namespace
+{
+class Random
+{
+public:
+  u32 operator()(u32 range)
+  {
+    m_seed = m_seed * 1103515245 + 12345;
+    return (m_seed >> 8) % range;
+  }
+
+private:
+  u32 m_seed = 1;
+};
+
+struct YUV420Image
+{
+  YUV420Image(int width, int height)
+      : y(width * height), u((width + 1) / 2 * ((height + 1) / 2)), v(u.size()),
+        planes{y.data(), u.data(), v.data(), width, (width + 1) / 2, (width + 1) / 2}
+  {
+  }
+
+  std::vector<u8> y;
+  std::vector<u8> u;
+  std::vector<u8> v;
+  FrameDumpConversion::YUV420Planes planes;
+};
+}  // namespace
+
+TEST(FrameDumpConversion, ConvertsBlackAndWhite)
+{
+  const std::vector<u8> rgba = {0, 0, 0, 255, 0, 0, 0, 255, 255, 255, 255, 255, 255, 255, 255, 255};
+  YUV420Image image(2, 2);
+  FrameDumpConversion::ConvertRGBAToYUV420(rgba.data(), 8, 2, 2, image.planes, 0, 2);
+
+  EXPECT_EQ((std::vector<u8>{16, 16, 235, 235}), image.y);
+  EXPECT_EQ(128, image.u[0]);
+  EXPECT_EQ(128, image.v[0]);
+}
+
+TEST(FrameDumpConversion, SIMDMatchesGeneric)
+{
+  Random random;
+  for (int iteration = 0; iteration < 50; iteration++)
+  {
+    // Odd sizes now and then, and widths which aren't a multiple of the SIMD width
+    const int width = 1 + random(100);
+    const int height = 1 + random(40);
+    const int src_stride = width * 4 + random(3) * 4;
+    std::vector<u8> rgba(src_stride * height);
+    for (u8& byte : rgba)
+      byte = static_cast<u8>(random(256));
+
+    YUV420Image expected(width, height);
+    FrameDumpConversion::ConvertRGBAToYUV420Generic(rgba.data(), src_stride, width, height,
+                                                    expected.planes, 0, height);
+
+    // Converting the image in bands has to give the same result as converting it at once.
+    YUV420Image actual(width, height);
+    const int band_height = 2 * (1 + random(8));
+    for (int first_row = 0; first_row < height; first_row += band_height)
+    {
+      FrameDumpConversion::ConvertRGBAToYUV420(rgba.data(), src_stride, width, height,
+                                               actual.planes, first_row,
+                                               std::min(first_row + band_height, height));
+    }
+
+    ASSERT_EQ(expected.y, actual.y) << width << "x" << height;
+    ASSERT_EQ(expected.u, actual.u) << width << "x" << height;
+    ASSERT_EQ(expected.v, actual.v) << width << "x" << height;
+  }
+}
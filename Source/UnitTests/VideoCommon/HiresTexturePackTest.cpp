@@ -0,0 +1,108 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/HiresTexturePack.h"
+
+using VideoCommon::HiresTexturePack;
+using VideoCommon::HiresTexturePackWriter;
+
+class HiresTexturePackTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = File::CreateTempDir();
+    m_filename = m_directory + "/test" + HiresTexturePack::EXTENSION;
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_directory); }
+
+  static HiresTexturePack::Level MakeLevel(const std::vector<u8>& data, u32 width)
+  {
+    return {AbstractTextureFormat::RGBA8, width, width, width, data.data(), data.size()};
+  }
+
+  static bool Matches(const HiresTexturePack::Level& level, const std::vector<u8>& data)
+  {
+    return level.size == data.size() && std::memcmp(level.data, data.data(), data.size()) == 0;
+  }
+
+  void WritePack()
+  {
+    HiresTexturePackWriter writer;
+    ASSERT_TRUE(writer.Open(m_filename));
+    ASSERT_TRUE(writer.AddTexture("tex1_8x8_first", {MakeLevel(m_first, 8), MakeLevel(m_mip, 4)},
+                                  false));
+    ASSERT_TRUE(writer.AddTexture("tex1_4x4_second", {MakeLevel(m_second, 4)}, true));
+    EXPECT_EQ(2u, writer.GetTextureCount());
+    ASSERT_TRUE(writer.Finish());
+  }
+
+  std::string m_directory;
+  std::string m_filename;
+  const std::vector<u8> m_first = std::vector<u8>(8 * 8 * 4, 1);
+  const std::vector<u8> m_mip = std::vector<u8>(4 * 4 * 4, 2);
+  const std::vector<u8> m_second = std::vector<u8>(4 * 4 * 4, 3);
+};
+
+TEST_F(HiresTexturePackTest, ReadsWrittenTextures)
+{
+  WritePack();
+
+  HiresTexturePack pack;
+  ASSERT_TRUE(pack.Open(m_filename));
+  EXPECT_EQ(2u, pack.GetTextureNames().size());
+
+  std::vector<HiresTexturePack::Level> levels;
+  bool has_arbitrary_mipmaps = true;
+  ASSERT_TRUE(pack.GetTexture("tex1_8x8_first", &levels, &has_arbitrary_mipmaps));
+  EXPECT_FALSE(has_arbitrary_mipmaps);
+  ASSERT_EQ(2u, levels.size());
+  EXPECT_EQ(AbstractTextureFormat::RGBA8, levels[0].format);
+  EXPECT_EQ(8u, levels[0].width);
+  EXPECT_EQ(4u, levels[1].height);
+  EXPECT_TRUE(Matches(levels[0], m_first));
+  EXPECT_TRUE(Matches(levels[1], m_mip));
+
+  ASSERT_TRUE(pack.GetTexture("tex1_4x4_second", &levels, &has_arbitrary_mipmaps));
+  EXPECT_TRUE(has_arbitrary_mipmaps);
+  ASSERT_EQ(1u, levels.size());
+  EXPECT_TRUE(Matches(levels[0], m_second));
+
+  EXPECT_FALSE(pack.GetTexture("tex1_4x4_third", &levels, &has_arbitrary_mipmaps));
+}
+
+TEST_F(HiresTexturePackTest, RejectsDamagedFiles)
+{
+  HiresTexturePack pack;
+  EXPECT_FALSE(pack.Open(m_filename));
+
+  ASSERT_TRUE(File::WriteStringToFile("not a texture pack", m_filename));
+  EXPECT_FALSE(pack.Open(m_filename));
+
+  // Cutting off the index leaves it pointing outside of the file.
+  WritePack();
+  {
+    File::IOFile file(m_filename, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 8));
+  }
+  EXPECT_FALSE(pack.Open(m_filename));
+  EXPECT_TRUE(pack.GetTextureNames().empty());
+
+  // A level with less data than its size needs would be read past its end on upload.
+  HiresTexturePackWriter writer;
+  ASSERT_TRUE(writer.Open(m_filename));
+  ASSERT_TRUE(writer.AddTexture("tex1_8x8_short", {MakeLevel(m_mip, 8)}, false));
+  ASSERT_TRUE(writer.Finish());
+  EXPECT_FALSE(pack.Open(m_filename));
+}
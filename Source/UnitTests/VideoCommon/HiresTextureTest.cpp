@@ -0,0 +1,200 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "UICommon/UICommon.h"
+#include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoConfig.h"
+
+class HiresTextureTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    s_texture_directory =
+        File::GetUserPath(D_HIRESTEXTURES_IDX) + SConfig::GetInstance().GetGameID() + "/";
+    File::CreateFullPath(s_texture_directory);
+
+    g_ActiveConfig.bHiresTextures = true;
+    g_ActiveConfig.bCacheHiresTextures = false;
+    g_ActiveConfig.bStreamHiresTextures = true;
+    g_ActiveConfig.iHiresTextureCacheSize = 1;
+  }
+
+  void TearDown() override
+  {
+    HiresTexture::Shutdown();
+    g_ActiveConfig.bHiresTextures = false;
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  static std::vector<u8> MakeNativeTexture(u8 seed) { return std::vector<u8>(64, seed); }
+
+  static std::string GetBaseName(const std::vector<u8>& native)
+  {
+    return HiresTexture::GenBaseName(native.data(), native.size(), nullptr, 0, 4, 4,
+                                     TextureFormat::RGBA8, false, true);
+  }
+
+  static void AddCustomTexture(const std::vector<u8>& native, u32 size)
+  {
+    const std::vector<u8> data(size * size * 4, native[0]);
+    ASSERT_TRUE(TextureToPng(data.data(), size * 4,
+                             s_texture_directory + GetBaseName(native) + ".png", size, size));
+  }
+
+  static std::shared_ptr<HiresTexture> Search(const std::vector<u8>& native,
+                                              std::string* pending_name = nullptr)
+  {
+    return HiresTexture::Search(native.data(), native.size(), nullptr, 0, 4, 4,
+                                TextureFormat::RGBA8, false, pending_name);
+  }
+
+  // Searches for the texture until it has been loaded, like the texture cache does.
+  static std::shared_ptr<HiresTexture> SearchUntilLoaded(const std::vector<u8>& native)
+  {
+    std::string pending_name;
+    std::shared_ptr<HiresTexture> texture = Search(native, &pending_name);
+    if (texture || pending_name.empty())
+      return texture;
+
+    for (int i = 0; i < 5000 && !HiresTexture::IsReady(pending_name); ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return Search(native);
+  }
+
+  static std::string s_texture_directory;
+
+private:
+  std::string m_profile_path;
+};
+
+std::string HiresTextureTest::s_texture_directory;
+
+TEST_F(HiresTextureTest, StreamsTexturesInTheBackground)
+{
+  const std::vector<u8> native = MakeNativeTexture(1);
+  const std::vector<u8> broken = MakeNativeTexture(2);
+  AddCustomTexture(native, 8);
+  ASSERT_TRUE(
+      File::WriteStringToFile("not a png", s_texture_directory + GetBaseName(broken) + ".png"));
+  HiresTexture::Init();
+
+  std::string pending_name;
+  EXPECT_EQ(nullptr, Search(native, &pending_name));
+  EXPECT_EQ(GetBaseName(native), pending_name);
+
+  const std::shared_ptr<HiresTexture> texture = SearchUntilLoaded(native);
+  ASSERT_NE(nullptr, texture);
+  ASSERT_EQ(1u, texture->m_levels.size());
+  EXPECT_EQ(8u, texture->m_levels[0].width);
+  EXPECT_EQ(8u, texture->m_levels[0].height);
+
+  // Textures which fail to load, or which have no replacement, aren't pending.
+  EXPECT_EQ(nullptr, SearchUntilLoaded(broken));
+  pending_name.clear();
+  EXPECT_EQ(nullptr, Search(broken, &pending_name));
+  EXPECT_EQ(nullptr, Search(MakeNativeTexture(3), &pending_name));
+  EXPECT_TRUE(pending_name.empty());
+
+  const HiresTexture::Statistics statistics = HiresTexture::GetStatistics();
+  EXPECT_EQ(1u, statistics.loads);
+  EXPECT_EQ(1u, statistics.failed_loads);
+  EXPECT_LE(2u, statistics.misses);
+  EXPECT_EQ(1u, statistics.hits);
+  EXPECT_EQ(8u * 8 * 4, statistics.cache_size);
+}
+
+TEST_F(HiresTextureTest, EvictsLeastRecentlyUsedTextures)
+{
+  // Each texture takes a quarter of the 1 MiB limit.
+  std::vector<std::vector<u8>> natives;
+  for (u8 i = 0; i < 5; ++i)
+  {
+    natives.push_back(MakeNativeTexture(i + 1));
+    AddCustomTexture(natives.back(), 256);
+  }
+  HiresTexture::Init();
+
+  for (size_t i = 0; i < 4; ++i)
+    ASSERT_NE(nullptr, SearchUntilLoaded(natives[i]));
+  EXPECT_EQ(0u, HiresTexture::GetStatistics().evictions);
+
+  // Using the first texture again makes the second one the least recently used.
+  ASSERT_NE(nullptr, Search(natives[0]));
+  ASSERT_NE(nullptr, SearchUntilLoaded(natives[4]));
+  EXPECT_EQ(1u, HiresTexture::GetStatistics().evictions);
+
+  std::string pending_name;
+  EXPECT_NE(nullptr, Search(natives[0]));
+  EXPECT_NE(nullptr, Search(natives[2]));
+  EXPECT_EQ(nullptr, Search(natives[1], &pending_name));
+  EXPECT_EQ(GetBaseName(natives[1]), pending_name);
+  EXPECT_LE(HiresTexture::GetStatistics().cache_size, 1024u * 1024);
+}
+
+TEST_F(HiresTextureTest, LoadsRightAwayWithoutStreaming)
+{
+  g_ActiveConfig.bStreamHiresTextures = false;
+  const std::vector<u8> native = MakeNativeTexture(1);
+  AddCustomTexture(native, 4);
+  HiresTexture::Init();
+
+  std::string pending_name;
+  const std::shared_ptr<HiresTexture> texture = Search(native, &pending_name);
+  ASSERT_NE(nullptr, texture);
+  EXPECT_EQ(4u, texture->m_levels[0].width);
+  EXPECT_TRUE(pending_name.empty());
+  EXPECT_EQ(texture, Search(native));
+}
+
+TEST_F(HiresTextureTest, LoadsPackedTexturesRightAway)
+{
+  const std::vector<u8> native = MakeNativeTexture(1);
+  AddCustomTexture(native, 8);
+
+  HiresTexture::Init();
+  const std::shared_ptr<HiresTexture> loose = SearchUntilLoaded(native);
+  ASSERT_NE(nullptr, loose);
+  const std::vector<u8> loose_data = loose->m_levels[0].data;
+  HiresTexture::Shutdown();
+
+  size_t texture_count = 0;
+  ASSERT_TRUE(HiresTexture::WritePack(s_texture_directory, s_texture_directory + "pack.dtp",
+                                      &texture_count));
+  EXPECT_EQ(1u, texture_count);
+  ASSERT_TRUE(File::Delete(s_texture_directory + GetBaseName(native) + ".png"));
+  HiresTexture::Init();
+
+  // Packed textures are mapped instead of being streamed.
+  std::string pending_name;
+  const std::shared_ptr<HiresTexture> texture = Search(native, &pending_name);
+  ASSERT_NE(nullptr, texture);
+  EXPECT_TRUE(pending_name.empty());
+  ASSERT_EQ(1u, texture->m_levels.size());
+  EXPECT_EQ(8u, texture->m_levels[0].width);
+  EXPECT_TRUE(texture->m_levels[0].data.empty());
+  ASSERT_EQ(loose_data.size(), texture->m_levels[0].GetSize());
+  EXPECT_TRUE(std::equal(loose_data.begin(), loose_data.end(), texture->m_levels[0].GetData()));
+}
@@ -0,0 +1,107 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+constexpr u32 MAX_VERTICES = 65535;
+
+std::vector<u16> GenerateIndices(bool vectorized, int primitive, u32 num_vertices, u32 base)
+{
+  std::vector<u16> indices(MAX_VERTICES * 3 + 16);
+  IndexGenerator::Init(vectorized);
+  IndexGenerator::Start(indices.data());
+  // Offset the batch so that the base index is taken into account.
+  IndexGenerator::AddIndices(OpcodeDecoder::GX_DRAW_POINTS, base);
+  const u32 first_index = IndexGenerator::GetIndexLen();
+  IndexGenerator::AddIndices(primitive, num_vertices);
+  indices.resize(IndexGenerator::GetIndexLen());
+  indices.erase(indices.begin(), indices.begin() + first_index);
+  return indices;
+}
+
+const char* const primitive_names[] = {"quads",     "quads_2", "triangles",  "triangle_strip",
+                                       "triangle_fan", "lines", "line_strip", "points"};
+}  // namespace
+
+class IndexGeneratorTest : public ::testing::TestWithParam<std::tuple<int, bool>>
+{
+protected:
+  void SetUp() override
+  {
+    std::tie(m_primitive, m_primitive_restart) = GetParam();
+    g_Config.backend_info.bSupportsPrimitiveRestart = m_primitive_restart;
+  }
+
+  void TearDown() override
+  {
+    g_Config.backend_info.bSupportsPrimitiveRestart = false;
+    IndexGenerator::Init();
+  }
+
+  int m_primitive;
+  bool m_primitive_restart;
+};
+
+INSTANTIATE_TEST_CASE_P(AllPrimitives, IndexGeneratorTest,
+                        ::testing::Combine(::testing::Values(OpcodeDecoder::GX_DRAW_QUADS,
+                                                             OpcodeDecoder::GX_DRAW_QUADS_2,
+                                                             OpcodeDecoder::GX_DRAW_TRIANGLES,
+                                                             OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP,
+                                                             OpcodeDecoder::GX_DRAW_TRIANGLE_FAN),
+                                           ::testing::Bool()));
+
+TEST_P(IndexGeneratorTest, MatchesScalar)
+{
+  std::vector<u32> counts;
+  for (u32 i = 0; i < 100; i++)
+    counts.push_back(i);
+  counts.push_back(1000);
+  counts.push_back(1001);
+  counts.push_back(1002);
+  counts.push_back(1003);
+  counts.push_back(30000);
+
+  for (u32 base : {0u, 7u, 1234u})
+  {
+    for (u32 count : counts)
+    {
+      const std::vector<u16> scalar = GenerateIndices(false, m_primitive, count, base);
+      const std::vector<u16> vectorized = GenerateIndices(true, m_primitive, count, base);
+      EXPECT_EQ(scalar, vectorized) << "vertices: " << count << ", base: " << base;
+    }
+  }
+}
+
+TEST_P(IndexGeneratorTest, DISABLED_Speed)
+{
+  std::vector<u16> indices(MAX_VERTICES * 3 + 16);
+  for (bool vectorized : {false, true})
+  {
+    IndexGenerator::Init(vectorized);
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 2000; ++i)
+    {
+      IndexGenerator::Start(indices.data());
+      IndexGenerator::AddIndices(m_primitive, 60000);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    printf("%s, primitive restart: %d, %s: %lld us\n", primitive_names[m_primitive],
+           m_primitive_restart, vectorized ? "vectorized" : "scalar",
+           static_cast<long long>(
+               std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+  }
+}
@@ -0,0 +1,181 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/ShaderDiskCache.h"
+
+using VideoCommon::ShaderDiskCache;
+
+class ShaderDiskCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = File::CreateTempDir();
+    m_filename = m_directory + "/shaders.cache";
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_directory); }
+
+  static std::vector<u8> MakeData(size_t size, u8 seed)
+  {
+    std::vector<u8> data(size);
+    for (size_t i = 0; i < size; ++i)
+      data[i] = static_cast<u8>(seed + i * 13);
+    return data;
+  }
+
+  static bool Matches(ShaderDiskCache& cache, u32 tag, u64 key, const std::vector<u8>& data)
+  {
+    size_t size = 0;
+    const u8* cached = cache.Lookup(tag, key, &size);
+    return cached && size == data.size() && std::memcmp(cached, data.data(), size) == 0;
+  }
+
+  std::string ReadFile() const
+  {
+    std::string contents;
+    File::ReadFileToString(m_filename, contents);
+    return contents;
+  }
+
+  void WriteFile(const std::string& contents) const
+  {
+    ASSERT_TRUE(File::WriteStringToFile(contents, m_filename));
+  }
+
+  std::string m_directory;
+  std::string m_filename;
+};
+
+TEST_F(ShaderDiskCacheTest, StoresAcrossSessions)
+{
+  const std::vector<u8> first = MakeData(300, 1);
+  const std::vector<u8> second = MakeData(45, 2);
+
+  ShaderDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename));
+  cache.Append(0, u64{1}, first.data(), first.size());
+  cache.Append(1, u64{1}, second.data(), second.size());
+  // Records written in this session can be looked up too.
+  EXPECT_TRUE(Matches(cache, 0, 1, first));
+  cache.Close();
+
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_EQ(2u, cache.GetEntryCount());
+  EXPECT_TRUE(Matches(cache, 0, 1, first));
+  EXPECT_TRUE(Matches(cache, 1, 1, second));
+
+  // Tags and keys both have to match.
+  size_t size;
+  EXPECT_EQ(nullptr, cache.Lookup(2, u64{1}, &size));
+  EXPECT_EQ(nullptr, cache.Lookup(0, u64{2}, &size));
+  EXPECT_EQ(nullptr, cache.Lookup(0, u32{1}, &size));
+}
+
+TEST_F(ShaderDiskCacheTest, ScansRecordsWithoutAnIndex)
+{
+  const std::vector<u8> first = MakeData(100, 3);
+  const std::vector<u8> second = MakeData(200, 4);
+
+  ShaderDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename));
+  cache.Append(0, u64{1}, first.data(), first.size());
+  cache.Close();
+  const std::string one_record = ReadFile();
+
+  ASSERT_TRUE(cache.Open(m_filename));
+  cache.Append(0, u64{2}, second.data(), second.size());
+  cache.Close();
+
+  // Damage the index, as if Dolphin had crashed while writing it.
+  std::string contents = ReadFile();
+  contents[contents.size() - 1] ^= 0xFF;
+  WriteFile(contents.substr(0, contents.size() - 1));
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_TRUE(Matches(cache, 0, 1, first));
+  EXPECT_TRUE(Matches(cache, 0, 2, second));
+  cache.Close();
+
+  // Files which were never closed have no index at all.
+  WriteFile(one_record.substr(0, one_record.find(std::string(first.begin(), first.end())) +
+                                     first.size() + 4));
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_EQ(1u, cache.GetEntryCount());
+  EXPECT_TRUE(Matches(cache, 0, 1, first));
+}
+
+TEST_F(ShaderDiskCacheTest, DropsDamagedRecords)
+{
+  const std::vector<u8> first = MakeData(64, 5);
+  const std::vector<u8> second = MakeData(64, 6);
+
+  ShaderDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename));
+  cache.Append(0, u64{1}, first.data(), first.size());
+  cache.Append(0, u64{2}, second.data(), second.size());
+  cache.Close();
+
+  // The index is fine, so the damage is only noticed once the binary is used.
+  std::string contents = ReadFile();
+  contents[contents.find(std::string(first.begin(), first.end())) + 10] ^= 0x55;
+  WriteFile(contents);
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_EQ(2u, cache.GetEntryCount());
+  size_t size;
+  EXPECT_EQ(nullptr, cache.Lookup(0, u64{1}, &size));
+  EXPECT_TRUE(Matches(cache, 0, 2, second));
+  EXPECT_EQ(1u, cache.GetEntryCount());
+
+  // The record can be written again.
+  cache.Append(0, u64{1}, first.data(), first.size());
+  cache.Close();
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_TRUE(Matches(cache, 0, 1, first));
+}
+
+TEST_F(ShaderDiskCacheTest, CompactsReplacedRecords)
+{
+  const std::vector<u8> old_data = MakeData(4096, 7);
+  const std::vector<u8> new_data = MakeData(1024, 8);
+  const std::vector<u8> other_data = MakeData(1024, 9);
+
+  ShaderDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename));
+  cache.Append(0, u64{1}, old_data.data(), old_data.size());
+  cache.Append(0, u64{2}, other_data.data(), other_data.size());
+  cache.Append(0, u64{1}, new_data.data(), new_data.size());
+  EXPECT_LT(4096u, cache.GetUnusedSize());
+  cache.Close();
+
+  EXPECT_GT(4096u, ReadFile().size());
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_EQ(0u, cache.GetUnusedSize());
+  EXPECT_EQ(2u, cache.GetEntryCount());
+  EXPECT_TRUE(Matches(cache, 0, 1, new_data));
+  EXPECT_TRUE(Matches(cache, 0, 2, other_data));
+}
+
+TEST_F(ShaderDiskCacheTest, ReplacesFilesFromOtherVersions)
+{
+  WriteFile("not a shader cache");
+  ShaderDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_EQ(0u, cache.GetEntryCount());
+
+  const std::vector<u8> data = MakeData(32, 10);
+  cache.Append(0, u64{1}, data.data(), data.size());
+  cache.Close();
+  ASSERT_TRUE(cache.Open(m_filename));
+  EXPECT_TRUE(Matches(cache, 0, 1, data));
+}
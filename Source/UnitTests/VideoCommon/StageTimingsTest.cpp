@@ -0,0 +1,94 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <picojson/picojson.h>
+
+#include "VideoCommon/StageTimings.h"
+
+namespace
+{
+constexpr size_t Index(StageTimings::Stage stage)
+{
+  return static_cast<size_t>(stage);
+}
+}  // namespace
+
+TEST(StageTimings, NestedStagesAreExclusive)
+{
+  StageTimings::SetBenchmarking(true);
+  {
+    StageTimings::ScopedTimer decode(StageTimings::Stage::OpcodeDecode);
+    StageTimings::ScopedTimer load(StageTimings::Stage::VertexLoad);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  {
+    StageTimings::ScopedTimer disabled(StageTimings::Stage::Present, false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  StageTimings::OnFramePresented();
+  StageTimings::SetBenchmarking(false);
+
+  const StageTimings::Times times = StageTimings::GetLastFrame().times;
+  EXPECT_GE(times[Index(StageTimings::Stage::VertexLoad)], 20000.0);
+  EXPECT_LT(times[Index(StageTimings::Stage::OpcodeDecode)],
+            times[Index(StageTimings::Stage::VertexLoad)]);
+  EXPECT_EQ(0.0, times[Index(StageTimings::Stage::Present)]);
+  EXPECT_FALSE(StageTimings::GetFrames().empty());
+}
+
+TEST(StageTimings, Summarize)
+{
+  std::vector<StageTimings::Times> frames(4);
+  for (size_t i = 0; i < frames.size(); i++)
+    frames[i][Index(StageTimings::Stage::TextureLoad)] = (i + 1) * 1000.0;
+
+  const std::vector<StageTimings::StageSummary> summaries = StageTimings::Summarize(frames);
+  ASSERT_EQ(StageTimings::NUM_STAGES, summaries.size());
+
+  const StageTimings::StageSummary& texture_load =
+      summaries[Index(StageTimings::Stage::TextureLoad)];
+  EXPECT_STREQ("texture_load", texture_load.name);
+  EXPECT_DOUBLE_EQ(2.5, texture_load.mean);
+  EXPECT_DOUBLE_EQ(2.0, texture_load.p50);
+  EXPECT_DOUBLE_EQ(4.0, texture_load.p90);
+  EXPECT_DOUBLE_EQ(4.0, texture_load.max);
+  EXPECT_EQ(0.0, summaries[Index(StageTimings::Stage::BackendDraw)].max);
+}
+
+TEST(StageTimings, FramesToCSV)
+{
+  StageTimings::Frame frame = {};
+  frame.end_time = 1234;
+  frame.times[Index(StageTimings::Stage::BackendDraw)] = 56.5;
+
+  EXPECT_EQ("end_time_us,opcode_decode_us,vertex_load_us,texture_load_us,shader_lookup_us,"
+            "backend_draw_us,present_us\n"
+            "1234,0,0,0,0,56.5,0\n",
+            StageTimings::FramesToCSV({frame}));
+}
+
+TEST(StageTimings, Trace)
+{
+  StageTimings::StartTrace();
+  {
+    StageTimings::ScopedTimer timer(StageTimings::Stage::ShaderLookup);
+  }
+  StageTimings::OnFramePresented();
+  const std::string trace = StageTimings::StopTrace();
+
+  picojson::value value;
+  ASSERT_EQ("", picojson::parse(value, trace));
+  const picojson::array& events = value.get("traceEvents").get<picojson::array>();
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ("shader_lookup", events[0].get("name").get<std::string>());
+  EXPECT_EQ("X", events[0].get("ph").get<std::string>());
+  EXPECT_EQ("frame", events[1].get("name").get<std::string>());
+}
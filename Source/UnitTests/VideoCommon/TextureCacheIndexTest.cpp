@@ -0,0 +1,382 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/TextureCacheIndex.h"
+
+namespace
+{
+struct FakeEntry
+{
+  u32 addr;
+  u32 size;
+  u64 hash;
+};
+
+u32 RangeEnd(const FakeEntry* entry)
+{
+  return entry->addr + std::max<u32>(entry->size, 1);
+}
+
+// The multimap based lookups the texture cache used before, including the 4 MiB look-behind for
+// overlap queries.
+class MultimapIndex
+{
+public:
+  void Insert(FakeEntry* entry)
+  {
+    m_by_address.emplace(entry->addr, entry);
+    m_by_hash.emplace(entry->hash, entry);
+  }
+
+  void Erase(FakeEntry* entry)
+  {
+    auto range = m_by_address.equal_range(entry->addr);
+    m_by_address.erase(std::find_if(range.first, range.second,
+                                    [&](const auto& pair) { return pair.second == entry; }));
+    auto hash_range = m_by_hash.equal_range(entry->hash);
+    m_by_hash.erase(std::find_if(hash_range.first, hash_range.second,
+                                 [&](const auto& pair) { return pair.second == entry; }));
+  }
+
+  std::vector<FakeEntry*> FindAt(u32 address) const
+  {
+    std::vector<FakeEntry*> result;
+    auto range = m_by_address.equal_range(address);
+    for (auto it = range.first; it != range.second; ++it)
+      result.push_back(it->second);
+    return result;
+  }
+
+  std::vector<FakeEntry*> FindOverlapping(u32 address, u32 size) const
+  {
+    constexpr u32 max_texture_size = 1024 * 1024 * 4;
+    const u32 end = address + std::max<u32>(size, 1);
+    const u32 lower_addr = address > max_texture_size ? address - max_texture_size : 0;
+    std::vector<FakeEntry*> result;
+    for (auto it = m_by_address.lower_bound(lower_addr);
+         it != m_by_address.upper_bound(address + size); ++it)
+    {
+      if (it->second->addr < end && RangeEnd(it->second) > address)
+        result.push_back(it->second);
+    }
+    return result;
+  }
+
+  FakeEntry* FindByHash(u64 hash, u32 size) const
+  {
+    auto range = m_by_hash.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+      if (it->second->size == size)
+        return it->second;
+    }
+    return nullptr;
+  }
+
+private:
+  std::multimap<u32, FakeEntry*> m_by_address;
+  std::multimap<u64, FakeEntry*> m_by_hash;
+};
+
+class FlatIndex
+{
+public:
+  void Insert(FakeEntry* entry)
+  {
+    m_by_address.Insert(entry, entry->addr, entry->size);
+    m_by_hash.Add(entry->hash, entry);
+  }
+
+  void Erase(FakeEntry* entry)
+  {
+    m_by_address.Erase(entry, entry->addr);
+    m_by_hash.Remove(entry->hash, [&](const FakeEntry* other) { return other == entry; });
+  }
+
+  std::vector<FakeEntry*> FindAt(u32 address) const
+  {
+    std::vector<FakeEntry*> result;
+    for (FakeEntry* entry : m_by_address.At(address))
+      result.push_back(entry);
+    return result;
+  }
+
+  std::vector<FakeEntry*> FindOverlapping(u32 address, u32 size) const
+  {
+    return m_by_address.FindOverlapping(address, size);
+  }
+
+  FakeEntry* FindByHash(u64 hash, u32 size) const
+  {
+    if (const auto* list = m_by_hash.Find(hash))
+    {
+      for (FakeEntry* entry : *list)
+      {
+        if (entry->size == size)
+          return entry;
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  VideoCommon::PagedRangeIndex<FakeEntry*> m_by_address;
+  VideoCommon::FlatMultiIndex<u64, FakeEntry*> m_by_hash;
+};
+
+enum class OpType
+{
+  Insert,
+  Erase,
+  FindAt,
+  FindOverlapping,
+  FindByHash,
+};
+
+struct Op
+{
+  OpType type;
+  u32 address;
+  u32 size;
+  u64 hash;
+  size_t entry;
+};
+
+// A frame-like mix of texture loads, EFB copies and evictions. Most textures are small, a few
+// are large render targets, and many addresses and hashes are reused.
+std::vector<Op> GenerateWorkload(std::vector<FakeEntry>* entries, size_t num_ops)
+{
+  std::mt19937 rng(1234);
+  std::vector<Op> ops;
+  std::vector<size_t> live;
+  const u32 num_slots = 4096;
+  entries->reserve(num_ops);
+
+  for (size_t i = 0; i < num_ops; i++)
+  {
+    const u32 roll = rng() % 100;
+    if (roll < 30 || live.empty())
+    {
+      const u32 address = (rng() % num_slots) * 0x2000;
+      const u32 size = roll < 2 ? 640 * 528 * 2 : 32u << (rng() % 9);
+      entries->push_back({address, size, rng() % 2048});
+      live.push_back(entries->size() - 1);
+      ops.push_back({OpType::Insert, address, size, 0, entries->size() - 1});
+    }
+    else if (roll < 45)
+    {
+      const size_t index = rng() % live.size();
+      ops.push_back({OpType::Erase, 0, 0, 0, live[index]});
+      live[index] = live.back();
+      live.pop_back();
+    }
+    else if (roll < 80)
+    {
+      ops.push_back({OpType::FindAt, (*entries)[live[rng() % live.size()]].addr, 0, 0, 0});
+    }
+    else if (roll < 90)
+    {
+      const u32 address = static_cast<u32>((rng() % num_slots) * 0x2000 + (rng() % 0x2000));
+      ops.push_back({OpType::FindOverlapping, address, 32u << (rng() % 15), 0, 0});
+    }
+    else
+    {
+      ops.push_back({OpType::FindByHash, 0, 32u << (rng() % 9), rng() % 2048, 0});
+    }
+  }
+  return ops;
+}
+
+template <typename Range>
+std::vector<int> Collect(const Range& range)
+{
+  std::vector<int> values;
+  for (int value : range)
+    values.push_back(value);
+  return values;
+}
+
+template <typename Index>
+u64 Replay(Index* index, std::vector<FakeEntry>* entries, const std::vector<Op>& ops,
+           std::vector<std::vector<FakeEntry*>>* results)
+{
+  u64 checksum = 0;
+  for (const Op& op : ops)
+  {
+    switch (op.type)
+    {
+    case OpType::Insert:
+      index->Insert(&(*entries)[op.entry]);
+      break;
+    case OpType::Erase:
+      index->Erase(&(*entries)[op.entry]);
+      break;
+    case OpType::FindAt:
+    case OpType::FindOverlapping:
+    {
+      auto found = op.type == OpType::FindAt ? index->FindAt(op.address) :
+                                               index->FindOverlapping(op.address, op.size);
+      checksum += found.size();
+      if (results)
+        results->push_back(std::move(found));
+      break;
+    }
+    case OpType::FindByHash:
+    {
+      FakeEntry* found = index->FindByHash(op.hash, op.size);
+      checksum += found != nullptr;
+      if (results)
+        results->push_back({found});
+      break;
+    }
+    }
+  }
+  return checksum;
+}
+}  // namespace
+
+TEST(TextureCacheIndex, FlatMultiIndexKeepsInsertionOrder)
+{
+  VideoCommon::FlatMultiIndex<u32, int> index;
+  for (int i = 0; i < 1000; i++)
+    index.Add(i % 10, i);
+
+  // Remove every other value and reinsert, so tombstones and recycled lists get exercised.
+  for (int i = 0; i < 1000; i += 2)
+    EXPECT_TRUE(index.Remove(i % 10, [i](int value) { return value == i; }));
+  EXPECT_FALSE(index.Remove(3, [](int value) { return value == 2; }));
+  EXPECT_EQ(nullptr, index.Find(0));
+
+  for (u32 key = 1; key < 10; key += 2)
+  {
+    const auto* list = index.Find(key);
+    ASSERT_NE(nullptr, list);
+    ASSERT_EQ(100u, list->size());
+    EXPECT_TRUE(std::is_sorted(list->begin(), list->end()));
+  }
+}
+
+TEST(TextureCacheIndex, PagedRangeIndexOverlap)
+{
+  VideoCommon::PagedRangeIndex<int> index;
+  index.Insert(0, 0x10000, 0x100000);  // spans many pages
+  index.Insert(1, 0x10000, 0);         // empty, only found by its address
+  index.Insert(2, 0x8000, 0x8000);     // ends where the others start
+  index.Insert(3, 0x50000, 0x20);
+
+  EXPECT_EQ((std::vector<int>{0, 1}), Collect(index.At(0x10000)));
+  EXPECT_EQ((std::vector<int>{}), Collect(index.At(0x10004)));
+  EXPECT_EQ((std::vector<int>{}), Collect(index.At(0x900000)));
+  EXPECT_EQ((std::vector<int>{2}), index.FindOverlapping(0xFFFF, 1));
+  EXPECT_EQ((std::vector<int>{0, 1}), index.FindOverlapping(0x10000, 1));
+  EXPECT_EQ((std::vector<int>{0, 3}), index.FindOverlapping(0x40000, 0x20000));
+  EXPECT_EQ((std::vector<int>{}), index.FindOverlapping(0x110000, 0x1000));
+  std::vector<int> all = Collect(index.All());
+  std::sort(all.begin(), all.end());
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3}), all);
+
+  index.Erase(0, 0x10000);
+  EXPECT_EQ((std::vector<int>{3}), index.FindOverlapping(0x40000, 0x20000));
+  EXPECT_EQ(3u, index.size());
+}
+
+TEST(TextureCacheIndex, PagedRangeIndexEraseWhileIterating)
+{
+  VideoCommon::PagedRangeIndex<int> index;
+  for (int i = 0; i < 200; i++)
+    index.Insert(i, (i % 20) * 0x3000, i % 3 == 0 ? 0x9000 : 0x10);
+
+  // Erase every other value from under the cursor, like the texture cache does on cleanup.
+  std::vector<int> visited;
+  for (int value : index.All())
+  {
+    visited.push_back(value);
+    if (value % 2 == 0)
+      index.Erase(value, (value % 20) * 0x3000);
+  }
+  std::sort(visited.begin(), visited.end());
+  ASSERT_EQ(200u, visited.size());
+  for (int i = 0; i < 200; i++)
+    EXPECT_EQ(i, visited[i]);
+  EXPECT_EQ(100u, index.size());
+
+  // Erasing the last values at an address leaves the page empty behind the cursor.
+  visited.clear();
+  for (int value : index.At(0x3000))
+  {
+    visited.push_back(value);
+    index.Erase(value, 0x3000);
+  }
+  EXPECT_EQ((std::vector<int>{1, 21, 41, 61, 81, 101, 121, 141, 161, 181}), visited);
+  EXPECT_EQ((std::vector<int>{}), Collect(index.At(0x3000)));
+  EXPECT_EQ(90u, index.size());
+}
+
+TEST(TextureCacheIndex, MatchesMultimap)
+{
+  std::vector<FakeEntry> entries;
+  const std::vector<Op> ops = GenerateWorkload(&entries, 100000);
+
+  std::vector<std::vector<FakeEntry*>> expected, actual;
+  MultimapIndex reference;
+  FlatIndex flat;
+  Replay(&reference, &entries, ops, &expected);
+  Replay(&flat, &entries, ops, &actual);
+
+  ASSERT_EQ(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++)
+    ASSERT_EQ(expected[i], actual[i]) << "query " << i;
+}
+
+TEST(TextureCacheIndex, DISABLED_ReplaySpeed)
+{
+  std::vector<FakeEntry> entries;
+  const std::vector<Op> ops = GenerateWorkload(&entries, 200000);
+
+  const auto time = [&](auto&& index) {
+    const auto start = std::chrono::steady_clock::now();
+    const u64 checksum = Replay(&index, &entries, ops, nullptr);
+    const auto end = std::chrono::steady_clock::now();
+    return std::make_pair(
+        checksum, std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+  };
+
+  const auto reference = time(MultimapIndex());
+  const auto flat = time(FlatIndex());
+  EXPECT_EQ(reference.first, flat.first);
+  printf("texture cache index replay, %zu ops: multimap %lld us, flat %lld us\n", ops.size(),
+         static_cast<long long>(reference.second), static_cast<long long>(flat.second));
+}
+
+TEST(TextureCacheIndex, ObjectPoolReusesSlots)
+{
+  VideoCommon::ObjectPool<FakeEntry, 4> pool;
+  FakeEntry* a = pool.Allocate(FakeEntry{1, 2, 3});
+  FakeEntry* b = pool.Allocate(FakeEntry{4, 5, 6});
+  EXPECT_NE(a, b);
+  EXPECT_EQ(4u, b->addr);
+
+  pool.Free(a);
+  FakeEntry* c = pool.Allocate(FakeEntry{7, 8, 9});
+  EXPECT_EQ(a, c);
+  EXPECT_EQ(7u, c->addr);
+
+  std::vector<FakeEntry*> more;
+  for (int i = 0; i < 10; i++)
+    more.push_back(pool.Allocate(FakeEntry{}));
+  for (FakeEntry* entry : more)
+    pool.Free(entry);
+  pool.Free(b);
+  pool.Free(c);
+}
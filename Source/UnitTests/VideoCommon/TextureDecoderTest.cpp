@@ -0,0 +1,231 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/WorkerPool.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+constexpr TextureFormat ALL_FORMATS[] = {
+    TextureFormat::I4,     TextureFormat::I8,    TextureFormat::IA4,   TextureFormat::IA8,
+    TextureFormat::RGB565, TextureFormat::RGB5A3, TextureFormat::RGBA8, TextureFormat::C4,
+    TextureFormat::C8,     TextureFormat::C14X2, TextureFormat::CMPR,  TextureFormat::XFB,
+};
+
+constexpr TLUTFormat ALL_TLUT_FORMATS[] = {TLUTFormat::IA8, TLUTFormat::RGB565,
+                                           TLUTFormat::RGB5A3};
+
+// One random texture level, decoded with either the host's decoder or the generic one.
+class Level
+{
+public:
+  Level(TextureFormat format, int width, int height) : m_format(format)
+  {
+    const int block_width = TexDecoder_GetBlockWidthInTexels(format);
+    const int block_height = TexDecoder_GetBlockHeightInTexels(format);
+    m_width = (width + block_width - 1) / block_width * block_width;
+    m_height = (height + block_height - 1) / block_height * block_height;
+
+    std::mt19937 rng(static_cast<u32>(format) + 1);
+    m_src.resize(TexDecoder_GetTextureSizeInBytes(m_width, m_height, format));
+    std::generate(m_src.begin(), m_src.end(), [&] { return static_cast<u8>(rng()); });
+    // C14X2 can index 16384 palette entries, and the decoders may read past the last one.
+    m_tlut.resize(16384 * 2 + 16);
+    std::generate(m_tlut.begin(), m_tlut.end(), [&] { return static_cast<u8>(rng()); });
+    m_dst.resize(static_cast<size_t>(m_width) * m_height);
+  }
+
+  const std::vector<u32>& Decode(TLUTFormat tlut_format)
+  {
+    _TexDecoder_DecodeImpl(m_dst.data(), m_src.data(), m_width, m_height, m_format, m_tlut.data(),
+                           tlut_format);
+    return m_dst;
+  }
+
+  const std::vector<u32>& DecodeGeneric(TLUTFormat tlut_format)
+  {
+    _TexDecoder_DecodeImpl_Generic(m_dst.data(), m_src.data(), m_width, m_height, m_format,
+                                   m_tlut.data(), tlut_format);
+    return m_dst;
+  }
+
+  size_t GetSourceSize() const { return m_src.size(); }
+
+private:
+  TextureFormat m_format;
+  int m_width;
+  int m_height;
+  std::vector<u8> m_src;
+  std::vector<u8> m_tlut;
+  std::vector<u32> m_dst;
+};
+
+// Runs f once for every SIMD path the host supports.
+template <typename F>
+void ForEachDecoderPath(F f)
+{
+#ifdef _M_X86
+  const CPUInfo saved = cpu_info;
+  f("default");
+  cpu_info.bAVX2 = false;
+  f("without AVX2");
+  cpu_info.bSSSE3 = false;
+  f("without SSSE3");
+  cpu_info = saved;
+#else
+  f("default");
+#endif
+}
+
+// A texture with a full mipmap chain, laid out like the texture cache lays it out.
+class MipChain
+{
+public:
+  MipChain(TextureFormat format, int width, int height) : m_format(format)
+  {
+    const int block_width = TexDecoder_GetBlockWidthInTexels(format);
+    const int block_height = TexDecoder_GetBlockHeightInTexels(format);
+    size_t src_size = 0;
+    size_t dst_size = 0;
+    for (int level_width = width, level_height = height;;
+         level_width = std::max(level_width / 2, 1), level_height = std::max(level_height / 2, 1))
+    {
+      const int expanded_width = (level_width + block_width - 1) / block_width * block_width;
+      const int expanded_height = (level_height + block_height - 1) / block_height * block_height;
+      m_sizes.push_back({expanded_width, expanded_height});
+      src_size += TexDecoder_GetTextureSizeInBytes(expanded_width, expanded_height, format);
+      dst_size += static_cast<size_t>(expanded_width) * expanded_height * sizeof(u32);
+      if (level_width == 1 && level_height == 1)
+        break;
+    }
+
+    std::mt19937 rng(static_cast<u32>(format));
+    m_src.resize(src_size);
+    std::generate(m_src.begin(), m_src.end(), [&] { return static_cast<u8>(rng()); });
+    // C14X2 can index 16384 palette entries.
+    m_tlut.resize(16384 * 2);
+    std::generate(m_tlut.begin(), m_tlut.end(), [&] { return static_cast<u8>(rng()); });
+    m_dst.resize(dst_size);
+  }
+
+  const std::vector<u8>& Decode(Common::WorkerPool* pool)
+  {
+    std::fill(m_dst.begin(), m_dst.end(), 0);
+    std::vector<TexDecoderLevel> levels;
+    const u8* src = m_src.data();
+    u8* dst = m_dst.data();
+    for (const auto& size : m_sizes)
+    {
+      levels.push_back({dst, src, size.first, size.second});
+      src += TexDecoder_GetTextureSizeInBytes(size.first, size.second, m_format);
+      dst += static_cast<size_t>(size.first) * size.second * sizeof(u32);
+    }
+    TexDecoder_DecodeLevels(pool, levels.data(), levels.size(), m_format, m_tlut.data(),
+                            TLUTFormat::RGB5A3);
+    return m_dst;
+  }
+
+private:
+  TextureFormat m_format;
+  std::vector<std::pair<int, int>> m_sizes;
+  std::vector<u8> m_src;
+  std::vector<u8> m_tlut;
+  std::vector<u8> m_dst;
+};
+}  // namespace
+
+TEST(TextureDecoder, MatchesGenericDecoder)
+{
+  for (TextureFormat format : ALL_FORMATS)
+  {
+    Level level(format, 200, 120);
+    for (TLUTFormat tlut_format : ALL_TLUT_FORMATS)
+    {
+      const std::vector<u32> expected = level.DecodeGeneric(tlut_format);
+      ForEachDecoderPath([&](const char* path) {
+        const std::vector<u32>& actual = level.Decode(tlut_format);
+        const auto mismatch = std::mismatch(expected.begin(), expected.end(), actual.begin());
+        EXPECT_TRUE(mismatch.first == expected.end())
+            << "format " << static_cast<int>(format) << " TLUT format "
+            << static_cast<int>(tlut_format) << " " << path << ": texel "
+            << (mismatch.first - expected.begin()) << " is " << std::hex << *mismatch.second
+            << ", expected " << *mismatch.first;
+      });
+    }
+  }
+}
+
+TEST(TextureDecoder, DISABLED_DecodeSpeed)
+{
+  const auto time = [](auto&& decode) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 20; ++i)
+      decode();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / 20;
+  };
+
+  for (TextureFormat format : ALL_FORMATS)
+  {
+    Level level(format, 1024, 1024);
+    const double generic = time([&] { level.DecodeGeneric(TLUTFormat::RGB5A3); });
+    printf("format %2d, generic: %7.1f MB/s", static_cast<int>(format),
+           level.GetSourceSize() / generic / 1e6);
+    ForEachDecoderPath([&](const char* path) {
+      const double seconds = time([&] { level.Decode(TLUTFormat::RGB5A3); });
+      printf(", %s: %7.1f MB/s", path, level.GetSourceSize() / seconds / 1e6);
+    });
+    printf("\n");
+  }
+}
+
+TEST(TextureDecoder, ParallelMatchesSerial)
+{
+  Common::WorkerPool serial;
+  Common::WorkerPool parallel(3, "Texture Decoder");
+
+  for (bool overlay : {false, true})
+  {
+    TexDecoder_SetTexFmtOverlayOptions(overlay, false);
+    for (TextureFormat format : ALL_FORMATS)
+    {
+      // Odd sizes, so some levels don't fill their last block row.
+      MipChain texture(format, 640, 452);
+      const std::vector<u8> expected = texture.Decode(&serial);
+      EXPECT_TRUE(expected == texture.Decode(&parallel))
+          << "format " << static_cast<int>(format) << " overlay " << overlay;
+    }
+  }
+  TexDecoder_SetTexFmtOverlayOptions(false, false);
+}
+
+TEST(TextureDecoder, DISABLED_ParallelDecodeSpeed)
+{
+  const int max_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+  for (TextureFormat format : {TextureFormat::RGB5A3, TextureFormat::RGBA8, TextureFormat::CMPR})
+  {
+    MipChain texture(format, 1024, 1024);
+    for (int threads = 0; threads <= max_threads; threads++)
+    {
+      Common::WorkerPool pool(threads, "Texture Decoder");
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < 20; ++i)
+        texture.Decode(&pool);
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+      printf("format %d, worker threads: %d, %lld us\n", static_cast<int>(format), threads,
+             static_cast<long long>(
+                 std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+  }
+}
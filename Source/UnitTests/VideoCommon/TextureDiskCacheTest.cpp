@@ -0,0 +1,167 @@
+// Copyright 2018 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/TextureDiskCache.h"
+
+using VideoCommon::TextureDiskCache;
+
+class TextureDiskCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = File::CreateTempDir();
+    m_filename = m_directory + "/test.cache";
+  }
+
+  void TearDown() override { File::DeleteDirRecursively(m_directory); }
+
+  static TextureDiskCache::Key MakeKey(u64 hash)
+  {
+    TextureDiskCache::Key key = {};
+    key.base_hash = hash;
+    key.full_hash = hash * 3;
+    key.format = 1;
+    key.width = 8;
+    key.height = 8;
+    key.levels = 1;
+    return key;
+  }
+
+  static std::vector<u8> MakeData(size_t size, u8 seed)
+  {
+    std::vector<u8> data(size);
+    for (size_t i = 0; i < size; ++i)
+      data[i] = static_cast<u8>(seed + i * 7);
+    return data;
+  }
+
+  static bool Matches(const u8* cached, const std::vector<u8>& data)
+  {
+    return cached && std::memcmp(cached, data.data(), data.size()) == 0;
+  }
+
+  std::string m_directory;
+  std::string m_filename;
+};
+
+TEST_F(TextureDiskCacheTest, StoresAcrossSessions)
+{
+  const std::vector<u8> first = MakeData(256, 1);
+  const std::vector<u8> second = MakeData(100, 2);
+
+  TextureDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename, 1 << 20));
+  cache.Store(MakeKey(1), first.data(), first.size());
+  cache.Store(MakeKey(2), second.data(), second.size());
+  EXPECT_EQ(2u, cache.GetEntryCount());
+  cache.Close();
+
+  ASSERT_TRUE(cache.Open(m_filename, 1 << 20));
+  EXPECT_EQ(2u, cache.GetEntryCount());
+  EXPECT_TRUE(Matches(cache.Lookup(MakeKey(1), first.size()), first));
+  EXPECT_TRUE(Matches(cache.Lookup(MakeKey(2), second.size()), second));
+
+  // Different keys and sizes don't match.
+  TextureDiskCache::Key other_format = MakeKey(1);
+  other_format.format = 2;
+  EXPECT_EQ(nullptr, cache.Lookup(other_format, first.size()));
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(3), first.size()));
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(1), first.size() + 1));
+}
+
+TEST_F(TextureDiskCacheTest, LooksUpRecordsWrittenInTheSameSession)
+{
+  const std::vector<u8> data = MakeData(4096, 3);
+
+  TextureDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename, 1 << 20));
+  cache.Store(MakeKey(1), data.data(), data.size());
+
+  // The record is written in the background, so it may not be there yet.
+  const u8* cached = nullptr;
+  for (int i = 0; i < 1000 && !cached; ++i)
+  {
+    cached = cache.Lookup(MakeKey(1), data.size());
+    if (!cached)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_TRUE(Matches(cached, data));
+}
+
+TEST_F(TextureDiskCacheTest, DropsLeastRecentlyUsedRecords)
+{
+  const std::vector<u8> data = MakeData(1024, 4);
+  // Room for a few records. Trimming keeps three quarters of the limit.
+  constexpr u64 limit = 4 * (1024 + 64);
+
+  TextureDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename, limit));
+  for (u64 i = 0; i < 3; ++i)
+    cache.Store(MakeKey(i), data.data(), data.size());
+  cache.Close();
+
+  // Use the first record, then go over the limit.
+  ASSERT_TRUE(cache.Open(m_filename, limit));
+  EXPECT_NE(nullptr, cache.Lookup(MakeKey(0), data.size()));
+  cache.Store(MakeKey(3), data.data(), data.size());
+  cache.Store(MakeKey(4), data.data(), data.size());
+  EXPECT_EQ(5u, cache.GetEntryCount());
+
+  // Nothing is added once the limit has been exceeded.
+  cache.Store(MakeKey(5), data.data(), data.size());
+  EXPECT_EQ(5u, cache.GetEntryCount());
+  cache.Close();
+
+  ASSERT_TRUE(cache.Open(m_filename, limit));
+  EXPECT_LE(cache.GetSize(), limit / 4 * 3);
+  EXPECT_EQ(3u, cache.GetEntryCount());
+  EXPECT_TRUE(Matches(cache.Lookup(MakeKey(0), data.size()), data));
+  EXPECT_TRUE(Matches(cache.Lookup(MakeKey(3), data.size()), data));
+  EXPECT_TRUE(Matches(cache.Lookup(MakeKey(4), data.size()), data));
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(1), data.size()));
+  EXPECT_EQ(nullptr, cache.Lookup(MakeKey(2), data.size()));
+}
+
+TEST_F(TextureDiskCacheTest, RecoversFromDamagedFiles)
+{
+  const std::vector<u8> data = MakeData(512, 5);
+
+  TextureDiskCache cache;
+  ASSERT_TRUE(cache.Open(m_filename, 1 << 20));
+  cache.Store(MakeKey(1), data.data(), data.size());
+  cache.Store(MakeKey(2), data.data(), data.size());
+  cache.Close();
+
+  // Cut off the second record, as if writing it had been interrupted.
+  {
+    File::IOFile file(m_filename, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 100));
+  }
+  ASSERT_TRUE(cache.Open(m_filename, 1 << 20));
+  EXPECT_EQ(1u, cache.GetEntryCount());
+  EXPECT_TRUE(Matches(cache.Lookup(MakeKey(1), data.size()), data));
+  cache.Store(MakeKey(2), data.data(), data.size());
+  cache.Close();
+
+  ASSERT_TRUE(cache.Open(m_filename, 1 << 20));
+  EXPECT_TRUE(Matches(cache.Lookup(MakeKey(2), data.size()), data));
+  cache.Close();
+
+  // Files which aren't caches are replaced.
+  ASSERT_TRUE(File::WriteStringToFile("not a texture cache", m_filename));
+  ASSERT_TRUE(cache.Open(m_filename, 1 << 20));
+  EXPECT_EQ(0u, cache.GetEntryCount());
+}
@@ -2,11 +2,17 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>  // NOLINT
 
@@ -14,9 +20,11 @@
 #include "Common/Common.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VertexLoaderBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VideoConfig.h"
 
 TEST(VertexLoaderUID, UniqueEnough)
 {
@@ -354,3 +362,115 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
   for (int i = 0; i < 100; ++i)
     RunVertices(100000);
 }
+
+class VertexLoaderParallelTest : public VertexLoaderTest
+{
+protected:
+  static constexpr int NUM_VERTICES = 59999;
+  static constexpr size_t OUTPUT_HALF = sizeof(output_memory) / 2;
+
+  void SetUp() override
+  {
+    VertexLoaderTest::SetUp();
+
+    m_vtx_desc.PosMatIdx = 1;
+    m_vtx_desc.Position = DIRECT;
+    m_vtx_attr.g0.PosElements = 1;  // XYZ
+    m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+    m_vtx_desc.Color0 = DIRECT;
+    m_vtx_attr.g0.Color0Elements = 1;  // Has Alpha
+    m_vtx_attr.g0.Color0Comp = FORMAT_32B_8888;
+    m_vtx_desc.Tex0Coord = DIRECT;
+    m_vtx_attr.g0.Tex0CoordElements = 1;  // ST
+    m_vtx_attr.g0.Tex0CoordFormat = FORMAT_SHORT;
+    CreateAndCheckSizes(1 + 12 + 4 + 4, 4 + 12 + 4 + 8);
+
+    for (int i = 0; i < NUM_VERTICES; i++)
+    {
+      Input<u8>(i & 0x3f);
+      Input(static_cast<float>(i));
+      Input(static_cast<float>(-i));
+      Input(static_cast<float>(i) * 0.5f);
+      Input<u32>(static_cast<u32>(i) * 0x01010101);
+      Input<s16>(static_cast<s16>(i));
+      Input<s16>(static_cast<s16>(-i));
+    }
+
+    g_Config.backend_info.bSupportsPrimitiveRestart = false;
+    IndexGenerator::Init();
+  }
+
+  void TearDown() override
+  {
+    VertexLoaderManager::Shutdown();
+    g_ActiveConfig.iVertexLoaderThreads = 0;
+  }
+
+  // Converts the vertices with the given number of worker threads into the selected output half.
+  int Convert(int threads, int primitive, int half)
+  {
+    g_ActiveConfig.iVertexLoaderThreads = threads;
+    ResetPointers();
+    u8* const dst = output_memory + half * OUTPUT_HALF;
+    IndexGenerator::Start(m_indices[half].data());
+    return VertexLoaderManager::ConvertVertices(m_loader.get(), primitive, NUM_VERTICES, m_src,
+                                                DataReader(dst, dst + OUTPUT_HALF));
+  }
+
+  std::array<std::vector<u16>, 2> m_indices{{std::vector<u16>(NUM_VERTICES * 3),
+                                             std::vector<u16>(NUM_VERTICES * 3)}};
+};
+
+TEST_F(VertexLoaderParallelTest, MatchesSerial)
+{
+  for (int primitive : {OpcodeDecoder::GX_DRAW_QUADS, OpcodeDecoder::GX_DRAW_TRIANGLES,
+                        OpcodeDecoder::GX_DRAW_TRIANGLE_STRIP, OpcodeDecoder::GX_DRAW_POINTS})
+  {
+    const int serial_count = Convert(0, primitive, 0);
+    const u32 serial_indices = IndexGenerator::GetIndexLen();
+    float serial_position_cache[3][4];
+    std::memcpy(serial_position_cache, VertexLoaderManager::position_cache,
+                sizeof(serial_position_cache));
+    u32 serial_position_matrix_index[4];
+    std::memcpy(serial_position_matrix_index, VertexLoaderManager::position_matrix_index,
+                sizeof(serial_position_matrix_index));
+    std::memset(VertexLoaderManager::position_cache, 0xff,
+                sizeof(VertexLoaderManager::position_cache));
+    std::memset(VertexLoaderManager::position_matrix_index, 0xff,
+                sizeof(VertexLoaderManager::position_matrix_index));
+
+    const int parallel_count = Convert(3, primitive, 1);
+    const u32 parallel_indices = IndexGenerator::GetIndexLen();
+
+    ASSERT_EQ(NUM_VERTICES, serial_count);
+    ASSERT_EQ(serial_count, parallel_count);
+    EXPECT_EQ(0, std::memcmp(output_memory, output_memory + OUTPUT_HALF,
+                             NUM_VERTICES * m_loader->m_native_vtx_decl.stride));
+    for (int i = 0; i < 3; i++)
+    {
+      EXPECT_EQ(0, std::memcmp(serial_position_cache[i], VertexLoaderManager::position_cache[i],
+                               m_loader->m_native_vtx_decl.position.components * sizeof(float)));
+    }
+    EXPECT_TRUE(std::equal(serial_position_matrix_index + 1, serial_position_matrix_index + 4,
+                           VertexLoaderManager::position_matrix_index + 1));
+    ASSERT_EQ(serial_indices, parallel_indices);
+    EXPECT_TRUE(std::equal(m_indices[0].begin(), m_indices[0].begin() + serial_indices,
+                           m_indices[1].begin()));
+  }
+}
+
+TEST_F(VertexLoaderParallelTest, DISABLED_ConversionSpeed)
+{
+  const int max_threads =
+      std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+  for (int threads = 0; threads <= max_threads; threads++)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 100; ++i)
+      Convert(threads, OpcodeDecoder::GX_DRAW_TRIANGLES, 0);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    printf("worker threads: %d, %lld us\n", threads,
+           static_cast<long long>(
+               std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+  }
+}